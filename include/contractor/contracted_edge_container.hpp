@@ -33,6 +33,7 @@ struct ContractedEdgeContainer
                         lhs.data.turn_id,
                         lhs.data.weight,
                         lhs.data.duration,
+                        lhs.data.distance,
                         lhs.data.forward,
                         lhs.data.backward) < std::tie(rhs.source,
                                                       rhs.target,
@@ -40,6 +41,7 @@ struct ContractedEdgeContainer
                                                       rhs.data.turn_id,
                                                       rhs.data.weight,
                                                       rhs.data.duration,
+                                                      rhs.data.distance,
                                                       rhs.data.forward,
                                                       rhs.data.backward);
     }
@@ -43,7 +43,11 @@ namespace contractor
 struct ContractorConfig final : storage::IOConfig
 {
     ContractorConfig()
-        : IOConfig({".osrm.ebg", ".osrm.ebg_nodes", ".osrm.properties"},
+        : IOConfig({".osrm.ebg",
+                    ".osrm.ebg_nodes",
+                    ".osrm.properties",
+                    ".osrm.geometry",
+                    ".osrm.nbg_nodes"},
                    {},
                    {".osrm.hsgr", ".osrm.enw"}),
           requested_num_threads(0)
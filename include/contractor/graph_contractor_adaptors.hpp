@@ -6,6 +6,8 @@
 #include "util/log.hpp"
 #include "util/percent.hpp"
 
+#include <boost/assert.hpp>
+
 #include <tbb/parallel_sort.h>
 
 #include <vector>
@@ -16,9 +18,14 @@ namespace contractor
 {
 
 // Make sure to move in the input edge list!
+// An edge has the length of its source node, node_distances holds them for all nodes.
 template <typename InputEdgeContainer>
-ContractorGraph toContractorGraph(NodeID number_of_nodes, InputEdgeContainer input_edge_list)
+ContractorGraph toContractorGraph(NodeID number_of_nodes,
+                                  InputEdgeContainer input_edge_list,
+                                  const std::vector<EdgeDistance> &node_distances)
 {
+    BOOST_ASSERT(node_distances.size() == number_of_nodes);
+
     std::vector<ContractorEdge> edges;
     edges.reserve(input_edge_list.size() * 2);
 
@@ -41,6 +48,7 @@ ContractorGraph toContractorGraph(NodeID number_of_nodes, InputEdgeContainer inp
                            input_edge.target,
                            std::max(input_edge.data.weight, 1),
                            input_edge.data.duration,
+                           0, // set below, depends on the direction
                            1,
                            input_edge.data.turn_id,
                            false,
@@ -51,6 +59,7 @@ ContractorGraph toContractorGraph(NodeID number_of_nodes, InputEdgeContainer inp
                            input_edge.source,
                            std::max(input_edge.data.weight, 1),
                            input_edge.data.duration,
+                           0,
                            1,
                            input_edge.data.turn_id,
                            false,
@@ -82,6 +91,9 @@ ContractorGraph toContractorGraph(NodeID number_of_nodes, InputEdgeContainer inp
         forward_edge.data.originalEdges = reverse_edge.data.originalEdges = 1;
         forward_edge.data.weight = reverse_edge.data.weight = INVALID_EDGE_WEIGHT;
         forward_edge.data.duration = reverse_edge.data.duration = MAXIMAL_EDGE_DURATION;
+        // the reverse edge stands for the edge from target to source
+        forward_edge.data.distance = node_distances[source];
+        reverse_edge.data.distance = node_distances[target];
         // remove parallel edges
         while (i < edges.size() && edges[i].source == source && edges[i].target == target)
         {
@@ -100,7 +112,8 @@ ContractorGraph toContractorGraph(NodeID number_of_nodes, InputEdgeContainer inp
             ++i;
         }
         // merge edges (s,t) and (t,s) into bidirectional edge
-        if (forward_edge.data.weight == reverse_edge.data.weight)
+        if (forward_edge.data.weight == reverse_edge.data.weight &&
+            forward_edge.data.distance == reverse_edge.data.distance)
         {
             if ((int)forward_edge.data.weight != INVALID_EDGE_WEIGHT)
             {
@@ -151,6 +164,7 @@ template <class Edge, typename GraphT> inline std::vector<Edge> toEdges(GraphT g
                 BOOST_ASSERT_MSG(SPECIAL_NODEID != new_edge.target, "Target id invalid");
                 new_edge.data.weight = data.weight;
                 new_edge.data.duration = data.duration;
+                new_edge.data.distance = data.distance;
                 new_edge.data.shortcut = data.shortcut;
                 new_edge.data.turn_id = data.id;
                 BOOST_ASSERT_MSG(new_edge.data.turn_id != INT_MAX, // 2^31
@@ -17,7 +17,8 @@ struct QueryEdge
     struct EdgeData
     {
         explicit EdgeData()
-            : turn_id(0), shortcut(false), weight(0), duration(0), forward(false), backward(false)
+            : turn_id(0), shortcut(false), weight(0), duration(0), forward(false), backward(false),
+              distance(0)
         {
         }
 
@@ -25,10 +26,11 @@ struct QueryEdge
                  const bool shortcut,
                  const EdgeWeight weight,
                  const EdgeWeight duration,
+                 const EdgeDistance distance,
                  const bool forward,
                  const bool backward)
             : turn_id(turn_id), shortcut(shortcut), weight(weight), duration(duration),
-              forward(forward), backward(backward)
+              forward(forward), backward(backward), distance(distance)
         {
         }
 
@@ -36,6 +38,7 @@ struct QueryEdge
         {
             weight = other.weight;
             duration = other.duration;
+            distance = other.distance;
             shortcut = other.shortcut;
             turn_id = other.id;
             forward = other.forward;
@@ -50,6 +53,8 @@ struct QueryEdge
         EdgeWeight duration : 30;
         std::uint32_t forward : 1;
         std::uint32_t backward : 1;
+        // length of the unpacked path, the sum of the lengths of all but its last edge based node
+        EdgeDistance distance;
     } data;
 
     QueryEdge() : source(SPECIAL_NODEID), target(SPECIAL_NODEID) {}
@@ -68,6 +73,7 @@ struct QueryEdge
     {
         return (source == right.source && target == right.target &&
                 data.weight == right.data.weight && data.duration == right.data.duration &&
+                data.distance == right.data.distance &&
                 data.shortcut == right.data.shortcut && data.forward == right.data.forward &&
                 data.backward == right.data.backward && data.turn_id == right.data.turn_id);
     }
@@ -5,8 +5,11 @@
 #include "engine/datafacade/datafacade_base.hpp"
 
 #include "engine/api/json_factory.hpp"
+#include "engine/api/pbf_factory.hpp"
 #include "engine/hint.hpp"
 
+#include "util/json_writer.hpp"
+
 #include <boost/assert.hpp>
 #include <boost/range/algorithm/transform.hpp>
 
@@ -66,6 +69,56 @@ class BaseAPI
         }
     }
 
+    // Streaming counterpart of MakeWaypoint, the object is left open for additional members
+    void StartWaypoint(util::json::Writer &writer, const PhantomNode &phantom) const
+    {
+        writer.StartObject();
+        writer.Key("location");
+        writer.StartArray();
+        writer.Number(static_cast<double>(util::toFloating(phantom.location.lon)));
+        writer.Number(static_cast<double>(util::toFloating(phantom.location.lat)));
+        writer.EndArray();
+        writer.Key("name");
+        writer.String(
+            facade.GetNameForID(facade.GetNameIndex(phantom.forward_segment_id.id)).to_string());
+        if (parameters.generate_hints)
+        {
+            writer.Key("hint");
+            writer.String(Hint{phantom, facade.GetCheckSum()}.ToBase64());
+        }
+    }
+
+    // Protobuf counterpart of MakeWaypoints, adds one Waypoint message per coordinate
+    void WriteWaypoints(protozero::pbf_writer &writer,
+                        const protozero::pbf_tag_type tag,
+                        const std::vector<PhantomNodes> &segment_end_coordinates) const
+    {
+        BOOST_ASSERT(parameters.coordinates.size() == segment_end_coordinates.size() + 1);
+        {
+            protozero::pbf_writer waypoint(writer, tag);
+            WriteWaypoint(waypoint, segment_end_coordinates.front().source_phantom);
+        }
+        for (const auto &phantom_pair : segment_end_coordinates)
+        {
+            protozero::pbf_writer waypoint(writer, tag);
+            WriteWaypoint(waypoint, phantom_pair.target_phantom);
+        }
+    }
+
+    // Protobuf counterpart of MakeWaypoint, fills an already started Waypoint message
+    void WriteWaypoint(protozero::pbf_writer &waypoint, const PhantomNode &phantom) const
+    {
+        waypoint.add_string(
+            pbf::waypoint::name,
+            facade.GetNameForID(facade.GetNameIndex(phantom.forward_segment_id.id)).to_string());
+        pbf::writeLocation(waypoint, pbf::waypoint::location, phantom.location);
+        if (parameters.generate_hints)
+        {
+            waypoint.add_string(pbf::waypoint::hint,
+                                Hint{phantom, facade.GetCheckSum()}.ToBase64());
+        }
+    }
+
     const datafacade::BaseDataFacade &facade;
     const BaseParameters &parameters;
 };
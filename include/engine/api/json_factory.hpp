@@ -35,6 +35,15 @@ namespace detail
 
 util::json::Array coordinateToLonLat(const util::Coordinate coordinate);
 
+// Check whether to include a modifier in the result of the API
+inline bool isValidModifier(const guidance::StepManeuver maneuver)
+{
+    return (maneuver.waypoint_type == guidance::WaypointType::None ||
+            maneuver.instruction.direction_modifier != osrm::guidance::DirectionModifier::UTurn);
+}
+
+std::string waypointTypeToString(const guidance::WaypointType waypoint_type);
+
 /**
  * Ensures that a bearing value is a whole number, and clamped to the range 0-359
  */
@@ -30,6 +30,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "engine/api/route_parameters.hpp"
 
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -44,6 +45,9 @@ namespace api
  *
  * Holds member attributes:
  *  - timestamps: timestamp(s) for the corresponding input coordinate(s)
+ *  - session: name of a matching session, the coordinates are appended to its trace and only
+ *             the matchings that became final are returned
+ *  - close_session: matches the rest of the session trace and removes the session
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -88,9 +92,21 @@ struct MatchParameters : public RouteParameters
     GapsType gaps;
     bool tidy;
     std::vector<std::size_t> waypoints;
+    std::string session;
+    bool close_session = false;
 
     bool IsValid() const
     {
+        if (!session.empty())
+        {
+            // the coordinates continue the trace of the session, closing it needs none
+            return BaseParameters::IsValid() && (!coordinates.empty() || close_session) &&
+                   (timestamps.empty() || timestamps.size() == coordinates.size()) && !tidy &&
+                   waypoints.empty();
+        }
+        if (close_session)
+            return false;
+
         const auto valid_waypoints =
             std::all_of(waypoints.begin(), waypoints.end(), [this](const auto &w) {
                 return w < coordinates.size();
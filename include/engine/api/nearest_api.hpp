@@ -9,6 +9,12 @@
 
 #include <boost/assert.hpp>
 
+#include <protozero/pbf_writer.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -44,39 +50,8 @@ class NearestAPI final : public BaseAPI
                 waypoint.values["distance"] = phantom_with_distance.distance;
 
                 util::json::Array nodes;
-
-                std::uint64_t from_node = 0;
-                std::uint64_t to_node = 0;
-
-                datafacade::BaseDataFacade::NodeForwardRange forward_geometry;
-                if (phantom_node.forward_segment_id.enabled)
-                {
-                    auto segment_id = phantom_node.forward_segment_id.id;
-                    const auto geometry_id = facade.GetGeometryIndex(segment_id).id;
-                    forward_geometry = facade.GetUncompressedForwardGeometry(geometry_id);
-
-                    auto osm_node_id = facade.GetOSMNodeIDOfNode(
-                        forward_geometry(phantom_node.fwd_segment_position));
-                    to_node = static_cast<std::uint64_t>(osm_node_id);
-                }
-
-                if (phantom_node.reverse_segment_id.enabled)
-                {
-                    auto segment_id = phantom_node.reverse_segment_id.id;
-                    const auto geometry_id = facade.GetGeometryIndex(segment_id).id;
-                    const auto geometry = facade.GetUncompressedForwardGeometry(geometry_id);
-                    auto osm_node_id =
-                        facade.GetOSMNodeIDOfNode(geometry(phantom_node.fwd_segment_position + 1));
-                    from_node = static_cast<std::uint64_t>(osm_node_id);
-                }
-                else if (phantom_node.forward_segment_id.enabled &&
-                         phantom_node.fwd_segment_position > 0)
-                {
-                    // In the case of one way, rely on forward segment only
-                    auto osm_node_id = facade.GetOSMNodeIDOfNode(
-                        forward_geometry(phantom_node.fwd_segment_position - 1));
-                    from_node = static_cast<std::uint64_t>(osm_node_id);
-                }
+                std::uint64_t from_node, to_node;
+                std::tie(from_node, to_node) = GetNodes(phantom_node);
                 nodes.values.push_back(from_node);
                 nodes.values.push_back(to_node);
                 waypoint.values["nodes"] = std::move(nodes);
@@ -88,7 +63,98 @@ class NearestAPI final : public BaseAPI
         response.values["waypoints"] = std::move(waypoints);
     }
 
+    // Same response as above, written straight into the buffer of the writer
+    void MakeResponse(const std::vector<std::vector<PhantomNodeWithDistance>> &phantom_nodes,
+                      util::json::Writer &writer) const
+    {
+        BOOST_ASSERT(phantom_nodes.size() == 1);
+        BOOST_ASSERT(parameters.coordinates.size() == 1);
+
+        writer.StartObject();
+        writer.Key("code");
+        writer.String("Ok");
+        writer.Key("waypoints");
+        writer.StartArray();
+        for (const auto &phantom_with_distance : phantom_nodes.front())
+        {
+            const auto &phantom_node = phantom_with_distance.phantom_node;
+            StartWaypoint(writer, phantom_node);
+            writer.Key("distance");
+            writer.Number(phantom_with_distance.distance);
+
+            std::uint64_t from_node, to_node;
+            std::tie(from_node, to_node) = GetNodes(phantom_node);
+            writer.Key("nodes");
+            writer.StartArray();
+            writer.Number(from_node);
+            writer.Number(to_node);
+            writer.EndArray();
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+
+    // Protobuf response, see docs/pbf_response.proto
+    void MakeResponse(const std::vector<std::vector<PhantomNodeWithDistance>> &phantom_nodes,
+                      protozero::pbf_writer &response) const
+    {
+        BOOST_ASSERT(phantom_nodes.size() == 1);
+        BOOST_ASSERT(parameters.coordinates.size() == 1);
+
+        response.add_string(pbf::response::code, "Ok");
+        for (const auto &phantom_with_distance : phantom_nodes.front())
+        {
+            const auto &phantom_node = phantom_with_distance.phantom_node;
+            protozero::pbf_writer waypoint(response, pbf::response::waypoints);
+            WriteWaypoint(waypoint, phantom_node);
+            waypoint.add_double(pbf::waypoint::distance, phantom_with_distance.distance);
+
+            std::uint64_t nodes[2];
+            std::tie(nodes[0], nodes[1]) = GetNodes(phantom_node);
+            waypoint.add_packed_uint64(pbf::waypoint::nodes, std::begin(nodes), std::end(nodes));
+        }
+    }
+
     const NearestParameters &parameters;
+
+  private:
+    // OSM node ids of the segment the phantom node is on
+    std::pair<std::uint64_t, std::uint64_t> GetNodes(const PhantomNode &phantom_node) const
+    {
+        std::uint64_t from_node = 0;
+        std::uint64_t to_node = 0;
+
+        datafacade::BaseDataFacade::NodeForwardRange forward_geometry;
+        if (phantom_node.forward_segment_id.enabled)
+        {
+            auto segment_id = phantom_node.forward_segment_id.id;
+            const auto geometry_id = facade.GetGeometryIndex(segment_id).id;
+            forward_geometry = facade.GetUncompressedForwardGeometry(geometry_id);
+
+            auto osm_node_id = facade.GetOSMNodeIDOfNode(
+                forward_geometry(phantom_node.fwd_segment_position));
+            to_node = static_cast<std::uint64_t>(osm_node_id);
+        }
+
+        if (phantom_node.reverse_segment_id.enabled)
+        {
+            auto segment_id = phantom_node.reverse_segment_id.id;
+            const auto geometry_id = facade.GetGeometryIndex(segment_id).id;
+            const auto geometry = facade.GetUncompressedForwardGeometry(geometry_id);
+            auto osm_node_id =
+                facade.GetOSMNodeIDOfNode(geometry(phantom_node.fwd_segment_position + 1));
+            from_node = static_cast<std::uint64_t>(osm_node_id);
+        }
+        else if (phantom_node.forward_segment_id.enabled && phantom_node.fwd_segment_position > 0)
+        {
+            // In the case of one way, rely on forward segment only
+            auto osm_node_id = facade.GetOSMNodeIDOfNode(
+                forward_geometry(phantom_node.fwd_segment_position - 1));
+            from_node = static_cast<std::uint64_t>(osm_node_id);
+        }
+        return std::make_pair(from_node, to_node);
+    }
 };
 
 } // ns api
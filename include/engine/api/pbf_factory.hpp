@@ -0,0 +1,55 @@
+#ifndef ENGINE_API_PBF_FACTORY_HPP
+#define ENGINE_API_PBF_FACTORY_HPP
+
+#include "engine/api/pbf_schema.hpp"
+#include "engine/guidance/route.hpp"
+#include "engine/guidance/route_leg.hpp"
+#include "engine/guidance/route_step.hpp"
+#include "engine/guidance/step_maneuver.hpp"
+
+#include <protozero/pbf_writer.hpp>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+namespace pbf
+{
+
+void writeStepManeuver(protozero::pbf_writer &writer, const guidance::StepManeuver &step_maneuver);
+
+namespace detail
+{
+// All step fields except for geometry and maneuver
+void writeRouteStepProperties(protozero::pbf_writer &writer, const guidance::RouteStep &route_step);
+} // namespace detail
+
+// The geometry of the step is passed separately, it is a range of the leg geometry
+template <typename ForwardIter>
+void writeRouteStep(protozero::pbf_writer &writer,
+                    const guidance::RouteStep &route_step,
+                    ForwardIter geometry_begin,
+                    ForwardIter geometry_end)
+{
+    detail::writeRouteStepProperties(writer, route_step);
+    writeGeometry(writer, step::geometry, geometry_begin, geometry_end);
+    protozero::pbf_writer maneuver_writer(writer, step::maneuver);
+    writeStepManeuver(maneuver_writer, route_step.maneuver);
+}
+
+// Steps and annotation are added by the caller
+void writeRouteLeg(protozero::pbf_writer &writer, const guidance::RouteLeg &route_leg);
+
+// Geometry and legs are added by the caller
+void writeRoute(protozero::pbf_writer &writer,
+                const guidance::Route &guidance_route,
+                const char *weight_name);
+
+} // namespace pbf
+} // namespace api
+} // namespace engine
+} // namespace osrm
+
+#endif // ENGINE_API_PBF_FACTORY_HPP
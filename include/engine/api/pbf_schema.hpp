@@ -0,0 +1,168 @@
+#ifndef ENGINE_API_PBF_SCHEMA_HPP
+#define ENGINE_API_PBF_SCHEMA_HPP
+
+#include "util/coordinate.hpp"
+
+#include <protozero/pbf_writer.hpp>
+
+#include <cstdint>
+#include <iterator>
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+namespace pbf
+{
+
+// Field numbers of the messages in docs/pbf_response.proto
+namespace response
+{
+enum : protozero::pbf_tag_type
+{
+    code = 1,
+    message = 2,
+    waypoints = 3,
+    routes = 4,
+    sources = 5,
+    destinations = 6,
+    durations = 7,
+    distances = 8
+};
+}
+
+namespace waypoint
+{
+enum : protozero::pbf_tag_type
+{
+    name = 1,
+    location = 2,
+    hint = 3,
+    distance = 4,
+    nodes = 5
+};
+}
+
+namespace route
+{
+enum : protozero::pbf_tag_type
+{
+    distance = 1,
+    duration = 2,
+    weight = 3,
+    weight_name = 4,
+    geometry = 5,
+    legs = 6
+};
+}
+
+namespace leg
+{
+enum : protozero::pbf_tag_type
+{
+    distance = 1,
+    duration = 2,
+    weight = 3,
+    summary = 4,
+    steps = 5,
+    annotation = 6
+};
+}
+
+namespace step
+{
+enum : protozero::pbf_tag_type
+{
+    distance = 1,
+    duration = 2,
+    weight = 3,
+    name = 4,
+    ref = 5,
+    pronunciation = 6,
+    destinations = 7,
+    exits = 8,
+    rotary_name = 9,
+    rotary_pronunciation = 10,
+    mode = 11,
+    driving_side = 12,
+    geometry = 13,
+    maneuver = 14
+};
+}
+
+namespace maneuver
+{
+enum : protozero::pbf_tag_type
+{
+    type = 1,
+    modifier = 2,
+    location = 3,
+    bearing_before = 4,
+    bearing_after = 5,
+    exit = 6
+};
+}
+
+namespace annotation
+{
+enum : protozero::pbf_tag_type
+{
+    duration = 1,
+    distance = 2,
+    weight = 3,
+    speed = 4,
+    datasources = 5,
+    nodes = 6,
+    datasource_names = 7
+};
+}
+
+// Fixed point longitude and latitude as packed field
+inline void writeLocation(protozero::pbf_writer &writer,
+                          const protozero::pbf_tag_type tag,
+                          const util::Coordinate location)
+{
+    const std::int32_t lon_lat[] = {static_cast<std::int32_t>(location.lon),
+                                    static_cast<std::int32_t>(location.lat)};
+    writer.add_packed_sint32(tag, std::begin(lon_lat), std::end(lon_lat));
+}
+
+// Fixed point coordinates, all but the first one relative to their predecessor
+template <typename ForwardIter>
+void writeGeometry(protozero::pbf_writer &writer,
+                   const protozero::pbf_tag_type tag,
+                   ForwardIter begin,
+                   ForwardIter end)
+{
+    protozero::packed_field_sint32 geometry(writer, tag);
+    std::int32_t previous_lon = 0;
+    std::int32_t previous_lat = 0;
+    for (; begin != end; ++begin)
+    {
+        const auto lon = static_cast<std::int32_t>(begin->lon);
+        const auto lat = static_cast<std::int32_t>(begin->lat);
+        geometry.add_element(lon - previous_lon);
+        geometry.add_element(lat - previous_lat);
+        previous_lon = lon;
+        previous_lat = lat;
+    }
+}
+
+// Response with only code and message, like BasePlugin::Error
+inline void writeError(std::string &result, const std::string &code, const std::string &message)
+{
+    result.clear();
+    protozero::pbf_writer writer(result);
+    writer.add_string(response::code, code);
+    writer.add_string(response::message, message);
+}
+
+} // namespace pbf
+} // namespace api
+} // namespace engine
+} // namespace osrm
+
+#endif // ENGINE_API_PBF_SCHEMA_HPP
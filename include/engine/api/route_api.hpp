@@ -26,7 +26,14 @@
 #include "util/integer_range.hpp"
 #include "util/json_util.hpp"
 
+#include <protozero/pbf_writer.hpp>
+
+#include <cmath>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+#include <tuple>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -68,6 +75,30 @@ class RouteAPI : public BaseAPI
         response.values["code"] = "Ok";
     }
 
+    // Protobuf response, see docs/pbf_response.proto
+    void MakeResponse(const InternalManyRoutesResult &raw_routes,
+                      protozero::pbf_writer &response) const
+    {
+        BOOST_ASSERT(!raw_routes.routes.empty());
+
+        response.add_string(pbf::response::code, "Ok");
+        BaseAPI::WriteWaypoints(
+            response, pbf::response::waypoints, raw_routes.routes[0].segment_end_coordinates);
+
+        for (const auto &route : raw_routes.routes)
+        {
+            if (!route.is_valid())
+                continue;
+
+            protozero::pbf_writer route_writer(response, pbf::response::routes);
+            WriteRoute(route_writer,
+                       route.segment_end_coordinates,
+                       route.unpacked_path_segments,
+                       route.source_traversed_in_reverse,
+                       route.target_traversed_in_reverse);
+        }
+    }
+
   protected:
     template <typename ForwardIter>
     util::json::Value MakeGeometry(ForwardIter begin, ForwardIter end) const
@@ -100,10 +131,12 @@ class RouteAPI : public BaseAPI
         return annotations_store;
     }
 
-    util::json::Object MakeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
-                                 const std::vector<std::vector<PathData>> &unpacked_path_segments,
-                                 const std::vector<bool> &source_traversed_in_reverse,
-                                 const std::vector<bool> &target_traversed_in_reverse) const
+    // Assembles the legs including steps (if requested) and their geometries
+    std::pair<std::vector<guidance::RouteLeg>, std::vector<guidance::LegGeometry>>
+    AssembleLegs(const std::vector<PhantomNodes> &segment_end_coordinates,
+                 const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                 const std::vector<bool> &source_traversed_in_reverse,
+                 const std::vector<bool> &target_traversed_in_reverse) const
     {
         std::vector<guidance::RouteLeg> legs;
         std::vector<guidance::LegGeometry> leg_geometries;
@@ -200,6 +233,34 @@ class RouteAPI : public BaseAPI
             legs.push_back(std::move(leg));
         }
 
+        return std::make_pair(std::move(legs), std::move(leg_geometries));
+    }
+
+    RouteParameters::AnnotationsType GetRequestedAnnotations() const
+    {
+        // To maintain support for uses of the old default constructors, we check
+        // if annotations property was set manually after default construction
+        auto requested_annotations = parameters.annotations_type;
+        if ((parameters.annotations == true) &&
+            (parameters.annotations_type == RouteParameters::AnnotationsType::None))
+        {
+            requested_annotations = RouteParameters::AnnotationsType::All;
+        }
+        return requested_annotations;
+    }
+
+    util::json::Object MakeRoute(const std::vector<PhantomNodes> &segment_end_coordinates,
+                                 const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                                 const std::vector<bool> &source_traversed_in_reverse,
+                                 const std::vector<bool> &target_traversed_in_reverse) const
+    {
+        std::vector<guidance::RouteLeg> legs;
+        std::vector<guidance::LegGeometry> leg_geometries;
+        std::tie(legs, leg_geometries) = AssembleLegs(segment_end_coordinates,
+                                                      unpacked_path_segments,
+                                                      source_traversed_in_reverse,
+                                                      target_traversed_in_reverse);
+
         auto route = guidance::assembleRoute(legs);
         boost::optional<util::json::Value> json_overview;
         if (parameters.overview != RouteParameters::OverviewType::False)
@@ -252,15 +313,7 @@ class RouteAPI : public BaseAPI
 
         std::vector<util::json::Object> annotations;
 
-        // To maintain support for uses of the old default constructors, we check
-        // if annotations property was set manually after default construction
-        auto requested_annotations = parameters.annotations_type;
-        if ((parameters.annotations == true) &&
-            (parameters.annotations_type == RouteParameters::AnnotationsType::None))
-        {
-            requested_annotations = RouteParameters::AnnotationsType::All;
-        }
-
+        const auto requested_annotations = GetRequestedAnnotations();
         if (requested_annotations != RouteParameters::AnnotationsType::None)
         {
             for (const auto idx : util::irange<std::size_t>(0UL, leg_geometries.size()))
@@ -356,6 +409,130 @@ class RouteAPI : public BaseAPI
         return result;
     }
 
+    // Protobuf counterpart of MakeRoute
+    void WriteRoute(protozero::pbf_writer &writer,
+                    const std::vector<PhantomNodes> &segment_end_coordinates,
+                    const std::vector<std::vector<PathData>> &unpacked_path_segments,
+                    const std::vector<bool> &source_traversed_in_reverse,
+                    const std::vector<bool> &target_traversed_in_reverse) const
+    {
+        std::vector<guidance::RouteLeg> legs;
+        std::vector<guidance::LegGeometry> leg_geometries;
+        std::tie(legs, leg_geometries) = AssembleLegs(segment_end_coordinates,
+                                                      unpacked_path_segments,
+                                                      source_traversed_in_reverse,
+                                                      target_traversed_in_reverse);
+
+        pbf::writeRoute(writer, guidance::assembleRoute(legs), facade.GetWeightName());
+        if (parameters.overview != RouteParameters::OverviewType::False)
+        {
+            const auto use_simplification =
+                parameters.overview == RouteParameters::OverviewType::Simplified;
+            const auto overview = guidance::assembleOverview(leg_geometries, use_simplification);
+            pbf::writeGeometry(writer, pbf::route::geometry, overview.begin(), overview.end());
+        }
+
+        const auto requested_annotations = GetRequestedAnnotations();
+        for (const auto idx : util::irange<std::size_t>(0UL, legs.size()))
+        {
+            const auto &leg_geometry = leg_geometries[idx];
+            protozero::pbf_writer leg_writer(writer, pbf::route::legs);
+            pbf::writeRouteLeg(leg_writer, legs[idx]);
+
+            for (const auto &step : legs[idx].steps)
+            {
+                protozero::pbf_writer step_writer(leg_writer, pbf::leg::steps);
+                pbf::writeRouteStep(step_writer,
+                                    step,
+                                    leg_geometry.locations.begin() + step.geometry_begin,
+                                    leg_geometry.locations.begin() + step.geometry_end);
+            }
+
+            if (requested_annotations != RouteParameters::AnnotationsType::None)
+            {
+                protozero::pbf_writer annotation_writer(leg_writer, pbf::leg::annotation);
+                WriteAnnotation(annotation_writer, leg_geometry, requested_annotations);
+            }
+        }
+    }
+
+    void WriteAnnotation(protozero::pbf_writer &writer,
+                         const guidance::LegGeometry &leg_geometry,
+                         const RouteParameters::AnnotationsType requested_annotations) const
+    {
+        const auto write_packed = [&writer, &leg_geometry](const protozero::pbf_tag_type tag,
+                                                           auto get) {
+            protozero::packed_field_double field(writer, tag);
+            for (const auto &annotation : leg_geometry.annotations)
+            {
+                field.add_element(get(annotation));
+            }
+        };
+
+        // same as in MakeRoute, speed is not part of annotations=true
+        if (parameters.annotations_type & RouteParameters::AnnotationsType::Speed)
+        {
+            double prev_speed = 0;
+            write_packed(pbf::annotation::speed,
+                         [&prev_speed](const guidance::LegGeometry::Annotation &anno) {
+                             if (anno.duration < std::numeric_limits<double>::min())
+                             {
+                                 return prev_speed;
+                             }
+                             auto speed = std::round(anno.distance / anno.duration * 10.) / 10.;
+                             prev_speed = speed;
+                             return util::json::clamp_float(speed);
+                         });
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Duration)
+        {
+            write_packed(pbf::annotation::duration,
+                         [](const guidance::LegGeometry::Annotation &anno) {
+                             return anno.duration;
+                         });
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Distance)
+        {
+            write_packed(pbf::annotation::distance,
+                         [](const guidance::LegGeometry::Annotation &anno) {
+                             return anno.distance;
+                         });
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Weight)
+        {
+            write_packed(pbf::annotation::weight,
+                         [](const guidance::LegGeometry::Annotation &anno) { return anno.weight; });
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Datasources)
+        {
+            {
+                protozero::packed_field_uint32 datasources(writer, pbf::annotation::datasources);
+                for (const auto &annotation : leg_geometry.annotations)
+                {
+                    datasources.add_element(annotation.datasource);
+                }
+            }
+
+            const auto MAX_DATASOURCE_ID = 255u;
+            for (auto i = 0u; i < MAX_DATASOURCE_ID; i++)
+            {
+                const auto name = facade.GetDatasourceName(i);
+                // Length of 0 indicates the first empty name, so we can stop here
+                if (name.size() == 0)
+                    break;
+                writer.add_string(pbf::annotation::datasource_names, name.data(), name.size());
+            }
+        }
+        if (requested_annotations & RouteParameters::AnnotationsType::Nodes)
+        {
+            protozero::packed_field_uint64 nodes(writer, pbf::annotation::nodes);
+            for (const auto node_id : leg_geometry.osm_node_ids)
+            {
+                nodes.add_element(static_cast<std::uint64_t>(node_id));
+            }
+        }
+    }
+
     const RouteParameters &parameters;
 };
 
@@ -16,10 +16,16 @@
 #include "engine/internal_route_result.hpp"
 
 #include "util/integer_range.hpp"
+#include "util/json_writer.hpp"
 
 #include <boost/range/algorithm/transform.hpp>
 
+#include <protozero/pbf_writer.hpp>
+
+#include <algorithm>
+#include <cmath>
 #include <iterator>
+#include <limits>
 
 namespace osrm
 {
@@ -80,7 +86,236 @@ class TableAPI final : public BaseAPI
         response.values["code"] = "Ok";
     }
 
+    // Same response as above, but written straight into the buffer of the writer instead of
+    // building one Value per table cell first.
+    void MakeResponse(const std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>> &tables,
+                      const std::vector<PhantomNode> &phantoms,
+                      util::json::Writer &writer) const
+    {
+        // empty sources or destinations mean all coordinates (symmetric case)
+        const auto number_of_sources =
+            parameters.sources.empty() ? phantoms.size() : parameters.sources.size();
+        const auto number_of_destinations =
+            parameters.destinations.empty() ? phantoms.size() : parameters.destinations.size();
+
+        StartResponse(phantoms, writer);
+
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            writer.Key("durations");
+            writer.StartArray();
+            WriteDurationRows(writer, tables.first, number_of_sources, number_of_destinations);
+            writer.EndArray();
+        }
+
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            writer.Key("distances");
+            writer.StartArray();
+            WriteDistanceRows(writer, tables.second, number_of_sources, number_of_destinations);
+            writer.EndArray();
+        }
+
+        EndResponse(writer);
+    }
+
+    // The JSON response in parts, for tables that are written while they are computed:
+    // StartResponse, the rows of the "durations" and "distances" arrays, EndResponse.
+    void StartResponse(const std::vector<PhantomNode> &phantoms, util::json::Writer &writer) const
+    {
+        writer.StartObject();
+        writer.Key("sources");
+        WriteWaypoints(writer, phantoms, parameters.sources);
+        writer.Key("destinations");
+        WriteWaypoints(writer, phantoms, parameters.destinations);
+    }
+
+    void EndResponse(util::json::Writer &writer) const
+    {
+        writer.Key("code");
+        writer.String("Ok");
+        writer.EndObject();
+    }
+
+    // Writes the first number_of_rows rows of the durations as arrays
+    void WriteDurationRows(util::json::Writer &writer,
+                           const std::vector<EdgeDuration> &durations,
+                           std::size_t number_of_rows,
+                           std::size_t number_of_columns) const
+    {
+        WriteRows(writer,
+                  durations,
+                  number_of_rows,
+                  number_of_columns,
+                  [&writer](const EdgeDuration duration) {
+                      if (duration == MAXIMAL_EDGE_DURATION)
+                      {
+                          writer.Null();
+                      }
+                      else
+                      {
+                          // division by 10 because the duration is in deciseconds (10s)
+                          writer.Number(duration / 10.);
+                      }
+                  });
+    }
+
+    void WriteDistanceRows(util::json::Writer &writer,
+                           const std::vector<EdgeDistance> &distances,
+                           std::size_t number_of_rows,
+                           std::size_t number_of_columns) const
+    {
+        WriteRows(writer,
+                  distances,
+                  number_of_rows,
+                  number_of_columns,
+                  [&writer](const EdgeDistance distance) {
+                      if (distance == INVALID_EDGE_DISTANCE)
+                      {
+                          writer.Null();
+                      }
+                      else
+                      {
+                          // round to single decimal place
+                          writer.Number(std::round(distance * 10) / 10.);
+                      }
+                  });
+    }
+
+    // Protobuf response, see docs/pbf_response.proto. The tables are written row major into a
+    // single packed field each, unreachable cells are NaN.
+    void MakeResponse(const std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>> &tables,
+                      const std::vector<PhantomNode> &phantoms,
+                      protozero::pbf_writer &response) const
+    {
+        const auto number_of_sources =
+            parameters.sources.empty() ? phantoms.size() : parameters.sources.size();
+        const auto number_of_destinations =
+            parameters.destinations.empty() ? phantoms.size() : parameters.destinations.size();
+        const auto number_of_cells = number_of_sources * number_of_destinations;
+
+        response.add_string(pbf::response::code, "Ok");
+        WriteWaypoints(response, pbf::response::sources, phantoms, parameters.sources);
+        WriteWaypoints(response, pbf::response::destinations, phantoms, parameters.destinations);
+
+        if (parameters.annotations & TableParameters::AnnotationsType::Duration)
+        {
+            BOOST_ASSERT(tables.first.size() >= number_of_cells);
+            protozero::packed_field_double durations(response, pbf::response::durations);
+            std::for_each(tables.first.begin(),
+                          tables.first.begin() + number_of_cells,
+                          [&durations](const EdgeDuration duration) {
+                              durations.add_element(duration == MAXIMAL_EDGE_DURATION
+                                                        ? std::numeric_limits<double>::quiet_NaN()
+                                                        : duration / 10.);
+                          });
+        }
+
+        if (parameters.annotations & TableParameters::AnnotationsType::Distance)
+        {
+            BOOST_ASSERT(tables.second.size() >= number_of_cells);
+            protozero::packed_field_double distances(response, pbf::response::distances);
+            std::for_each(tables.second.begin(),
+                          tables.second.begin() + number_of_cells,
+                          [&distances](const EdgeDistance distance) {
+                              distances.add_element(distance == INVALID_EDGE_DISTANCE
+                                                        ? std::numeric_limits<double>::quiet_NaN()
+                                                        : std::round(distance * 10) / 10.);
+                          });
+        }
+    }
+
+    // Response to registering a target set: the snapped targets as destinations
+    void MakeResponse(const std::vector<PhantomNode> &phantoms, util::json::Object &response) const
+    {
+        response.values["destinations"] = MakeWaypoints(phantoms);
+        response.values["code"] = "Ok";
+    }
+
+    void MakeResponse(const std::vector<PhantomNode> &phantoms, util::json::Writer &writer) const
+    {
+        writer.StartObject();
+        writer.Key("destinations");
+        WriteWaypoints(writer, phantoms, {});
+        EndResponse(writer);
+    }
+
+    void MakeResponse(const std::vector<PhantomNode> &phantoms,
+                      protozero::pbf_writer &response) const
+    {
+        response.add_string(pbf::response::code, "Ok");
+        WriteWaypoints(response, pbf::response::destinations, phantoms, {});
+    }
+
   protected:
+    // Writes the waypoints of the given indices, or of all phantoms if indices is empty
+    void WriteWaypoints(util::json::Writer &writer,
+                        const std::vector<PhantomNode> &phantoms,
+                        const std::vector<std::size_t> &indices) const
+    {
+        writer.StartArray();
+        if (indices.empty())
+        {
+            BOOST_ASSERT(phantoms.size() == parameters.coordinates.size());
+            for (const auto &phantom : phantoms)
+            {
+                StartWaypoint(writer, phantom);
+                writer.EndObject();
+            }
+        }
+        else
+        {
+            for (const auto idx : indices)
+            {
+                BOOST_ASSERT(idx < phantoms.size());
+                StartWaypoint(writer, phantoms[idx]);
+                writer.EndObject();
+            }
+        }
+        writer.EndArray();
+    }
+
+    void WriteWaypoints(protozero::pbf_writer &response,
+                        const protozero::pbf_tag_type tag,
+                        const std::vector<PhantomNode> &phantoms,
+                        const std::vector<std::size_t> &indices) const
+    {
+        if (indices.empty())
+        {
+            for (const auto &phantom : phantoms)
+            {
+                protozero::pbf_writer waypoint(response, tag);
+                WriteWaypoint(waypoint, phantom);
+            }
+        }
+        else
+        {
+            for (const auto idx : indices)
+            {
+                BOOST_ASSERT(idx < phantoms.size());
+                protozero::pbf_writer waypoint(response, tag);
+                WriteWaypoint(waypoint, phantoms[idx]);
+            }
+        }
+    }
+
+    template <typename T, typename WriteCellT>
+    void WriteRows(util::json::Writer &writer,
+                   const std::vector<T> &values,
+                   std::size_t number_of_rows,
+                   std::size_t number_of_columns,
+                   WriteCellT write_cell) const
+    {
+        BOOST_ASSERT(values.size() >= number_of_rows * number_of_columns);
+        for (const auto row : util::irange<std::size_t>(0UL, number_of_rows))
+        {
+            writer.StartArray();
+            const auto row_begin_iterator = values.begin() + (row * number_of_columns);
+            std::for_each(row_begin_iterator, row_begin_iterator + number_of_columns, write_cell);
+            writer.EndArray();
+        }
+    }
+
     virtual util::json::Array MakeWaypoints(const std::vector<PhantomNode> &phantoms) const
     {
         util::json::Array json_waypoints;
@@ -34,6 +34,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <algorithm>
 #include <iterator>
+#include <string>
 #include <vector>
 
 namespace osrm
@@ -51,6 +52,10 @@ namespace api
  *             use all coordinates as sources
  *  - destinations: indices into coordinates indicating destinations for the Table service, no
  *                  destinations means use all coordinates as destinations
+ *  - target_set: name of a registered target set whose targets are the destinations, the
+ *                coordinates are only sources then
+ *  - register_target_set: registers all coordinates as the targets of target_set instead of
+ *                         computing a table, an existing set of that name is replaced
  *
  * \see OSRM, Coordinate, Hint, Bearing, RouteParame, RouteParameters, TableParameters,
  *      NearestParameters, TripParameters, MatchParameters and TileParameters
@@ -70,6 +75,9 @@ struct TableParameters : public BaseParameters
 
     AnnotationsType annotations = AnnotationsType::Duration;
 
+    std::string target_set;
+    bool register_target_set = false;
+
     TableParameters() = default;
     template <typename... Args>
     TableParameters(std::vector<std::size_t> sources_,
@@ -95,8 +103,21 @@ struct TableParameters : public BaseParameters
         if (!BaseParameters::IsValid())
             return false;
 
+        if (register_target_set)
+        {
+            // the set holds all coordinates
+            return !target_set.empty() && !coordinates.empty() && sources.empty() &&
+                   destinations.empty();
+        }
+
+        // The targets of a set are the destinations, the coordinates the sources
+        if (!target_set.empty())
+        {
+            if (coordinates.empty() || !destinations.empty())
+                return false;
+        }
         // Distance Table makes only sense with 2+ coodinates
-        if (coordinates.size() < 2)
+        else if (coordinates.size() < 2)
             return false;
 
         // 1/ The user is able to specify duplicates in srcs and dsts, in that case it's their fault
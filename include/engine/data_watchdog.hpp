@@ -14,6 +14,8 @@
 #include <boost/thread/locks.hpp>
 #include <boost/thread/shared_mutex.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <thread>
 
@@ -55,6 +57,7 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
             updatable_shared_region = &shared_register.GetRegion(updatable_region_id);
             static_region = *static_shared_region;
             updatable_region = *updatable_shared_region;
+            timestamp = static_region.timestamp + updatable_region.timestamp;
 
             facade_factory =
                 DataFacadeFactory<datafacade::ContiguousInternalMemoryDataFacade, AlgorithmT>(
@@ -82,6 +85,10 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
         return facade_factory.Get(params);
     }
 
+    // Both region timestamps only ever increase, so does their sum whenever osrm-datastore
+    // replaced one of the regions
+    std::uint64_t GetTimestamp() const { return timestamp; }
+
   private:
     void Run()
     {
@@ -116,6 +123,8 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
                     std::make_shared<datafacade::SharedMemoryAllocator>(
                         std::vector<storage::SharedRegionRegister::ShmKey>{
                             static_region.shm_key, updatable_region.shm_key}));
+            // only announce the new dataset once queries run on it
+            timestamp = static_region.timestamp + updatable_region.timestamp;
         }
 
         util::Log() << "DataWatchdog thread stopped";
@@ -129,6 +138,7 @@ class DataWatchdogImpl<AlgorithmT, datafacade::ContiguousInternalMemoryDataFacad
     storage::SharedRegion updatable_region;
     storage::SharedRegion *static_shared_region;
     storage::SharedRegion *updatable_shared_region;
+    std::atomic<std::uint64_t> timestamp;
     DataFacadeFactory<datafacade::ContiguousInternalMemoryDataFacade, AlgorithmT> facade_factory;
 };
 }
@@ -9,6 +9,9 @@ namespace engine
 {
 
 using DataFacadeBase = datafacade::ContiguousInternalMemoryDataFacadeBase;
+// Routing algorithms take the concrete facade: its accessors are final, so graph accesses in
+// the search loops are bound statically and can be inlined. Plugins and tests can still use
+// the virtual BaseDataFacade and AlgorithmDataFacade interfaces.
 template <typename AlgorithmT>
 using DataFacade = datafacade::ContiguousInternalMemoryDataFacade<AlgorithmT>;
 }
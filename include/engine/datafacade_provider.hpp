@@ -8,6 +8,8 @@
 #include "engine/datafacade/process_memory_allocator.hpp"
 #include "engine/datafacade_factory.hpp"
 
+#include <cstdint>
+
 namespace osrm
 {
 namespace engine
@@ -24,6 +26,9 @@ template <typename AlgorithmT, template <typename A> class FacadeT> class DataFa
 
     virtual std::shared_ptr<const Facade> Get(const api::BaseParameters &) const = 0;
     virtual std::shared_ptr<const Facade> Get(const api::TileParameters &) const = 0;
+
+    // Changes when the provider switched to a different dataset
+    virtual std::uint64_t GetTimestamp() const { return 0; }
 };
 
 template <typename AlgorithmT, template <typename A> class FacadeT>
@@ -93,6 +98,8 @@ class WatchingProvider : public DataFacadeProvider<AlgorithmT, FacadeT>
     {
         return watchdog.Get(params);
     }
+
+    std::uint64_t GetTimestamp() const override final { return watchdog.GetTimestamp(); }
 };
 }
 
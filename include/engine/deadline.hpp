@@ -0,0 +1,103 @@
+#ifndef OSRM_ENGINE_DEADLINE_HPP
+#define OSRM_ENGINE_DEADLINE_HPP
+
+#include "util/exception.hpp"
+
+#include <boost/optional.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace osrm
+{
+namespace engine
+{
+
+// Thrown from inside the routing algorithms when a query exceeds its time budget.
+class DeadlineExceeded final : public util::exception
+{
+  public:
+    DeadlineExceeded() : util::exception("Query exceeded its time budget") {}
+};
+
+/**
+ * Time budget of a query that is checked cooperatively by the search loops.
+ *
+ * The deadline of the query currently processed by a thread is available through Current(),
+ * so the routing algorithms do not need an additional parameter. Use ScopedDeadline to set it.
+ */
+class Deadline
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Only look at the clock every CHECK_INTERVAL calls of Check(), this keeps the
+    // overhead in the inner loops negligible.
+    static constexpr std::uint32_t CHECK_INTERVAL = 1024;
+
+    Deadline() : expiry(Clock::time_point::max()), calls(0) {}
+
+    explicit Deadline(const std::chrono::milliseconds budget)
+        : expiry(Clock::now() + budget), calls(0)
+    {
+    }
+
+    bool IsUnlimited() const { return expiry == Clock::time_point::max(); }
+
+    bool Expired() const { return !IsUnlimited() && Clock::now() >= expiry; }
+
+    // Throws DeadlineExceeded if the budget is used up
+    void Check()
+    {
+        if (IsUnlimited() || (++calls % CHECK_INTERVAL) != 0)
+        {
+            return;
+        }
+        if (Clock::now() >= expiry)
+        {
+            throw DeadlineExceeded();
+        }
+    }
+
+    // Like Check() but does not skip calls, for checks outside of the inner loops
+    void CheckNow() const
+    {
+        if (Expired())
+        {
+            throw DeadlineExceeded();
+        }
+    }
+
+    // Deadline of a query from the server-wide budget in milliseconds (negative for unlimited)
+    // and the budget of the request, which can only lower it
+    static Deadline ForQuery(const int default_timeout, const boost::optional<unsigned> &timeout);
+
+    // Deadline of the query processed by the calling thread
+    static Deadline &Current();
+
+  private:
+    Clock::time_point expiry;
+    std::uint32_t calls;
+};
+
+// Sets the deadline of the calling thread for the lifetime of this object
+class ScopedDeadline
+{
+  public:
+    explicit ScopedDeadline(const Deadline deadline) : previous(Deadline::Current())
+    {
+        Deadline::Current() = deadline;
+    }
+
+    ~ScopedDeadline() { Deadline::Current() = previous; }
+
+    ScopedDeadline(const ScopedDeadline &) = delete;
+    ScopedDeadline &operator=(const ScopedDeadline &) = delete;
+
+  private:
+    const Deadline previous;
+};
+}
+}
+
+#endif
@@ -8,6 +8,7 @@
 #include "engine/api/tile_parameters.hpp"
 #include "engine/api/trip_parameters.hpp"
 #include "engine/datafacade_provider.hpp"
+#include "engine/deadline.hpp"
 #include "engine/engine_config.hpp"
 #include "engine/plugins/match.hpp"
 #include "engine/plugins/nearest.hpp"
@@ -16,12 +17,22 @@
 #include "engine/plugins/trip.hpp"
 #include "engine/plugins/viaroute.hpp"
 #include "engine/routing_algorithms.hpp"
+#include "engine/search_engine_data_pool.hpp"
 #include "engine/status.hpp"
 
 #include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -43,18 +54,55 @@ class EngineInterface
     virtual Status Match(const api::MatchParameters &parameters,
                          util::json::Object &result) const = 0;
     virtual Status Tile(const api::TileParameters &parameters, std::string &result) const = 0;
+
+    // Match many traces on up to max_threads threads, handler gets the result of each trace
+    virtual Status
+    Match(const std::vector<api::MatchParameters> &parameters,
+          const std::function<void(std::size_t, Status, util::json::Object &)> &handler,
+          const unsigned max_threads) const = 0;
+
+    // Render the JSON response directly into the buffer, see util::json::Writer
+    virtual Status Table(const api::TableParameters &parameters,
+                         util::json::Buffer &result) const = 0;
+    virtual Status Nearest(const api::NearestParameters &parameters,
+                           util::json::Buffer &result) const = 0;
+
+    // Render the JSON response while the table is computed, consume gets the rendered parts
+    virtual Status Table(const api::TableParameters &parameters,
+                         util::json::Buffer &result,
+                         const util::json::BufferConsumer &consume) const = 0;
+
+    // Encode the response as protobuf, see docs/pbf_response.proto
+    virtual Status Route(const api::RouteParameters &parameters, std::string &result) const = 0;
+    virtual Status Table(const api::TableParameters &parameters, std::string &result) const = 0;
+    virtual Status Nearest(const api::NearestParameters &parameters,
+                           std::string &result) const = 0;
+
+    virtual std::uint64_t GetDataTimestamp() const = 0;
 };
 
 template <typename Algorithm> class Engine final : public EngineInterface
 {
   public:
     explicit Engine(const EngineConfig &config)
-        : route_plugin(config.max_locations_viaroute, config.max_alternatives),            //
-          table_plugin(config.max_locations_distance_table),                               //
+        : route_plugin(config.max_locations_viaroute,                                      //
+                       config.max_alternatives,                                            //
+                       config.max_route_threads,                                           //
+                       config.max_snapping_threads),                                       //
+          table_plugin(config.max_locations_distance_table,                                //
+                       config.max_table_threads,                                           //
+                       config.max_table_target_sets,                                       //
+                       config.max_snapping_threads),                                       //
           nearest_plugin(config.max_results_nearest),                                      //
-          trip_plugin(config.max_locations_trip),                                          //
-          match_plugin(config.max_locations_map_matching, config.max_radius_map_matching), //
-          tile_plugin()                                                                    //
+          trip_plugin(config.max_locations_trip, config.max_snapping_threads),             //
+          match_plugin(config.max_locations_map_matching,                                  //
+                       config.max_radius_map_matching,                                     //
+                       config.max_match_sessions,                                          //
+                       config.match_session_timeout,                                       //
+                       config.max_snapping_threads),                                       //
+          tile_plugin(),                                                                   //
+          default_timeout(config.default_timeout),                                         //
+          search_contexts(config.max_search_contexts)                                      //
 
     {
         if (config.use_shared_memory)
@@ -83,49 +131,191 @@ template <typename Algorithm> class Engine final : public EngineInterface
 
     Engine(const Engine &) = delete;
     Engine &operator=(const Engine &) = delete;
-    virtual ~Engine() = default;
+    virtual ~Engine()
+    {
+        const auto statistics = search_contexts.GetStatistics();
+        util::Log(statistics.contended_acquisitions > 0 ? logINFO : logDEBUG)
+            << "Search contexts: " << statistics.contexts << " created, "
+            << statistics.acquisitions << " acquired, " << statistics.contended_acquisitions
+            << " waited for " << statistics.wait_time.count() / 1000 << "ms in total";
+    }
 
     Status Route(const api::RouteParameters &params,
                  util::json::Object &result) const override final
     {
-        return route_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return RunWithDeadline(route_plugin, params, result);
     }
 
     Status Table(const api::TableParameters &params,
                  util::json::Object &result) const override final
     {
-        return table_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return RunWithDeadline(table_plugin, params, result);
     }
 
     Status Nearest(const api::NearestParameters &params,
                    util::json::Object &result) const override final
     {
-        return nearest_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return RunWithDeadline(nearest_plugin, params, result);
     }
 
     Status Trip(const api::TripParameters &params, util::json::Object &result) const override final
     {
-        return trip_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return RunWithDeadline(trip_plugin, params, result);
     }
 
     Status Match(const api::MatchParameters &params,
                  util::json::Object &result) const override final
     {
-        return match_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        return RunWithDeadline(match_plugin, params, result);
+    }
+
+    Status Match(const std::vector<api::MatchParameters> &params,
+                 const std::function<void(std::size_t, Status, util::json::Object &)> &handler,
+                 const unsigned max_threads) const override final
+    {
+        // like the workers of a single query the threads only use contexts the pool can spare,
+        // so they never wait for it next to the other queries
+        auto search_context = search_contexts.Acquire();
+        ScopedSearchEngineDataPool<Algorithm> pool(search_contexts);
+        WorkerSearchContexts<Algorithm> workers(*search_context, std::max(1u, max_threads));
+
+        tbb::task_arena arena(static_cast<int>(workers.Size()));
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, params.size()),
+                [&](const tbb::blocked_range<std::size_t> &traces) {
+                    // the heaps are reused for all traces of the range
+                    workers.Run([&](SearchEngineData<Algorithm> &heaps) {
+                        for (auto index = traces.begin(); index < traces.end(); ++index)
+                        {
+                            util::json::Object result;
+                            if (!params[index].IsValid())
+                            {
+                                result.values["code"] = "InvalidOptions";
+                                result.values["message"] = "Invalid match parameters.";
+                                handler(index, Status::Error, result);
+                                continue;
+                            }
+                            const auto status =
+                                RunInContext(heaps, match_plugin, params[index], result);
+                            handler(index, status, result);
+                        }
+                    });
+                });
+        });
+        return Status::Ok;
     }
 
     Status Tile(const api::TileParameters &params, std::string &result) const override final
     {
-        return tile_plugin.HandleRequest(GetAlgorithms(params), params, result);
+        auto search_context = search_contexts.Acquire();
+        return tile_plugin.HandleRequest(GetAlgorithms(*search_context, params), params, result);
+    }
+
+    Status Table(const api::TableParameters &params,
+                 util::json::Buffer &result) const override final
+    {
+        return RunWithDeadline(table_plugin, params, result);
+    }
+
+    Status Nearest(const api::NearestParameters &params,
+                   util::json::Buffer &result) const override final
+    {
+        return RunWithDeadline(nearest_plugin, params, result);
+    }
+
+    Status Table(const api::TableParameters &params,
+                 util::json::Buffer &result,
+                 const util::json::BufferConsumer &consume) const override final
+    {
+        return RunWithDeadline(table_plugin, params, result, consume);
+    }
+
+    Status Route(const api::RouteParameters &params, std::string &result) const override final
+    {
+        return RunWithDeadline(route_plugin, params, result);
+    }
+
+    Status Table(const api::TableParameters &params, std::string &result) const override final
+    {
+        return RunWithDeadline(table_plugin, params, result);
+    }
+
+    Status Nearest(const api::NearestParameters &params, std::string &result) const override final
+    {
+        return RunWithDeadline(nearest_plugin, params, result);
+    }
+
+    std::uint64_t GetDataTimestamp() const override final
+    {
+        return facade_provider->GetTimestamp();
     }
 
   private:
-    template <typename ParametersT> auto GetAlgorithms(const ParametersT &params) const
+    template <typename ParametersT>
+    auto GetAlgorithms(SearchEngineData<Algorithm> &heaps, const ParametersT &params) const
     {
         return RoutingAlgorithms<Algorithm>{heaps, facade_provider->Get(params)};
     }
+
+    // The request can only lower the server-wide time budget
+    Deadline GetDeadline(const api::BaseParameters &params) const
+    {
+        return Deadline::ForQuery(default_timeout, params.timeout);
+    }
+
+    template <typename PluginT, typename ParametersT, typename ResultT, typename... ArgsT>
+    Status RunWithDeadline(const PluginT &plugin,
+                           const ParametersT &params,
+                           ResultT &result,
+                           const ArgsT &... args) const
+    {
+        auto search_context = search_contexts.Acquire();
+        return RunInContext(*search_context, plugin, params, result, args...);
+    }
+
+    template <typename PluginT, typename ParametersT, typename ResultT, typename... ArgsT>
+    Status RunInContext(SearchEngineData<Algorithm> &heaps,
+                        const PluginT &plugin,
+                        const ParametersT &params,
+                        ResultT &result,
+                        const ArgsT &... args) const
+    {
+        ScopedDeadline deadline(GetDeadline(params));
+        // parallel searches of the query take the contexts of their workers from the pool
+        ScopedSearchEngineDataPool<Algorithm> pool(search_contexts);
+        try
+        {
+            return plugin.HandleRequest(GetAlgorithms(heaps, params), params, result, args...);
+        }
+        catch (const DeadlineExceeded &)
+        {
+            SetTimeoutError(result);
+            return Status::Error;
+        }
+    }
+
+    static void SetTimeoutError(util::json::Object &result)
+    {
+        result.values.clear();
+        result.values["code"] = "Timeout";
+        result.values["message"] = "Query exceeded its time budget.";
+    }
+
+    static void SetTimeoutError(util::json::Buffer &result)
+    {
+        util::json::Object error;
+        SetTimeoutError(error);
+        result.clear();
+        util::json::render(result, error);
+    }
+
+    static void SetTimeoutError(std::string &result)
+    {
+        api::pbf::writeError(result, "Timeout", "Query exceeded its time budget.");
+    }
+
     std::unique_ptr<DataFacadeProvider<Algorithm>> facade_provider;
-    mutable SearchEngineData<Algorithm> heaps;
 
     const plugins::ViaRoutePlugin route_plugin;
     const plugins::TablePlugin table_plugin;
@@ -133,6 +323,9 @@ template <typename Algorithm> class Engine final : public EngineInterface
     const plugins::TripPlugin trip_plugin;
     const plugins::MatchPlugin match_plugin;
     const plugins::TilePlugin tile_plugin;
+    const int default_timeout;
+
+    mutable SearchEngineDataPool<Algorithm> search_contexts;
 };
 }
 }
@@ -53,6 +53,29 @@ namespace engine
  *  - Match
  *  - Nearest
  *
+ * A default time budget in milliseconds (-1 for unlimited) can be set for all queries, queries
+ * exceeding it are aborted. Requests can lower it with their own timeout.
+ *
+ * Each running query uses its own search context with the heaps of the routing algorithms. These
+ * are kept for reuse, by default one for each query that ran concurrently. The number of contexts
+ * can be limited to bound the memory, queries then wait for a free context.
+ *
+ * The searches of a single table query can run on several threads, the maximum is set with
+ * max_table_threads. By default they run on the thread of the query. The legs of routes that
+ * allow u-turns at the waypoints are independent and are searched on at most max_route_threads
+ * threads. The additional threads take their search contexts from the same pool but never wait
+ * for it, they are only used as long as the pool has contexts to spare.
+ *
+ * Likewise the coordinates of requests with many of them are snapped to the road network on at
+ * most max_snapping_threads threads.
+ *
+ * Table targets that are used by many queries can be registered as named target sets, at most
+ * max_table_target_sets of them. 0 disables target sets.
+ *
+ * Traces that arrive in parts are matched in sessions, at most max_match_sessions of them. A
+ * session is removed after match_session_timeout seconds without requests. 0 disables sessions
+ * or keeps idle ones respectively.
+ *
  * In addition, shared memory can be used for datasets loaded with osrm-datastore.
  *
  * You can chose between three algorithms:
@@ -87,6 +110,14 @@ struct EngineConfig final
     double max_radius_map_matching = -1.0;
     int max_results_nearest = -1;
     int max_alternatives = 3; // set an arbitrary upper bound; can be adjusted by user
+    int default_timeout = -1; // in milliseconds
+    unsigned max_search_contexts = 0; // 0 for one per concurrent query
+    unsigned max_table_threads = 1;
+    unsigned max_route_threads = 1;
+    unsigned max_snapping_threads = 1;
+    unsigned max_table_target_sets = 16;
+    unsigned max_match_sessions = 1024;
+    unsigned match_session_timeout = 300; // in seconds
     bool use_shared_memory = true;
     boost::filesystem::path memory_file;
     Algorithm algorithm = Algorithm::CH;
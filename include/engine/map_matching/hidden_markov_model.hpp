@@ -88,6 +88,66 @@ template <class CandidateLists> struct HiddenMarkovModel
         Clear(0);
     }
 
+    // Adds the timestamps that were appended to candidates_list since the model was built or
+    // grown last, they start out cleared
+    void Grow()
+    {
+        const auto first_new_timestamp = viterbi.size();
+        const auto number_of_timestamps = candidates_list.size();
+        BOOST_ASSERT(first_new_timestamp <= number_of_timestamps);
+
+        viterbi.resize(number_of_timestamps);
+        viterbi_reachable.resize(number_of_timestamps);
+        parents.resize(number_of_timestamps);
+        path_distances.resize(number_of_timestamps);
+        pruned.resize(number_of_timestamps);
+        breakage.resize(number_of_timestamps);
+        for (const auto i : util::irange(first_new_timestamp, number_of_timestamps))
+        {
+            const auto &num_candidates = candidates_list[i].size();
+            viterbi[i].resize(num_candidates);
+            viterbi_reachable[i].resize(num_candidates);
+            parents[i].resize(num_candidates);
+            path_distances[i].resize(num_candidates);
+            pruned[i].resize(num_candidates);
+        }
+
+        Clear(first_new_timestamp);
+    }
+
+    // Drops the first timestamps, the caller drops them from candidates_list. The parents are
+    // shifted to the remaining timestamps, states with a dropped parent become their own parent.
+    void Drop(const std::size_t number_of_timestamps)
+    {
+        BOOST_ASSERT(number_of_timestamps <= viterbi.size());
+
+        const auto drop = [number_of_timestamps](auto &values) {
+            values.erase(values.begin(), values.begin() + number_of_timestamps);
+        };
+        drop(viterbi);
+        drop(viterbi_reachable);
+        drop(parents);
+        drop(path_distances);
+        drop(pruned);
+        drop(breakage);
+
+        for (const auto t : util::irange<std::size_t>(0UL, parents.size()))
+        {
+            for (const auto s : util::irange<std::size_t>(0UL, parents[t].size()))
+            {
+                auto &parent = parents[t][s];
+                if (parent.first < number_of_timestamps)
+                {
+                    parent = std::make_pair(t, s);
+                }
+                else
+                {
+                    parent.first -= number_of_timestamps;
+                }
+            }
+        }
+    }
+
     void Clear(std::size_t initial_timestamp)
     {
         BOOST_ASSERT(viterbi.size() == parents.size() && parents.size() == path_distances.size() &&
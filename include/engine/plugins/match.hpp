@@ -7,6 +7,11 @@
 
 #include "util/json_util.hpp"
 
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace osrm
@@ -24,9 +29,17 @@ class MatchPlugin : public BasePlugin
     using CandidateLists = routing_algorithms::CandidateLists;
     static const constexpr double RADIUS_MULTIPLIER = 3;
 
-    MatchPlugin(const int max_locations_map_matching, const double max_radius_map_matching)
-        : max_locations_map_matching(max_locations_map_matching),
-          max_radius_map_matching(max_radius_map_matching)
+    // At most max_sessions matching sessions are kept, see api::MatchParameters::session.
+    // Sessions without requests for session_timeout seconds are removed, 0 keeps them. The
+    // candidates of the trace points are looked up on at most max_snapping_threads threads.
+    MatchPlugin(const int max_locations_map_matching,
+                const double max_radius_map_matching,
+                const unsigned max_sessions = 0,
+                const unsigned session_timeout = 0,
+                const unsigned max_snapping_threads = 1)
+        : BasePlugin(max_snapping_threads), max_locations_map_matching(max_locations_map_matching),
+          max_radius_map_matching(max_radius_map_matching), max_sessions(max_sessions),
+          session_timeout(session_timeout)
     {
     }
 
@@ -35,8 +48,39 @@ class MatchPlugin : public BasePlugin
                          util::json::Object &json_result) const;
 
   private:
+    // The points of a session trace that are not matched finally yet. Their candidates are only
+    // valid for the facade of the state, they are found again from the parameters of the points
+    // for other facades, e.g. after osrm-datastore loaded a new dataset.
+    struct Session
+    {
+        // requests of a session are handled one after the other
+        std::mutex mutex;
+        std::unique_ptr<routing_algorithms::MapMatchingState> state;
+        // the coordinates, bearings, radiuses, approaches and timestamps of the kept points
+        api::MatchParameters points;
+        // guarded by sessions_mutex
+        std::chrono::steady_clock::time_point last_used;
+    };
+
+    // Snaps the coordinates of the parameters to the candidates for matching
+    CandidateLists GetCandidates(const datafacade::BaseDataFacade &facade,
+                                 const api::MatchParameters &parameters) const;
+
+    Status HandleSessionRequest(const RoutingAlgorithmsInterface &algorithms,
+                                const api::MatchParameters &parameters,
+                                util::json::Object &json_result) const;
+
+    // The session of the request, a new one if it doesn't exist. Removes idle sessions.
+    std::shared_ptr<Session> GetSession(const api::MatchParameters &parameters) const;
+
     const int max_locations_map_matching;
     const double max_radius_map_matching;
+    const unsigned max_sessions;
+    const unsigned session_timeout;
+
+    mutable std::mutex sessions_mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<Session>> sessions;
+    mutable std::chrono::steady_clock::time_point last_sessions_sweep;
 };
 }
 }
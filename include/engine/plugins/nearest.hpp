@@ -7,6 +7,8 @@
 #include "engine/routing_algorithms.hpp"
 #include "osrm/json_container.hpp"
 
+#include <string>
+
 namespace osrm
 {
 namespace engine
@@ -23,7 +25,22 @@ class NearestPlugin final : public BasePlugin
                          const api::NearestParameters &params,
                          util::json::Object &result) const;
 
+    // Renders the response directly without building the object tree
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::NearestParameters &params,
+                         util::json::Buffer &result) const;
+
+    // Encodes the response as protobuf
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::NearestParameters &params,
+                         std::string &result) const;
+
   private:
+    template <typename ResultT>
+    Status HandleRequestImpl(const RoutingAlgorithmsInterface &algorithms,
+                             const api::NearestParameters &params,
+                             ResultT &result) const;
+
     const int max_results;
 };
 }
@@ -2,6 +2,7 @@
 #define BASE_PLUGIN_HPP
 
 #include "engine/api/base_parameters.hpp"
+#include "engine/api/pbf_schema.hpp"
 #include "engine/datafacade/datafacade_base.hpp"
 #include "engine/phantom_node.hpp"
 #include "engine/routing_algorithms.hpp"
@@ -9,11 +10,19 @@
 
 #include "util/coordinate.hpp"
 #include "util/coordinate_calculation.hpp"
+#include "util/hilbert_value.hpp"
 #include "util/integer_range.hpp"
 #include "util/json_container.hpp"
+#include "util/json_writer.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 
 #include <algorithm>
+#include <cstdint>
 #include <iterator>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -29,6 +38,51 @@ namespace plugins
 class BasePlugin
 {
   protected:
+    // The coordinates of a request are snapped on at most max_snapping_threads threads
+    explicit BasePlugin(const unsigned max_snapping_threads = 1)
+        : max_snapping_threads(max_snapping_threads)
+    {
+    }
+
+    // Calls snap for the index of every coordinate. The coordinates are snapped in the order of
+    // their Hilbert values, so that consecutive lookups mostly descend the same nodes of the
+    // R-tree. Requests with many coordinates are split into chunks that run on several threads,
+    // snap has to be safe to call concurrently for different indices.
+    template <typename SnapT>
+    void SnapCoordinates(const std::vector<util::Coordinate> &coordinates, const SnapT &snap) const
+    {
+        std::vector<std::size_t> order(coordinates.size());
+        std::iota(order.begin(), order.end(), 0);
+        if (coordinates.size() > 2)
+        {
+            std::vector<std::uint64_t> hilbert_values(coordinates.size());
+            std::transform(coordinates.begin(),
+                           coordinates.end(),
+                           hilbert_values.begin(),
+                           util::GetHilbertCode);
+            std::sort(order.begin(), order.end(), [&](const auto lhs, const auto rhs) {
+                return hilbert_values[lhs] < hilbert_values[rhs];
+            });
+        }
+
+        if (max_snapping_threads <= 1 || order.size() < 2 * SNAPPING_CHUNK_SIZE)
+        {
+            for (const auto index : order)
+                snap(index);
+            return;
+        }
+
+        tbb::task_arena arena(static_cast<int>(max_snapping_threads));
+        arena.execute([&] {
+            tbb::parallel_for(
+                tbb::blocked_range<std::size_t>(0, order.size(), SNAPPING_CHUNK_SIZE),
+                [&](const tbb::blocked_range<std::size_t> &chunk) {
+                    for (auto position = chunk.begin(); position < chunk.end(); ++position)
+                        snap(order[position]);
+                });
+        });
+    }
+
     bool CheckAllCoordinates(const std::vector<util::Coordinate> &coordinates) const
     {
         return !std::any_of(
@@ -37,9 +91,10 @@ class BasePlugin
             });
     }
 
+    template <typename ResultT>
     bool CheckAlgorithms(const api::BaseParameters &params,
                          const RoutingAlgorithmsInterface &algorithms,
-                         util::json::Object &result) const
+                         ResultT &result) const
     {
         if (algorithms.IsValid())
         {
@@ -71,6 +126,52 @@ class BasePlugin
         return Status::Error;
     }
 
+    Status Error(const std::string &code,
+                 const std::string &message,
+                 util::json::Buffer &rendered_result) const
+    {
+        rendered_result.clear();
+        util::json::Writer writer(rendered_result);
+        writer.StartObject();
+        writer.Key("code");
+        writer.String(code);
+        writer.Key("message");
+        writer.String(message);
+        writer.EndObject();
+        return Status::Error;
+    }
+
+    Status Error(const std::string &code, const std::string &message, std::string &pbf_result) const
+    {
+        api::pbf::writeError(pbf_result, code, message);
+        return Status::Error;
+    }
+
+    // Lets the API object either fill the object tree, write straight into the buffer or
+    // encode the response as protobuf
+    template <typename APIT, typename... ArgsT>
+    static void MakeResponse(const APIT &api, util::json::Object &result, const ArgsT &... args)
+    {
+        api.MakeResponse(args..., result);
+    }
+
+    template <typename APIT, typename... ArgsT>
+    static void MakeResponse(const APIT &api, util::json::Buffer &result, const ArgsT &... args)
+    {
+        result.clear();
+        util::json::Writer writer(result);
+        api.MakeResponse(args..., writer);
+        BOOST_ASSERT(writer.IsComplete());
+    }
+
+    template <typename APIT, typename... ArgsT>
+    static void MakeResponse(const APIT &api, std::string &result, const ArgsT &... args)
+    {
+        result.clear();
+        protozero::pbf_writer writer(result);
+        api.MakeResponse(args..., writer);
+    }
+
     // Decides whether to use the phantom node from a big or small component if both are found.
     // Returns true if all phantom nodes are in the same component after snapping.
     std::vector<PhantomNode>
@@ -148,8 +249,7 @@ class BasePlugin
         const bool use_bearings = !parameters.bearings.empty();
         const bool use_approaches = !parameters.approaches.empty();
 
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
-        {
+        SnapCoordinates(parameters.coordinates, [&](const std::size_t i) {
             Approach approach = engine::Approach::UNRESTRICTED;
             if (use_approaches && parameters.approaches[i])
                 approach = parameters.approaches[i].get();
@@ -162,7 +262,7 @@ class BasePlugin
                     util::coordinate_calculation::haversineDistance(
                         parameters.coordinates[i], parameters.hints[i]->phantom.location),
                 });
-                continue;
+                return;
             }
             if (use_bearings && parameters.bearings[i])
             {
@@ -178,7 +278,7 @@ class BasePlugin
                 phantom_nodes[i] = facade.NearestPhantomNodesInRange(
                     parameters.coordinates[i], radiuses[i], approach);
             }
-        }
+        });
 
         return phantom_nodes;
     }
@@ -197,8 +297,7 @@ class BasePlugin
         const bool use_approaches = !parameters.approaches.empty();
 
         BOOST_ASSERT(parameters.IsValid());
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
-        {
+        SnapCoordinates(parameters.coordinates, [&](const std::size_t i) {
             Approach approach = engine::Approach::UNRESTRICTED;
             if (use_approaches && parameters.approaches[i])
                 approach = parameters.approaches[i].get();
@@ -211,7 +310,7 @@ class BasePlugin
                     util::coordinate_calculation::haversineDistance(
                         parameters.coordinates[i], parameters.hints[i]->phantom.location),
                 });
-                continue;
+                return;
             }
 
             if (use_bearings && parameters.bearings[i])
@@ -249,12 +348,17 @@ class BasePlugin
                         parameters.coordinates[i], number_of_results, approach);
                 }
             }
+        });
 
-            // we didn't find a fitting node, return error
-            if (phantom_nodes[i].empty())
-            {
-                break;
-            }
+        // we didn't find a fitting node, the coordinates after it are left without nodes
+        const auto missing = std::find_if(phantom_nodes.begin(),
+                                          phantom_nodes.end(),
+                                          [](const auto &nodes) { return nodes.empty(); });
+        if (missing != phantom_nodes.end())
+        {
+            std::for_each(std::next(missing), phantom_nodes.end(), [](auto &nodes) {
+                nodes.clear();
+            });
         }
         return phantom_nodes;
     }
@@ -270,8 +374,7 @@ class BasePlugin
         const bool use_approaches = !parameters.approaches.empty();
 
         BOOST_ASSERT(parameters.IsValid());
-        for (const auto i : util::irange<std::size_t>(0UL, parameters.coordinates.size()))
-        {
+        SnapCoordinates(parameters.coordinates, [&](const std::size_t i) {
             Approach approach = engine::Approach::UNRESTRICTED;
             if (use_approaches && parameters.approaches[i])
                 approach = parameters.approaches[i].get();
@@ -281,7 +384,7 @@ class BasePlugin
             {
                 phantom_node_pairs[i].first = parameters.hints[i]->phantom;
                 // we don't set the second one - it will be marked as invalid
-                continue;
+                return;
             }
 
             if (use_bearings && parameters.bearings[i])
@@ -321,20 +424,25 @@ class BasePlugin
                             parameters.coordinates[i], approach);
                 }
             }
+        });
 
-            // we didn't find a fitting node, return error
-            if (!phantom_node_pairs[i].first.IsValid())
-            {
-                // This ensures the list of phantom nodes only consists of valid nodes.
-                // We can use this on the call-site to detect an error.
-                phantom_node_pairs.pop_back();
-                break;
-            }
-            BOOST_ASSERT(phantom_node_pairs[i].first.IsValid());
-            BOOST_ASSERT(phantom_node_pairs[i].second.IsValid());
+        // we didn't find a fitting node, return error
+        if (std::any_of(phantom_node_pairs.begin(),
+                        phantom_node_pairs.end(),
+                        [](const PhantomNodePair &pair) { return !pair.first.IsValid(); }))
+        {
+            // This ensures the list of phantom nodes only consists of valid nodes.
+            // We can use this on the call-site to detect an error.
+            phantom_node_pairs.pop_back();
         }
         return phantom_node_pairs;
     }
+
+  private:
+    // Coordinates are snapped in chunks of this many on each thread
+    static constexpr std::size_t SNAPPING_CHUNK_SIZE = 64;
+
+    const unsigned max_snapping_threads;
 };
 }
 }
@@ -5,9 +5,16 @@
 
 #include "engine/api/table_parameters.hpp"
 #include "engine/routing_algorithms.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
 
 #include "util/json_container.hpp"
 
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -18,14 +25,78 @@ namespace plugins
 class TablePlugin final : public BasePlugin
 {
   public:
-    explicit TablePlugin(const int max_locations_distance_table);
+    // Searches of a single table run on at most max_threads threads. At most max_target_sets
+    // target sets can be registered, see api::TableParameters::register_target_set.
+    TablePlugin(const int max_locations_distance_table,
+                const unsigned max_threads = 1,
+                const unsigned max_target_sets = 0,
+                const unsigned max_snapping_threads = 1);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::TableParameters &params,
                          util::json::Object &result) const;
 
+    // Renders the response directly without building the object tree
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         util::json::Buffer &result) const;
+
+    // Renders the response while the table is computed in blocks of rows and passes everything
+    // rendered so far to consume after each block. The end of the response is left in result.
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         util::json::Buffer &result,
+                         const util::json::BufferConsumer &consume) const;
+
+    // Encodes the response as protobuf
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         std::string &result) const;
+
   private:
+    // A registered target set. Its targets are only valid for the facade they were prepared on,
+    // they are prepared again from the parameters for other facades, e.g. after osrm-datastore
+    // loaded a new dataset or for requests with other exclude flags.
+    struct TargetSet
+    {
+        api::TableParameters parameters;
+        // at most one per facade, the ones of released facades are dropped
+        std::vector<std::shared_ptr<const routing_algorithms::ManyToManyTargets>> prepared;
+    };
+
+    // Checks the request and snaps its coordinates, sets the error response if either fails.
+    // targets is set to the prepared targets if the request uses a target set.
+    template <typename ResultT>
+    Status SnapRequest(const RoutingAlgorithmsInterface &algorithms,
+                       const api::TableParameters &params,
+                       std::vector<PhantomNode> &snapped_phantoms,
+                       std::shared_ptr<const routing_algorithms::ManyToManyTargets> &targets,
+                       ResultT &result) const;
+
+    // The targets of the named set prepared on the facade of algorithms
+    template <typename ResultT>
+    Status GetTargetSet(const RoutingAlgorithmsInterface &algorithms,
+                        const std::string &name,
+                        std::shared_ptr<const routing_algorithms::ManyToManyTargets> &targets,
+                        ResultT &result) const;
+
+    template <typename ResultT>
+    Status RegisterTargetSet(const RoutingAlgorithmsInterface &algorithms,
+                             const api::TableParameters &params,
+                             ResultT &result) const;
+
+    template <typename ResultT>
+    Status HandleRequestImpl(const RoutingAlgorithmsInterface &algorithms,
+                             const api::TableParameters &params,
+                             ResultT &result) const;
+
     const int max_locations_distance_table;
+    const unsigned max_threads;
+    const unsigned max_target_sets;
+
+    // sets are replaced instead of modified, requests keep using the one they found
+    mutable std::mutex target_sets_mutex;
+    mutable std::unordered_map<std::string, std::shared_ptr<const TargetSet>> target_sets;
 };
 }
 }
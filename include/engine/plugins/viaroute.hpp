@@ -27,13 +27,30 @@ class ViaRoutePlugin final : public BasePlugin
   private:
     const int max_locations_viaroute;
     const int max_alternatives;
+    const unsigned max_threads;
 
   public:
-    explicit ViaRoutePlugin(int max_locations_viaroute, int max_alternatives);
+    // The legs of a route with u-turns at the waypoints are searched on at most max_threads
+    // threads
+    ViaRoutePlugin(int max_locations_viaroute,
+                   int max_alternatives,
+                   const unsigned max_threads = 1,
+                   const unsigned max_snapping_threads = 1);
 
     Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                          const api::RouteParameters &route_parameters,
                          util::json::Object &json_result) const;
+
+    // Encodes the response as protobuf
+    Status HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::RouteParameters &route_parameters,
+                         std::string &pbf_result) const;
+
+  private:
+    template <typename ResultT>
+    Status HandleRequestImpl(const RoutingAlgorithmsInterface &algorithms,
+                             const api::RouteParameters &route_parameters,
+                             ResultT &result) const;
 };
 }
 }
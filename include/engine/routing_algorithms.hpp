@@ -25,7 +25,8 @@ class RoutingAlgorithmsInterface
 
     virtual InternalRouteResult
     ShortestPathSearch(const std::vector<PhantomNodes> &phantom_node_pair,
-                       const boost::optional<bool> continue_straight_at_waypoint) const = 0;
+                       const boost::optional<bool> continue_straight_at_waypoint,
+                       const unsigned max_threads) const = 0;
 
     virtual InternalRouteResult
     DirectShortestPathSearch(const PhantomNodes &phantom_node_pair) const = 0;
@@ -35,7 +36,39 @@ class RoutingAlgorithmsInterface
                      const std::vector<std::size_t> &source_indices,
                      const std::vector<std::size_t> &target_indices,
                      const bool calculate_distance,
-                     const bool calculate_duration) const = 0;
+                     const bool calculate_duration,
+                     const unsigned max_threads) const = 0;
+
+    // Passes the table to handler in blocks of rows, see routing_algorithms::manyToManyBlockSearch
+    virtual void
+    ManyToManyBlockSearch(const std::vector<PhantomNode> &phantom_nodes,
+                          const std::vector<std::size_t> &source_indices,
+                          const std::vector<std::size_t> &target_indices,
+                          const bool calculate_distance,
+                          const bool calculate_duration,
+                          const unsigned max_threads,
+                          const std::size_t rows_per_block,
+                          const routing_algorithms::ManyToManyRowsHandler &handler) const = 0;
+
+    // Targets for tables from any sources, see routing_algorithms::manyToManyTargets. They are
+    // only valid as long as IsPreparedOnFacade returns true.
+    virtual std::shared_ptr<const routing_algorithms::ManyToManyTargets>
+    PrepareManyToManyTargets(const std::vector<PhantomNode> &target_phantom_nodes,
+                             const unsigned max_threads) const = 0;
+
+    virtual bool
+    IsPreparedOnFacade(const routing_algorithms::ManyToManyTargets &targets) const = 0;
+
+    // Like ManyToManyBlockSearch with the prepared targets as destinations
+    virtual void ManyToManyTargetsBlockSearch(
+        const std::vector<PhantomNode> &phantom_nodes,
+        const std::vector<std::size_t> &source_indices,
+        const routing_algorithms::ManyToManyTargets &targets,
+        const bool calculate_distance,
+        const bool calculate_duration,
+        const unsigned max_threads,
+        const std::size_t rows_per_block,
+        const routing_algorithms::ManyToManyRowsHandler &handler) const = 0;
 
     virtual routing_algorithms::SubMatchingList
     MapMatching(const routing_algorithms::CandidateLists &candidates_list,
@@ -44,6 +77,16 @@ class RoutingAlgorithmsInterface
                 const std::vector<boost::optional<double>> &trace_gps_precision,
                 const bool allow_splitting) const = 0;
 
+    // Matches the points appended to the state, see routing_algorithms::mapMatching. The state
+    // can only be continued as long as IsPreparedOnFacade returns true.
+    virtual routing_algorithms::SubMatchingList
+    MapMatching(routing_algorithms::MapMatchingState &state,
+                const bool allow_splitting,
+                const bool finish,
+                const std::size_t max_kept_points) const = 0;
+
+    virtual bool IsPreparedOnFacade(const routing_algorithms::MapMatchingState &state) const = 0;
+
     virtual std::vector<routing_algorithms::TurnData>
     GetTileTurns(const std::vector<datafacade::BaseDataFacade::RTreeLeaf> &edges,
                  const std::vector<std::size_t> &sorted_edge_indexes) const = 0;
@@ -77,9 +120,10 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
     AlternativePathSearch(const PhantomNodes &phantom_node_pair,
                           unsigned number_of_alternatives) const final override;
 
-    InternalRouteResult ShortestPathSearch(
-        const std::vector<PhantomNodes> &phantom_node_pair,
-        const boost::optional<bool> continue_straight_at_waypoint) const final override;
+    InternalRouteResult
+    ShortestPathSearch(const std::vector<PhantomNodes> &phantom_node_pair,
+                       const boost::optional<bool> continue_straight_at_waypoint,
+                       const unsigned max_threads) const final override;
 
     InternalRouteResult
     DirectShortestPathSearch(const PhantomNodes &phantom_nodes) const final override;
@@ -89,7 +133,38 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
                      const std::vector<std::size_t> &source_indices,
                      const std::vector<std::size_t> &target_indices,
                      const bool calculate_distance,
-                     const bool calculate_duration) const final override;
+                     const bool calculate_duration,
+                     const unsigned max_threads) const final override;
+
+    void ManyToManyBlockSearch(const std::vector<PhantomNode> &phantom_nodes,
+                               const std::vector<std::size_t> &source_indices,
+                               const std::vector<std::size_t> &target_indices,
+                               const bool calculate_distance,
+                               const bool calculate_duration,
+                               const unsigned max_threads,
+                               const std::size_t rows_per_block,
+                               const routing_algorithms::ManyToManyRowsHandler &handler) const
+        final override;
+
+    std::shared_ptr<const routing_algorithms::ManyToManyTargets>
+    PrepareManyToManyTargets(const std::vector<PhantomNode> &target_phantom_nodes,
+                             const unsigned max_threads) const final override;
+
+    bool IsPreparedOnFacade(const routing_algorithms::ManyToManyTargets &targets) const
+        final override
+    {
+        return targets.facade.lock() == facade;
+    }
+
+    void ManyToManyTargetsBlockSearch(
+        const std::vector<PhantomNode> &phantom_nodes,
+        const std::vector<std::size_t> &source_indices,
+        const routing_algorithms::ManyToManyTargets &targets,
+        const bool calculate_distance,
+        const bool calculate_duration,
+        const unsigned max_threads,
+        const std::size_t rows_per_block,
+        const routing_algorithms::ManyToManyRowsHandler &handler) const final override;
 
     routing_algorithms::SubMatchingList
     MapMatching(const routing_algorithms::CandidateLists &candidates_list,
@@ -98,6 +173,17 @@ template <typename Algorithm> class RoutingAlgorithms final : public RoutingAlgo
                 const std::vector<boost::optional<double>> &trace_gps_precision,
                 const bool allow_splitting) const final override;
 
+    routing_algorithms::SubMatchingList MapMatching(routing_algorithms::MapMatchingState &state,
+                                                    const bool allow_splitting,
+                                                    const bool finish,
+                                                    const std::size_t max_kept_points) const
+        final override;
+
+    bool IsPreparedOnFacade(const routing_algorithms::MapMatchingState &state) const final override
+    {
+        return state.facade.lock() == facade;
+    }
+
     std::vector<routing_algorithms::TurnData>
     GetTileTurns(const std::vector<datafacade::BaseDataFacade::RTreeLeaf> &edges,
                  const std::vector<std::size_t> &sorted_edge_indexes) const final override;
@@ -163,10 +249,11 @@ RoutingAlgorithms<Algorithm>::AlternativePathSearch(const PhantomNodes &phantom_
 template <typename Algorithm>
 InternalRouteResult RoutingAlgorithms<Algorithm>::ShortestPathSearch(
     const std::vector<PhantomNodes> &phantom_node_pair,
-    const boost::optional<bool> continue_straight_at_waypoint) const
+    const boost::optional<bool> continue_straight_at_waypoint,
+    const unsigned max_threads) const
 {
     return routing_algorithms::shortestPathSearch(
-        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint);
+        heaps, *facade, phantom_node_pair, continue_straight_at_waypoint, max_threads);
 }
 
 template <typename Algorithm>
@@ -193,13 +280,28 @@ inline routing_algorithms::SubMatchingList RoutingAlgorithms<Algorithm>::MapMatc
                                            allow_splitting);
 }
 
+template <typename Algorithm>
+inline routing_algorithms::SubMatchingList
+RoutingAlgorithms<Algorithm>::MapMatching(routing_algorithms::MapMatchingState &state,
+                                          const bool allow_splitting,
+                                          const bool finish,
+                                          const std::size_t max_kept_points) const
+{
+    // a new state has no facade yet
+    BOOST_ASSERT(state.facade.expired() || IsPreparedOnFacade(state));
+    state.facade = facade;
+    return routing_algorithms::mapMatching(
+        heaps, *facade, state, allow_splitting, finish, max_kept_points);
+}
+
 template <typename Algorithm>
 std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
 RoutingAlgorithms<Algorithm>::ManyToManySearch(const std::vector<PhantomNode> &phantom_nodes,
                                                const std::vector<std::size_t> &_source_indices,
                                                const std::vector<std::size_t> &_target_indices,
                                                const bool calculate_distance,
-                                               const bool calculate_duration) const
+                                               const bool calculate_duration,
+                                               const unsigned max_threads) const
 {
     BOOST_ASSERT(!phantom_nodes.empty());
 
@@ -223,7 +325,93 @@ RoutingAlgorithms<Algorithm>::ManyToManySearch(const std::vector<PhantomNode> &p
                                                 std::move(source_indices),
                                                 std::move(target_indices),
                                                 calculate_distance,
-                                                calculate_duration);
+                                                calculate_duration,
+                                                max_threads);
+}
+
+template <typename Algorithm>
+void RoutingAlgorithms<Algorithm>::ManyToManyBlockSearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &_source_indices,
+    const std::vector<std::size_t> &_target_indices,
+    const bool calculate_distance,
+    const bool calculate_duration,
+    const unsigned max_threads,
+    const std::size_t rows_per_block,
+    const routing_algorithms::ManyToManyRowsHandler &handler) const
+{
+    BOOST_ASSERT(!phantom_nodes.empty());
+
+    auto source_indices = _source_indices;
+    auto target_indices = _target_indices;
+
+    if (source_indices.empty())
+    {
+        source_indices.resize(phantom_nodes.size());
+        std::iota(source_indices.begin(), source_indices.end(), 0);
+    }
+    if (target_indices.empty())
+    {
+        target_indices.resize(phantom_nodes.size());
+        std::iota(target_indices.begin(), target_indices.end(), 0);
+    }
+
+    routing_algorithms::manyToManyBlockSearch(heaps,
+                                              *facade,
+                                              phantom_nodes,
+                                              source_indices,
+                                              target_indices,
+                                              calculate_distance,
+                                              calculate_duration,
+                                              max_threads,
+                                              rows_per_block,
+                                              handler);
+}
+
+template <typename Algorithm>
+std::shared_ptr<const routing_algorithms::ManyToManyTargets>
+RoutingAlgorithms<Algorithm>::PrepareManyToManyTargets(
+    const std::vector<PhantomNode> &target_phantom_nodes, const unsigned max_threads) const
+{
+    BOOST_ASSERT(!target_phantom_nodes.empty());
+
+    auto targets = routing_algorithms::manyToManyTargets(
+        heaps, *facade, target_phantom_nodes, max_threads);
+    targets->facade = facade;
+    return targets;
+}
+
+template <typename Algorithm>
+void RoutingAlgorithms<Algorithm>::ManyToManyTargetsBlockSearch(
+    const std::vector<PhantomNode> &phantom_nodes,
+    const std::vector<std::size_t> &_source_indices,
+    const routing_algorithms::ManyToManyTargets &targets,
+    const bool calculate_distance,
+    const bool calculate_duration,
+    const unsigned max_threads,
+    const std::size_t rows_per_block,
+    const routing_algorithms::ManyToManyRowsHandler &handler) const
+{
+    BOOST_ASSERT(!phantom_nodes.empty());
+    BOOST_ASSERT(IsPreparedOnFacade(targets));
+
+    auto source_indices = _source_indices;
+    if (source_indices.empty())
+    {
+        source_indices.resize(phantom_nodes.size());
+        std::iota(source_indices.begin(), source_indices.end(), 0);
+    }
+
+    routing_algorithms::manyToManyBlockSearch(heaps,
+                                              *facade,
+                                              phantom_nodes,
+                                              source_indices,
+                                              targets,
+                                              calculate_distance,
+                                              calculate_duration,
+                                              max_threads,
+                                              rows_per_block,
+                                              handler);
 }
 
 template <typename Algorithm>
@@ -0,0 +1,69 @@
+#ifndef OSRM_ENGINE_ROUTING_ALGORITHMS_BUCKET_RELAXATION_HPP
+#define OSRM_ENGINE_ROUTING_ALGORITHMS_BUCKET_RELAXATION_HPP
+
+#include "util/typedefs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+// The buckets of a node as arrays of their members, see NodeBucketIndex
+struct NodeBuckets
+{
+    const std::uint32_t *column_indices;
+    const EdgeWeight *weights;
+    const EdgeDuration *durations;
+    const EdgeDistance *distances;
+    std::size_t size;
+
+    bool empty() const { return size == 0; }
+};
+
+// The row of a source in the tables of a table search, the tables of metrics that are not
+// requested are null
+struct TableRow
+{
+    EdgeWeight *weights;
+    EdgeDuration *durations;
+    EdgeDistance *distances;
+};
+
+// Implementations of relaxBuckets. The vector kernels compare the sums of a block of buckets with
+// the entries of their columns at once and only write the entries of better paths one by one.
+enum class BucketKernel
+{
+    Scalar,
+    SSE41,
+    AVX2
+};
+
+// Whether the CPU the process runs on can execute the kernel
+bool isSupported(const BucketKernel kernel);
+
+// The fastest kernel the CPU supports, detected on the first call
+BucketKernel getBucketKernel();
+
+// Adds the weight and the metrics of the path from the source to the node to all buckets of the
+// node and keeps the sums that are better than the row's entries in the buckets' columns, by
+// weight and then by duration if durations are requested. The weight must not be negative, paths
+// that start and end on the same segment are left to the caller. The buckets of a node must be in
+// different columns. Metrics is one of the TableMetrics of many_to_many.hpp.
+template <typename Metrics>
+void relaxBuckets(const NodeBuckets &buckets,
+                  const EdgeWeight weight,
+                  const EdgeDuration duration,
+                  const EdgeDistance distance,
+                  const TableRow &row,
+                  const BucketKernel kernel = getBucketKernel());
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
+
+#endif
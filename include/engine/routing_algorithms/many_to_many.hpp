@@ -3,10 +3,19 @@
 
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/routing_algorithms/bucket_relaxation.hpp"
 #include "engine/search_engine_data.hpp"
 
+#include "util/integer_range.hpp"
 #include "util/typedefs.hpp"
 
+#include <boost/assert.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -25,14 +34,18 @@ struct NodeBucket
     unsigned column_index; // a column in the weight/duration matrix
     EdgeWeight weight;
     EdgeDuration duration;
+    EdgeDistance distance;
+
+    NodeBucket() = default;
 
     NodeBucket(NodeID middle_node,
                NodeID parent_node,
                unsigned column_index,
                EdgeWeight weight,
-               EdgeDuration duration)
+               EdgeDuration duration,
+               EdgeDistance distance)
         : middle_node(middle_node), parent_node(parent_node), column_index(column_index),
-          weight(weight), duration(duration)
+          weight(weight), duration(duration), distance(distance)
     {
     }
 
@@ -55,28 +68,270 @@ struct NodeBucket
             return lhs < rhs.middle_node;
         }
     };
+};
 
-    // functor for equal_range
-    struct ColumnCompare
+// Buckets grouped by their middle node, so that a forward search finds the buckets of a settled
+// node with a single hash table probe instead of a binary search in the sorted buckets.
+// An open addressing table of the middle nodes holds the offsets of a contiguous slice of the
+// buckets per slot, the buckets are placed in their slices by a counting pass. The members of the
+// buckets are stored in separate arrays for the vector kernels of relaxBuckets, the middle and
+// parent nodes are not needed anymore.
+class NodeBucketIndex
+{
+  public:
+    NodeBucketIndex() : NodeBucketIndex(std::vector<NodeBucket>{}) {}
+
+    explicit NodeBucketIndex(const std::vector<NodeBucket> &unordered_buckets)
+        : slot_nodes(MIN_NUMBER_OF_SLOTS, SPECIAL_NODEID), shift(32 - MIN_SLOT_BITS)
     {
-        unsigned column_idx;
+        std::size_t number_of_nodes = 0;
+        for (const auto &bucket : unordered_buckets)
+        {
+            auto slot = FindSlot(bucket.middle_node);
+            if (slot_nodes[slot] != SPECIAL_NODEID)
+                continue;
 
-        ColumnCompare(unsigned column_idx) : column_idx(column_idx){};
+            // at most half of the slots are used
+            if (2 * (number_of_nodes + 1) > slot_nodes.size())
+            {
+                Grow();
+                slot = FindSlot(bucket.middle_node);
+            }
+            slot_nodes[slot] = bucket.middle_node;
+            ++number_of_nodes;
+        }
 
-        bool operator()(const NodeBucket &lhs, const NodeID &rhs) const // lowerbound
+        std::vector<std::uint32_t> bucket_slots(unordered_buckets.size());
+        first_bucket.resize(slot_nodes.size() + 1, 0);
+        for (const auto index : util::irange<std::size_t>(0, unordered_buckets.size()))
         {
-            return std::tie(lhs.middle_node, lhs.column_index) < std::tie(rhs, column_idx);
+            bucket_slots[index] = FindSlot(unordered_buckets[index].middle_node);
+            ++first_bucket[bucket_slots[index] + 1];
         }
+        std::partial_sum(first_bucket.begin(), first_bucket.end(), first_bucket.begin());
 
-        bool operator()(const NodeID &lhs, const NodeBucket &rhs) const // upperbound
+        column_indices.resize(unordered_buckets.size());
+        weights.resize(unordered_buckets.size());
+        durations.resize(unordered_buckets.size());
+        distances.resize(unordered_buckets.size());
+        auto next_bucket = first_bucket;
+        for (const auto index : util::irange<std::size_t>(0, unordered_buckets.size()))
         {
-            return std::tie(lhs, column_idx) < std::tie(rhs.middle_node, rhs.column_index);
+            const auto &bucket = unordered_buckets[index];
+            const auto position = next_bucket[bucket_slots[index]]++;
+            column_indices[position] = bucket.column_index;
+            weights[position] = bucket.weight;
+            durations[position] = bucket.duration;
+            distances[position] = bucket.distance;
         }
-    };
+    }
+
+    // The buckets of the node in the order they were added, empty if there are none
+    NodeBuckets GetBuckets(const NodeID node) const
+    {
+        const auto slot = FindSlot(node);
+        const auto first = first_bucket[slot];
+        return {column_indices.data() + first,
+                weights.data() + first,
+                durations.data() + first,
+                distances.data() + first,
+                first_bucket[slot + 1] - first};
+    }
+
+    std::size_t GetNumberOfBuckets() const { return weights.size(); }
+
+  private:
+    static constexpr std::uint32_t MIN_SLOT_BITS = 4;
+    static constexpr std::size_t MIN_NUMBER_OF_SLOTS = 1 << MIN_SLOT_BITS;
+
+    // Slot of the node or the empty slot the node would be inserted into
+    std::size_t FindSlot(const NodeID node) const
+    {
+        BOOST_ASSERT(node != SPECIAL_NODEID);
+        // Fibonacci hashing, node ids of search spaces are clustered
+        const std::size_t mask = slot_nodes.size() - 1;
+        auto slot = static_cast<std::uint32_t>(node * 2654435769u) >> shift;
+        while (slot_nodes[slot] != node && slot_nodes[slot] != SPECIAL_NODEID)
+        {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    void Grow()
+    {
+        std::vector<NodeID> nodes(slot_nodes.size() * 2, SPECIAL_NODEID);
+        nodes.swap(slot_nodes);
+        --shift;
+        for (const auto node : nodes)
+        {
+            if (node != SPECIAL_NODEID)
+                slot_nodes[FindSlot(node)] = node;
+        }
+    }
+
+    std::vector<NodeID> slot_nodes;
+    std::uint32_t shift;
+    // the buckets of slot i are [first_bucket[i], first_bucket[i + 1])
+    std::vector<std::uint32_t> first_bucket;
+    std::vector<std::uint32_t> column_indices;
+    std::vector<EdgeWeight> weights;
+    std::vector<EdgeDuration> durations;
+    std::vector<EdgeDistance> distances;
 };
 }
 
+// The metrics a table search computes besides the weight. The search kernels are instantiated
+// for every combination, tables of other metrics are not allocated and their sums are skipped.
+// Without durations paths of equal weight are not ordered by duration.
+template <bool DURATION, bool DISTANCE> struct TableMetrics
+{
+    static constexpr bool duration = DURATION;
+    static constexpr bool distance = DISTANCE;
+};
+
+// Calls function with the TableMetrics of the requested tables
+template <typename FunctionT>
+auto dispatchTableMetrics(const bool calculate_duration,
+                          const bool calculate_distance,
+                          FunctionT &&function)
+{
+    if (calculate_duration && calculate_distance)
+        return function(TableMetrics<true, true>{});
+    if (calculate_duration)
+        return function(TableMetrics<true, false>{});
+    if (calculate_distance)
+        return function(TableMetrics<false, true>{});
+    return function(TableMetrics<false, false>{});
+}
+
+// Runs on at most max_threads threads, the calling thread's heaps are only used if it is one.
+// Only the requested tables are returned, the others are empty.
+template <typename Algorithm>
+std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const bool calculate_distance,
+                 const bool calculate_duration,
+                 const unsigned max_threads);
+
+// Receives the rows of a table from first_row on, row major like the tables of manyToManySearch.
+// Only the requested tables are filled, the handler may take the vectors.
+using ManyToManyRowsHandler = std::function<void(const std::size_t first_row,
+                                                 std::vector<EdgeDuration> &durations,
+                                                 std::vector<EdgeDistance> &distances)>;
+
+// Like manyToManySearch, but passes the table to handler in blocks of rows_per_block rows as
+// soon as they are computed. Only the tables of one block are held at a time, except for
+// algorithms that compute the whole table at once and pass it as a single block.
+template <typename Algorithm>
+void manyToManyBlockSearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler);
+
+// Targets that are searched once and shared by all tables from any sources to them, e.g. depots
+// that are the destinations of many requests. Algorithms keep the part of the search that does
+// not depend on the sources, see manyToManyTargets.
+class ManyToManyTargets
+{
+  public:
+    explicit ManyToManyTargets(std::vector<PhantomNode> phantom_nodes_)
+        : phantom_nodes(std::move(phantom_nodes_))
+    {
+    }
+    virtual ~ManyToManyTargets() = default;
+
+    const std::vector<PhantomNode> &GetPhantomNodes() const { return phantom_nodes; }
+
+    // The facade the targets were prepared on, they are invalid for any other one. Set by
+    // RoutingAlgorithms, which own the facade.
+    std::weak_ptr<const void> facade;
+
+  private:
+    std::vector<PhantomNode> phantom_nodes;
+};
+
+// Prepares all phantom nodes as targets with all metrics, so that any annotations can be
+// requested from them
 template <typename Algorithm>
+std::shared_ptr<ManyToManyTargets>
+manyToManyTargets(SearchEngineData<Algorithm> &engine_working_data,
+                  const DataFacade<Algorithm> &facade,
+                  const std::vector<PhantomNode> &target_phantom_nodes,
+                  const unsigned max_threads);
+
+// Like manyToManyBlockSearch with the prepared targets as the columns of the table, only the
+// searches of the sources run. The targets must be prepared on the same facade.
+template <typename Algorithm>
+void manyToManyBlockSearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const ManyToManyTargets &targets,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler);
+
+namespace ch
+{
+// Buckets: the backward searches of the targets store their search spaces in buckets that the
+// forward searches of the sources scan. RestrictedPHAST extracts the part of the hierarchy above
+// the targets once and sweeps it linearly for every source, which is faster for many sources
+// and targets. Both carry the distance as a third metric next to weight and duration.
+enum class ManyToManyStrategy
+{
+    Buckets,
+    RestrictedPHAST
+};
+
+// The strategy manyToManySearch<ch::Algorithm> uses for a table of this shape
+ManyToManyStrategy chooseManyToManyStrategy(const std::size_t number_of_sources,
+                                            const std::size_t number_of_targets);
+
+std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const bool calculate_distance,
+                 const bool calculate_duration,
+                 const unsigned max_threads,
+                 const ManyToManyStrategy strategy);
+
+// The searches of the targets are shared by all blocks, only the searches of the sources
+// run per block
+void manyToManyBlockSearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler,
+                           const ManyToManyStrategy strategy);
+} // namespace ch
+
+namespace mld
+{
+// Sources in the same cell share the searches from the exits of the cell, the nodes with edges out
+// of it, and only search the cell themselves. manyToManySearch<mld::Algorithm> chooses the level
+// of the cells by the estimated cost and only groups the sources of cells where that pays off.
+// This groups all sources that lie in a single cell of group_level, INVALID_LEVEL_ID groups none.
 std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
 manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                  const DataFacade<Algorithm> &facade,
@@ -84,7 +339,9 @@ manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                  const std::vector<std::size_t> &source_indices,
                  const std::vector<std::size_t> &target_indices,
                  const bool calculate_distance,
-                 const bool calculate_duration);
+                 const bool calculate_duration,
+                 const LevelID group_level);
+} // namespace mld
 
 } // namespace routing_algorithms
 } // namespace engine
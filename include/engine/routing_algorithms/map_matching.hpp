@@ -3,9 +3,16 @@
 
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/map_matching/hidden_markov_model.hpp"
 #include "engine/map_matching/sub_matching.hpp"
 #include "engine/search_engine_data.hpp"
 
+#include "util/coordinate.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace osrm
@@ -20,6 +27,42 @@ using CandidateLists = std::vector<CandidateList>;
 using SubMatchingList = std::vector<map_matching::SubMatching>;
 static const constexpr double DEFAULT_GPS_PRECISION = 5;
 
+// The matching of a trace whose points arrive in parts. The caller appends the candidates,
+// coordinates, timestamps and GPS precisions of new points and mapMatching matches them. Points
+// are only kept until the matching up to them is final, first_index is the index of the first
+// kept point in the whole trace. Timestamps are given for all points or for none, GPS precisions
+// may be left empty as well.
+struct MapMatchingState
+{
+    MapMatchingState() : model(candidates_list, emission_log_probabilities) {}
+
+    // the model refers to the members
+    MapMatchingState(const MapMatchingState &) = delete;
+    MapMatchingState &operator=(const MapMatchingState &) = delete;
+
+    std::size_t first_index = 0;
+    CandidateLists candidates_list;
+    std::vector<util::Coordinate> trace_coordinates;
+    std::vector<unsigned> trace_timestamps;
+    std::vector<boost::optional<double>> trace_gps_precision;
+
+    // The facade the candidates were found on, they are invalid for any other one. Set by
+    // RoutingAlgorithms, which own the facade.
+    std::weak_ptr<const void> facade;
+
+    // Viterbi state of the kept points, the indices are relative to first_index
+    std::vector<std::vector<double>> emission_log_probabilities;
+    map_matching::HiddenMarkovModel<CandidateLists> model;
+    // the next point to compute the transitions to, or to start a sub matching from if there are
+    // no unbroken points
+    std::size_t next_timestamp = 0;
+    std::vector<std::size_t> prev_unbroken_timestamps;
+    std::size_t breakage_begin = map_matching::INVALID_STATE;
+    // ends of the sub matchings that were split off and not backtracked yet
+    std::vector<std::size_t> split_points;
+    std::size_t sub_matching_begin = 0;
+};
+
 //[1] "Hidden Markov Map Matching Through Noise and Sparseness";
 //     P. Newson and J. Krumm; 2009; ACM GIS
 template <typename Algorithm>
@@ -31,6 +74,20 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                             const std::vector<boost::optional<double>> &trace_gps_precision,
                             const bool allow_splitting);
 
+// Matches the points appended to the state and returns the sub matchings that became final, their
+// indices are the ones of the whole trace. The matching up to a point is final once the paths to
+// all candidates of the recent points pass one of its candidates, the sub matching up to there is
+// returned and continued from that candidate by later calls. With finish all points are matched
+// and dropped. If more than max_kept_points points (0 for any number) are kept afterwards, the
+// sub matching is ended like by finish.
+template <typename Algorithm>
+SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            MapMatchingState &state,
+                            const bool allow_splitting,
+                            const bool finish,
+                            const std::size_t max_kept_points = 0);
+
 } // namespace routing_algorithms
 } // namespace engine
 } // namespace osrm
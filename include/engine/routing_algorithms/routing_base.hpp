@@ -6,6 +6,7 @@
 
 #include "engine/algorithm.hpp"
 #include "engine/datafacade.hpp"
+#include "engine/deadline.hpp"
 #include "engine/internal_route_result.hpp"
 #include "engine/phantom_node.hpp"
 #include "engine/search_engine_data.hpp"
@@ -45,9 +46,8 @@ bool needsLoopForward(const PhantomNodes &phantoms);
 bool needsLoopBackwards(const PhantomNodes &phantoms);
 
 template <typename Heap>
-void insertNodesInHeaps(Heap &forward_heap, Heap &reverse_heap, const PhantomNodes &nodes)
+void insertSourceNodesInHeap(Heap &forward_heap, const PhantomNode &source)
 {
-    const auto &source = nodes.source_phantom;
     if (source.IsValidForwardSource())
     {
         forward_heap.Insert(source.forward_segment_id.id,
@@ -61,8 +61,11 @@ void insertNodesInHeaps(Heap &forward_heap, Heap &reverse_heap, const PhantomNod
                             -source.GetReverseWeightPlusOffset(),
                             source.reverse_segment_id.id);
     }
+}
 
-    const auto &target = nodes.target_phantom;
+template <typename Heap>
+void insertTargetNodesInHeap(Heap &reverse_heap, const PhantomNode &target)
+{
     if (target.IsValidForwardTarget())
     {
         reverse_heap.Insert(target.forward_segment_id.id,
@@ -78,6 +81,13 @@ void insertNodesInHeaps(Heap &forward_heap, Heap &reverse_heap, const PhantomNod
     }
 }
 
+template <typename Heap>
+void insertNodesInHeaps(Heap &forward_heap, Heap &reverse_heap, const PhantomNodes &nodes)
+{
+    insertSourceNodesInHeap(forward_heap, nodes.source_phantom);
+    insertTargetNodesInHeap(reverse_heap, nodes.target_phantom);
+}
+
 template <typename ManyToManyQueryHeap>
 void insertSourceInHeap(ManyToManyQueryHeap &heap, const PhantomNode &phantom_node)
 {
@@ -406,22 +416,6 @@ InternalRouteResult extractRoute(const DataFacade<AlgorithmT> &facade,
     return raw_route_data;
 }
 
-template <typename FacadeT> EdgeDistance computeEdgeDistance(const FacadeT &facade, NodeID node_id)
-{
-    const auto geometry_index = facade.GetGeometryIndex(node_id);
-
-    EdgeDistance total_distance = 0.0;
-
-    auto geometry_range = facade.GetUncompressedForwardGeometry(geometry_index.id);
-    for (auto current = geometry_range.begin(); current < geometry_range.end() - 1; ++current)
-    {
-        total_distance += util::coordinate_calculation::fccApproximateDistance(
-            facade.GetCoordinateOfNode(*current), facade.GetCoordinateOfNode(*std::next(current)));
-    }
-
-    return total_distance;
-}
-
 } // namespace routing_algorithms
 } // namespace engine
 } // namespace osrm
@@ -205,6 +205,20 @@ EdgeWeight getLoopWeight(const DataFacade<Algorithm> &facade, NodeID node)
     return loop_weight;
 }
 
+inline EdgeDistance getLoopDistance(const DataFacade<Algorithm> &facade, NodeID node)
+{
+    EdgeDistance loop_distance = INVALID_EDGE_DISTANCE;
+    for (auto edge : facade.GetAdjacentEdgeRange(node))
+    {
+        const auto &data = facade.GetEdgeData(edge);
+        if (data.forward && facade.GetTarget(edge) == node)
+        {
+            loop_distance = std::min(loop_distance, data.distance);
+        }
+    }
+    return loop_distance;
+}
+
 /**
  * Given a sequence of connected `NodeID`s in the CH graph, performs a depth-first unpacking of
  * the shortcut
@@ -288,106 +302,6 @@ void unpackPath(const DataFacade<Algorithm> &facade,
     }
 }
 
-template <typename BidirectionalIterator>
-EdgeDistance calculateEBGNodeAnnotations(const DataFacade<Algorithm> &facade,
-                                         BidirectionalIterator packed_path_begin,
-                                         BidirectionalIterator packed_path_end)
-{
-    // Make sure we have at least something to unpack
-    if (packed_path_begin == packed_path_end ||
-        std::distance(packed_path_begin, packed_path_end) <= 1)
-        return 0;
-
-    std::stack<std::tuple<NodeID, NodeID, bool>> recursion_stack;
-    std::stack<EdgeDistance> distance_stack;
-    // We have to push the path in reverse order onto the stack because it's LIFO.
-    for (auto current = std::prev(packed_path_end); current > packed_path_begin;
-         current = std::prev(current))
-    {
-        recursion_stack.emplace(*std::prev(current), *current, false);
-    }
-
-    std::tuple<NodeID, NodeID, bool> edge;
-    while (!recursion_stack.empty())
-    {
-        edge = recursion_stack.top();
-        recursion_stack.pop();
-
-        // Have we processed the edge before? tells us if we have values in the durations stack that
-        // we can add up
-        if (!std::get<2>(edge))
-        { // haven't processed edge before, so process it in the body!
-
-            std::get<2>(edge) = true; // mark that this edge will now be processed
-
-            // Look for an edge on the forward CH graph (.forward)
-            EdgeID smaller_edge_id =
-                facade.FindSmallestEdge(std::get<0>(edge), std::get<1>(edge), [](const auto &data) {
-                    return data.forward;
-                });
-
-            // If we didn't find one there, the we might be looking at a part of the path that
-            // was found using the backward search.  Here, we flip the node order (.second,
-            // .first) and only consider edges with the `.backward` flag.
-            if (SPECIAL_EDGEID == smaller_edge_id)
-            {
-                smaller_edge_id =
-                    facade.FindSmallestEdge(std::get<1>(edge),
-                                            std::get<0>(edge),
-                                            [](const auto &data) { return data.backward; });
-            }
-
-            // If we didn't find anything *still*, then something is broken and someone has
-            // called this function with bad values.
-            BOOST_ASSERT_MSG(smaller_edge_id != SPECIAL_EDGEID, "Invalid smaller edge ID");
-
-            const auto &data = facade.GetEdgeData(smaller_edge_id);
-            BOOST_ASSERT_MSG(data.weight != std::numeric_limits<EdgeWeight>::max(),
-                             "edge weight invalid");
-
-            // If the edge is a shortcut, we need to add the two halfs to the stack.
-            if (data.shortcut)
-            { // unpack
-                const NodeID middle_node_id = data.turn_id;
-                // Note the order here - we're adding these to a stack, so we
-                // want the first->middle to get visited before middle->second
-                recursion_stack.emplace(edge);
-                recursion_stack.emplace(middle_node_id, std::get<1>(edge), false);
-                recursion_stack.emplace(std::get<0>(edge), middle_node_id, false);
-            }
-            else
-            {
-                // compute the duration here and put it onto the duration stack using method
-                // similar to annotatePath but smaller
-                EdgeDistance distance = computeEdgeDistance(facade, std::get<0>(edge));
-                distance_stack.emplace(distance);
-            }
-        }
-        else
-        { // the edge has already been processed. this means that there are enough values in the
-            // distances stack
-
-            BOOST_ASSERT_MSG(distance_stack.size() >= 2,
-                             "There are not enough (at least 2) values on the distance stack");
-            EdgeDistance distance1 = distance_stack.top();
-            distance_stack.pop();
-            EdgeDistance distance2 = distance_stack.top();
-            distance_stack.pop();
-            EdgeDistance distance = distance1 + distance2;
-            distance_stack.emplace(distance);
-        }
-    }
-
-    EdgeDistance total_distance = 0;
-    while (!distance_stack.empty())
-    {
-        total_distance += distance_stack.top();
-        distance_stack.pop();
-    }
-
-    return total_distance;
-}
-
 template <typename RandomIter, typename FacadeT>
 void unpackPath(const FacadeT &facade,
                 RandomIter packed_path_begin,
@@ -479,6 +393,17 @@ double getNetworkDistance(SearchEngineData<Algorithm> &engine_working_data,
                           const PhantomNode &target_phantom,
                           int duration_upper_bound = INVALID_EDGE_WEIGHT);
 
+// The network distances from the source to each of the targets, as getNetworkDistance would
+// compute them. The forward search space of the source is only built once and every target runs
+// a reverse search against it.
+std::vector<double> getNetworkDistances(SearchEngineData<Algorithm> &engine_working_data,
+                                        const DataFacade<ch::Algorithm> &facade,
+                                        SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                                        SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                                        const PhantomNode &source_phantom,
+                                        const std::vector<PhantomNode> &target_phantoms,
+                                        const EdgeWeight weight_upper_bound = INVALID_EDGE_WEIGHT);
+
 } // namespace ch
 } // namespace routing_algorithms
 } // namespace engine
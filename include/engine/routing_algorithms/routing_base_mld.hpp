@@ -6,6 +6,7 @@
 #include "engine/routing_algorithms/routing_base.hpp"
 #include "engine/search_engine_data.hpp"
 
+#include "util/integer_range.hpp"
 #include "util/typedefs.hpp"
 
 #include <boost/assert.hpp>
@@ -25,6 +26,13 @@ namespace routing_algorithms
 namespace mld
 {
 
+// The phantom nodes of a search from one source to several targets
+struct OneToManyPhantomNodes
+{
+    const PhantomNode &source_phantom;
+    const std::vector<PhantomNode> &target_phantoms;
+};
+
 namespace
 {
 // Unrestricted search (Args is const PhantomNodes &):
@@ -52,6 +60,35 @@ inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
 
 inline bool checkParentCellRestriction(CellID, const PhantomNodes &) { return true; }
 
+// Unrestricted one-to-many search (Args is OneToManyPhantomNodes):
+//   * use the minimal query level of the source and all targets, which is the minimum of
+//     partition.GetQueryLevel over all pairs of the source and a target
+//   * allow to traverse all cells
+template <typename MultiLevelPartition>
+inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
+                                 NodeID node,
+                                 const OneToManyPhantomNodes &phantom_nodes)
+{
+    auto level = [&partition, node](const PhantomNode &phantom_node) {
+        auto highest_different_level = [&partition, node](const SegmentID &segment) {
+            if (segment.enabled)
+                return partition.GetHighestDifferentLevel(segment.id, node);
+            return INVALID_LEVEL_ID;
+        };
+        return std::min(highest_different_level(phantom_node.forward_segment_id),
+                        highest_different_level(phantom_node.reverse_segment_id));
+    };
+
+    auto result = level(phantom_nodes.source_phantom);
+    for (const auto &target_phantom : phantom_nodes.target_phantoms)
+    {
+        result = std::min(result, level(target_phantom));
+    }
+    return result;
+}
+
+inline bool checkParentCellRestriction(CellID, const OneToManyPhantomNodes &) { return true; }
+
 // Restricted search (Args is LevelID, CellID):
 //   * use the fixed level for queries
 //   * check if the node cell is the same as the specified parent onr
@@ -286,6 +323,18 @@ using UnpackedNodes = std::vector<NodeID>;
 using UnpackedEdges = std::vector<EdgeID>;
 using UnpackedPath = std::tuple<EdgeWeight, UnpackedNodes, UnpackedEdges>;
 
+template <typename Algorithm, typename... Args>
+UnpackedPath unpackPackedPath(SearchEngineData<Algorithm> &engine_working_data,
+                              const DataFacade<Algorithm> &facade,
+                              typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                              typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                              const bool force_loop_forward,
+                              const bool force_loop_reverse,
+                              const EdgeWeight weight,
+                              const PackedPath &packed_path,
+                              const NodeID middle,
+                              Args... args);
+
 template <typename Algorithm, typename... Args>
 UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
                     const DataFacade<Algorithm> &facade,
@@ -301,8 +350,6 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
         return std::make_tuple(INVALID_EDGE_WEIGHT, std::vector<NodeID>(), std::vector<EdgeID>());
     }
 
-    const auto &partition = facade.GetMultiLevelPartition();
-
     BOOST_ASSERT(!forward_heap.Empty() && forward_heap.MinKey() < INVALID_EDGE_WEIGHT);
     BOOST_ASSERT(!reverse_heap.Empty() && reverse_heap.MinKey() < INVALID_EDGE_WEIGHT);
 
@@ -311,9 +358,11 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
     EdgeWeight weight = weight_upper_bound;
     EdgeWeight forward_heap_min = forward_heap.MinKey();
     EdgeWeight reverse_heap_min = reverse_heap.MinKey();
+    auto &deadline = Deadline::Current();
     while (forward_heap.Size() + reverse_heap.Size() > 0 &&
            forward_heap_min + reverse_heap_min < weight)
     {
+        deadline.Check();
         if (!forward_heap.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -349,7 +398,35 @@ UnpackedPath search(SearchEngineData<Algorithm> &engine_working_data,
     }
 
     // Get packed path as edges {from node ID, to node ID, from_clique_arc}
-    auto packed_path = retrievePackedPathFromHeap(forward_heap, reverse_heap, middle);
+    const auto packed_path = retrievePackedPathFromHeap(forward_heap, reverse_heap, middle);
+
+    return unpackPackedPath(engine_working_data,
+                            facade,
+                            forward_heap,
+                            reverse_heap,
+                            force_loop_forward,
+                            force_loop_reverse,
+                            weight,
+                            packed_path,
+                            middle,
+                            args...);
+}
+
+// Unpacks the overlay edges of the packed path of a search with the same Args down to the base
+// graph. The heaps are cleared for the searches in the cells of the overlay edges.
+template <typename Algorithm, typename... Args>
+UnpackedPath unpackPackedPath(SearchEngineData<Algorithm> &engine_working_data,
+                              const DataFacade<Algorithm> &facade,
+                              typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                              typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                              const bool force_loop_forward,
+                              const bool force_loop_reverse,
+                              const EdgeWeight weight,
+                              const PackedPath &packed_path,
+                              const NodeID middle,
+                              Args... args)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
 
     // Beware the edge case when start, middle, end are all the same.
     // In this case we return a single node, no edges. We also don't unpack.
@@ -508,6 +585,119 @@ double getNetworkDistance(SearchEngineData<Algorithm> &engine_working_data,
     return getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
 }
 
+// The network distances from the source to each of the targets, as getNetworkDistance would
+// compute them. The forward search space of the source is only built once and every target runs
+// a reverse search against it, both searches use the query levels of the source and all targets.
+template <typename Algorithm>
+std::vector<double>
+getNetworkDistances(SearchEngineData<Algorithm> &engine_working_data,
+                    const DataFacade<Algorithm> &facade,
+                    typename SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                    typename SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                    const PhantomNode &source_phantom,
+                    const std::vector<PhantomNode> &target_phantoms,
+                    const EdgeWeight weight_upper_bound = INVALID_EDGE_WEIGHT)
+{
+    std::vector<double> distances(target_phantoms.size(), std::numeric_limits<double>::max());
+
+    forward_heap.Clear();
+    reverse_heap.Clear();
+
+    insertSourceNodesInHeap(forward_heap, source_phantom);
+    if (forward_heap.Empty())
+    {
+        return distances;
+    }
+
+    const OneToManyPhantomNodes phantom_nodes{source_phantom, target_phantoms};
+    const auto forward_heap_min = forward_heap.MinKey();
+    auto &deadline = Deadline::Current();
+
+    // Reverse weights are not negative, so all paths below the bound meet the forward search at
+    // a node with a smaller weight. With the empty reverse heap the forward steps never meet.
+    NodeID middle = SPECIAL_NODEID;
+    EdgeWeight weight = weight_upper_bound;
+    while (!forward_heap.Empty() && forward_heap.MinKey() < weight_upper_bound)
+    {
+        deadline.Check();
+        routingStep<FORWARD_DIRECTION>(facade,
+                                       forward_heap,
+                                       reverse_heap,
+                                       middle,
+                                       weight,
+                                       DO_NOT_FORCE_LOOPS,
+                                       DO_NOT_FORCE_LOOPS,
+                                       phantom_nodes);
+    }
+
+    // The unpacking searches reuse the heaps, so the packed paths of all targets are collected
+    // before the search space of the source is dropped
+    struct TargetPath
+    {
+        std::size_t target;
+        EdgeWeight weight;
+        NodeID middle;
+        PackedPath packed_path;
+    };
+    std::vector<TargetPath> target_paths;
+    for (const auto target : util::irange<std::size_t>(0UL, target_phantoms.size()))
+    {
+        reverse_heap.Clear();
+        insertTargetNodesInHeap(reverse_heap, target_phantoms[target]);
+
+        middle = SPECIAL_NODEID;
+        weight = weight_upper_bound;
+        while (!reverse_heap.Empty() && forward_heap_min + reverse_heap.MinKey() < weight)
+        {
+            deadline.Check();
+            routingStep<REVERSE_DIRECTION>(facade,
+                                           reverse_heap,
+                                           forward_heap,
+                                           middle,
+                                           weight,
+                                           DO_NOT_FORCE_LOOPS,
+                                           DO_NOT_FORCE_LOOPS,
+                                           phantom_nodes);
+        }
+
+        if (weight >= weight_upper_bound || SPECIAL_NODEID == middle)
+        {
+            continue;
+        }
+
+        auto packed_path = retrievePackedPathFromHeap(forward_heap, reverse_heap, middle);
+        target_paths.push_back({target, weight, middle, std::move(packed_path)});
+    }
+
+    for (const auto &target_path : target_paths)
+    {
+        const auto &target_phantom = target_phantoms[target_path.target];
+
+        std::vector<NodeID> unpacked_nodes;
+        std::vector<EdgeID> unpacked_edges;
+        std::tie(std::ignore, unpacked_nodes, unpacked_edges) =
+            unpackPackedPath(engine_working_data,
+                             facade,
+                             forward_heap,
+                             reverse_heap,
+                             DO_NOT_FORCE_LOOPS,
+                             DO_NOT_FORCE_LOOPS,
+                             target_path.weight,
+                             target_path.packed_path,
+                             target_path.middle,
+                             phantom_nodes);
+
+        std::vector<PathData> unpacked_path;
+        const PhantomNodes pair{source_phantom, target_phantom};
+        annotatePath(facade, pair, unpacked_nodes, unpacked_edges, unpacked_path);
+
+        distances[target_path.target] =
+            getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
+    }
+
+    return distances;
+}
+
 } // namespace mld
 } // namespace routing_algorithms
 } // namespace engine
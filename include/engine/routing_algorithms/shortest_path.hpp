@@ -13,11 +13,14 @@ namespace engine
 namespace routing_algorithms
 {
 
+// Searches the route through all legs. If u-turns are allowed at the waypoints the legs are
+// searched independently, on up to max_threads threads.
 template <typename Algorithm>
 InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                        const DataFacade<Algorithm> &facade,
                                        const std::vector<PhantomNodes> &phantom_nodes_vector,
-                                       const boost::optional<bool> continue_straight_at_waypoint);
+                                       const boost::optional<bool> continue_straight_at_waypoint,
+                                       const unsigned max_threads);
 
 } // namespace routing_algorithms
 } // namespace engine
@@ -2,10 +2,19 @@
 #define OSRM_SHORTEST_PATH_IMPL_HPP
 
 #include "engine/routing_algorithms/shortest_path.hpp"
+#include "engine/search_engine_data_pool.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/optional.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace osrm
 {
 namespace engine
@@ -214,7 +223,7 @@ inline void initializeHeap(SearchEngineData<Algorithm> &engine_working_data,
 {
 
     const auto nodes_number = facade.GetNumberOfNodes();
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(nodes_number);
+    engine_working_data.InitializeOrClearFirstHeaps(nodes_number);
 }
 
 template <>
@@ -224,7 +233,91 @@ inline void initializeHeap<mld::Algorithm>(SearchEngineData<mld::Algorithm> &eng
 
     const auto nodes_number = facade.GetNumberOfNodes();
     const auto border_nodes_number = facade.GetMaxBorderNodeID() + 1;
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(nodes_number, border_nodes_number);
+    engine_working_data.InitializeOrClearFirstHeaps(nodes_number, border_nodes_number);
+}
+
+// The path of a leg that allows a u-turn at its source, its weight does not include the weight
+// of the route up to the source
+struct UTurnLeg
+{
+    int weight = INVALID_EDGE_WEIGHT;
+    std::vector<NodeID> packed_path;
+};
+
+// With u-turns at the waypoints a leg is searched from its source alone, the route up to it
+// only decides from which nodes of the source phantom. These are the valid target nodes of the
+// previous leg if it found a path, otherwise the whole route is invalid anyway. So all legs can
+// be searched before they are connected, on up to max_threads threads with their own heaps. The
+// heaps of the workers come from the pool of the query, see WorkerSearchContexts.
+template <typename Algorithm>
+std::vector<UTurnLeg> searchUTurnLegs(SearchEngineData<Algorithm> &engine_working_data,
+                                      const DataFacade<Algorithm> &facade,
+                                      const std::vector<PhantomNodes> &phantom_nodes_vector,
+                                      const unsigned max_threads)
+{
+    std::vector<UTurnLeg> legs(phantom_nodes_vector.size());
+
+    const auto search_leg = [&](SearchEngineData<Algorithm> &heaps, const std::size_t leg) {
+        const auto &source_phantom = phantom_nodes_vector[leg].source_phantom;
+        const auto &target_phantom = phantom_nodes_vector[leg].target_phantom;
+        const auto search_to_forward_node = target_phantom.IsValidForwardTarget();
+        const auto search_to_reverse_node = target_phantom.IsValidReverseTarget();
+        if (!search_to_forward_node && !search_to_reverse_node)
+            return;
+
+        const auto &previous_target = phantom_nodes_vector[leg > 0 ? leg - 1 : 0].target_phantom;
+        const auto search_from_forward_node = leg > 0 ? previous_target.IsValidForwardTarget()
+                                                      : source_phantom.IsValidForwardSource();
+        const auto search_from_reverse_node = leg > 0 ? previous_target.IsValidReverseTarget()
+                                                      : source_phantom.IsValidReverseSource();
+
+        searchWithUTurn(heaps,
+                        facade,
+                        *heaps.forward_heap_1,
+                        *heaps.reverse_heap_1,
+                        search_from_forward_node,
+                        search_from_reverse_node,
+                        search_to_forward_node,
+                        search_to_reverse_node,
+                        source_phantom,
+                        target_phantom,
+                        0,
+                        0,
+                        legs[leg].weight,
+                        legs[leg].packed_path);
+    };
+
+    const auto search_legs = [&](SearchEngineData<Algorithm> &heaps,
+                                 const tbb::blocked_range<std::size_t> &range) {
+        for (auto leg = range.begin(); leg < range.end(); ++leg)
+            search_leg(heaps, leg);
+    };
+    const tbb::blocked_range<std::size_t> all_legs(0, legs.size());
+
+    // threads only pay off for more than one leg and if the pool of the query has heaps to spare
+    std::unique_ptr<WorkerSearchContexts<Algorithm>> worker_heaps;
+    if (max_threads > 1 && legs.size() > 1)
+        worker_heaps =
+            std::make_unique<WorkerSearchContexts<Algorithm>>(engine_working_data, max_threads);
+    if (!worker_heaps || worker_heaps->Size() <= 1)
+    {
+        search_legs(engine_working_data, all_legs);
+        return legs;
+    }
+
+    // the workers check the deadline of the query as well
+    const auto deadline = Deadline::Current();
+    tbb::task_arena arena(static_cast<int>(worker_heaps->Size()));
+    arena.execute([&] {
+        tbb::parallel_for(all_legs, [&](const tbb::blocked_range<std::size_t> &range) {
+            ScopedDeadline scoped_deadline(deadline);
+            worker_heaps->Run([&](SearchEngineData<Algorithm> &heaps) {
+                initializeHeap(heaps, facade);
+                search_legs(heaps, range);
+            });
+        });
+    });
+    return legs;
 }
 }
 
@@ -232,7 +325,8 @@ template <typename Algorithm>
 InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_working_data,
                                        const DataFacade<Algorithm> &facade,
                                        const std::vector<PhantomNodes> &phantom_nodes_vector,
-                                       const boost::optional<bool> continue_straight_at_waypoint)
+                                       const boost::optional<bool> continue_straight_at_waypoint,
+                                       const unsigned max_threads)
 {
     InternalRouteResult raw_route_data;
     raw_route_data.segment_end_coordinates = phantom_nodes_vector;
@@ -242,6 +336,13 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
 
     initializeHeap(engine_working_data, facade);
 
+    std::vector<UTurnLeg> uturn_legs;
+    if (allow_uturn_at_waypoint)
+    {
+        uturn_legs =
+            searchUTurnLegs(engine_working_data, facade, phantom_nodes_vector, max_threads);
+    }
+
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
 
@@ -284,20 +385,13 @@ InternalRouteResult shortestPathSearch(SearchEngineData<Algorithm> &engine_worki
         {
             if (allow_uturn_at_waypoint)
             {
-                searchWithUTurn(engine_working_data,
-                                facade,
-                                forward_heap,
-                                reverse_heap,
-                                search_from_forward_node,
-                                search_from_reverse_node,
-                                search_to_forward_node,
-                                search_to_reverse_node,
-                                source_phantom,
-                                target_phantom,
-                                total_weight_to_forward,
-                                total_weight_to_reverse,
-                                new_total_weight_to_forward,
-                                packed_leg_to_forward);
+                auto &leg = uturn_legs[current_leg];
+                // prevents the overflow of adding to an invalid weight, see searchWithUTurn
+                new_total_weight_to_forward = leg.weight;
+                if (new_total_weight_to_forward != INVALID_EDGE_WEIGHT)
+                    new_total_weight_to_forward +=
+                        std::min(total_weight_to_forward, total_weight_to_reverse);
+                packed_leg_to_forward = std::move(leg.packed_path);
                 // if only the reverse node is valid (e.g. when using the match plugin) we
                 // actually need to move
                 if (!target_phantom.IsValidForwardTarget())
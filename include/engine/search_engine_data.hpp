@@ -5,7 +5,7 @@
 #include "util/query_heap.hpp"
 #include "util/typedefs.hpp"
 
-#include <boost/thread/tss.hpp>
+#include <memory>
 
 namespace osrm
 {
@@ -16,6 +16,10 @@ namespace engine
 // - CH algorithms use CH heaps
 // - CoreCH algorithms use CH
 // - MLD algorithms use MLD heaps
+//
+// A SearchEngineData is the search context of one query at a time, see SearchEngineDataPool.
+// Heaps are only allocated once a routing algorithm asks for them and are re-created when the
+// size of the graph changes, e.g. after a dataset was swapped.
 
 template <typename Algorithm> struct SearchEngineData
 {
@@ -30,38 +34,47 @@ struct HeapData
 struct ManyToManyHeapData : HeapData
 {
     EdgeWeight duration;
-    ManyToManyHeapData(NodeID p, EdgeWeight duration) : HeapData(p), duration(duration) {}
+    EdgeDistance distance;
+    ManyToManyHeapData(NodeID p, EdgeWeight duration, EdgeDistance distance)
+        : HeapData(p), duration(duration), distance(distance)
+    {
+    }
 };
 
 template <> struct SearchEngineData<routing_algorithms::ch::Algorithm>
 {
-    using QueryHeap = util::
-        QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, util::UnorderedMapStorage<NodeID, int>>;
+    // Index of the nodes in the heaps, see src/benchmarks/query_heap.cpp for a comparison of the
+    // storages in util/query_heap.hpp
+    using HeapIndexStorage = util::HybridStorage<NodeID, int>;
 
-    using ManyToManyQueryHeap = util::QueryHeap<NodeID,
-                                                NodeID,
-                                                EdgeWeight,
-                                                ManyToManyHeapData,
-                                                util::UnorderedMapStorage<NodeID, int>>;
+    using QueryHeap = util::QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, HeapIndexStorage>;
 
-    using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
-    using ManyToManyHeapPtr = boost::thread_specific_ptr<ManyToManyQueryHeap>;
+    using ManyToManyQueryHeap =
+        util::QueryHeap<NodeID, NodeID, EdgeWeight, ManyToManyHeapData, HeapIndexStorage>;
 
-    static SearchEngineHeapPtr forward_heap_1;
-    static SearchEngineHeapPtr reverse_heap_1;
-    static SearchEngineHeapPtr forward_heap_2;
-    static SearchEngineHeapPtr reverse_heap_2;
-    static SearchEngineHeapPtr forward_heap_3;
-    static SearchEngineHeapPtr reverse_heap_3;
-    static ManyToManyHeapPtr many_to_many_heap;
+    using SearchEngineHeapPtr = std::unique_ptr<QueryHeap>;
+    using ManyToManyHeapPtr = std::unique_ptr<ManyToManyQueryHeap>;
 
-    void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes);
+    SearchEngineHeapPtr forward_heap_1;
+    SearchEngineHeapPtr reverse_heap_1;
+    SearchEngineHeapPtr forward_heap_2;
+    SearchEngineHeapPtr reverse_heap_2;
+    SearchEngineHeapPtr forward_heap_3;
+    SearchEngineHeapPtr reverse_heap_3;
+    ManyToManyHeapPtr many_to_many_heap;
 
-    void InitializeOrClearSecondThreadLocalStorage(unsigned number_of_nodes);
+    void InitializeOrClearFirstHeaps(unsigned number_of_nodes);
 
-    void InitializeOrClearThirdThreadLocalStorage(unsigned number_of_nodes);
+    void InitializeOrClearSecondHeaps(unsigned number_of_nodes);
 
-    void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes);
+    void InitializeOrClearThirdHeaps(unsigned number_of_nodes);
+
+    void InitializeOrClearManyToManyHeap(unsigned number_of_nodes);
+
+  private:
+    void ResetOnSizeChange(unsigned number_of_nodes);
+
+    unsigned heaps_number_of_nodes = 0;
 };
 
 struct MultiLayerDijkstraHeapData
@@ -99,18 +112,23 @@ template <> struct SearchEngineData<routing_algorithms::mld::Algorithm>
                                                 ManyToManyMultiLayerDijkstraHeapData,
                                                 util::TwoLevelStorage<NodeID, int>>;
 
-    using SearchEngineHeapPtr = boost::thread_specific_ptr<QueryHeap>;
-    using ManyToManyHeapPtr = boost::thread_specific_ptr<ManyToManyQueryHeap>;
+    using SearchEngineHeapPtr = std::unique_ptr<QueryHeap>;
+    using ManyToManyHeapPtr = std::unique_ptr<ManyToManyQueryHeap>;
+
+    SearchEngineHeapPtr forward_heap_1;
+    SearchEngineHeapPtr reverse_heap_1;
+    ManyToManyHeapPtr many_to_many_heap;
+
+    void InitializeOrClearFirstHeaps(unsigned number_of_nodes, unsigned number_of_boundary_nodes);
 
-    static SearchEngineHeapPtr forward_heap_1;
-    static SearchEngineHeapPtr reverse_heap_1;
-    static ManyToManyHeapPtr many_to_many_heap;
+    void InitializeOrClearManyToManyHeap(unsigned number_of_nodes,
+                                         unsigned number_of_boundary_nodes);
 
-    void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes,
-                                                  unsigned number_of_boundary_nodes);
+  private:
+    void ResetOnSizeChange(unsigned number_of_nodes, unsigned number_of_boundary_nodes);
 
-    void InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes,
-                                                       unsigned number_of_boundary_nodes);
+    unsigned heaps_number_of_nodes = 0;
+    unsigned heaps_number_of_boundary_nodes = 0;
 };
 }
 }
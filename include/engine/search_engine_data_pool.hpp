@@ -0,0 +1,275 @@
+#ifndef SEARCH_ENGINE_DATA_POOL_HPP
+#define SEARCH_ENGINE_DATA_POOL_HPP
+
+#include "engine/search_engine_data.hpp"
+
+#include <boost/assert.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/tss.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace engine
+{
+
+/**
+ * Pool of search contexts that are checked out for the duration of a query.
+ *
+ * Contexts are created on demand, so the number of contexts (and with it the memory held by
+ * their heaps) follows the number of concurrently running queries instead of the number of
+ * threads that ever ran one. With a limit set, Acquire() blocks until a context is returned.
+ * The most recently returned context is handed out first, its heaps are most likely still
+ * cached.
+ */
+template <typename Algorithm> class SearchEngineDataPool
+{
+  public:
+    using Data = SearchEngineData<Algorithm>;
+
+    struct Statistics
+    {
+        // contexts created so far, this is the peak number of concurrent queries and their workers
+        std::size_t contexts = 0;
+        std::size_t acquisitions = 0;
+        // acquisitions that had to wait because the limit was reached
+        std::size_t contended_acquisitions = 0;
+        std::chrono::microseconds wait_time{0};
+    };
+
+    // Returns the context to the pool when it goes out of scope
+    class Handle
+    {
+      public:
+        Handle(SearchEngineDataPool &pool, std::unique_ptr<Data> data)
+            : pool(&pool), data(std::move(data))
+        {
+        }
+
+        Handle(Handle &&) = default;
+        Handle &operator=(Handle &&) = delete;
+        Handle(const Handle &) = delete;
+        Handle &operator=(const Handle &) = delete;
+
+        ~Handle()
+        {
+            if (data)
+            {
+                pool->Release(std::move(data));
+            }
+        }
+
+        Data &operator*() const { return *data; }
+        Data *operator->() const { return data.get(); }
+
+      private:
+        SearchEngineDataPool *pool;
+        std::unique_ptr<Data> data;
+    };
+
+    // A limit of 0 means one context per concurrent query
+    explicit SearchEngineDataPool(const std::size_t max_contexts = 0) : max_contexts(max_contexts)
+    {
+    }
+
+    SearchEngineDataPool(const SearchEngineDataPool &) = delete;
+    SearchEngineDataPool &operator=(const SearchEngineDataPool &) = delete;
+
+    ~SearchEngineDataPool() { BOOST_ASSERT(idle.size() == statistics.contexts); }
+
+    Handle Acquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        ++statistics.acquisitions;
+
+        if (idle.empty() && IsFull())
+        {
+            ++statistics.contended_acquisitions;
+            const auto wait_start = std::chrono::steady_clock::now();
+            released.wait(lock, [this] { return !idle.empty(); });
+            statistics.wait_time += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - wait_start);
+        }
+
+        return Take(lock);
+    }
+
+    // Like Acquire() but returns nothing instead of waiting if the limit is reached
+    boost::optional<Handle> TryAcquire()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (idle.empty() && IsFull())
+        {
+            return boost::none;
+        }
+
+        ++statistics.acquisitions;
+        return Take(lock);
+    }
+
+    Statistics GetStatistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return statistics;
+    }
+
+    // Pool of the query processed by the calling thread, the parallel searches of the query take
+    // the contexts of their workers from it. Use ScopedSearchEngineDataPool to set it.
+    static SearchEngineDataPool *Current() { return CurrentPointer().get(); }
+
+  private:
+    template <typename> friend class ScopedSearchEngineDataPool;
+
+    static boost::thread_specific_ptr<SearchEngineDataPool> &CurrentPointer()
+    {
+        // the threads do not own the pool
+        static boost::thread_specific_ptr<SearchEngineDataPool> current(
+            [](SearchEngineDataPool *) {});
+        return current;
+    }
+
+    bool IsFull() const { return max_contexts != 0 && statistics.contexts >= max_contexts; }
+
+    // Hands out an idle context or a new one if there is none, the mutex is held by lock
+    Handle Take(std::unique_lock<std::mutex> &lock)
+    {
+        if (idle.empty())
+        {
+            ++statistics.contexts;
+            lock.unlock();
+            return Handle(*this, std::make_unique<Data>());
+        }
+
+        auto data = std::move(idle.back());
+        idle.pop_back();
+        return Handle(*this, std::move(data));
+    }
+
+    void Release(std::unique_ptr<Data> data)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(std::move(data));
+        }
+        released.notify_one();
+    }
+
+    const std::size_t max_contexts;
+
+    mutable std::mutex mutex;
+    std::condition_variable released;
+    std::vector<std::unique_ptr<Data>> idle;
+    Statistics statistics;
+};
+
+// Sets the pool of the calling thread for the lifetime of this object
+template <typename Algorithm> class ScopedSearchEngineDataPool
+{
+  public:
+    using Pool = SearchEngineDataPool<Algorithm>;
+
+    explicit ScopedSearchEngineDataPool(Pool &pool) : previous(Pool::Current())
+    {
+        Pool::CurrentPointer().reset(&pool);
+    }
+
+    ~ScopedSearchEngineDataPool() { Pool::CurrentPointer().reset(previous); }
+
+    ScopedSearchEngineDataPool(const ScopedSearchEngineDataPool &) = delete;
+    ScopedSearchEngineDataPool &operator=(const ScopedSearchEngineDataPool &) = delete;
+
+  private:
+    Pool *const previous;
+};
+
+/**
+ * Search contexts of the threads of one parallel search.
+ *
+ * The context of the query is shared with the workers, additional contexts are only taken from
+ * the pool of the query while it has them to spare. So a parallel search never waits for the
+ * pool or holds more contexts than its limit allows, it runs on fewer threads instead. Without
+ * a pool, e.g. when the routing algorithms are called directly, the workers get their own.
+ */
+template <typename Algorithm> class WorkerSearchContexts
+{
+  public:
+    using Data = SearchEngineData<Algorithm>;
+    using Pool = SearchEngineDataPool<Algorithm>;
+
+    WorkerSearchContexts(Data &query_context, const unsigned max_threads)
+        : pool(Pool::Current()), idle{&query_context}
+    {
+        if (!pool)
+        {
+            own_pool = std::make_unique<Pool>();
+            pool = own_pool.get();
+        }
+        while (idle.size() < max_threads)
+        {
+            auto handle = pool->TryAcquire();
+            if (!handle)
+            {
+                break;
+            }
+            idle.push_back(&**handle);
+            handles.push_back(std::move(*handle));
+        }
+        number_of_contexts = idle.size();
+    }
+
+    // Number of threads that can search at the same time
+    std::size_t Size() const { return number_of_contexts; }
+
+    // Runs the search with a context that no other thread uses at the same time
+    template <typename SearchT> void Run(const SearchT &search)
+    {
+        Data *context = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [this] { return !idle.empty(); });
+            context = idle.back();
+            idle.pop_back();
+        }
+        try
+        {
+            search(*context);
+        }
+        catch (...)
+        {
+            Release(context);
+            throw;
+        }
+        Release(context);
+    }
+
+  private:
+    void Release(Data *context)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.push_back(context);
+        }
+        released.notify_one();
+    }
+
+    // declared before the handles, they return their contexts to it
+    std::unique_ptr<Pool> own_pool;
+    Pool *pool;
+    std::vector<typename Pool::Handle> handles;
+    std::size_t number_of_contexts;
+
+    std::mutex mutex;
+    std::condition_variable released;
+    std::vector<Data *> idle;
+};
+}
+}
+
+#endif // SEARCH_ENGINE_DATA_POOL_HPP
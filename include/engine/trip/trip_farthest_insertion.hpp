@@ -1,6 +1,7 @@
 #ifndef TRIP_FARTHEST_INSERTION_HPP
 #define TRIP_FARTHEST_INSERTION_HPP
 
+#include "engine/deadline.hpp"
 #include "util/dist_table_wrapper.hpp"
 #include "util/typedefs.hpp"
 
@@ -95,9 +96,11 @@ inline std::vector<NodeID> FindRoute(const std::size_t &number_of_locations,
     route.push_back(start1);
     route.push_back(start2);
 
+    const auto &deadline = Deadline::Current();
     // two nodes are already in the initial start trip, so we need to add all other nodes
     for (std::size_t added_nodes = 2; added_nodes < number_of_locations; ++added_nodes)
     {
+        deadline.CheckNow();
         auto farthest_distance = std::numeric_limits<int>::min();
         auto next_node = -1;
         NodeIDIter next_insert_point;
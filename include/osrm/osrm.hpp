@@ -31,8 +31,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "osrm/osrm_fwd.hpp"
 #include "osrm/status.hpp"
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -58,6 +61,8 @@ using engine::api::TripParameters;
  *  - Tile: vector tiles with internal graph representation
  *
  *  All services take service-specific parameters, fill a JSON object, and return a status code.
+ *  Table and Nearest can also render their JSON response directly into a character buffer.
+ *  Route, Table and Nearest can also encode their response as protobuf into a string.
  */
 class OSRM final
 {
@@ -85,6 +90,15 @@ class OSRM final
      */
     Status Route(const RouteParameters &parameters, json::Object &result) const;
 
+    /**
+     * Shortest path queries for coordinates, encoded as protobuf.
+     *
+     * \param parameters route query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, RouteParameters and docs/pbf_response.proto
+     */
+    Status Route(const RouteParameters &parameters, std::string &result) const;
+
     /**
      * Distance tables for coordinates.
      *
@@ -94,6 +108,42 @@ class OSRM final
      */
     Status Table(const TableParameters &parameters, json::Object &result) const;
 
+    /**
+     * Distance tables for coordinates, rendered directly as JSON text.
+     *
+     * Skips building the json::Object, which is considerably faster for large tables.
+     *
+     * \param parameters table query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, TableParameters and json::Buffer
+     */
+    Status Table(const TableParameters &parameters, std::vector<char> &result) const;
+
+    /**
+     * Distance tables for coordinates, rendered as JSON text while they are computed.
+     *
+     * The table is computed in blocks of rows. After each block consume is called with the
+     * text rendered so far and has to take it out of the buffer. The end of the response is
+     * left in result. If the query fails after consume was called, the parts already consumed
+     * are not a valid response.
+     *
+     * \param parameters table query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, TableParameters and json::Buffer
+     */
+    Status Table(const TableParameters &parameters,
+                 std::vector<char> &result,
+                 const std::function<void(std::vector<char> &)> &consume) const;
+
+    /**
+     * Distance tables for coordinates, encoded as protobuf.
+     *
+     * \param parameters table query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, TableParameters and docs/pbf_response.proto
+     */
+    Status Table(const TableParameters &parameters, std::string &result) const;
+
     /**
      * Nearest street segment for coordinate.
      *
@@ -103,6 +153,24 @@ class OSRM final
      */
     Status Nearest(const NearestParameters &parameters, json::Object &result) const;
 
+    /**
+     * Nearest street segment for coordinate, rendered directly as JSON text.
+     *
+     * \param parameters nearest query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, NearestParameters and json::Buffer
+     */
+    Status Nearest(const NearestParameters &parameters, std::vector<char> &result) const;
+
+    /**
+     * Nearest street segment for coordinate, encoded as protobuf.
+     *
+     * \param parameters nearest query specific parameters
+     * \return Status indicating success for the query or failure
+     * \see Status, NearestParameters and docs/pbf_response.proto
+     */
+    Status Nearest(const NearestParameters &parameters, std::string &result) const;
+
     /**
      * Trip: shortest round trip between coordinates.
      *
@@ -121,6 +189,22 @@ class OSRM final
      */
     Status Match(const MatchParameters &parameters, json::Object &result) const;
 
+    /**
+     * Match: snaps many noisy coordinate traces to the road network
+     *
+     * Matches the traces in parallel on up to max_threads threads, each thread reuses its
+     * search heaps for all traces it matches. handler is called with the index, status and
+     * result of each trace from the thread that matched it, so it can be called concurrently
+     * for different traces. Invalid parameters of a trace are reported as InvalidOptions.
+     *
+     * \param parameters match query specific parameters of each trace
+     * \return Status indicating that all traces were handled
+     * \see Status, MatchParameters and json::Object
+     */
+    Status Match(const std::vector<MatchParameters> &parameters,
+                 const std::function<void(std::size_t, Status, json::Object &)> &handler,
+                 const unsigned max_threads) const;
+
     /**
      * Tile: vector tiles with internal graph representation
      *
@@ -130,6 +214,15 @@ class OSRM final
      */
     Status Tile(const TileParameters &parameters, std::string &result) const;
 
+    /**
+     * Identifies the dataset queries currently run on.
+     *
+     * Changes when osrm-datastore loaded new data into the shared memory region this instance
+     * watches, always 0 for data loaded by the instance itself. Responses can be cached until
+     * it changes.
+     */
+    std::uint64_t GetDataTimestamp() const;
+
   private:
     std::unique_ptr<engine::EngineInterface> engine_;
 };
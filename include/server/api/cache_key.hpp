@@ -0,0 +1,26 @@
+#ifndef SERVER_API_CACHE_KEY_HPP
+#define SERVER_API_CACHE_KEY_HPP
+
+#include "engine/api/nearest_parameters.hpp"
+#include "engine/api/route_parameters.hpp"
+
+#include <string>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+// Binary encoding of all parameters that affect a successful response. Queries that only differ
+// in their spelling, e.g. "steps=1" and "steps=true" or a different profile name, get the same
+// key. The timeout is left out since exceeding it only produces an error.
+std::string makeCacheKey(const engine::api::RouteParameters &parameters);
+std::string makeCacheKey(const engine::api::NearestParameters &parameters);
+
+} // ns api
+} // ns server
+} // ns osrm
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef SERVER_API_TABLE_BODY_PARSER_HPP
+#define SERVER_API_TABLE_BODY_PARSER_HPP
+
+#include "engine/api/table_parameters.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+// Flags of the packed table request, the annotations use the bits of
+// engine::api::TableParameters::AnnotationsType
+namespace table_body
+{
+const constexpr std::uint32_t DURATIONS = 0x01;
+const constexpr std::uint32_t DISTANCES = 0x02;
+const constexpr std::uint32_t SKIP_HINTS = 0x04;
+const constexpr std::uint32_t ALL_FLAGS = DURATIONS | DISTANCES | SKIP_HINTS;
+}
+
+// Parses the packed little endian body of a POST table request, see docs/http.md:
+//
+//   uint32 number of coordinates, uint32 number of sources, uint32 number of destinations,
+//   uint32 flags, int32 longitude and latitude of each coordinate in 1e-6 degrees,
+//   uint32 indices of the sources, uint32 indices of the destinations
+//
+// Starts parsing at iter and modifies it until iter == end or parsing failed
+boost::optional<engine::api::TableParameters>
+parseTableBody(std::vector<char>::const_iterator &iter,
+               const std::vector<char>::const_iterator end);
+
+inline boost::optional<engine::api::TableParameters> parseTableBody(const std::vector<char> &body)
+{
+    auto iter = body.begin();
+    return parseTableBody(iter, body.end());
+}
+
+} // ns api
+} // ns server
+} // ns osrm
+
+#endif
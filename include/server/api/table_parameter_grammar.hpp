@@ -48,9 +48,20 @@ struct TableParametersGrammar : public BaseParametersGrammar<Iterator, Signature
             (qi::lit("all") |
              (size_t_ % ';')[ph::bind(&engine::api::TableParameters::sources, qi::_r1) = qi::_1]);
 
-        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1);
+        target_set_rule =
+            qi::lit("target_set=") >
+            qi::as_string[+qi::char_("a-zA-Z0-9_-")]
+                         [ph::bind(&engine::api::TableParameters::target_set, qi::_r1) = qi::_1];
 
-        root_rule = BaseGrammar::query_rule(qi::_r1) > -qi::lit(".json") >
+        register_target_set_rule =
+            qi::lit("register_target_set=") >
+            qi::bool_[ph::bind(&engine::api::TableParameters::register_target_set, qi::_r1) =
+                          qi::_1];
+
+        table_rule = destinations_rule(qi::_r1) | sources_rule(qi::_r1) |
+                     target_set_rule(qi::_r1) | register_target_set_rule(qi::_r1);
+
+        root_rule = BaseGrammar::query_rule(qi::_r1) > -BaseGrammar::format_rule(qi::_r1) >
                     -('?' > (table_rule(qi::_r1) | base_rule(qi::_r1)) % '&');
     }
 
@@ -77,6 +88,8 @@ struct TableParametersGrammar : public BaseParametersGrammar<Iterator, Signature
     qi::rule<Iterator, Signature> table_rule;
     qi::rule<Iterator, Signature> sources_rule;
     qi::rule<Iterator, Signature> destinations_rule;
+    qi::rule<Iterator, Signature> target_set_rule;
+    qi::rule<Iterator, Signature> register_target_set_rule;
     qi::rule<Iterator, std::size_t()> size_t_;
     qi::symbols<char, engine::api::TableParameters::AnnotationsType> annotations;
     qi::rule<Iterator, engine::api::TableParameters::AnnotationsType()> annotations_list;
@@ -22,6 +22,17 @@ inline boost::optional<ParsedURL> parseURL(std::string url_string)
     auto iter = url_string.begin();
     return parseURL(iter, url_string.end());
 }
+
+// Same as parseURL for URLs without a query, like /table/v1/driving for POST requests.
+// The query of the result is empty.
+boost::optional<ParsedURL> parseServiceURL(std::string::iterator &iter,
+                                           const std::string::iterator end);
+
+inline boost::optional<ParsedURL> parseServiceURL(std::string url_string)
+{
+    auto iter = url_string.begin();
+    return parseServiceURL(iter, url_string.end());
+}
 }
 }
 }
@@ -9,9 +9,15 @@
 #include <boost/array.hpp>
 #include <boost/asio.hpp>
 #include <boost/config.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/version.hpp>
 
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 // workaround for incomplete std::shared_ptr compatibility in old boost versions
@@ -32,12 +38,19 @@ namespace server
 {
 
 class RequestHandler;
+class RequestQueue;
 
 /// Represents a single connection from a client.
+/// Connections are kept open for several requests (HTTP keep-alive) until either the client
+/// asks to close, the idle timeout elapses or the maximum number of requests was served.
 class Connection : public std::enable_shared_from_this<Connection>
 {
   public:
-    explicit Connection(boost::asio::io_service &io_service, RequestHandler &handler);
+    explicit Connection(boost::asio::io_service &io_service,
+                        RequestHandler &handler,
+                        RequestQueue *request_queue,
+                        const unsigned keepalive_timeout,
+                        const unsigned keepalive_max_requests);
     Connection(const Connection &) = delete;
     Connection &operator=(const Connection &) = delete;
 
@@ -49,20 +62,88 @@ class Connection : public std::enable_shared_from_this<Connection>
   private:
     void handle_read(const boost::system::error_code &e, std::size_t bytes_transferred);
 
+    /// Parse the given range and answer the request if it is complete
+    void process_data(char *begin, char *end);
+
+    /// Wait for more data of the current or the next request
+    void start_read();
+
+    /// Answer the current request, on the I/O thread or a worker of the request queue
+    void handle_request();
+
+    /// Send content of the current reply while the query is still running, as chunks of the
+    /// chunked transfer encoding. The chunks are written by the I/O threads, the query waits
+    /// while too much content is pending and is aborted if the client stops reading.
+    void write_content(http::reply &reply, std::vector<char> &content);
+
+    /// Queue output of a streamed reply, on the thread running the query
+    void queue_content(std::vector<char> output);
+
+    /// Write as much pending content as the socket takes without blocking, for queries that
+    /// run on the I/O thread. Expects content_mutex to be locked.
+    void write_pending_content_now();
+
+    /// Write the pending content of a streamed reply one chunk after the other
+    void write_pending_content();
+    void handle_content_write(const boost::system::error_code &e);
+
+    /// Compress and send the reply to the current request
+    void write_reply();
+
+    /// Count the request and set the headers of the resulting keep-alive state
+    void set_connection_headers(http::reply &reply);
+
+    /// Append data as a chunk to output, an empty chunk would end the content
+    static void append_chunk(const std::vector<char> &data, std::vector<char> &output);
+
     /// Handle completion of a write operation.
     void handle_write(const boost::system::error_code &e);
 
+    /// Handle expiry of the idle timer
+    void handle_timeout(const boost::system::error_code &e);
+
+    void close();
+
+    static boost::iostreams::gzip_params
+    get_compression_parameters(const http::compression_type compression_type);
+
     std::vector<char> compress_buffers(const std::vector<char> &uncompressed_data,
                                        const http::compression_type compression_type);
 
     boost::asio::io_service::strand strand;
     boost::asio::ip::tcp::socket TCP_socket;
+    boost::asio::deadline_timer timer;
     RequestHandler &request_handler;
+    // queries are run inline on the I/O thread if there is no queue
+    RequestQueue *request_queue;
     RequestParser request_parser;
     boost::array<char, 8192> incoming_data_buffer;
+    // range of incoming_data_buffer that follows the current request (pipelining)
+    char *pending_begin;
+    char *pending_end;
+    const unsigned keepalive_timeout;
+    unsigned remaining_requests;
+    bool keep_alive;
     http::request current_request;
     http::reply current_reply;
+    http::compression_type current_compression;
     std::vector<char> compressed_output;
+    // the headers of the current reply were sent with its first chunk
+    bool streaming;
+    // compresses all chunks of a streamed reply into compressed_output
+    std::unique_ptr<boost::iostreams::filtering_ostream> chunk_compressor;
+    // output of the streamed reply that is not sent yet, added by the query and written by
+    // the I/O threads
+    std::mutex content_mutex;
+    std::condition_variable content_written;
+    std::deque<std::vector<char>> pending_content;
+    std::size_t pending_content_size;
+    std::size_t written_content_size;
+    bool writing_content;
+    // the last chunk is pending, the reply is done once it is written
+    bool content_complete;
+    // the client is gone, the query is aborted with its next content
+    bool content_failed;
     // Header compression_header;
     std::vector<boost::asio::const_buffer> output_buffer;
 };
@@ -1,9 +1,11 @@
 #ifndef REQUEST_HPP
 #define REQUEST_HPP
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/asio.hpp>
 
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -14,10 +16,29 @@ namespace http
 
 struct request
 {
+    std::string method;
     std::string uri;
     std::string referrer;
     std::string agent;
+    std::string connection;
+    unsigned http_version_major = 1;
+    unsigned http_version_minor = 0;
     boost::asio::ip::address endpoint;
+    // content of requests with a Content-Length header, e.g. POST requests
+    std::vector<char> body;
+
+    // HTTP/1.1 connections are persistent by default, HTTP/1.0 ones only on request
+    bool keep_alive() const
+    {
+        if (http_version_major == 1 && http_version_minor == 0)
+        {
+            return boost::iequals(connection, "keep-alive");
+        }
+        return !boost::iequals(connection, "close");
+    }
+
+    // chunked transfer encoding was introduced with HTTP/1.1
+    bool accepts_chunked() const { return !(http_version_major == 1 && http_version_minor == 0); }
 };
 }
 }
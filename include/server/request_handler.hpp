@@ -3,7 +3,9 @@
 
 #include "server/service_handler.hpp"
 
+#include <functional>
 #include <string>
+#include <vector>
 
 namespace osrm
 {
@@ -26,7 +28,14 @@ class RequestHandler
 
     void RegisterServiceHandler(std::unique_ptr<ServiceHandlerInterface> service_handler);
 
-    void HandleRequest(const http::request &current_request, http::reply &current_reply);
+    // Sends content of the reply before the request is answered completely. The headers of the
+    // reply are sent with the first content, the rest of the content follows the last call.
+    using ContentWriter = std::function<void(http::reply &reply, std::vector<char> &content)>;
+
+    // Large responses are streamed to write_content if it is set
+    void HandleRequest(const http::request &current_request,
+                       http::reply &current_reply,
+                       const ContentWriter &write_content = ContentWriter{});
 
   private:
     std::unique_ptr<ServiceHandlerInterface> service_handler;
@@ -4,6 +4,7 @@
 #include "server/http/compression_type.hpp"
 #include "server/http/header.hpp"
 
+#include <cstddef>
 #include <tuple>
 
 namespace osrm
@@ -25,12 +26,22 @@ class RequestParser
     {
         valid,
         invalid,
-        indeterminate
+        indeterminate,
+        too_large
     };
 
-    std::tuple<RequestStatus, http::compression_type>
+    // Consumes input until a complete request was parsed or the input is exhausted.
+    // The returned pointer marks the first byte not belonging to the parsed request,
+    // which allows pipelined requests to be handled from the same buffer.
+    std::tuple<RequestStatus, http::compression_type, char *>
     parse(http::request &current_request, char *begin, char *end);
 
+    // Resets the parser to accept the next request on a persistent connection
+    void reset();
+
+    // Requests with a larger Content-Length are too large, only POST /table requests have a body
+    static constexpr std::size_t MAX_BODY_SIZE = 64 * 1024 * 1024;
+
   private:
     RequestStatus consume(http::request &current_request, const char input);
 
@@ -64,11 +75,16 @@ class RequestParser
         space_before_header_value,
         header_value,
         expecting_newline_2,
-        expecting_newline_3
+        expecting_newline_3,
+        body
     } state;
 
+    // Adds the value of the header to the request or the parser state, false if it is invalid
+    bool apply_header(http::request &current_request);
+
     http::header current_header;
     http::compression_type selected_compression;
+    std::size_t content_length;
 };
 }
 }
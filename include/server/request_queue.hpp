@@ -0,0 +1,89 @@
+#ifndef SERVER_REQUEST_QUEUE_HPP
+#define SERVER_REQUEST_QUEUE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+/// Bounded admission queue in front of a fixed pool of compute workers.
+///
+/// The I/O threads only parse requests and write replies, the actual queries are run on
+/// the workers. If either the total number of waiting requests or the number of pending
+/// requests of a single service exceeds its limit the request is rejected right away, so
+/// latency stays bounded under overload and expensive services can not starve cheap ones.
+class RequestQueue
+{
+  public:
+    using Job = std::function<void()>;
+
+    /// Why a job did not answer its request: the queue was stopped before the job ran or the
+    /// job threw an exception
+    enum class Failure
+    {
+        Stopped,
+        Error
+    };
+    using FailureHandler = std::function<void(Failure)>;
+
+    // A limit of 0 means unlimited
+    RequestQueue(const unsigned num_workers,
+                 const std::size_t max_queue_size,
+                 std::unordered_map<std::string, std::size_t> service_limits);
+    ~RequestQueue();
+
+    RequestQueue(const RequestQueue &) = delete;
+    RequestQueue &operator=(const RequestQueue &) = delete;
+
+    /// Enqueues the job, returns false if it was rejected because a queue limit was reached.
+    /// on_failure is called if the job is discarded or throws, so the request can be answered.
+    bool Push(const std::string &service, Job job, FailureHandler on_failure = FailureHandler{});
+
+    /// Stops all workers after their current job, waiting jobs are discarded and their
+    /// failure handlers called on the calling thread.
+    void Stop();
+
+    std::size_t GetRejectedCount() const;
+
+    /// Extracts the service name from a request URI like /route/v1/driving/...
+    static std::string GetServiceName(const std::string &uri);
+
+  private:
+    struct QueuedJob
+    {
+        std::string service;
+        Job job;
+        FailureHandler on_failure;
+    };
+
+    static void HandleFailure(const QueuedJob &job, const Failure failure);
+
+    void Work();
+
+    const std::size_t max_queue_size;
+    const std::unordered_map<std::string, std::size_t> service_limits;
+
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<QueuedJob> jobs;
+    // number of waiting and running requests per service
+    std::unordered_map<std::string, std::size_t> pending_per_service;
+    std::size_t rejected_count;
+    bool stopped;
+
+    std::vector<std::thread> workers;
+};
+}
+}
+
+#endif
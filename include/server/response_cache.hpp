@@ -0,0 +1,125 @@
+#ifndef SERVER_RESPONSE_CACHE_HPP
+#define SERVER_RESPONSE_CACHE_HPP
+
+#include "server/api/cache_key.hpp"
+#include "server/service/base_service.hpp"
+
+#include "engine/status.hpp"
+#include "osrm/osrm.hpp"
+#include "util/json_renderer.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+
+/// Sharded LRU cache of rendered responses, keyed on the parsed query parameters.
+///
+/// Every shard has its own lock and an equal part of the size limit. A shard only holds
+/// responses of a single dataset: looking up a key with a different data timestamp drops all
+/// entries of the shard, so responses of a replaced shared memory dataset are never served.
+class ResponseCache
+{
+  public:
+    using Response = service::BaseService::ResultT;
+
+    struct Statistics
+    {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evictions = 0;
+        // entries dropped because the dataset changed
+        std::size_t invalidations = 0;
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    ResponseCache(const std::size_t max_bytes, const std::size_t number_of_shards = 16);
+
+    ResponseCache(const ResponseCache &) = delete;
+    ResponseCache &operator=(const ResponseCache &) = delete;
+
+    /// Returns the cached response for the key or nullptr.
+    std::shared_ptr<const Response> Lookup(const std::string &key,
+                                           const std::uint64_t data_timestamp);
+
+    /// Caches a rendered JSON buffer or protobuf response. It is dropped if it is larger than a
+    /// shard or the dataset changed since the response was looked up.
+    void Insert(const std::string &key, const std::uint64_t data_timestamp, Response response);
+
+    Statistics GetStatistics() const;
+
+  private:
+    struct Entry
+    {
+        std::string key;
+        std::shared_ptr<const Response> response;
+        std::size_t bytes;
+    };
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::uint64_t data_timestamp = 0;
+        // most recently used first
+        std::list<Entry> entries;
+        std::unordered_map<std::string, std::list<Entry>::iterator> index;
+        std::size_t bytes = 0;
+        Statistics statistics;
+    };
+
+    Shard &GetShard(const std::string &key);
+
+    const std::size_t max_shard_bytes;
+    std::vector<Shard> shards;
+};
+
+/// Answers the query from the cache if there is one, successful responses are cached.
+/// JSON objects are rendered before they are cached, a hit saves the rendering as well.
+template <typename ParametersT, typename QueryT>
+engine::Status runCachedQuery(ResponseCache *cache,
+                              const OSRM &routing_machine,
+                              const ParametersT &parameters,
+                              ResponseCache::Response &result,
+                              QueryT &&run_query)
+{
+    if (!cache)
+    {
+        return run_query();
+    }
+
+    const auto key = api::makeCacheKey(parameters);
+    const auto data_timestamp = routing_machine.GetDataTimestamp();
+    if (const auto cached = cache->Lookup(key, data_timestamp))
+    {
+        result = *cached;
+        return engine::Status::Ok;
+    }
+
+    const auto status = run_query();
+    if (status == engine::Status::Ok)
+    {
+        if (result.is<util::json::Object>())
+        {
+            util::json::Buffer buffer;
+            util::json::render(buffer, result.get<util::json::Object>());
+            result = std::move(buffer);
+        }
+        cache->Insert(key, data_timestamp, result);
+    }
+    return status;
+}
+}
+}
+
+#endif // SERVER_RESPONSE_CACHE_HPP
@@ -3,6 +3,7 @@
 
 #include "server/connection.hpp"
 #include "server/request_handler.hpp"
+#include "server/request_queue.hpp"
 #include "server/service_handler.hpp"
 
 #include "util/integer_range.hpp"
@@ -22,6 +23,7 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
 namespace osrm
@@ -33,18 +35,49 @@ class Server
 {
   public:
     // Note: returns a shared instead of a unique ptr as it is captured in a lambda somewhere else
-    static std::shared_ptr<Server>
-    CreateServer(std::string &ip_address, int ip_port, unsigned requested_num_threads)
+    static std::shared_ptr<Server> CreateServer(std::string &ip_address,
+                                                int ip_port,
+                                                unsigned requested_num_threads,
+                                                unsigned keepalive_timeout,
+                                                unsigned keepalive_max_requests,
+                                                unsigned num_workers = 0,
+                                                std::size_t max_queue_size = 0,
+                                                std::unordered_map<std::string, std::size_t>
+                                                    service_queue_limits = {})
     {
         util::Log() << "http 1.1 compression handled by zlib version " << zlibVersion();
         const unsigned hardware_threads = std::max(1u, std::thread::hardware_concurrency());
         const unsigned real_num_threads = std::min(hardware_threads, requested_num_threads);
-        return std::make_shared<Server>(ip_address, ip_port, real_num_threads);
+        return std::make_shared<Server>(ip_address,
+                                        ip_port,
+                                        real_num_threads,
+                                        keepalive_timeout,
+                                        keepalive_max_requests,
+                                        num_workers,
+                                        max_queue_size,
+                                        std::move(service_queue_limits));
     }
 
-    explicit Server(const std::string &address, const int port, const unsigned thread_pool_size)
-        : thread_pool_size(thread_pool_size), acceptor(io_service),
-          new_connection(std::make_shared<Connection>(io_service, request_handler))
+    // If num_workers is zero the queries are run directly on the I/O threads
+    explicit Server(const std::string &address,
+                    const int port,
+                    const unsigned thread_pool_size,
+                    const unsigned keepalive_timeout,
+                    const unsigned keepalive_max_requests,
+                    const unsigned num_workers,
+                    const std::size_t max_queue_size,
+                    std::unordered_map<std::string, std::size_t> service_queue_limits)
+        : thread_pool_size(thread_pool_size), keepalive_timeout(keepalive_timeout),
+          keepalive_max_requests(keepalive_max_requests), acceptor(io_service),
+          request_queue(num_workers > 0
+                            ? std::make_unique<RequestQueue>(
+                                  num_workers, max_queue_size, std::move(service_queue_limits))
+                            : nullptr),
+          new_connection(std::make_shared<Connection>(io_service,
+                                                      request_handler,
+                                                      request_queue.get(),
+                                                      keepalive_timeout,
+                                                      keepalive_max_requests))
     {
         const auto port_string = std::to_string(port);
 
@@ -62,6 +95,10 @@ class Server
         acceptor.listen();
 
         util::Log() << "Listening on: " << acceptor.local_endpoint();
+        if (request_queue)
+        {
+            util::Log() << "Running queries on " << num_workers << " worker threads";
+        }
 
         acceptor.async_accept(
             new_connection->socket(),
@@ -83,7 +120,15 @@ class Server
         }
     }
 
-    void Stop() { io_service.stop(); }
+    void Stop()
+    {
+        // the I/O threads still write the replies of the queued requests the queue discards
+        if (request_queue)
+        {
+            request_queue->Stop();
+        }
+        io_service.stop();
+    }
 
     void RegisterServiceHandler(std::unique_ptr<ServiceHandlerInterface> service_handler_)
     {
@@ -96,7 +141,11 @@ class Server
         if (!e)
         {
             new_connection->start();
-            new_connection = std::make_shared<Connection>(io_service, request_handler);
+            new_connection = std::make_shared<Connection>(io_service,
+                                                          request_handler,
+                                                          request_queue.get(),
+                                                          keepalive_timeout,
+                                                          keepalive_max_requests);
             acceptor.async_accept(
                 new_connection->socket(),
                 boost::bind(&Server::HandleAccept, this, boost::asio::placeholders::error));
@@ -104,10 +153,14 @@ class Server
     }
 
     unsigned thread_pool_size;
+    unsigned keepalive_timeout;
+    unsigned keepalive_max_requests;
     boost::asio::io_service io_service;
     boost::asio::ip::tcp::acceptor acceptor;
-    std::shared_ptr<Connection> new_connection;
     RequestHandler request_handler;
+    // declared after io_service and request_handler so the workers are joined first
+    std::unique_ptr<RequestQueue> request_queue;
+    std::shared_ptr<Connection> new_connection;
 };
 }
 }
@@ -4,6 +4,7 @@
 #include "engine/status.hpp"
 #include "osrm/osrm.hpp"
 #include "util/coordinate.hpp"
+#include "util/json_container.hpp"
 
 #include <mapbox/variant.hpp>
 
@@ -20,7 +21,8 @@ namespace service
 class BaseService
 {
   public:
-    using ResultT = mapbox::util::variant<util::json::Object, std::string>;
+    // JSON object tree, protobuf data (tiles) or already rendered JSON
+    using ResultT = mapbox::util::variant<util::json::Object, std::string, util::json::Buffer>;
 
     BaseService(OSRM &routing_machine) : routing_machine(routing_machine) {}
     virtual ~BaseService() = default;
@@ -28,6 +30,32 @@ class BaseService
     virtual engine::Status
     RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) = 0;
 
+    // Services that can send their JSON response while it is rendered pass the rendered parts
+    // to consume, the others ignore it
+    virtual engine::Status RunStreamingQuery(std::size_t prefix_length,
+                                             std::string &query,
+                                             ResultT &result,
+                                             const util::json::BufferConsumer &consume)
+    {
+        (void)consume;
+        return RunQuery(prefix_length, query, result);
+    }
+
+    // Services that accept POST requests parse their parameters from the body, the others
+    // reject them
+    virtual engine::Status RunBodyQuery(const std::vector<char> &body,
+                                        ResultT &result,
+                                        const util::json::BufferConsumer &consume)
+    {
+        (void)body;
+        (void)consume;
+        result = util::json::Object();
+        auto &json_result = result.get<util::json::Object>();
+        json_result.values["code"] = "InvalidQuery";
+        json_result.values["message"] = "Service does not accept POST requests";
+        return engine::Status::Error;
+    }
+
     virtual unsigned GetVersion() = 0;
 
   protected:
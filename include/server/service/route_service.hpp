@@ -14,18 +14,27 @@ namespace osrm
 {
 namespace server
 {
+class ResponseCache;
+
 namespace service
 {
 
 class RouteService final : public BaseService
 {
   public:
-    RouteService(OSRM &routing_machine) : BaseService(routing_machine) {}
+    // Successful responses are cached if a cache is given
+    RouteService(OSRM &routing_machine, ResponseCache *response_cache = nullptr)
+        : BaseService(routing_machine), response_cache(response_cache)
+    {
+    }
 
     engine::Status
     RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) final override;
 
     unsigned GetVersion() final override { return 1; }
+
+  private:
+    ResponseCache *response_cache;
 };
 }
 }
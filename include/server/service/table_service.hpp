@@ -3,6 +3,7 @@
 
 #include "server/service/base_service.hpp"
 
+#include "engine/api/table_parameters.hpp"
 #include "engine/status.hpp"
 #include "osrm/osrm.hpp"
 #include "util/coordinate.hpp"
@@ -25,7 +26,23 @@ class TableService final : public BaseService
     engine::Status
     RunQuery(std::size_t prefix_length, std::string &query, ResultT &result) final override;
 
+    // Large JSON tables are streamed to consume if it is set
+    engine::Status RunStreamingQuery(std::size_t prefix_length,
+                                     std::string &query,
+                                     ResultT &result,
+                                     const util::json::BufferConsumer &consume) final override;
+
+    // Parses the packed coordinates and indices of POST requests, see api::parseTableBody
+    engine::Status RunBodyQuery(const std::vector<char> &body,
+                                ResultT &result,
+                                const util::json::BufferConsumer &consume) final override;
+
     unsigned GetVersion() final override { return 1; }
+
+  private:
+    engine::Status RunTable(engine::api::TableParameters &parameters,
+                            ResultT &result,
+                            const util::json::BufferConsumer &consume);
 };
 }
 }
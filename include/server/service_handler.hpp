@@ -1,11 +1,15 @@
 #ifndef SERVER_SERVICE_HANLDER_HPP
 #define SERVER_SERVICE_HANLDER_HPP
 
+#include "server/response_cache.hpp"
 #include "server/service/base_service.hpp"
 
 #include "osrm/osrm.hpp"
 
+#include <cstddef>
+#include <memory>
 #include <unordered_map>
+#include <vector>
 
 namespace osrm
 {
@@ -27,19 +31,38 @@ class ServiceHandlerInterface
 {
   public:
     virtual ~ServiceHandlerInterface() {}
+    // consume receives the parts of streamed responses, services only stream if it is set
     virtual engine::Status RunQuery(api::ParsedURL parsed_url,
-                                    service::BaseService::ResultT &result) = 0;
+                                    service::BaseService::ResultT &result,
+                                    const util::json::BufferConsumer &consume) = 0;
+    // POST requests, the parameters are in the body instead of the query of the URL
+    virtual engine::Status RunBodyQuery(api::ParsedURL parsed_url,
+                                        const std::vector<char> &body,
+                                        service::BaseService::ResultT &result,
+                                        const util::json::BufferConsumer &consume) = 0;
 };
 
 class ServiceHandler final : public ServiceHandlerInterface
 {
   public:
-    ServiceHandler(osrm::EngineConfig &config);
+    // Caches route and nearest responses up to the given size in bytes, 0 disables the cache
+    ServiceHandler(osrm::EngineConfig &config, const std::size_t response_cache_size = 0);
+    ~ServiceHandler();
     using ResultT = service::BaseService::ResultT;
 
-    virtual engine::Status RunQuery(api::ParsedURL parsed_url, ResultT &result) override;
+    virtual engine::Status RunQuery(api::ParsedURL parsed_url,
+                                    ResultT &result,
+                                    const util::json::BufferConsumer &consume) override;
+    virtual engine::Status RunBodyQuery(api::ParsedURL parsed_url,
+                                        const std::vector<char> &body,
+                                        ResultT &result,
+                                        const util::json::BufferConsumer &consume) override;
 
   private:
+    // The service of the URL or nullptr with the error in result
+    service::BaseService *FindService(const api::ParsedURL &parsed_url, ResultT &result);
+
+    std::unique_ptr<ResponseCache> response_cache;
     std::unordered_map<std::string, std::unique_ptr<service::BaseService>> service_map;
     OSRM routing_machine;
 };
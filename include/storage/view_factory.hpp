@@ -28,6 +28,8 @@
 #include "partitioner/multi_level_partition.hpp"
 
 #include "util/coordinate.hpp"
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
 #include "util/packed_vector.hpp"
 #include "util/range_table.hpp"
 #include "util/static_graph.hpp"
@@ -243,12 +245,30 @@ inline auto make_entry_classes_view(const SharedDataIndex &index, const std::str
     return make_vector_view<util::guidance::EntryClass>(index, name);
 }
 
+// The edge layout of the contracted graph is not covered by the data version, so data from an
+// older osrm-contract is rejected here instead of being read with the wrong layout
+inline auto make_contracted_edge_view(const SharedDataIndex &index, const std::string &name)
+{
+    using EdgeArrayEntry = contractor::QueryGraphView::EdgeArrayEntry;
+    const auto block_name = name + "/contracted_graph/edge_array";
+    const auto expected_size = index.GetBlockEntries(block_name) * sizeof(EdgeArrayEntry);
+    if (index.GetBlockSize(block_name) != expected_size)
+    {
+        throw util::RuntimeError(block_name + ": Edge size does not match",
+                                 ErrorCode::IncompatibleFileVersion,
+                                 SOURCE_REF,
+                                 "the .hsgr file was created by an older osrm-contract, "
+                                 "run osrm-contract again");
+    }
+
+    return make_vector_view<EdgeArrayEntry>(index, block_name);
+}
+
 inline auto make_contracted_metric_view(const SharedDataIndex &index, const std::string &name)
 {
     auto node_list = make_vector_view<contractor::QueryGraphView::NodeArrayEntry>(
         index, name + "/contracted_graph/node_array");
-    auto edge_list = make_vector_view<contractor::QueryGraphView::EdgeArrayEntry>(
-        index, name + "/contracted_graph/edge_array");
+    auto edge_list = make_contracted_edge_view(index, name);
 
     std::vector<util::vector_view<bool>> edge_filter;
     index.List(name + "/exclude",
@@ -362,8 +382,7 @@ inline auto make_filtered_graph_view(const SharedDataIndex &index,
     auto edge_filter = make_vector_view<bool>(index, exclude_prefix + "/edge_filter");
     auto node_list = make_vector_view<contractor::QueryGraphView::NodeArrayEntry>(
         index, name + "/contracted_graph/node_array");
-    auto edge_list = make_vector_view<contractor::QueryGraphView::EdgeArrayEntry>(
-        index, name + "/contracted_graph/edge_array");
+    auto edge_list = make_contracted_edge_view(index, name);
 
     return util::FilteredGraphView<contractor::QueryGraphView>({node_list, edge_list}, edge_filter);
 }
@@ -33,6 +33,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <mapbox/variant.hpp>
 
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -147,6 +148,19 @@ struct Array
     std::vector<Value> values;
 };
 
+/**
+ * Rendered JSON document.
+ *
+ * Filled by the streaming Writer, which skips building the Object tree for large responses.
+ */
+using Buffer = std::vector<char>;
+
+/**
+ * Takes the rendered start of a document out of the Buffer, e.g. to send it while the rest of
+ * the document is still being rendered into the emptied Buffer.
+ */
+using BufferConsumer = std::function<void(Buffer &)>;
+
 } // namespace json
 } // namespace util
 } // namespace osrm
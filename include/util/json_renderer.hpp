@@ -9,6 +9,9 @@
 
 #include "osrm/json_container.hpp"
 
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
 #include <iterator>
 #include <ostream>
 #include <string>
@@ -21,6 +24,82 @@ namespace util
 namespace json
 {
 
+namespace detail
+{
+
+// Enough for the fixed notation of the largest double
+constexpr std::size_t NUMBER_BUFFER_SIZE = 330;
+
+// Formats the number exactly like cast::to_string_with_precision, i.e. fixed notation with six
+// decimals and trailing zeros removed, but without going through an ostringstream.
+// Returns the number of characters written to buffer.
+inline std::size_t formatNumber(const double value, char *buffer)
+{
+    // Below this limit the scaled value is accurate to 2^-10, which is enough to tell on which
+    // side of the rounding boundary it lies. Covers coordinates, durations and distances.
+    constexpr double FAST_PATH_LIMIT = 8796093.0;
+    constexpr double ROUNDING_MARGIN = 1e-3;
+
+    const double magnitude = std::abs(value);
+    if (magnitude < FAST_PATH_LIMIT)
+    {
+        const double scaled = magnitude * 1e6;
+        const double integral = std::floor(scaled);
+        const double fraction = scaled - integral;
+        if (std::abs(fraction - 0.5) > ROUNDING_MARGIN)
+        {
+            const std::uint64_t units =
+                static_cast<std::uint64_t>(integral) + (fraction > 0.5 ? 1 : 0);
+            std::uint64_t integer_part = units / 1000000;
+            std::uint32_t decimals = units % 1000000;
+
+            std::size_t length = 0;
+            // like printf we keep the sign of negative numbers that round to zero
+            if (std::signbit(value))
+            {
+                buffer[length++] = '-';
+            }
+
+            char digits[20];
+            std::size_t num_digits = 0;
+            do
+            {
+                digits[num_digits++] = '0' + integer_part % 10;
+                integer_part /= 10;
+            } while (integer_part > 0);
+            while (num_digits > 0)
+            {
+                buffer[length++] = digits[--num_digits];
+            }
+
+            if (decimals > 0)
+            {
+                buffer[length++] = '.';
+                for (std::uint32_t divisor = 100000; decimals > 0; divisor /= 10)
+                {
+                    buffer[length++] = '0' + decimals / divisor;
+                    decimals %= divisor;
+                }
+            }
+            return length;
+        }
+    }
+
+    // large, non-finite or halfway values
+    auto length =
+        static_cast<std::size_t>(std::snprintf(buffer, NUMBER_BUFFER_SIZE, "%.6f", value));
+    while (length > 0 && buffer[length - 1] == '0')
+    {
+        --length;
+    }
+    if (length > 0 && buffer[length - 1] == '.')
+    {
+        --length;
+    }
+    return length;
+}
+}
+
 struct Renderer
 {
     explicit Renderer(std::ostream &_out) : out(_out) {}
@@ -91,8 +170,9 @@ struct ArrayRenderer
 
     void operator()(const Number &number) const
     {
-        const std::string number_string = cast::to_string_with_precision(number.value);
-        out.insert(out.end(), number_string.begin(), number_string.end());
+        char buffer[detail::NUMBER_BUFFER_SIZE];
+        const auto length = detail::formatNumber(number.value, buffer);
+        out.insert(out.end(), buffer, buffer + length);
     }
 
     void operator()(const Object &object) const
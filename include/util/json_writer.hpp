@@ -0,0 +1,195 @@
+#ifndef JSON_WRITER_HPP
+#define JSON_WRITER_HPP
+
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace osrm
+{
+namespace util
+{
+namespace json
+{
+
+/**
+ * Streaming JSON writer that appends directly to a Buffer.
+ *
+ * Produces the same output as rendering the equivalent Object tree with render(), but without
+ * allocating a Value per element. Separators are inserted automatically:
+ *
+ *   Writer writer(buffer);
+ *   writer.StartObject();
+ *   writer.Key("durations");
+ *   writer.StartArray();
+ *   writer.Number(1.5);
+ *   writer.Null();
+ *   writer.EndArray();
+ *   writer.EndObject();
+ */
+class Writer
+{
+  public:
+    explicit Writer(Buffer &out_) : out(out_), needs_separator(false), depth(0) {}
+
+    void StartObject()
+    {
+        BeginValue();
+        out.push_back('{');
+        needs_separator = false;
+        ++depth;
+    }
+
+    void EndObject()
+    {
+        BOOST_ASSERT(depth > 0);
+        out.push_back('}');
+        needs_separator = true;
+        --depth;
+    }
+
+    void StartArray()
+    {
+        BeginValue();
+        out.push_back('[');
+        needs_separator = false;
+        ++depth;
+    }
+
+    void EndArray()
+    {
+        BOOST_ASSERT(depth > 0);
+        out.push_back(']');
+        needs_separator = true;
+        --depth;
+    }
+
+    // Keys are written verbatim, like the Object keys in the renderer
+    void Key(const char *key)
+    {
+        BeginValue();
+        out.push_back('"');
+        out.insert(out.end(), key, key + std::strlen(key));
+        out.push_back('"');
+        out.push_back(':');
+        needs_separator = false;
+    }
+
+    void String(const std::string &value)
+    {
+        BeginValue();
+        out.push_back('"');
+        AppendEscaped(value);
+        out.push_back('"');
+        needs_separator = true;
+    }
+
+    void Number(const double value)
+    {
+        BeginValue();
+        char buffer[detail::NUMBER_BUFFER_SIZE];
+        const auto length = detail::formatNumber(value, buffer);
+        out.insert(out.end(), buffer, buffer + length);
+        needs_separator = true;
+    }
+
+    void Bool(const bool value)
+    {
+        BeginValue();
+        if (value)
+        {
+            Append("true");
+        }
+        else
+        {
+            Append("false");
+        }
+        needs_separator = true;
+    }
+
+    void Null()
+    {
+        BeginValue();
+        Append("null");
+        needs_separator = true;
+    }
+
+    // Embeds an already built value, for parts of a response that are shared with the tree API
+    void Value(const json::Value &value)
+    {
+        BeginValue();
+        mapbox::util::apply_visitor(ArrayRenderer(out), value);
+        needs_separator = true;
+    }
+
+    // True once all started objects and arrays were closed again
+    bool IsComplete() const { return depth == 0; }
+
+  private:
+    void BeginValue()
+    {
+        if (needs_separator)
+        {
+            out.push_back(',');
+        }
+    }
+
+    template <std::size_t N> void Append(const char (&literal)[N])
+    {
+        out.insert(out.end(), literal, literal + N - 1);
+    }
+
+    // Same escaping as escape_JSON, without the temporary string
+    void AppendEscaped(const std::string &value)
+    {
+        for (const char letter : value)
+        {
+            switch (letter)
+            {
+            case '\\':
+                Append("\\\\");
+                break;
+            case '"':
+                Append("\\\"");
+                break;
+            case '/':
+                Append("\\/");
+                break;
+            case '\b':
+                Append("\\b");
+                break;
+            case '\f':
+                Append("\\f");
+                break;
+            case '\n':
+                Append("\\n");
+                break;
+            case '\r':
+                Append("\\r");
+                break;
+            case '\t':
+                Append("\\t");
+                break;
+            default:
+                out.push_back(letter);
+                break;
+            }
+        }
+    }
+
+    Buffer &out;
+    bool needs_separator;
+    std::size_t depth;
+};
+
+} // namespace json
+} // namespace util
+} // namespace osrm
+
+#endif // JSON_WRITER_HPP
@@ -2,11 +2,12 @@
 #define OSRM_UTIL_QUERY_HEAP_HPP
 
 #include <boost/assert.hpp>
-#include <boost/heap/d_ary_heap.hpp>
 
 #include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -15,19 +16,21 @@ namespace osrm
 namespace util
 {
 
+// Array of positions that is cleared in O(1) by bumping a generation counter. Positions
+// written in an older generation read as not inserted.
 template <typename NodeID, typename Key> class GenerationArrayStorage
 {
     using GenerationCounter = std::uint16_t;
 
   public:
     explicit GenerationArrayStorage(std::size_t size)
-        : positions(size, 0), generation(1), generations(size, 0)
+        : generation(1), generations(size, 0), positions(size, 0)
     {
     }
 
     Key &operator[](NodeID node)
     {
-        generation[node] = generation;
+        generations[node] = generation;
         return positions[node];
     }
 
@@ -126,6 +129,158 @@ template <typename NodeID, typename Key> class UnorderedMapStorage
     std::unordered_map<NodeID, Key> nodes;
 };
 
+// Starts as a small open addressing hash table and is promoted to a GenerationArrayStorage
+// once the search space gets large. Most searches stay small and never pay for an array over
+// all nodes, large ones get O(1) lookups. The promotion is kept for subsequent searches.
+template <typename NodeID, typename Key> class HybridStorage
+{
+    struct Slot
+    {
+        NodeID node;
+        Key key;
+    };
+
+    static constexpr std::size_t INITIAL_CAPACITY = 64;
+    // the hash table may use at most 1/MAX_HASH_FRACTION of the slots of the array
+    static constexpr std::size_t MAX_HASH_FRACTION = 64;
+    static constexpr NodeID EMPTY = std::numeric_limits<NodeID>::max();
+    static constexpr std::uint64_t GOLDEN_RATIO = 11400714819323198485ull;
+
+  public:
+    explicit HybridStorage(std::size_t number_of_nodes)
+        : number_of_nodes(number_of_nodes),
+          max_capacity(number_of_nodes / MAX_HASH_FRACTION > INITIAL_CAPACITY
+                           ? number_of_nodes / MAX_HASH_FRACTION
+                           : INITIAL_CAPACITY),
+          slots(INITIAL_CAPACITY, Slot{EMPTY, 0}), shift(64 - log2(INITIAL_CAPACITY)), size(0)
+    {
+    }
+
+    Key &operator[](const NodeID node)
+    {
+        if (array)
+        {
+            return (*array)[node];
+        }
+
+        auto *slot = &FindSlot(node);
+        if (slot->node == EMPTY)
+        {
+            // keep the load factor below 3/4
+            if (4 * (size + 1) > 3 * slots.size())
+            {
+                if (2 * slots.size() > max_capacity)
+                {
+                    Promote();
+                    return (*array)[node];
+                }
+                Rehash(2 * slots.size());
+                slot = &FindSlot(node);
+            }
+            slot->node = node;
+            ++size;
+        }
+        return slot->key;
+    }
+
+    Key peek_index(const NodeID node) const
+    {
+        if (array)
+        {
+            return array->peek_index(node);
+        }
+
+        const auto &slot = FindSlot(node);
+        if (slot.node == node)
+        {
+            return slot.key;
+        }
+        return std::numeric_limits<Key>::max();
+    }
+
+    void Clear()
+    {
+        if (array)
+        {
+            array->Clear();
+        }
+        else if (size > 0)
+        {
+            std::fill(slots.begin(), slots.end(), Slot{EMPTY, 0});
+            size = 0;
+        }
+    }
+
+    bool IsPromoted() const { return static_cast<bool>(array); }
+
+  private:
+    static unsigned log2(std::size_t value)
+    {
+        unsigned result = 0;
+        while (value >>= 1)
+            ++result;
+        return result;
+    }
+
+    // Fibonacci hashing, uses the high bits of the product
+    std::size_t Hash(const NodeID node) const
+    {
+        return static_cast<std::size_t>((static_cast<std::uint64_t>(node) * GOLDEN_RATIO) >> shift);
+    }
+
+    // Slot of the node or the empty slot where it would be inserted
+    const Slot &FindSlot(const NodeID node) const
+    {
+        const auto mask = slots.size() - 1;
+        auto index = Hash(node);
+        while (slots[index].node != node && slots[index].node != EMPTY)
+        {
+            index = (index + 1) & mask;
+        }
+        return slots[index];
+    }
+
+    Slot &FindSlot(const NodeID node)
+    {
+        return const_cast<Slot &>(static_cast<const HybridStorage &>(*this).FindSlot(node));
+    }
+
+    void Rehash(const std::size_t capacity)
+    {
+        std::vector<Slot> old_slots(capacity, Slot{EMPTY, 0});
+        old_slots.swap(slots);
+        shift = 64 - log2(capacity);
+        for (const auto &slot : old_slots)
+        {
+            if (slot.node != EMPTY)
+            {
+                FindSlot(slot.node) = slot;
+            }
+        }
+    }
+
+    void Promote()
+    {
+        array = std::make_unique<GenerationArrayStorage<NodeID, Key>>(number_of_nodes);
+        for (const auto &slot : slots)
+        {
+            if (slot.node != EMPTY)
+            {
+                (*array)[slot.node] = slot.key;
+            }
+        }
+        std::vector<Slot>().swap(slots);
+        size = 0;
+    }
+
+    const std::size_t number_of_nodes;
+    const std::size_t max_capacity;
+    std::vector<Slot> slots;
+    unsigned shift;
+    std::size_t size;
+    std::unique_ptr<GenerationArrayStorage<NodeID, Key>> array;
+};
+
 template <typename NodeID,
           typename Key,
           template <typename N, typename K> class BaseIndexStorage = UnorderedMapStorage,
@@ -187,6 +342,11 @@ class TwoLevelStorage
     OverlayIndexStorage<NodeID, Key> overlay;
 };
 
+// Priority queue of nodes with decrease-key, ordered by weight and then by insertion order.
+//
+// The heap is an intrusive 4-ary heap of (weight, index) entries, so comparisons only touch the
+// heap array. The index refers to the entry of the node in inserted_nodes, which in turn stores
+// the position of the node in the heap for decrease-key.
 template <typename NodeID,
           typename Key,
           typename Weight,
@@ -218,8 +378,9 @@ class QueryHeap
     {
         BOOST_ASSERT(node < std::numeric_limits<NodeID>::max());
         const auto index = static_cast<Key>(inserted_nodes.size());
-        const auto handle = heap.push(std::make_pair(weight, index));
-        inserted_nodes.emplace_back(HeapNode{handle, node, weight, data});
+        inserted_nodes.emplace_back(HeapNode{RemovedPosition(), node, weight, data});
+        heap.push_back(HeapEntry{weight, index});
+        SiftUp(heap.size() - 1);
         node_index[node] = index;
     }
 
@@ -245,16 +406,7 @@ class QueryHeap
     {
         BOOST_ASSERT(WasInserted(node));
         const Key index = node_index.peek_index(node);
-
-        // Use end iterator as a reliable "non-existent" handle.
-        // Default-constructed handles are singular and
-        // can only be checked-compared to another singular instance.
-        // Behaviour investigated at https://lists.boost.org/boost-users/2017/08/87787.php,
-        // eventually confirmation at https://stackoverflow.com/a/45622940/151641.
-        // Corrected in https://github.com/Project-OSRM/osrm-backend/pull/4396
-        auto const end_it = const_cast<HeapContainer &>(heap).end();  // non-const iterator
-        auto const none_handle = heap.s_handle_from_iterator(end_it); // from non-const iterator
-        return inserted_nodes[index].handle == none_handle;
+        return inserted_nodes[index].position == RemovedPosition();
     }
 
     bool WasInserted(const NodeID node) const
@@ -270,29 +422,35 @@ class QueryHeap
     NodeID Min() const
     {
         BOOST_ASSERT(!heap.empty());
-        return inserted_nodes[heap.top().second].node;
+        return inserted_nodes[heap.front().index].node;
     }
 
     Weight MinKey() const
     {
         BOOST_ASSERT(!heap.empty());
-        return heap.top().first;
+        return heap.front().weight;
     }
 
     NodeID DeleteMin()
     {
         BOOST_ASSERT(!heap.empty());
-        const Key removedIndex = heap.top().second;
-        heap.pop();
-        inserted_nodes[removedIndex].handle = heap.s_handle_from_iterator(heap.end());
-        return inserted_nodes[removedIndex].node;
+        const Key removed_index = heap.front().index;
+        inserted_nodes[removed_index].position = RemovedPosition();
+
+        const auto last = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+        {
+            heap.front() = last;
+            SiftDown(0);
+        }
+        return inserted_nodes[removed_index].node;
     }
 
     void DeleteAll()
     {
-        auto const none_handle = heap.s_handle_from_iterator(heap.end());
-        std::for_each(inserted_nodes.begin(), inserted_nodes.end(), [&none_handle](auto &node) {
-            node.handle = none_handle;
+        std::for_each(inserted_nodes.begin(), inserted_nodes.end(), [](auto &node) {
+            node.position = RemovedPosition();
         });
         heap.clear();
     }
@@ -303,27 +461,91 @@ class QueryHeap
         const auto index = node_index.peek_index(node);
         auto &reference = inserted_nodes[index];
         reference.weight = weight;
-        heap.increase(reference.handle, std::make_pair(weight, index));
+        const auto position = static_cast<std::size_t>(reference.position);
+        heap[position].weight = weight;
+        SiftUp(position);
     }
 
   private:
-    using HeapData = std::pair<Weight, Key>;
-    using HeapContainer = boost::heap::d_ary_heap<HeapData,
-                                                  boost::heap::arity<4>,
-                                                  boost::heap::mutable_<true>,
-                                                  boost::heap::compare<std::greater<HeapData>>>;
-    using HeapHandle = typename HeapContainer::handle_type;
+    static constexpr std::size_t ARITY = 4;
+
+    struct HeapEntry
+    {
+        Weight weight;
+        Key index;
+    };
 
     struct HeapNode
     {
-        HeapHandle handle;
+        // position in the heap, RemovedPosition() once the node was deleted from the heap
+        Key position;
         NodeID node;
         Weight weight;
         Data data;
     };
 
+    static Key RemovedPosition() { return std::numeric_limits<Key>::max(); }
+
+    // ties are broken by insertion order, which makes the order of equal weights deterministic
+    static bool Less(const HeapEntry &lhs, const HeapEntry &rhs)
+    {
+        return lhs.weight < rhs.weight || (!(rhs.weight < lhs.weight) && lhs.index < rhs.index);
+    }
+
+    void Place(const std::size_t position, const HeapEntry &entry)
+    {
+        heap[position] = entry;
+        inserted_nodes[entry.index].position = static_cast<Key>(position);
+    }
+
+    void SiftUp(std::size_t position)
+    {
+        const auto entry = heap[position];
+        while (position > 0)
+        {
+            const auto parent = (position - 1) / ARITY;
+            if (!Less(entry, heap[parent]))
+            {
+                break;
+            }
+            Place(position, heap[parent]);
+            position = parent;
+        }
+        Place(position, entry);
+    }
+
+    void SiftDown(std::size_t position)
+    {
+        const auto entry = heap[position];
+        const auto size = heap.size();
+        while (true)
+        {
+            const auto first_child = ARITY * position + 1;
+            if (first_child >= size)
+            {
+                break;
+            }
+            const auto last_child = std::min(first_child + ARITY, size);
+            auto best_child = first_child;
+            for (auto child = first_child + 1; child < last_child; ++child)
+            {
+                if (Less(heap[child], heap[best_child]))
+                {
+                    best_child = child;
+                }
+            }
+            if (!Less(heap[best_child], entry))
+            {
+                break;
+            }
+            Place(position, heap[best_child]);
+            position = best_child;
+        }
+        Place(position, entry);
+    }
+
     std::vector<HeapNode> inserted_nodes;
-    HeapContainer heap;
+    std::vector<HeapEntry> heap;
     IndexStorage node_index;
 };
 }
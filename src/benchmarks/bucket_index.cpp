@@ -0,0 +1,160 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+using engine::routing_algorithms::BucketKernel;
+using engine::routing_algorithms::NodeBucket;
+using engine::routing_algorithms::NodeBucketIndex;
+using DurationMetrics = engine::routing_algorithms::TableMetrics<true, false>;
+
+namespace
+{
+
+// CH search spaces of a few hundred nodes, the higher the node the more search spaces share it.
+// Node ids are drawn from a skewed distribution so low ids are the shared high level nodes.
+std::vector<NodeID> getSearchSpace(std::mt19937 &generator,
+                                   const std::size_t number_of_nodes,
+                                   const std::size_t search_space)
+{
+    std::exponential_distribution<double> levels(256.0);
+    std::vector<NodeID> nodes;
+    while (nodes.size() < search_space)
+    {
+        const auto node = static_cast<std::size_t>(levels(generator) * number_of_nodes);
+        if (node < number_of_nodes)
+            nodes.push_back(static_cast<NodeID>(node));
+    }
+    std::sort(nodes.begin(), nodes.end());
+    nodes.erase(std::unique(nodes.begin(), nodes.end()), nodes.end());
+    return nodes;
+}
+
+// Builds the lookup structure from the buckets of the backward searches and scans the buckets
+// of all nodes the forward searches settle, like the forward steps of the CH table search
+template <typename BuildT, typename ScanT>
+void measure(const std::string &name,
+             const std::vector<NodeBucket> &buckets,
+             const std::vector<std::vector<NodeID>> &forward_search_spaces,
+             BuildT &&build,
+             ScanT &&scan)
+{
+    TIMER_START(build);
+    const auto lookup = build(buckets);
+    TIMER_STOP(build);
+
+    std::int64_t sum = 0;
+    TIMER_START(scan);
+    for (const auto &search_space : forward_search_spaces)
+    {
+        for (const auto node : search_space)
+        {
+            sum += scan(lookup, node);
+        }
+    }
+    TIMER_STOP(scan);
+
+    util::Log() << "  " << name << ": build " << TIMER_MSEC(build) << " ms, lookups "
+                << TIMER_MSEC(scan) << " ms (checksum " << sum << ")";
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const std::size_t number_of_nodes = 1 << 24;
+    const std::size_t search_space = 500;
+
+    for (const auto &shape : std::vector<std::pair<std::size_t, std::size_t>>{
+             {100, 100}, {100, 1000}, {1000, 1000}, {1000, 5000}})
+    {
+        std::mt19937 generator(1337);
+
+        std::vector<NodeBucket> buckets;
+        for (const auto column : util::irange<unsigned>(0, shape.second))
+        {
+            for (const auto node : getSearchSpace(generator, number_of_nodes, search_space))
+            {
+                buckets.emplace_back(node, SPECIAL_NODEID, column, column, 0, 0);
+            }
+        }
+        std::vector<std::vector<NodeID>> forward_search_spaces;
+        for (std::size_t row = 0; row < shape.first; ++row)
+        {
+            forward_search_spaces.push_back(
+                getSearchSpace(generator, number_of_nodes, search_space));
+        }
+
+        util::Log() << shape.first << "x" << shape.second << " table, " << buckets.size()
+                    << " buckets:";
+
+        measure("sorted vector and std::equal_range",
+                buckets,
+                forward_search_spaces,
+                [](std::vector<NodeBucket> sorted) {
+                    std::sort(sorted.begin(), sorted.end());
+                    return sorted;
+                },
+                [](const std::vector<NodeBucket> &sorted, const NodeID node) {
+                    EdgeWeight sum = 0;
+                    const auto range = std::equal_range(
+                        sorted.begin(), sorted.end(), node, NodeBucket::Compare());
+                    for (auto bucket = range.first; bucket != range.second; ++bucket)
+                        sum += bucket->weight;
+                    return sum;
+                });
+
+        measure("NodeBucketIndex",
+                buckets,
+                forward_search_spaces,
+                [](const std::vector<NodeBucket> &unordered) { return NodeBucketIndex(unordered); },
+                [](const NodeBucketIndex &index, const NodeID node) {
+                    EdgeWeight sum = 0;
+                    const auto buckets = index.GetBuckets(node);
+                    for (const auto bucket : util::irange<std::size_t>(0, buckets.size))
+                        sum += buckets.weights[bucket];
+                    return sum;
+                });
+
+        // the forward steps of a table of durations, a row per forward search
+        for (const auto &kernel : {std::make_pair(BucketKernel::Scalar, "scalar"),
+                                   std::make_pair(BucketKernel::SSE41, "SSE4.1"),
+                                   std::make_pair(BucketKernel::AVX2, "AVX2")})
+        {
+            if (!engine::routing_algorithms::isSupported(kernel.first))
+                continue;
+
+            std::vector<EdgeWeight> weights(shape.second, INVALID_EDGE_WEIGHT);
+            std::vector<EdgeDuration> durations(shape.second, MAXIMAL_EDGE_DURATION);
+            measure(std::string("NodeBucketIndex and ") + kernel.second + " relaxBuckets",
+                    buckets,
+                    forward_search_spaces,
+                    [](const std::vector<NodeBucket> &unordered) {
+                        return NodeBucketIndex(unordered);
+                    },
+                    [&](const NodeBucketIndex &index, const NodeID node) {
+                        const auto buckets = index.GetBuckets(node);
+                        // deeper nodes of the search spaces are further away from the source
+                        engine::routing_algorithms::relaxBuckets<DurationMetrics>(
+                            buckets,
+                            node % 1024,
+                            node % 1024,
+                            0,
+                            {weights.data(), durations.data(), nullptr},
+                            kernel.first);
+                        return static_cast<EdgeWeight>(buckets.size);
+                    });
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include "engine/datafacade.hpp"
+#include "engine/datafacade/algorithm_datafacade.hpp"
+#include "engine/datafacade_provider.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "storage/storage_config.hpp"
+
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+using CH = engine::routing_algorithms::ch::Algorithm;
+using QueryHeap = engine::SearchEngineData<CH>::QueryHeap;
+
+// Settles one node of a CH search, the same graph accesses as ch::routingStep
+template <bool DIRECTION, typename Facade>
+void routingStep(const Facade &facade,
+                 QueryHeap &forward_heap,
+                 const QueryHeap &reverse_heap,
+                 EdgeWeight &upper_bound)
+{
+    const auto node = forward_heap.DeleteMin();
+    const auto weight = forward_heap.GetKey(node);
+
+    if (reverse_heap.WasInserted(node))
+    {
+        upper_bound = std::min(upper_bound, weight + reverse_heap.GetKey(node));
+    }
+
+    for (const auto edge : facade.GetAdjacentEdgeRange(node))
+    {
+        const auto &data = facade.GetEdgeData(edge);
+        if (DIRECTION ? data.forward : data.backward)
+        {
+            const auto to = facade.GetTarget(edge);
+            const auto to_weight = weight + data.weight;
+            if (!forward_heap.WasInserted(to))
+            {
+                forward_heap.Insert(to, to_weight, node);
+            }
+            else if (to_weight < forward_heap.GetKey(to))
+            {
+                forward_heap.GetData(to).parent = node;
+                forward_heap.DecreaseKey(to, to_weight);
+            }
+        }
+    }
+}
+
+// Bidirectional CH searches between the given node pairs
+template <typename Facade>
+double measureQueries(const Facade &facade,
+                      engine::SearchEngineData<CH> &heaps,
+                      const std::vector<std::pair<NodeID, NodeID>> &queries)
+{
+    std::size_t found = 0;
+    TIMER_START(queries);
+    for (const auto &query : queries)
+    {
+        heaps.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+        auto &forward_heap = *heaps.forward_heap_1;
+        auto &reverse_heap = *heaps.reverse_heap_1;
+        forward_heap.Insert(query.first, 0, query.first);
+        reverse_heap.Insert(query.second, 0, query.second);
+
+        auto upper_bound = INVALID_EDGE_WEIGHT;
+        while (!forward_heap.Empty() || !reverse_heap.Empty())
+        {
+            if (!forward_heap.Empty())
+            {
+                if (forward_heap.MinKey() < upper_bound)
+                    routingStep<true>(facade, forward_heap, reverse_heap, upper_bound);
+                else
+                    forward_heap.DeleteAll();
+            }
+            if (!reverse_heap.Empty())
+            {
+                if (reverse_heap.MinKey() < upper_bound)
+                    routingStep<false>(facade, reverse_heap, forward_heap, upper_bound);
+                else
+                    reverse_heap.DeleteAll();
+            }
+        }
+
+        found += upper_bound != INVALID_EDGE_WEIGHT;
+    }
+    TIMER_STOP(queries);
+
+    // keeps the searches from being optimized away
+    util::Log() << "  found " << found << " of " << queries.size() << " routes";
+
+    return TIMER_MSEC(queries) / queries.size();
+}
+}
+
+int main(int argc, const char *argv[]) try
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [number of queries]\n";
+        return EXIT_FAILURE;
+    }
+
+    util::LogPolicy::GetInstance().Unmute();
+
+    const storage::StorageConfig config{argv[1]};
+    const std::size_t number_of_queries = argc > 2 ? std::stoul(argv[2]) : 10000;
+
+    engine::ImmutableProvider<CH> provider(config);
+    const auto facade = provider.Get(engine::api::BaseParameters{});
+
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<NodeID> nodes(0, facade->GetNumberOfNodes() - 1);
+    std::vector<std::pair<NodeID, NodeID>> queries;
+    for (std::size_t query = 0; query < number_of_queries; ++query)
+    {
+        queries.emplace_back(nodes(generator), nodes(generator));
+    }
+
+    engine::SearchEngineData<CH> heaps;
+
+    // warm up heaps and caches, then run the same queries through both facade types
+    measureQueries<engine::DataFacade<CH>>(*facade, heaps, queries);
+
+    const auto &algorithm_facade =
+        static_cast<const engine::datafacade::AlgorithmDataFacade<CH> &>(*facade);
+    const auto virtual_ms = measureQueries(algorithm_facade, heaps, queries);
+    const auto concrete_ms = measureQueries<engine::DataFacade<CH>>(*facade, heaps, queries);
+
+    util::Log() << "Virtual AlgorithmDataFacade<CH>: " << virtual_ms << " ms per query";
+    util::Log() << "Concrete DataFacade<CH>: " << concrete_ms << " ms per query";
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,212 @@
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/query_heap.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <boost/heap/d_ary_heap.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+struct HeapData
+{
+    NodeID parent;
+};
+
+// Random graph with a bit of locality, node ids of road networks are sorted spatially
+class RandomGraph
+{
+  public:
+    RandomGraph(const std::size_t number_of_nodes, const std::size_t degree)
+        : number_of_nodes(number_of_nodes), degree(degree)
+    {
+        std::mt19937 generator(1337);
+        std::uniform_int_distribution<std::int64_t> offsets(-512, 512);
+        std::uniform_int_distribution<EdgeWeight> weights(1, 100);
+        for (const auto node : util::irange<std::size_t>(0, number_of_nodes))
+        {
+            for (std::size_t edge = 0; edge < degree; ++edge)
+            {
+                const auto target = (static_cast<std::int64_t>(node) + offsets(generator) +
+                                     static_cast<std::int64_t>(number_of_nodes)) %
+                                    static_cast<std::int64_t>(number_of_nodes);
+                targets.push_back(static_cast<NodeID>(target));
+                edge_weights.push_back(weights(generator));
+            }
+        }
+    }
+
+    const std::size_t number_of_nodes;
+    const std::size_t degree;
+    std::vector<NodeID> targets;
+    std::vector<EdgeWeight> edge_weights;
+};
+
+// The previous util::QueryHeap on top of boost::heap::d_ary_heap with mutable handles, as baseline
+template <typename IndexStorage> class BoostQueryHeap
+{
+  public:
+    explicit BoostQueryHeap(std::size_t number_of_nodes) : node_index(number_of_nodes) {}
+
+    void Clear()
+    {
+        heap.clear();
+        inserted_nodes.clear();
+        node_index.Clear();
+    }
+
+    bool Empty() const { return heap.empty(); }
+
+    void Insert(NodeID node, EdgeWeight weight, const HeapData &data)
+    {
+        const auto index = static_cast<int>(inserted_nodes.size());
+        const auto handle = heap.push(std::make_pair(weight, index));
+        inserted_nodes.emplace_back(HeapNode{handle, node, weight, data});
+        node_index[node] = index;
+    }
+
+    HeapData &GetData(NodeID node) { return inserted_nodes[node_index.peek_index(node)].data; }
+
+    EdgeWeight GetKey(NodeID node) const
+    {
+        return inserted_nodes[node_index.peek_index(node)].weight;
+    }
+
+    bool WasInserted(const NodeID node) const
+    {
+        const auto index = node_index.peek_index(node);
+        if (index >= static_cast<decltype(index)>(inserted_nodes.size()))
+        {
+            return false;
+        }
+        return inserted_nodes[index].node == node;
+    }
+
+    EdgeWeight MinKey() const { return heap.top().first; }
+
+    NodeID DeleteMin()
+    {
+        const auto removed_index = heap.top().second;
+        heap.pop();
+        inserted_nodes[removed_index].handle = heap.s_handle_from_iterator(heap.end());
+        return inserted_nodes[removed_index].node;
+    }
+
+    void DecreaseKey(NodeID node, EdgeWeight weight)
+    {
+        const auto index = node_index.peek_index(node);
+        auto &reference = inserted_nodes[index];
+        reference.weight = weight;
+        heap.increase(reference.handle, std::make_pair(weight, index));
+    }
+
+  private:
+    using HeapContainer = boost::heap::d_ary_heap<std::pair<EdgeWeight, int>,
+                                                  boost::heap::arity<4>,
+                                                  boost::heap::mutable_<true>,
+                                                  boost::heap::compare<std::greater<>>>;
+
+    struct HeapNode
+    {
+        typename HeapContainer::handle_type handle;
+        NodeID node;
+        EdgeWeight weight;
+        HeapData data;
+    };
+
+    std::vector<HeapNode> inserted_nodes;
+    HeapContainer heap;
+    IndexStorage node_index;
+};
+
+template <typename Storage>
+using QueryHeap = util::QueryHeap<NodeID, NodeID, EdgeWeight, HeapData, Storage>;
+
+// Dijkstra from random sources that stops after settling search_space nodes
+template <typename Heap>
+double measureSearches(const RandomGraph &graph,
+                       const std::size_t num_searches,
+                       const std::size_t search_space)
+{
+    Heap heap(graph.number_of_nodes);
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<NodeID> sources(0, graph.number_of_nodes - 1);
+
+    std::size_t settled = 0;
+    TIMER_START(search);
+    for (std::size_t search = 0; search < num_searches; ++search)
+    {
+        heap.Clear();
+        heap.Insert(sources(generator), 0, {SPECIAL_NODEID});
+
+        for (std::size_t count = 0; count < search_space && !heap.Empty(); ++count, ++settled)
+        {
+            const auto weight = heap.MinKey();
+            const auto node = heap.DeleteMin();
+            for (auto edge = node * graph.degree; edge < (node + 1) * graph.degree; ++edge)
+            {
+                const auto target = graph.targets[edge];
+                const auto to_weight = weight + graph.edge_weights[edge];
+                if (!heap.WasInserted(target))
+                {
+                    heap.Insert(target, to_weight, {node});
+                }
+                else if (to_weight < heap.GetKey(target))
+                {
+                    heap.GetData(target).parent = node;
+                    heap.DecreaseKey(target, to_weight);
+                }
+            }
+        }
+    }
+    TIMER_STOP(search);
+
+    // keeps the searches from being optimized away
+    if (settled == 0)
+        util::Log() << "no nodes settled";
+
+    return TIMER_MSEC(search) / num_searches;
+}
+
+template <typename Heap>
+void report(const std::string &name, const RandomGraph &graph, const std::size_t search_space)
+{
+    const auto num_searches = std::max<std::size_t>(10, 10000000 / search_space);
+    util::Log() << name << ": " << measureSearches<Heap>(graph, num_searches, search_space)
+                << " ms per search";
+}
+}
+
+int main(int, char **)
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    const RandomGraph graph(1 << 24, 4);
+
+    // CH searches settle a few hundred nodes, plain Dijkstra and one-to-many searches much more
+    for (const std::size_t search_space : {500, 5000, 200000})
+    {
+        util::Log() << "Search space of " << search_space << " nodes:";
+        report<QueryHeap<util::UnorderedMapStorage<NodeID, int>>>(
+            "  UnorderedMapStorage", graph, search_space);
+        report<QueryHeap<util::GenerationArrayStorage<NodeID, int>>>(
+            "  GenerationArrayStorage", graph, search_space);
+        report<QueryHeap<util::HybridStorage<NodeID, int>>>(
+            "  HybridStorage", graph, search_space);
+        report<QueryHeap<util::ArrayStorage<NodeID, int>>>("  ArrayStorage", graph, search_space);
+        report<BoostQueryHeap<util::HybridStorage<NodeID, int>>>(
+            "  HybridStorage with boost::heap::d_ary_heap", graph, search_space);
+        report<BoostQueryHeap<util::ArrayStorage<NodeID, int>>>(
+            "  ArrayStorage with boost::heap::d_ary_heap", graph, search_space);
+    }
+}
@@ -0,0 +1,154 @@
+#include "engine/approach.hpp"
+#include "engine/datafacade.hpp"
+#include "engine/datafacade_provider.hpp"
+#include "engine/phantom_node.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/search_engine_data.hpp"
+
+#include "storage/storage_config.hpp"
+
+#include "util/integer_range.hpp"
+#include "util/log.hpp"
+#include "util/timing_util.hpp"
+#include "util/typedefs.hpp"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace osrm;
+
+namespace
+{
+
+using CH = engine::routing_algorithms::ch::Algorithm;
+using engine::routing_algorithms::ch::ManyToManyStrategy;
+
+// Snapped locations at the start of random edge based nodes
+std::vector<engine::PhantomNode> getRandomPhantomNodes(const engine::DataFacade<CH> &facade,
+                                                       const std::size_t number_of_phantoms)
+{
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<NodeID> nodes(0, facade.GetNumberOfNodes() - 1);
+
+    std::vector<engine::PhantomNode> phantom_nodes;
+    while (phantom_nodes.size() < number_of_phantoms)
+    {
+        const auto geometry = facade.GetGeometryIndex(nodes(generator));
+        const auto geometry_nodes = facade.GetUncompressedForwardGeometry(geometry.id);
+        const auto coordinate = facade.GetCoordinateOfNode(*geometry_nodes.begin());
+        phantom_nodes.push_back(
+            facade
+                .NearestPhantomNodeWithAlternativeFromBigComponent(
+                    coordinate, engine::Approach::UNRESTRICTED)
+                .first);
+    }
+    return phantom_nodes;
+}
+
+std::vector<EdgeDuration> measureTable(const engine::DataFacade<CH> &facade,
+                                       engine::SearchEngineData<CH> &heaps,
+                                       const std::vector<engine::PhantomNode> &phantom_nodes,
+                                       const std::vector<std::size_t> &source_indices,
+                                       const std::vector<std::size_t> &target_indices,
+                                       const unsigned max_threads,
+                                       const ManyToManyStrategy strategy,
+                                       double &milliseconds)
+{
+    TIMER_START(table);
+    auto durations = engine::routing_algorithms::ch::manyToManySearch(heaps,
+                                                                      facade,
+                                                                      phantom_nodes,
+                                                                      source_indices,
+                                                                      target_indices,
+                                                                      false,
+                                                                      true,
+                                                                      max_threads,
+                                                                      strategy)
+                         .first;
+    TIMER_STOP(table);
+    milliseconds = TIMER_MSEC(table);
+    return durations;
+}
+}
+
+int main(int argc, const char *argv[]) try
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " data.osrm [number of threads]\n";
+        return EXIT_FAILURE;
+    }
+
+    util::LogPolicy::GetInstance().Unmute();
+
+    const storage::StorageConfig config{argv[1]};
+    const unsigned max_threads = argc > 2 ? std::stoul(argv[2]) : 1;
+
+    engine::ImmutableProvider<CH> provider(config);
+    const auto facade = provider.Get(engine::api::BaseParameters{});
+
+    // number of sources and targets, from one-to-many to large square matrices
+    const std::vector<std::pair<std::size_t, std::size_t>> shapes = {
+        {1, 1000}, {10, 1000}, {100, 100}, {100, 1000}, {100, 5000}, {1000, 1000}, {1000, 5000}};
+
+    const auto phantom_nodes = getRandomPhantomNodes(*facade, 6000);
+    engine::SearchEngineData<CH> heaps;
+
+    for (const auto &shape : shapes)
+    {
+        std::vector<std::size_t> source_indices(shape.first);
+        std::iota(source_indices.begin(), source_indices.end(), 0);
+        std::vector<std::size_t> target_indices(shape.second);
+        std::iota(
+            target_indices.begin(), target_indices.end(), phantom_nodes.size() - shape.second);
+
+        double buckets_ms = 0;
+        const auto buckets = measureTable(*facade,
+                                          heaps,
+                                          phantom_nodes,
+                                          source_indices,
+                                          target_indices,
+                                          max_threads,
+                                          ManyToManyStrategy::Buckets,
+                                          buckets_ms);
+        double restricted_ms = 0;
+        const auto restricted = measureTable(*facade,
+                                             heaps,
+                                             phantom_nodes,
+                                             source_indices,
+                                             target_indices,
+                                             max_threads,
+                                             ManyToManyStrategy::RestrictedPHAST,
+                                             restricted_ms);
+
+        std::size_t differences = 0;
+        for (const auto index : util::irange<std::size_t>(0, buckets.size()))
+        {
+            differences += buckets[index] != restricted[index];
+        }
+
+        const auto chosen =
+            engine::routing_algorithms::ch::chooseManyToManyStrategy(shape.first, shape.second);
+
+        util::Log() << shape.first << "x" << shape.second << ": buckets " << buckets_ms
+                    << " ms, restricted PHAST " << restricted_ms << " ms, uses "
+                    << (chosen == ManyToManyStrategy::Buckets ? "buckets" : "restricted PHAST");
+        if (differences > 0)
+        {
+            util::Log(logWARNING) << "  " << differences << " durations differ";
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+catch (const std::exception &e)
+{
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+}
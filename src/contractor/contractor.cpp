@@ -10,11 +10,14 @@
 #include "extractor/edge_based_graph_factory.hpp"
 #include "extractor/files.hpp"
 #include "extractor/node_based_edge.hpp"
+#include "extractor/segment_data_container.hpp"
 
 #include "storage/io.hpp"
 
 #include "updater/updater.hpp"
 
+#include "util/coordinate.hpp"
+#include "util/coordinate_calculation.hpp"
 #include "util/exception.hpp"
 #include "util/exception_utils.hpp"
 #include "util/exclude_flag.hpp"
@@ -36,12 +39,48 @@
 
 #include <boost/assert.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
 namespace osrm
 {
 namespace contractor
 {
 
+namespace
+{
+// Lengths of the edge based nodes, the distances of the edges that leave them
+std::vector<EdgeDistance>
+computeNodeDistances(const ContractorConfig &config,
+                     const extractor::EdgeBasedNodeDataContainer &node_data,
+                     const EdgeID number_of_edge_based_nodes)
+{
+    std::vector<util::Coordinate> coordinates;
+    extractor::files::readNodeCoordinates(config.GetPath(".osrm.nbg_nodes"), coordinates);
+    extractor::SegmentDataContainer segment_data;
+    extractor::files::readSegmentData(config.GetPath(".osrm.geometry"), segment_data);
+
+    std::vector<EdgeDistance> node_distances(number_of_edge_based_nodes);
+    tbb::parallel_for(
+        tbb::blocked_range<EdgeID>(0, number_of_edge_based_nodes),
+        [&](const tbb::blocked_range<EdgeID> &range) {
+            for (auto node = range.begin(); node < range.end(); ++node)
+            {
+                const auto geometry =
+                    segment_data.GetForwardGeometry(node_data.GetGeometryID(node).id);
+                EdgeDistance distance = 0;
+                for (auto current = geometry.begin(); current < geometry.end() - 1; ++current)
+                {
+                    distance += util::coordinate_calculation::fccApproximateDistance(
+                        coordinates[*current], coordinates[*std::next(current)]);
+                }
+                node_distances[node] = distance;
+            }
+        });
+    return node_distances;
+}
+}
+
 int Contractor::Run()
 {
     tbb::task_scheduler_init init(config.requested_num_threads);
@@ -87,6 +126,7 @@ int Contractor::Run()
 
     std::string metric_name;
     std::vector<std::vector<bool>> node_filters;
+    std::vector<EdgeDistance> node_distances;
     {
         extractor::EdgeBasedNodeDataContainer node_data;
         extractor::files::readNodeData(config.GetPath(".osrm.ebg_nodes"), node_data);
@@ -97,13 +137,16 @@ int Contractor::Run()
 
         node_filters =
             util::excludeFlagsToNodeFilter(number_of_edge_based_nodes, node_data, properties);
+
+        node_distances = computeNodeDistances(config, node_data, number_of_edge_based_nodes);
     }
 
     QueryGraph query_graph;
     std::vector<std::vector<bool>> edge_filters;
     std::vector<std::vector<bool>> cores;
     std::tie(query_graph, edge_filters) = contractExcludableGraph(
-        toContractorGraph(number_of_edge_based_nodes, std::move(edge_based_edge_list)),
+        toContractorGraph(
+            number_of_edge_based_nodes, std::move(edge_based_edge_list), node_distances),
         std::move(node_weights),
         std::move(node_filters));
     TIMER_STOP(contraction);
@@ -0,0 +1,102 @@
+#include "engine/api/pbf_factory.hpp"
+
+#include "extractor/travel_mode.hpp"
+#include "guidance/turn_instruction.hpp"
+
+#include "engine/api/json_factory.hpp"
+
+#include <boost/assert.hpp>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+
+namespace osrm
+{
+namespace engine
+{
+namespace api
+{
+namespace pbf
+{
+
+void writeStepManeuver(protozero::pbf_writer &writer, const guidance::StepManeuver &step_maneuver)
+{
+    std::string maneuver_type;
+    if (step_maneuver.waypoint_type == guidance::WaypointType::None)
+        maneuver_type = osrm::guidance::instructionTypeToString(step_maneuver.instruction.type);
+    else
+        maneuver_type = json::detail::waypointTypeToString(step_maneuver.waypoint_type);
+
+    // These invalid responses should never happen: log if they do happen
+    BOOST_ASSERT_MSG(maneuver_type != "invalid", "unexpected invalid maneuver type");
+
+    writer.add_string(maneuver::type, maneuver_type);
+    if (json::detail::isValidModifier(step_maneuver))
+    {
+        writer.add_string(maneuver::modifier,
+                          osrm::guidance::instructionModifierToString(
+                              step_maneuver.instruction.direction_modifier));
+    }
+    writeLocation(writer, maneuver::location, step_maneuver.location);
+    writer.add_uint32(maneuver::bearing_before,
+                      static_cast<std::uint32_t>(
+                          json::detail::roundAndClampBearing(step_maneuver.bearing_before)));
+    writer.add_uint32(maneuver::bearing_after,
+                      static_cast<std::uint32_t>(
+                          json::detail::roundAndClampBearing(step_maneuver.bearing_after)));
+    if (step_maneuver.exit != 0)
+    {
+        writer.add_uint32(maneuver::exit, step_maneuver.exit);
+    }
+}
+
+namespace detail
+{
+void writeRouteStepProperties(protozero::pbf_writer &writer, const guidance::RouteStep &route_step)
+{
+    writer.add_double(step::distance, std::round(route_step.distance * 10) / 10.);
+    writer.add_double(step::duration, route_step.duration);
+    writer.add_double(step::weight, route_step.weight);
+    writer.add_string(step::name, route_step.name);
+    if (!route_step.ref.empty())
+        writer.add_string(step::ref, route_step.ref);
+    if (!route_step.pronunciation.empty())
+        writer.add_string(step::pronunciation, route_step.pronunciation);
+    if (!route_step.destinations.empty())
+        writer.add_string(step::destinations, route_step.destinations);
+    if (!route_step.exits.empty())
+        writer.add_string(step::exits, route_step.exits);
+    if (!route_step.rotary_name.empty())
+    {
+        writer.add_string(step::rotary_name, route_step.rotary_name);
+        if (!route_step.rotary_pronunciation.empty())
+            writer.add_string(step::rotary_pronunciation, route_step.rotary_pronunciation);
+    }
+    writer.add_string(step::mode, extractor::travelModeToString(route_step.mode));
+    writer.add_string(step::driving_side, route_step.is_left_hand_driving ? "left" : "right");
+}
+} // namespace detail
+
+void writeRouteLeg(protozero::pbf_writer &writer, const guidance::RouteLeg &route_leg)
+{
+    writer.add_double(leg::distance, route_leg.distance);
+    writer.add_double(leg::duration, route_leg.duration);
+    writer.add_double(leg::weight, route_leg.weight);
+    writer.add_string(leg::summary, route_leg.summary);
+}
+
+void writeRoute(protozero::pbf_writer &writer,
+                const guidance::Route &guidance_route,
+                const char *weight_name)
+{
+    writer.add_double(route::distance, guidance_route.distance);
+    writer.add_double(route::duration, guidance_route.duration);
+    writer.add_double(route::weight, guidance_route.weight);
+    writer.add_string(route::weight_name, weight_name);
+}
+
+} // namespace pbf
+} // namespace api
+} // namespace engine
+} // namespace osrm
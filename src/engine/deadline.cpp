@@ -0,0 +1,33 @@
+#include "engine/deadline.hpp"
+
+#include <boost/thread/tss.hpp>
+
+namespace osrm
+{
+namespace engine
+{
+
+constexpr std::uint32_t Deadline::CHECK_INTERVAL;
+
+Deadline Deadline::ForQuery(const int default_timeout, const boost::optional<unsigned> &timeout)
+{
+    // wide enough for both, a request budget beyond the range of int must not turn negative
+    std::int64_t budget = default_timeout;
+    if (timeout && (budget < 0 || *timeout < budget))
+    {
+        budget = *timeout;
+    }
+    return budget < 0 ? Deadline{} : Deadline{std::chrono::milliseconds(budget)};
+}
+
+Deadline &Deadline::Current()
+{
+    static boost::thread_specific_ptr<Deadline> current;
+    if (!current.get())
+    {
+        current.reset(new Deadline());
+    }
+    return *current;
+}
+}
+}
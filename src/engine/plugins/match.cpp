@@ -110,6 +110,290 @@ void filterCandidates(const std::vector<util::Coordinate> &coordinates,
     }
 }
 
+// Appends the points of a request to the kept points of a session. Bearings, radiuses and
+// approaches that are only given for some of the points are unset for the others.
+void appendPoints(api::MatchParameters &points, const api::MatchParameters &parameters)
+{
+    const auto number_of_kept_points = points.coordinates.size();
+    const auto append = [&](auto &kept_values, const auto &appended_values) {
+        if (kept_values.empty() && appended_values.empty())
+        {
+            return;
+        }
+        kept_values.resize(number_of_kept_points);
+        if (appended_values.empty())
+        {
+            kept_values.resize(number_of_kept_points + parameters.coordinates.size());
+        }
+        else
+        {
+            kept_values.insert(kept_values.end(), appended_values.begin(), appended_values.end());
+        }
+    };
+    append(points.bearings, parameters.bearings);
+    append(points.radiuses, parameters.radiuses);
+    append(points.approaches, parameters.approaches);
+    points.timestamps.insert(
+        points.timestamps.end(), parameters.timestamps.begin(), parameters.timestamps.end());
+    points.coordinates.insert(
+        points.coordinates.end(), parameters.coordinates.begin(), parameters.coordinates.end());
+}
+
+// Keeps the points from index first_point on
+void dropPoints(api::MatchParameters &points, const std::size_t first_point)
+{
+    const auto drop = [first_point](auto &values) {
+        if (!values.empty())
+        {
+            values.erase(values.begin(), values.begin() + first_point);
+        }
+    };
+    drop(points.coordinates);
+    drop(points.bearings);
+    drop(points.radiuses);
+    drop(points.approaches);
+    drop(points.timestamps);
+}
+
+InternalRouteResult routeSubMatching(const RoutingAlgorithmsInterface &algorithms,
+                                     const map_matching::SubMatching &sub_matching)
+{
+    BOOST_ASSERT(sub_matching.nodes.size() > 1);
+
+    // FIXME we only run this to obtain the geometry
+    // The clean way would be to get this directly from the map matching plugin
+    InternalRouteResult sub_route;
+    PhantomNodes current_phantom_node_pair;
+    for (unsigned i = 0; i < sub_matching.nodes.size() - 1; ++i)
+    {
+        current_phantom_node_pair.source_phantom = sub_matching.nodes[i];
+        current_phantom_node_pair.target_phantom = sub_matching.nodes[i + 1];
+        BOOST_ASSERT(current_phantom_node_pair.source_phantom.IsValid());
+        BOOST_ASSERT(current_phantom_node_pair.target_phantom.IsValid());
+        sub_route.segment_end_coordinates.emplace_back(current_phantom_node_pair);
+    }
+    // force uturns to be on
+    // we split the phantom nodes anyway and only have bi-directional phantom nodes for
+    // possible uturns
+    sub_route = algorithms.ShortestPathSearch(sub_route.segment_end_coordinates, {false}, 1);
+    BOOST_ASSERT(sub_route.shortest_path_weight != INVALID_EDGE_WEIGHT);
+    return sub_route;
+}
+
+MatchPlugin::CandidateLists MatchPlugin::GetCandidates(const datafacade::BaseDataFacade &facade,
+                                                       const api::MatchParameters &parameters) const
+{
+    // assuming radius is the standard deviation of a normal distribution
+    // that models GPS noise (in this model), x3 should give us the correct
+    // search radius with > 99% confidence
+    std::vector<double> search_radiuses;
+    if (parameters.radiuses.empty())
+    {
+        search_radiuses.resize(parameters.coordinates.size(),
+                               routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER);
+    }
+    else
+    {
+        search_radiuses.resize(parameters.coordinates.size());
+        std::transform(parameters.radiuses.begin(),
+                       parameters.radiuses.end(),
+                       search_radiuses.begin(),
+                       [](const boost::optional<double> &maybe_radius) {
+                           if (maybe_radius)
+                           {
+                               return *maybe_radius * RADIUS_MULTIPLIER;
+                           }
+                           else
+                           {
+                               return routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER;
+                           }
+
+                       });
+    }
+
+    auto candidates_lists = GetPhantomNodesInRange(facade, parameters, search_radiuses);
+
+    filterCandidates(parameters.coordinates, candidates_lists);
+    return candidates_lists;
+}
+
+std::shared_ptr<MatchPlugin::Session>
+MatchPlugin::GetSession(const api::MatchParameters &parameters) const
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(sessions_mutex);
+    if (session_timeout > 0 && now - last_sessions_sweep >= std::chrono::seconds(1))
+    {
+        for (auto session = sessions.begin(); session != sessions.end();)
+        {
+            if (now - session->second->last_used > std::chrono::seconds(session_timeout))
+            {
+                session = sessions.erase(session);
+            }
+            else
+            {
+                ++session;
+            }
+        }
+        last_sessions_sweep = now;
+    }
+
+    auto found = sessions.find(parameters.session);
+    if (found == sessions.end())
+    {
+        // closing an unknown session or no room for a new one
+        if (parameters.coordinates.empty() || sessions.size() >= max_sessions)
+        {
+            return {};
+        }
+        found = sessions.emplace(parameters.session, std::make_shared<Session>()).first;
+    }
+    found->second->last_used = now;
+    return found->second;
+}
+
+Status MatchPlugin::HandleSessionRequest(const RoutingAlgorithmsInterface &algorithms,
+                                         const api::MatchParameters &parameters,
+                                         util::json::Object &json_result) const
+{
+    if (max_sessions == 0)
+    {
+        return Error("NotImplemented", "Match sessions are disabled.", json_result);
+    }
+
+    const auto session = GetSession(parameters);
+    if (!session)
+    {
+        if (parameters.coordinates.empty())
+        {
+            return Error("InvalidValue", "Unknown session.", json_result);
+        }
+        return Error("TooBig", "Too many match sessions", json_result);
+    }
+
+    std::lock_guard<std::mutex> session_lock(session->mutex);
+    auto &points = session->points;
+
+    if (!points.coordinates.empty() && !parameters.coordinates.empty())
+    {
+        if (points.timestamps.empty() != parameters.timestamps.empty())
+        {
+            return Error("InvalidValue",
+                         "Timestamps need to be given for all points of a session.",
+                         json_result);
+        }
+        if (!points.timestamps.empty() &&
+            parameters.timestamps.front() < points.timestamps.back())
+        {
+            return Error(
+                "InvalidValue", "Timestamps need to be monotonically increasing.", json_result);
+        }
+    }
+
+    const auto &facade = algorithms.GetFacade();
+
+    // the candidates of the kept points are only valid on the facade they were found on
+    if (!session->state || !algorithms.IsPreparedOnFacade(*session->state))
+    {
+        auto state = std::make_unique<routing_algorithms::MapMatchingState>();
+        state->first_index = session->state ? session->state->first_index : 0;
+        state->candidates_list = GetCandidates(facade, points);
+        session->state = std::move(state);
+    }
+    auto &state = *session->state;
+
+    auto candidates_lists = GetCandidates(facade, parameters);
+    const auto trace_begin = state.first_index;
+    const auto first_new_point = trace_begin + points.coordinates.size();
+    appendPoints(points, parameters);
+    state.candidates_list.insert(state.candidates_list.end(),
+                                 std::make_move_iterator(candidates_lists.begin()),
+                                 std::make_move_iterator(candidates_lists.end()));
+    state.trace_coordinates = points.coordinates;
+    state.trace_timestamps = points.timestamps;
+    state.trace_gps_precision = points.radiuses;
+
+    SubMatchingList sub_matchings;
+    try
+    {
+        sub_matchings = algorithms.MapMatching(
+            state,
+            parameters.gaps == api::MatchParameters::GapsType::Split,
+            parameters.close_session,
+            std::max(max_locations_map_matching, 0));
+    }
+    catch (...)
+    {
+        // The state is only partly updated, the kept points are matched again by the next
+        // request. The appended points are dropped, the request can be repeated.
+        const auto remove_appended = [&](auto &values) {
+            if (!values.empty())
+            {
+                values.resize(first_new_point - trace_begin);
+            }
+        };
+        remove_appended(points.coordinates);
+        remove_appended(points.bearings);
+        remove_appended(points.radiuses);
+        remove_appended(points.approaches);
+        remove_appended(points.timestamps);
+        session->state = std::make_unique<routing_algorithms::MapMatchingState>();
+        session->state->first_index = trace_begin;
+        throw;
+    }
+
+    // the tracepoints of the response start with the first point of its matchings
+    auto response_begin = first_new_point;
+    for (const auto &sub_matching : sub_matchings)
+    {
+        response_begin = std::min<std::size_t>(response_begin, sub_matching.indices.front());
+    }
+    for (auto &sub_matching : sub_matchings)
+    {
+        for (auto &index : sub_matching.indices)
+        {
+            index -= response_begin;
+        }
+    }
+
+    api::MatchParameters response_parameters = parameters;
+    response_parameters.coordinates.assign(points.coordinates.begin() +
+                                               (response_begin - trace_begin),
+                                           points.coordinates.end());
+    response_parameters.hints.clear();
+    response_parameters.bearings.clear();
+    response_parameters.radiuses.clear();
+    response_parameters.approaches.clear();
+    response_parameters.timestamps.clear();
+
+    std::vector<InternalRouteResult> sub_routes;
+    sub_routes.reserve(sub_matchings.size());
+    for (const auto &sub_matching : sub_matchings)
+    {
+        sub_routes.push_back(routeSubMatching(algorithms, sub_matching));
+    }
+
+    const auto tidied = api::tidy::keep_all(response_parameters);
+    api::MatchAPI match_api{facade, response_parameters, tidied};
+    match_api.MakeResponse(sub_matchings, sub_routes, json_result);
+    json_result.values["tracepoints_offset"] = response_begin;
+
+    dropPoints(points, state.first_index - trace_begin);
+
+    if (parameters.close_session)
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex);
+        const auto found = sessions.find(parameters.session);
+        if (found != sessions.end() && found->second == session)
+        {
+            sessions.erase(found);
+        }
+    }
+
+    return Status::Ok;
+}
+
 Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                   const api::MatchParameters &parameters,
                                   util::json::Object &json_result) const
@@ -162,6 +446,11 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
             "InvalidValue", "Timestamps need to be monotonically increasing.", json_result);
     }
 
+    if (!parameters.session.empty())
+    {
+        return HandleSessionRequest(algorithms, parameters, json_result);
+    }
+
     SubMatchingList sub_matchings;
     api::tidy::Result tidied;
     if (parameters.tidy)
@@ -185,37 +474,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                      json_result);
     }
 
-    // assuming radius is the standard deviation of a normal distribution
-    // that models GPS noise (in this model), x3 should give us the correct
-    // search radius with > 99% confidence
-    std::vector<double> search_radiuses;
-    if (tidied.parameters.radiuses.empty())
-    {
-        search_radiuses.resize(tidied.parameters.coordinates.size(),
-                               routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER);
-    }
-    else
-    {
-        search_radiuses.resize(tidied.parameters.coordinates.size());
-        std::transform(tidied.parameters.radiuses.begin(),
-                       tidied.parameters.radiuses.end(),
-                       search_radiuses.begin(),
-                       [](const boost::optional<double> &maybe_radius) {
-                           if (maybe_radius)
-                           {
-                               return *maybe_radius * RADIUS_MULTIPLIER;
-                           }
-                           else
-                           {
-                               return routing_algorithms::DEFAULT_GPS_PRECISION * RADIUS_MULTIPLIER;
-                           }
-
-                       });
-    }
-
-    auto candidates_lists = GetPhantomNodesInRange(facade, tidied.parameters, search_radiuses);
-
-    filterCandidates(tidied.parameters.coordinates, candidates_lists);
+    auto candidates_lists = GetCandidates(facade, tidied.parameters);
     if (std::all_of(candidates_lists.begin(),
                     candidates_lists.end(),
                     [](const std::vector<PhantomNodeWithDistance> &candidates) {
@@ -271,25 +530,7 @@ Status MatchPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     std::vector<InternalRouteResult> sub_routes(sub_matchings.size());
     for (auto index : util::irange<std::size_t>(0UL, sub_matchings.size()))
     {
-        BOOST_ASSERT(sub_matchings[index].nodes.size() > 1);
-
-        // FIXME we only run this to obtain the geometry
-        // The clean way would be to get this directly from the map matching plugin
-        PhantomNodes current_phantom_node_pair;
-        for (unsigned i = 0; i < sub_matchings[index].nodes.size() - 1; ++i)
-        {
-            current_phantom_node_pair.source_phantom = sub_matchings[index].nodes[i];
-            current_phantom_node_pair.target_phantom = sub_matchings[index].nodes[i + 1];
-            BOOST_ASSERT(current_phantom_node_pair.source_phantom.IsValid());
-            BOOST_ASSERT(current_phantom_node_pair.target_phantom.IsValid());
-            sub_routes[index].segment_end_coordinates.emplace_back(current_phantom_node_pair);
-        }
-        // force uturns to be on
-        // we split the phantom nodes anyway and only have bi-directional phantom nodes for
-        // possible uturns
-        sub_routes[index] =
-            algorithms.ShortestPathSearch(sub_routes[index].segment_end_coordinates, {false});
-        BOOST_ASSERT(sub_routes[index].shortest_path_weight != INVALID_EDGE_WEIGHT);
+        sub_routes[index] = routeSubMatching(algorithms, sub_matchings[index]);
         if (collapse_legs)
         {
             std::vector<bool> waypoint_legs;
@@ -21,7 +21,29 @@ NearestPlugin::NearestPlugin(const int max_results_) : max_results{max_results_}
 
 Status NearestPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                     const api::NearestParameters &params,
-                                    util::json::Object &json_result) const
+                                    util::json::Object &result) const
+{
+    return HandleRequestImpl(algorithms, params, result);
+}
+
+Status NearestPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                    const api::NearestParameters &params,
+                                    util::json::Buffer &result) const
+{
+    return HandleRequestImpl(algorithms, params, result);
+}
+
+Status NearestPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                    const api::NearestParameters &params,
+                                    std::string &result) const
+{
+    return HandleRequestImpl(algorithms, params, result);
+}
+
+template <typename ResultT>
+Status NearestPlugin::HandleRequestImpl(const RoutingAlgorithmsInterface &algorithms,
+                                        const api::NearestParameters &params,
+                                        ResultT &json_result) const
 {
     BOOST_ASSERT(params.IsValid());
 
@@ -56,7 +78,7 @@ Status NearestPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms
     BOOST_ASSERT(phantom_nodes.front().size() > 0);
 
     api::NearestAPI nearest_api(facade, params);
-    nearest_api.MakeResponse(phantom_nodes, json_result);
+    MakeResponse(nearest_api, json_result, phantom_nodes);
 
     return Status::Ok;
 }
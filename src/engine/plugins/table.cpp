@@ -5,12 +5,15 @@
 #include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/search_engine_data.hpp"
 #include "util/json_container.hpp"
+#include "util/json_writer.hpp"
 #include "util/string_util.hpp"
 
 #include <cstdlib>
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -23,14 +26,67 @@ namespace engine
 namespace plugins
 {
 
-TablePlugin::TablePlugin(const int max_locations_distance_table)
-    : max_locations_distance_table(max_locations_distance_table)
+namespace
+{
+// Cells of a block of rows of a streamed table, the rows are rendered and sent after each block
+const constexpr std::size_t STREAMED_TABLE_BLOCK_CELLS = 1 << 18;
+
+// The parameters of the response to a request to a target set, whose targets follow the
+// snapped coordinates. Sources and destinations are explicit so neither includes the other.
+api::TableParameters makeTargetSetParameters(const api::TableParameters &params,
+                                             const std::size_t number_of_targets)
+{
+    auto target_set_params = params;
+    if (target_set_params.sources.empty())
+    {
+        target_set_params.sources.resize(params.coordinates.size());
+        std::iota(target_set_params.sources.begin(), target_set_params.sources.end(), 0);
+    }
+    target_set_params.destinations.resize(number_of_targets);
+    std::iota(target_set_params.destinations.begin(),
+              target_set_params.destinations.end(),
+              params.coordinates.size());
+    return target_set_params;
+}
+}
+
+TablePlugin::TablePlugin(const int max_locations_distance_table,
+                         const unsigned max_threads,
+                         const unsigned max_target_sets,
+                         const unsigned max_snapping_threads)
+    : BasePlugin(max_snapping_threads), max_locations_distance_table(max_locations_distance_table),
+      max_threads(max_threads), max_target_sets(max_target_sets)
 {
 }
 
 Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                   const api::TableParameters &params,
                                   util::json::Object &result) const
+{
+    return HandleRequestImpl(algorithms, params, result);
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  util::json::Buffer &result) const
+{
+    return HandleRequestImpl(algorithms, params, result);
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  std::string &result) const
+{
+    return HandleRequestImpl(algorithms, params, result);
+}
+
+template <typename ResultT>
+Status
+TablePlugin::SnapRequest(const RoutingAlgorithmsInterface &algorithms,
+                         const api::TableParameters &params,
+                         std::vector<PhantomNode> &snapped_phantoms,
+                         std::shared_ptr<const routing_algorithms::ManyToManyTargets> &targets,
+                         ResultT &result) const
 {
     if (!algorithms.HasManyToManySearch())
     {
@@ -52,12 +108,21 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
             "InvalidOptions", "Number of bearings does not match number of coordinates", result);
     }
 
+    if (!params.target_set.empty() && !params.register_target_set)
+    {
+        const auto status = GetTargetSet(algorithms, params.target_set, targets, result);
+        if (status != Status::Ok)
+            return status;
+    }
+
     // Empty sources or destinations means the user wants all of them included, respectively
     // The ManyToMany routing algorithm we dispatch to below already handles this perfectly.
     const auto num_sources =
         params.sources.empty() ? params.coordinates.size() : params.sources.size();
     const auto num_destinations =
-        params.destinations.empty() ? params.coordinates.size() : params.destinations.size();
+        targets ? targets->GetPhantomNodes().size()
+                : params.destinations.empty() ? params.coordinates.size()
+                                              : params.destinations.size();
 
     if (max_locations_distance_table > 0 &&
         ((num_sources * num_destinations) >
@@ -80,12 +145,10 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                      result);
     }
 
-    auto snapped_phantoms = SnapPhantomNodes(phantom_nodes);
-
-    bool request_distance = params.annotations & api::TableParameters::AnnotationsType::Distance;
-    bool request_duration = params.annotations & api::TableParameters::AnnotationsType::Duration;
+    snapped_phantoms = SnapPhantomNodes(phantom_nodes);
 
-    if (request_distance && !algorithms.SupportsDistanceAnnotationType())
+    if ((params.annotations & api::TableParameters::AnnotationsType::Distance) &&
+        !algorithms.SupportsDistanceAnnotationType())
     {
         return Error("NotImplemented",
                      "The distance annotations calculation is not implemented for the chosen "
@@ -93,8 +156,157 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                      result);
     }
 
-    auto result_tables_pair = algorithms.ManyToManySearch(
-        snapped_phantoms, params.sources, params.destinations, request_distance, request_duration);
+    return Status::Ok;
+}
+
+template <typename ResultT>
+Status
+TablePlugin::GetTargetSet(const RoutingAlgorithmsInterface &algorithms,
+                          const std::string &name,
+                          std::shared_ptr<const routing_algorithms::ManyToManyTargets> &targets,
+                          ResultT &result) const
+{
+    std::shared_ptr<const TargetSet> target_set;
+    {
+        std::lock_guard<std::mutex> lock(target_sets_mutex);
+        const auto found = target_sets.find(name);
+        if (found != target_sets.end())
+            target_set = found->second;
+    }
+    if (!target_set)
+    {
+        return Error("InvalidOptions", "Target set " + name + " is not registered", result);
+    }
+
+    for (const auto &prepared : target_set->prepared)
+    {
+        if (algorithms.IsPreparedOnFacade(*prepared))
+        {
+            targets = prepared;
+            return Status::Ok;
+        }
+    }
+
+    // The set was registered on another dataset or for other exclude flags
+    std::vector<PhantomNode> phantoms;
+    std::shared_ptr<const routing_algorithms::ManyToManyTargets> no_targets;
+    const auto status =
+        SnapRequest(algorithms, target_set->parameters, phantoms, no_targets, result);
+    if (status != Status::Ok)
+        return status;
+    targets = algorithms.PrepareManyToManyTargets(phantoms, max_threads);
+
+    auto updated_set = std::make_shared<TargetSet>(TargetSet{target_set->parameters, {targets}});
+    for (const auto &prepared : target_set->prepared)
+    {
+        if (!prepared->facade.expired())
+            updated_set->prepared.push_back(prepared);
+    }
+
+    std::lock_guard<std::mutex> lock(target_sets_mutex);
+    const auto found = target_sets.find(name);
+    // unless the set was registered again in the meantime
+    if (found != target_sets.end() && found->second == target_set)
+        found->second = std::move(updated_set);
+
+    return Status::Ok;
+}
+
+template <typename ResultT>
+Status TablePlugin::RegisterTargetSet(const RoutingAlgorithmsInterface &algorithms,
+                                      const api::TableParameters &params,
+                                      ResultT &result) const
+{
+    const auto is_full = [this, &params] {
+        return target_sets.size() >= max_target_sets && target_sets.count(params.target_set) == 0;
+    };
+    {
+        std::lock_guard<std::mutex> lock(target_sets_mutex);
+        if (is_full())
+            return Error("TooBig", "Too many target sets", result);
+    }
+
+    std::vector<PhantomNode> phantoms;
+    std::shared_ptr<const routing_algorithms::ManyToManyTargets> no_targets;
+    const auto status = SnapRequest(algorithms, params, phantoms, no_targets, result);
+    if (status != Status::Ok)
+        return status;
+
+    // The targets are prepared with all annotations, the facade is chosen by each request
+    auto target_set = std::make_shared<TargetSet>();
+    target_set->parameters = params;
+    target_set->parameters.annotations = api::TableParameters::AnnotationsType::Duration;
+    target_set->parameters.exclude.clear();
+    target_set->prepared.push_back(algorithms.PrepareManyToManyTargets(phantoms, max_threads));
+
+    {
+        std::lock_guard<std::mutex> lock(target_sets_mutex);
+        if (is_full())
+            return Error("TooBig", "Too many target sets", result);
+        target_sets[params.target_set] = std::move(target_set);
+    }
+
+    api::TableAPI table_api{algorithms.GetFacade(), params};
+    MakeResponse(table_api, result, phantoms);
+
+    return Status::Ok;
+}
+
+template <typename ResultT>
+Status TablePlugin::HandleRequestImpl(const RoutingAlgorithmsInterface &algorithms,
+                                      const api::TableParameters &params,
+                                      ResultT &result) const
+{
+    if (params.register_target_set)
+        return RegisterTargetSet(algorithms, params, result);
+
+    std::vector<PhantomNode> snapped_phantoms;
+    std::shared_ptr<const routing_algorithms::ManyToManyTargets> targets;
+    const auto status = SnapRequest(algorithms, params, snapped_phantoms, targets, result);
+    if (status != Status::Ok)
+        return status;
+
+    bool request_distance = params.annotations & api::TableParameters::AnnotationsType::Distance;
+    bool request_duration = params.annotations & api::TableParameters::AnnotationsType::Duration;
+
+    if (targets)
+    {
+        // A single block holds the whole table
+        std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>> result_tables_pair;
+        const auto number_of_sources =
+            params.sources.empty() ? snapped_phantoms.size() : params.sources.size();
+        algorithms.ManyToManyTargetsBlockSearch(
+            snapped_phantoms,
+            params.sources,
+            *targets,
+            request_distance,
+            request_duration,
+            max_threads,
+            number_of_sources,
+            [&result_tables_pair](const std::size_t,
+                                  std::vector<EdgeDuration> &durations,
+                                  std::vector<EdgeDistance> &distances) {
+                result_tables_pair.first.swap(durations);
+                result_tables_pair.second.swap(distances);
+            });
+
+        const auto target_set_params =
+            makeTargetSetParameters(params, targets->GetPhantomNodes().size());
+        snapped_phantoms.insert(snapped_phantoms.end(),
+                                targets->GetPhantomNodes().begin(),
+                                targets->GetPhantomNodes().end());
+
+        api::TableAPI table_api{algorithms.GetFacade(), target_set_params};
+        MakeResponse(table_api, result, result_tables_pair, snapped_phantoms);
+        return Status::Ok;
+    }
+
+    auto result_tables_pair = algorithms.ManyToManySearch(snapped_phantoms,
+                                                          params.sources,
+                                                          params.destinations,
+                                                          request_distance,
+                                                          request_duration,
+                                                          max_threads);
 
     if ((request_duration && result_tables_pair.first.empty()) ||
         (request_distance && result_tables_pair.second.empty()))
@@ -102,8 +314,141 @@ Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
         return Error("NoTable", "No table found", result);
     }
 
-    api::TableAPI table_api{facade, params};
-    table_api.MakeResponse(result_tables_pair, snapped_phantoms, result);
+    api::TableAPI table_api{algorithms.GetFacade(), params};
+    MakeResponse(table_api, result, result_tables_pair, snapped_phantoms);
+
+    return Status::Ok;
+}
+
+Status TablePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                  const api::TableParameters &params,
+                                  util::json::Buffer &result,
+                                  const util::json::BufferConsumer &consume) const
+{
+    if (params.register_target_set)
+        return HandleRequestImpl(algorithms, params, result);
+
+    std::vector<PhantomNode> snapped_phantoms;
+    std::shared_ptr<const routing_algorithms::ManyToManyTargets> targets;
+    const auto status = SnapRequest(algorithms, params, snapped_phantoms, targets, result);
+    if (status != Status::Ok)
+        return status;
+
+    const bool request_distance =
+        params.annotations & api::TableParameters::AnnotationsType::Distance;
+    const bool request_duration =
+        params.annotations & api::TableParameters::AnnotationsType::Duration;
+
+    const auto number_of_destinations =
+        targets ? targets->GetPhantomNodes().size()
+                : params.destinations.empty() ? snapped_phantoms.size()
+                                              : params.destinations.size();
+    BOOST_ASSERT(number_of_destinations > 0);
+    const auto rows_per_block =
+        std::max<std::size_t>(STREAMED_TABLE_BLOCK_CELLS / number_of_destinations, 1);
+
+    // the targets of a set follow the sources in the waypoints of the response
+    api::TableParameters target_set_params;
+    std::vector<PhantomNode> response_phantoms;
+    if (targets)
+    {
+        target_set_params = makeTargetSetParameters(params, number_of_destinations);
+        response_phantoms = snapped_phantoms;
+        response_phantoms.insert(response_phantoms.end(),
+                                 targets->GetPhantomNodes().begin(),
+                                 targets->GetPhantomNodes().end());
+    }
+
+    api::TableAPI table_api{algorithms.GetFacade(), targets ? target_set_params : params};
+    result.clear();
+    util::json::Writer writer(result);
+    table_api.StartResponse(targets ? response_phantoms : snapped_phantoms, writer);
+    consume(result);
+
+    if (request_duration)
+    {
+        writer.Key("durations");
+        writer.StartArray();
+    }
+    else if (request_distance)
+    {
+        writer.Key("distances");
+        writer.StartArray();
+    }
+
+    // The distances follow all durations, their blocks are kept until the durations are written
+    std::vector<std::vector<EdgeDistance>> distance_blocks;
+    const routing_algorithms::ManyToManyRowsHandler write_rows =
+        [&](const std::size_t,
+            std::vector<EdgeDuration> &durations,
+            std::vector<EdgeDistance> &distances) {
+            // algorithms without blocks pass the whole table at once
+            const auto number_of_rows =
+                (request_duration ? durations.size() : distances.size()) / number_of_destinations;
+            if (request_duration)
+            {
+                table_api.WriteDurationRows(
+                    writer, durations, number_of_rows, number_of_destinations);
+                if (request_distance)
+                {
+                    distance_blocks.emplace_back();
+                    distance_blocks.back().swap(distances);
+                }
+            }
+            else if (request_distance)
+            {
+                table_api.WriteDistanceRows(
+                    writer, distances, number_of_rows, number_of_destinations);
+            }
+            consume(result);
+        };
+
+    if (targets)
+    {
+        algorithms.ManyToManyTargetsBlockSearch(snapped_phantoms,
+                                                params.sources,
+                                                *targets,
+                                                request_distance,
+                                                request_duration,
+                                                max_threads,
+                                                rows_per_block,
+                                                write_rows);
+    }
+    else
+    {
+        algorithms.ManyToManyBlockSearch(snapped_phantoms,
+                                         params.sources,
+                                         params.destinations,
+                                         request_distance,
+                                         request_duration,
+                                         max_threads,
+                                         rows_per_block,
+                                         write_rows);
+    }
+
+    if (request_duration || request_distance)
+    {
+        writer.EndArray();
+    }
+
+    if (request_duration && request_distance)
+    {
+        writer.Key("distances");
+        writer.StartArray();
+        for (auto &distances : distance_blocks)
+        {
+            table_api.WriteDistanceRows(writer,
+                                        distances,
+                                        distances.size() / number_of_destinations,
+                                        number_of_destinations);
+            std::vector<EdgeDistance>().swap(distances);
+            consume(result);
+        }
+        writer.EndArray();
+    }
+
+    table_api.EndResponse(writer);
+    BOOST_ASSERT(writer.IsComplete());
 
     return Status::Ok;
 }
@@ -85,7 +85,7 @@ InternalRouteResult TripPlugin::ComputeRoute(const RoutingAlgorithmsInterface &a
         BOOST_ASSERT(min_route.segment_end_coordinates.size() == trip.size() - 1);
     }
 
-    min_route = algorithms.ShortestPathSearch(min_route.segment_end_coordinates, {false});
+    min_route = algorithms.ShortestPathSearch(min_route.segment_end_coordinates, {false}, 1);
     BOOST_ASSERT_MSG(min_route.shortest_path_weight < INVALID_EDGE_WEIGHT, "unroutable route");
     return min_route;
 }
@@ -218,8 +218,12 @@ Status TripPlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
     // compute the duration table of all phantom nodes
     auto result_duration_table = util::DistTableWrapper<EdgeWeight>(
         algorithms
-            .ManyToManySearch(
-                snapped_phantoms, {}, {}, /*requestDistance*/ false, /*requestDuration*/ true)
+            .ManyToManySearch(snapped_phantoms,
+                              {},
+                              {},
+                              /*requestDistance*/ false,
+                              /*requestDuration*/ true,
+                              /*maxThreads*/ 1)
             .first,
         number_of_locations);
 
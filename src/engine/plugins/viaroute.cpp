@@ -21,14 +21,33 @@ namespace engine
 namespace plugins
 {
 
-ViaRoutePlugin::ViaRoutePlugin(int max_locations_viaroute, int max_alternatives)
-    : max_locations_viaroute(max_locations_viaroute), max_alternatives(max_alternatives)
+ViaRoutePlugin::ViaRoutePlugin(int max_locations_viaroute,
+                               int max_alternatives,
+                               const unsigned max_threads,
+                               const unsigned max_snapping_threads)
+    : BasePlugin(max_snapping_threads), max_locations_viaroute(max_locations_viaroute),
+      max_alternatives(max_alternatives), max_threads(max_threads)
 {
 }
 
 Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
                                      const api::RouteParameters &route_parameters,
                                      util::json::Object &json_result) const
+{
+    return HandleRequestImpl(algorithms, route_parameters, json_result);
+}
+
+Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithms,
+                                     const api::RouteParameters &route_parameters,
+                                     std::string &pbf_result) const
+{
+    return HandleRequestImpl(algorithms, route_parameters, pbf_result);
+}
+
+template <typename ResultT>
+Status ViaRoutePlugin::HandleRequestImpl(const RoutingAlgorithmsInterface &algorithms,
+                                         const api::RouteParameters &route_parameters,
+                                         ResultT &json_result) const
 {
     BOOST_ASSERT(route_parameters.IsValid());
 
@@ -120,7 +139,8 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
     }
     else
     {
-        routes = algorithms.ShortestPathSearch(start_end_nodes, route_parameters.continue_straight);
+        routes = algorithms.ShortestPathSearch(
+            start_end_nodes, route_parameters.continue_straight, max_threads);
     }
 
     // The post condition for all path searches is we have at least one route in our result.
@@ -132,7 +152,7 @@ Status ViaRoutePlugin::HandleRequest(const RoutingAlgorithmsInterface &algorithm
 
     if (routes.routes[0].is_valid())
     {
-        route_api.MakeResponse(routes, json_result);
+        MakeResponse(route_api, json_result, routes);
     }
     else
     {
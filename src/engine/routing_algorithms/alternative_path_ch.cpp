@@ -161,7 +161,7 @@ void computeWeightAndSharingOfViaPath(SearchEngineData<Algorithm> &engine_workin
                                       const std::vector<NodeID> &packed_shortest_path,
                                       const EdgeWeight min_edge_offset)
 {
-    engine_working_data.InitializeOrClearSecondThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearSecondHeaps(facade.GetNumberOfNodes());
 
     auto &existing_forward_heap = *engine_working_data.forward_heap_1;
     auto &existing_reverse_heap = *engine_working_data.reverse_heap_1;
@@ -521,7 +521,7 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
 
     t_test_path_weight += unpacked_until_weight;
     // Run actual T-Test query and compare if weight equal.
-    engine_working_data.InitializeOrClearThirdThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearThirdHeaps(facade.GetNumberOfNodes());
 
     QueryHeap &forward_heap3 = *engine_working_data.forward_heap_3;
     QueryHeap &reverse_heap3 = *engine_working_data.reverse_heap_3;
@@ -530,9 +530,11 @@ bool viaNodeCandidatePassesTTest(SearchEngineData<Algorithm> &engine_working_dat
 
     forward_heap3.Insert(s_P, 0, s_P);
     reverse_heap3.Insert(t_P, 0, t_P);
+    auto &deadline = Deadline::Current();
     // exploration from s and t until deletemin/(1+epsilon) > _lengt_oO_sShortest_path
     while ((forward_heap3.Size() + reverse_heap3.Size()) > 0)
     {
+        deadline.Check();
         if (!forward_heap3.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -577,9 +579,9 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
     std::vector<SearchSpaceEdge> reverse_search_space;
 
     // Init queues, semi-expensive because access to TSS invokes a sys-call
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
-    engine_working_data.InitializeOrClearSecondThreadLocalStorage(facade.GetNumberOfNodes());
-    engine_working_data.InitializeOrClearThirdThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearSecondHeaps(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearThirdHeaps(facade.GetNumberOfNodes());
 
     auto &forward_heap1 = *engine_working_data.forward_heap_1;
     auto &reverse_heap1 = *engine_working_data.reverse_heap_1;
@@ -598,9 +600,11 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &engi
 
     insertNodesInHeaps(forward_heap1, reverse_heap1, phantom_node_pair);
 
+    auto &deadline = Deadline::Current();
     // search from s and t till new_min/(1+epsilon) > weight_of_shortest_path
     while (0 < (forward_heap1.Size() + reverse_heap1.Size()))
     {
+        deadline.Check();
         if (0 < forward_heap1.Size())
         {
             alternativeRoutingStep<FORWARD_DIRECTION>(facade,
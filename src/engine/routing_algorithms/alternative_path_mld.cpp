@@ -686,8 +686,10 @@ makeCandidateVias(SearchEngineData<Algorithm> &search_engine_data,
     EdgeWeight forward_heap_min = forward_heap.MinKey();
     EdgeWeight reverse_heap_min = reverse_heap.MinKey();
 
+    auto &deadline = Deadline::Current();
     while (forward_heap.Size() + reverse_heap.Size() > 0)
     {
+        deadline.Check();
         if (shortest_path_weight != INVALID_EDGE_WEIGHT)
             overlap_weight = shortest_path_weight * parameters.kSearchSpaceOverlapFactor;
 
@@ -786,8 +788,8 @@ InternalManyRoutesResult alternativePathSearch(SearchEngineData<Algorithm> &sear
     const Partition &partition = facade.GetMultiLevelPartition();
 
     // Prepare heaps for usage below. The searches will modify them in-place.
-    search_engine_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes(),
-                                                                facade.GetMaxBorderNodeID() + 1);
+    search_engine_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes(),
+                                                   facade.GetMaxBorderNodeID() + 1);
 
     Heap &forward_heap = *search_engine_data.forward_heap_1;
     Heap &reverse_heap = *search_engine_data.reverse_heap_1;
@@ -0,0 +1,278 @@
+#include "engine/routing_algorithms/bucket_relaxation.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <tuple>
+
+// The vector kernels are compiled for their instruction sets with function attributes and only
+// called if the CPU supports them, the rest of the library keeps the baseline instruction set
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define OSRM_BUCKET_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace osrm
+{
+namespace engine
+{
+namespace routing_algorithms
+{
+
+namespace
+{
+
+// Writes the sum of the bucket if it is better than the entry of its column
+template <typename Metrics>
+inline void relaxBucket(const NodeBuckets &buckets,
+                        const std::size_t index,
+                        const EdgeWeight weight,
+                        const EdgeDuration duration,
+                        const EdgeDistance distance,
+                        const TableRow &row)
+{
+    const auto column = buckets.column_indices[index];
+    const auto new_weight = weight + buckets.weights[index];
+    auto &current_weight = row.weights[column];
+
+    if (Metrics::duration)
+    {
+        const auto new_duration = duration + buckets.durations[index];
+        auto &current_duration = row.durations[column];
+        if (std::tie(new_weight, new_duration) >= std::tie(current_weight, current_duration))
+            return;
+        current_duration = new_duration;
+    }
+    else if (new_weight >= current_weight)
+    {
+        return;
+    }
+
+    current_weight = new_weight;
+    if (Metrics::distance)
+        row.distances[column] = distance + buckets.distances[index];
+}
+
+template <typename Metrics>
+void relaxScalar(const NodeBuckets &buckets,
+                 const std::size_t first_bucket,
+                 const EdgeWeight weight,
+                 const EdgeDuration duration,
+                 const EdgeDistance distance,
+                 const TableRow &row)
+{
+    for (auto index = first_bucket; index < buckets.size; ++index)
+    {
+        relaxBucket<Metrics>(buckets, index, weight, duration, distance, row);
+    }
+}
+
+#ifdef OSRM_BUCKET_KERNELS_X86
+
+// Relaxes the buckets of the lanes set in the mask
+template <typename Metrics>
+inline void relaxLanes(int mask,
+                       const NodeBuckets &buckets,
+                       const std::size_t first_bucket,
+                       const EdgeWeight weight,
+                       const EdgeDuration duration,
+                       const EdgeDistance distance,
+                       const TableRow &row)
+{
+    while (mask != 0)
+    {
+        const auto lane = __builtin_ctz(mask);
+        mask &= mask - 1;
+        relaxBucket<Metrics>(buckets, first_bucket + lane, weight, duration, distance, row);
+    }
+}
+
+// The entries of 4 columns, SSE has no gather instruction
+__attribute__((target("sse4.1"))) inline __m128i gatherSSE41(const std::int32_t *table,
+                                                             const std::uint32_t *columns)
+{
+    auto entries = _mm_cvtsi32_si128(table[columns[0]]);
+    entries = _mm_insert_epi32(entries, table[columns[1]], 1);
+    entries = _mm_insert_epi32(entries, table[columns[2]], 2);
+    return _mm_insert_epi32(entries, table[columns[3]], 3);
+}
+
+// 4 buckets per step
+template <typename Metrics>
+__attribute__((target("sse4.1"))) void relaxSSE41(const NodeBuckets &buckets,
+                                                  const EdgeWeight weight,
+                                                  const EdgeDuration duration,
+                                                  const EdgeDistance distance,
+                                                  const TableRow &row)
+{
+    const auto source_weight = _mm_set1_epi32(weight);
+    const auto source_duration = _mm_set1_epi32(duration);
+
+    std::size_t index = 0;
+    for (; index + 4 <= buckets.size; index += 4)
+    {
+        const auto columns = buckets.column_indices + index;
+        const auto new_weights = _mm_add_epi32(
+            source_weight,
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(buckets.weights + index)));
+        const auto current_weights = gatherSSE41(row.weights, columns);
+
+        auto better = _mm_cmpgt_epi32(current_weights, new_weights);
+        if (Metrics::duration)
+        {
+            const auto new_durations = _mm_add_epi32(
+                source_duration,
+                _mm_loadu_si128(reinterpret_cast<const __m128i *>(buckets.durations + index)));
+            const auto current_durations = gatherSSE41(row.durations, columns);
+            better = _mm_or_si128(better,
+                                  _mm_and_si128(_mm_cmpeq_epi32(current_weights, new_weights),
+                                                _mm_cmpgt_epi32(current_durations, new_durations)));
+        }
+
+        relaxLanes<Metrics>(_mm_movemask_ps(_mm_castsi128_ps(better)),
+                            buckets,
+                            index,
+                            weight,
+                            duration,
+                            distance,
+                            row);
+    }
+
+    relaxScalar<Metrics>(buckets, index, weight, duration, distance, row);
+}
+
+// 8 buckets per step, the entries of their columns are gathered
+template <typename Metrics>
+__attribute__((target("avx2"))) void relaxAVX2(const NodeBuckets &buckets,
+                                               const EdgeWeight weight,
+                                               const EdgeDuration duration,
+                                               const EdgeDistance distance,
+                                               const TableRow &row)
+{
+    const auto source_weight = _mm256_set1_epi32(weight);
+    const auto source_duration = _mm256_set1_epi32(duration);
+
+    std::size_t index = 0;
+    for (; index + 8 <= buckets.size; index += 8)
+    {
+        // column indices are far below 2^31 and are used as signed offsets
+        const auto columns = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(buckets.column_indices + index));
+        const auto new_weights = _mm256_add_epi32(
+            source_weight,
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buckets.weights + index)));
+        const auto current_weights = _mm256_i32gather_epi32(row.weights, columns, 4);
+
+        auto better = _mm256_cmpgt_epi32(current_weights, new_weights);
+        if (Metrics::duration)
+        {
+            const auto new_durations = _mm256_add_epi32(
+                source_duration,
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buckets.durations + index)));
+            const auto current_durations = _mm256_i32gather_epi32(row.durations, columns, 4);
+            better = _mm256_or_si256(
+                better,
+                _mm256_and_si256(_mm256_cmpeq_epi32(current_weights, new_weights),
+                                 _mm256_cmpgt_epi32(current_durations, new_durations)));
+        }
+
+        relaxLanes<Metrics>(_mm256_movemask_ps(_mm256_castsi256_ps(better)),
+                            buckets,
+                            index,
+                            weight,
+                            duration,
+                            distance,
+                            row);
+    }
+
+    relaxScalar<Metrics>(buckets, index, weight, duration, distance, row);
+}
+
+#endif
+} // namespace
+
+bool isSupported(const BucketKernel kernel)
+{
+    switch (kernel)
+    {
+    case BucketKernel::Scalar:
+        return true;
+#ifdef OSRM_BUCKET_KERNELS_X86
+    case BucketKernel::SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case BucketKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+BucketKernel getBucketKernel()
+{
+    static const auto kernel = [] {
+        for (const auto kernel : {BucketKernel::AVX2, BucketKernel::SSE41})
+        {
+            if (isSupported(kernel))
+                return kernel;
+        }
+        return BucketKernel::Scalar;
+    }();
+    return kernel;
+}
+
+template <typename Metrics>
+void relaxBuckets(const NodeBuckets &buckets,
+                  const EdgeWeight weight,
+                  const EdgeDuration duration,
+                  const EdgeDistance distance,
+                  const TableRow &row,
+                  const BucketKernel kernel)
+{
+    BOOST_ASSERT(weight >= 0);
+    BOOST_ASSERT(isSupported(kernel));
+
+    switch (kernel)
+    {
+#ifdef OSRM_BUCKET_KERNELS_X86
+    case BucketKernel::AVX2:
+        relaxAVX2<Metrics>(buckets, weight, duration, distance, row);
+        break;
+    case BucketKernel::SSE41:
+        relaxSSE41<Metrics>(buckets, weight, duration, distance, row);
+        break;
+#endif
+    default:
+        relaxScalar<Metrics>(buckets, 0, weight, duration, distance, row);
+    }
+}
+
+template void relaxBuckets<TableMetrics<true, true>>(const NodeBuckets &,
+                                                     const EdgeWeight,
+                                                     const EdgeDuration,
+                                                     const EdgeDistance,
+                                                     const TableRow &,
+                                                     const BucketKernel);
+template void relaxBuckets<TableMetrics<true, false>>(const NodeBuckets &,
+                                                      const EdgeWeight,
+                                                      const EdgeDuration,
+                                                      const EdgeDistance,
+                                                      const TableRow &,
+                                                      const BucketKernel);
+template void relaxBuckets<TableMetrics<false, true>>(const NodeBuckets &,
+                                                      const EdgeWeight,
+                                                      const EdgeDuration,
+                                                      const EdgeDistance,
+                                                      const TableRow &,
+                                                      const BucketKernel);
+template void relaxBuckets<TableMetrics<false, false>>(const NodeBuckets &,
+                                                       const EdgeWeight,
+                                                       const EdgeDuration,
+                                                       const EdgeDistance,
+                                                       const TableRow &,
+                                                       const BucketKernel);
+
+} // namespace routing_algorithms
+} // namespace engine
+} // namespace osrm
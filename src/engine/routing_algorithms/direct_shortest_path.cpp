@@ -21,7 +21,7 @@ InternalRouteResult directShortestPathSearch(SearchEngineData<ch::Algorithm> &en
                                              const DataFacade<ch::Algorithm> &facade,
                                              const PhantomNodes &phantom_nodes)
 {
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes());
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes());
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
     forward_heap.Clear();
@@ -68,8 +68,8 @@ InternalRouteResult directShortestPathSearch(SearchEngineData<mld::Algorithm> &e
                                              const DataFacade<mld::Algorithm> &facade,
                                              const PhantomNodes &phantom_nodes)
 {
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(facade.GetNumberOfNodes(),
-                                                                 facade.GetMaxBorderNodeID() + 1);
+    engine_working_data.InitializeOrClearFirstHeaps(facade.GetNumberOfNodes(),
+                                                    facade.GetMaxBorderNodeID() + 1);
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
     insertNodesInHeaps(forward_heap, reverse_heap, phantom_nodes);
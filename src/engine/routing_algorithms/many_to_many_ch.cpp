@@ -1,11 +1,23 @@
 #include "engine/routing_algorithms/many_to_many.hpp"
 #include "engine/routing_algorithms/routing_base_ch.hpp"
+#include "engine/search_engine_data_pool.hpp"
+
+#include "util/integer_range.hpp"
 
 #include <boost/assert.hpp>
-#include <boost/range/iterator_range_core.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
+#include <algorithm>
+#include <cstdint>
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace osrm
@@ -18,10 +30,12 @@ namespace routing_algorithms
 namespace ch
 {
 
+template <typename Metrics>
 inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
                           const NodeID node,
                           EdgeWeight &weight,
-                          EdgeDuration &duration)
+                          EdgeDuration &duration,
+                          EdgeDistance &distance)
 { // Special case for CH when contractor creates a loop edge node->node
     BOOST_ASSERT(weight < 0);
 
@@ -32,7 +46,10 @@ inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
         if (new_weight_with_loop >= 0)
         {
             weight = new_weight_with_loop;
-            duration += ch::getLoopWeight<true>(facade, node);
+            if (Metrics::duration)
+                duration += ch::getLoopWeight<true>(facade, node);
+            if (Metrics::distance)
+                distance += ch::getLoopDistance(facade, node);
             return true;
         }
     }
@@ -41,11 +58,58 @@ inline bool addLoopWeight(const DataFacade<ch::Algorithm> &facade,
     return false;
 }
 
-template <bool DIRECTION>
+// Like the generic versions in routing_base.hpp, with the offsets of the requested metrics
+template <typename Metrics>
+void insertSourceInHeap(typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &heap,
+                        const PhantomNode &phantom_node)
+{
+    if (phantom_node.IsValidForwardSource())
+    {
+        heap.Insert(phantom_node.forward_segment_id.id,
+                    -phantom_node.GetForwardWeightPlusOffset(),
+                    {phantom_node.forward_segment_id.id,
+                     Metrics::duration ? -phantom_node.GetForwardDuration() : 0,
+                     Metrics::distance ? -phantom_node.GetForwardDistance() : 0});
+    }
+    if (phantom_node.IsValidReverseSource())
+    {
+        heap.Insert(phantom_node.reverse_segment_id.id,
+                    -phantom_node.GetReverseWeightPlusOffset(),
+                    {phantom_node.reverse_segment_id.id,
+                     Metrics::duration ? -phantom_node.GetReverseDuration() : 0,
+                     Metrics::distance ? -phantom_node.GetReverseDistance() : 0});
+    }
+}
+
+template <typename Metrics>
+void insertTargetInHeap(typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &heap,
+                        const PhantomNode &phantom_node)
+{
+    if (phantom_node.IsValidForwardTarget())
+    {
+        heap.Insert(phantom_node.forward_segment_id.id,
+                    phantom_node.GetForwardWeightPlusOffset(),
+                    {phantom_node.forward_segment_id.id,
+                     Metrics::duration ? phantom_node.GetForwardDuration() : 0,
+                     Metrics::distance ? phantom_node.GetForwardDistance() : 0});
+    }
+    if (phantom_node.IsValidReverseTarget())
+    {
+        heap.Insert(phantom_node.reverse_segment_id.id,
+                    phantom_node.GetReverseWeightPlusOffset(),
+                    {phantom_node.reverse_segment_id.id,
+                     Metrics::duration ? phantom_node.GetReverseDuration() : 0,
+                     Metrics::distance ? phantom_node.GetReverseDistance() : 0});
+    }
+}
+
+// Metrics that are not requested stay 0 in the heap
+template <bool DIRECTION, typename Metrics>
 void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
                         const NodeID node,
                         const EdgeWeight weight,
                         const EdgeDuration duration,
+                        const EdgeDistance distance,
                         typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
                         const PhantomNode &)
 {
@@ -62,82 +126,103 @@ void relaxOutgoingEdges(const DataFacade<Algorithm> &facade,
             const NodeID to = facade.GetTarget(edge);
             const auto edge_weight = data.weight;
 
-            const auto edge_duration = data.duration;
-
             BOOST_ASSERT_MSG(edge_weight > 0, "edge_weight invalid");
             const auto to_weight = weight + edge_weight;
-            const auto to_duration = duration + edge_duration;
+            const auto to_duration = Metrics::duration ? duration + data.duration : 0;
+            const auto to_distance = Metrics::distance ? distance + data.distance : 0;
 
             // New Node discovered -> Add to Heap + Node Info Storage
             if (!query_heap.WasInserted(to))
             {
-                query_heap.Insert(to, to_weight, {node, to_duration});
+                query_heap.Insert(to, to_weight, {node, to_duration, to_distance});
             }
             // Found a shorter Path -> Update weight and set new parent
             else if (std::tie(to_weight, to_duration) <
                      std::tie(query_heap.GetKey(to), query_heap.GetData(to).duration))
             {
-                query_heap.GetData(to) = {node, to_duration};
+                query_heap.GetData(to) = {node, to_duration, to_distance};
                 query_heap.DecreaseKey(to, to_weight);
             }
         }
     }
 }
 
+template <typename Metrics>
 void forwardRoutingStep(const DataFacade<Algorithm> &facade,
                         const std::size_t row_index,
                         const std::size_t number_of_targets,
                         typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
-                        const std::vector<NodeBucket> &search_space_with_buckets,
+                        const NodeBucketIndex &bucket_index,
                         std::vector<EdgeWeight> &weights_table,
                         std::vector<EdgeDuration> &durations_table,
-                        std::vector<NodeID> &middle_nodes_table,
+                        std::vector<EdgeDistance> &distances_table,
                         const PhantomNode &phantom_node)
 {
     const auto node = query_heap.DeleteMin();
     const auto source_weight = query_heap.GetKey(node);
     const auto source_duration = query_heap.GetData(node).duration;
+    const auto source_distance = query_heap.GetData(node).distance;
 
-    // Check if each encountered node has an entry
-    const auto &bucket_list = std::equal_range(search_space_with_buckets.begin(),
-                                               search_space_with_buckets.end(),
-                                               node,
-                                               NodeBucket::Compare());
-    for (const auto &current_bucket : boost::make_iterator_range(bucket_list))
-    {
-        // Get target id from bucket entry
-        const auto column_index = current_bucket.column_index;
-        const auto target_weight = current_bucket.weight;
-        const auto target_duration = current_bucket.duration;
+    const auto buckets = bucket_index.GetBuckets(node);
+    const auto first_location = row_index * number_of_targets;
 
-        auto &current_weight = weights_table[row_index * number_of_targets + column_index];
-        auto &current_duration = durations_table[row_index * number_of_targets + column_index];
+    // Only the nodes of the source's segments have negative weights, all other nodes scan their
+    // buckets with the vector kernels
+    if (source_weight >= 0)
+    {
+        relaxBuckets<Metrics>(
+            buckets,
+            source_weight,
+            source_duration,
+            source_distance,
+            {weights_table.data() + first_location,
+             Metrics::duration ? durations_table.data() + first_location : nullptr,
+             Metrics::distance ? distances_table.data() + first_location : nullptr});
+    }
+    else
+    {
+        for (const auto index : util::irange<std::size_t>(0, buckets.size))
+        {
+            // Entry of the bucket's target in the tables
+            const auto location = first_location + buckets.column_indices[index];
+            auto &current_weight = weights_table[location];
+            // The tables of metrics that are not requested are empty
+            const auto current_duration = Metrics::duration ? durations_table[location] : 0;
 
-        // Check if new weight is better
-        auto new_weight = source_weight + target_weight;
-        auto new_duration = source_duration + target_duration;
+            // Check if new weight is better
+            auto new_weight = source_weight + buckets.weights[index];
+            auto new_duration = source_duration + buckets.durations[index];
+            auto new_distance = source_distance + buckets.distances[index];
 
-        if (new_weight < 0)
-        {
-            if (addLoopWeight(facade, node, new_weight, new_duration))
+            if (new_weight < 0)
             {
-                current_weight = std::min(current_weight, new_weight);
-                current_duration = std::min(current_duration, new_duration);
-                middle_nodes_table[row_index * number_of_targets + column_index] = node;
+                if (addLoopWeight<Metrics>(facade, node, new_weight, new_duration, new_distance))
+                {
+                    current_weight = std::min(current_weight, new_weight);
+                    if (Metrics::duration)
+                        durations_table[location] = std::min(current_duration, new_duration);
+                    if (Metrics::distance)
+                        distances_table[location] =
+                            std::min(distances_table[location], new_distance);
+                }
+            }
+            else if (std::tie(new_weight, new_duration) <
+                     std::tie(current_weight, current_duration))
+            {
+                current_weight = new_weight;
+                if (Metrics::duration)
+                    durations_table[location] = new_duration;
+                if (Metrics::distance)
+                    distances_table[location] = new_distance;
             }
-        }
-        else if (std::tie(new_weight, new_duration) < std::tie(current_weight, current_duration))
-        {
-            current_weight = new_weight;
-            current_duration = new_duration;
-            middle_nodes_table[row_index * number_of_targets + column_index] = node;
         }
     }
 
-    relaxOutgoingEdges<FORWARD_DIRECTION>(
-        facade, node, source_weight, source_duration, query_heap, phantom_node);
+    relaxOutgoingEdges<FORWARD_DIRECTION, Metrics>(
+        facade, node, source_weight, source_duration, source_distance, query_heap, phantom_node);
 }
 
+template <typename Metrics>
 void backwardRoutingStep(const DataFacade<Algorithm> &facade,
                          const unsigned column_index,
                          typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
@@ -147,261 +232,916 @@ void backwardRoutingStep(const DataFacade<Algorithm> &facade,
     const auto node = query_heap.DeleteMin();
     const auto target_weight = query_heap.GetKey(node);
     const auto target_duration = query_heap.GetData(node).duration;
+    const auto target_distance = query_heap.GetData(node).distance;
     const auto parent = query_heap.GetData(node).parent;
 
     // Store settled nodes in search space bucket
     search_space_with_buckets.emplace_back(
-        node, parent, column_index, target_weight, target_duration);
+        node, parent, column_index, target_weight, target_duration, target_distance);
 
-    relaxOutgoingEdges<REVERSE_DIRECTION>(
-        facade, node, target_weight, target_duration, query_heap, phantom_node);
+    relaxOutgoingEdges<REVERSE_DIRECTION, Metrics>(
+        facade, node, target_weight, target_duration, target_distance, query_heap, phantom_node);
 }
 
 } // namespace ch
 
-void retrievePackedPathFromSearchSpace(const NodeID middle_node_id,
-                                       const unsigned column_index,
-                                       const std::vector<NodeBucket> &search_space_with_buckets,
-                                       std::vector<NodeID> &packed_leg)
+namespace
+{
+// Populates buckets with paths from all accessible nodes to the targets of the columns
+template <typename Metrics>
+void backwardSearches(SearchEngineData<ch::Algorithm> &engine_working_data,
+                      const DataFacade<ch::Algorithm> &facade,
+                      const std::vector<PhantomNode> &phantom_nodes,
+                      const std::vector<std::size_t> &target_indices,
+                      const tbb::blocked_range<std::uint32_t> &columns,
+                      Deadline &deadline,
+                      std::vector<NodeBucket> &search_space_with_buckets)
 {
-    auto bucket_list = std::equal_range(search_space_with_buckets.begin(),
-                                        search_space_with_buckets.end(),
-                                        middle_node_id,
-                                        NodeBucket::ColumnCompare(column_index));
+    for (auto column_index = columns.begin(); column_index < columns.end(); ++column_index)
+    {
+        const auto index = target_indices[column_index];
+        const auto &phantom = phantom_nodes[index];
 
-    NodeID current_node_id = middle_node_id;
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes());
+        auto &query_heap = *(engine_working_data.many_to_many_heap);
+        ch::insertTargetInHeap<Metrics>(query_heap, phantom);
 
-    BOOST_ASSERT_MSG(std::distance(bucket_list.first, bucket_list.second) == 1,
-                     "The pointers are not pointing to the same element.");
+        // Explore search space
+        while (!query_heap.Empty())
+        {
+            deadline.Check();
+            ch::backwardRoutingStep<Metrics>(
+                facade, column_index, query_heap, search_space_with_buckets, phantom);
+        }
+    }
+}
 
-    while (bucket_list.first->parent_node != current_node_id &&
-           bucket_list.first != search_space_with_buckets.end())
+// Finds shortest paths from the sources of the rows to all accessible nodes, every row only
+// writes its own entries of the tables. The tables start with the row first_row.
+template <typename Metrics>
+void forwardSearches(SearchEngineData<ch::Algorithm> &engine_working_data,
+                     const DataFacade<ch::Algorithm> &facade,
+                     const std::vector<PhantomNode> &phantom_nodes,
+                     const std::vector<std::size_t> &source_indices,
+                     const std::size_t number_of_targets,
+                     const tbb::blocked_range<std::uint32_t> &rows,
+                     Deadline &deadline,
+                     const NodeBucketIndex &bucket_index,
+                     const std::size_t first_row,
+                     std::vector<EdgeWeight> &weights_table,
+                     std::vector<EdgeDuration> &durations_table,
+                     std::vector<EdgeDistance> &distances_table)
+{
+    for (auto row_index = rows.begin(); row_index < rows.end(); ++row_index)
     {
-        current_node_id = bucket_list.first->parent_node;
+        const auto &source_phantom = phantom_nodes[source_indices[row_index]];
 
-        packed_leg.emplace_back(current_node_id);
+        // Clear heap and insert source nodes
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes());
+        auto &query_heap = *(engine_working_data.many_to_many_heap);
+        ch::insertSourceInHeap<Metrics>(query_heap, source_phantom);
 
-        bucket_list = std::equal_range(search_space_with_buckets.begin(),
-                                       search_space_with_buckets.end(),
-                                       current_node_id,
-                                       NodeBucket::ColumnCompare(column_index));
+        // Explore search space
+        while (!query_heap.Empty())
+        {
+            deadline.Check();
+            ch::forwardRoutingStep<Metrics>(facade,
+                                            row_index - first_row,
+                                            number_of_targets,
+                                            query_heap,
+                                            bucket_index,
+                                            weights_table,
+                                            durations_table,
+                                            distances_table,
+                                            source_phantom);
+        }
     }
 }
 
-void calculateDistances(typename SearchEngineData<ch::Algorithm>::ManyToManyQueryHeap &query_heap,
-                        const DataFacade<ch::Algorithm> &facade,
-                        const std::vector<PhantomNode> &phantom_nodes,
-                        const std::vector<std::size_t> &target_indices,
-                        const std::size_t row_index,
-                        const std::size_t source_index,
-                        const PhantomNode &source_phantom,
-                        const std::size_t number_of_targets,
-                        const std::vector<NodeBucket> &search_space_with_buckets,
-                        std::vector<EdgeDistance> &distances_table,
-                        const std::vector<NodeID> &middle_nodes_table)
+// Runs search for consecutive blocks of at most rows_per_block rows and passes the tables of
+// each block to handler, the tables of a block are reused for the next one
+template <typename Metrics, typename SearchT>
+void searchRowBlocks(const std::size_t number_of_sources,
+                     const std::size_t number_of_targets,
+                     const std::size_t rows_per_block,
+                     SearchT &&search,
+                     const ManyToManyRowsHandler &handler)
 {
-    std::vector<NodeID> packed_leg;
+    BOOST_ASSERT(rows_per_block > 0);
 
-    for (auto column_index : util::irange<std::size_t>(0, number_of_targets))
+    std::vector<EdgeDuration> durations_table;
+    std::vector<EdgeDistance> distances_table;
+    for (std::size_t first_row = 0; first_row < number_of_sources; first_row += rows_per_block)
     {
-        const auto target_index = target_indices[column_index];
-        const auto &target_phantom = phantom_nodes[target_index];
+        const auto last_row = std::min(first_row + rows_per_block, number_of_sources);
+        const auto number_of_entries = (last_row - first_row) * number_of_targets;
 
-        if (source_index == target_index)
-        {
-            distances_table[row_index * number_of_targets + column_index] = 0.0;
-            continue;
-        }
+        durations_table.assign(Metrics::duration ? number_of_entries : 0, MAXIMAL_EDGE_DURATION);
+        distances_table.assign(Metrics::distance ? number_of_entries : 0, INVALID_EDGE_DISTANCE);
 
-        NodeID middle_node_id = middle_nodes_table[row_index * number_of_targets + column_index];
+        search(tbb::blocked_range<std::uint32_t>(first_row, last_row),
+               durations_table,
+               distances_table);
+        handler(first_row, durations_table, distances_table);
+    }
+}
 
-        if (middle_node_id == SPECIAL_NODEID) // takes care of one-ways
-        {
-            distances_table[row_index * number_of_targets + column_index] = INVALID_EDGE_DISTANCE;
-            continue;
-        }
+// The threads of a parallel table search. The arena caps the number of threads working on the
+// request to the number of search contexts it got, all of them get a copy of its deadline.
+struct TableWorkers
+{
+    TableWorkers(SearchEngineData<ch::Algorithm> &engine_working_data, const unsigned max_threads)
+        : contexts(engine_working_data, max_threads), arena(static_cast<int>(contexts.Size())),
+          deadlines(Deadline::Current())
+    {
+    }
+
+    WorkerSearchContexts<ch::Algorithm> contexts;
+    tbb::task_arena arena;
+    tbb::enumerable_thread_specific<Deadline> deadlines;
+};
+
+// Threads only pay off if there is more than one search to run in parallel and the pool of the
+// query has contexts to spare
+std::unique_ptr<TableWorkers>
+makeTableWorkers(SearchEngineData<ch::Algorithm> &engine_working_data,
+                 const unsigned max_threads,
+                 const std::size_t number_of_searches)
+{
+    if (max_threads <= 1 || number_of_searches <= 1)
+        return nullptr;
+    auto workers = std::make_unique<TableWorkers>(engine_working_data, max_threads);
+    if (workers->contexts.Size() <= 1)
+        return nullptr;
+    return workers;
+}
+
+// Runs the backward searches of the targets and indexes their buckets, on the calling thread
+// or on the workers if there are any
+template <typename Metrics>
+NodeBucketIndex backwardBucketIndex(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                    const DataFacade<ch::Algorithm> &facade,
+                                    const std::vector<PhantomNode> &phantom_nodes,
+                                    const std::vector<std::size_t> &target_indices,
+                                    TableWorkers *workers)
+{
+    const tbb::blocked_range<std::uint32_t> columns(0, target_indices.size());
+    std::vector<NodeBucket> search_space_with_buckets;
 
-        // Step 1: Find path from source to middle node
-        ch::retrievePackedPathFromSingleManyToManyHeap(query_heap, middle_node_id, packed_leg);
-        std::reverse(packed_leg.begin(), packed_leg.end());
+    if (!workers)
+    {
+        backwardSearches<Metrics>(engine_working_data,
+                                  facade,
+                                  phantom_nodes,
+                                  target_indices,
+                                  columns,
+                                  Deadline::Current(),
+                                  search_space_with_buckets);
+        return NodeBucketIndex(search_space_with_buckets);
+    }
 
-        packed_leg.push_back(middle_node_id);
+    tbb::enumerable_thread_specific<std::vector<NodeBucket>> worker_buckets;
+    workers->arena.execute([&] {
+        tbb::parallel_for(columns, [&](const tbb::blocked_range<std::uint32_t> &range) {
+            workers->contexts.Run([&](SearchEngineData<ch::Algorithm> &heaps) {
+                backwardSearches<Metrics>(heaps,
+                                          facade,
+                                          phantom_nodes,
+                                          target_indices,
+                                          range,
+                                          workers->deadlines.local(),
+                                          worker_buckets.local());
+            });
+        });
+    });
+
+    std::size_t number_of_buckets = 0;
+    for (const auto &buckets : worker_buckets)
+    {
+        number_of_buckets += buckets.size();
+    }
+    search_space_with_buckets.reserve(number_of_buckets);
+    for (auto &buckets : worker_buckets)
+    {
+        search_space_with_buckets.insert(
+            search_space_with_buckets.end(), buckets.begin(), buckets.end());
+        std::vector<NodeBucket>().swap(buckets);
+    }
+    // (node, column) pairs are unique, the order of the buckets of a node does not matter
+    return NodeBucketIndex(search_space_with_buckets);
+}
 
-        // Step 2: Find path from middle to target node
-        retrievePackedPathFromSearchSpace(
-            middle_node_id, column_index, search_space_with_buckets, packed_leg);
+// Runs the forward searches of the sources against the buckets of the targets in blocks of rows
+template <typename Metrics>
+void forwardBucketSearches(SearchEngineData<ch::Algorithm> &engine_working_data,
+                           const DataFacade<ch::Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::size_t number_of_targets,
+                           const NodeBucketIndex &bucket_index,
+                           TableWorkers *workers,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler)
+{
+    std::vector<EdgeWeight> weights_table;
+
+    searchRowBlocks<Metrics>(
+        source_indices.size(),
+        number_of_targets,
+        rows_per_block,
+        [&](const tbb::blocked_range<std::uint32_t> &block,
+            std::vector<EdgeDuration> &durations_table,
+            std::vector<EdgeDistance> &distances_table) {
+            weights_table.assign(block.size() * number_of_targets, INVALID_EDGE_WEIGHT);
+            if (!workers)
+            {
+                forwardSearches<Metrics>(engine_working_data,
+                                         facade,
+                                         phantom_nodes,
+                                         source_indices,
+                                         number_of_targets,
+                                         block,
+                                         Deadline::Current(),
+                                         bucket_index,
+                                         block.begin(),
+                                         weights_table,
+                                         durations_table,
+                                         distances_table);
+                return;
+            }
+
+            workers->arena.execute([&] {
+                tbb::parallel_for(block, [&](const tbb::blocked_range<std::uint32_t> &range) {
+                    workers->contexts.Run([&](SearchEngineData<ch::Algorithm> &heaps) {
+                        forwardSearches<Metrics>(heaps,
+                                                 facade,
+                                                 phantom_nodes,
+                                                 source_indices,
+                                                 number_of_targets,
+                                                 range,
+                                                 workers->deadlines.local(),
+                                                 bucket_index,
+                                                 block.begin(),
+                                                 weights_table,
+                                                 durations_table,
+                                                 distances_table);
+                    });
+                });
+            });
+        },
+        handler);
+}
+
+template <typename Metrics>
+void bucketSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                  const DataFacade<ch::Algorithm> &facade,
+                  const std::vector<PhantomNode> &phantom_nodes,
+                  const std::vector<std::size_t> &source_indices,
+                  const std::vector<std::size_t> &target_indices,
+                  const unsigned max_threads,
+                  const std::size_t rows_per_block,
+                  const ManyToManyRowsHandler &handler)
+{
+    // The workers and their heaps are shared by the backward and forward searches
+    const auto workers = makeTableWorkers(engine_working_data,
+                                          max_threads,
+                                          std::max(source_indices.size(), target_indices.size()));
+
+    const auto bucket_index = backwardBucketIndex<Metrics>(
+        engine_working_data, facade, phantom_nodes, target_indices, workers.get());
+
+    forwardBucketSearches<Metrics>(engine_working_data,
+                                   facade,
+                                   phantom_nodes,
+                                   source_indices,
+                                   target_indices.size(),
+                                   bucket_index,
+                                   workers.get(),
+                                   rows_per_block,
+                                   handler);
+}
+
+// Targets with the buckets of their backward searches, which hold all metrics
+class BucketTargets final : public ManyToManyTargets
+{
+  public:
+    BucketTargets(std::vector<PhantomNode> phantom_nodes_, NodeBucketIndex bucket_index_)
+        : ManyToManyTargets(std::move(phantom_nodes_)), bucket_index(std::move(bucket_index_))
+    {
+    }
 
-        if (packed_leg.size() == 1 && (needsLoopForward(source_phantom, target_phantom) ||
-                                       needsLoopBackwards(source_phantom, target_phantom)))
+    const NodeBucketIndex bucket_index;
+};
+
+// The part of the downward graph of the hierarchy that leads to the targets, the restricted
+// graph of RPHAST (Delling et al., "Faster Batched Shortest Paths in Road Networks").
+// The CH data does not store node ranks, the nodes are numbered in a topological order
+// instead: all edges lead from a lower to a higher position, higher nodes come first.
+class RestrictedDownwardGraph
+{
+  public:
+    static constexpr std::uint32_t INVALID_POSITION = std::numeric_limits<std::uint32_t>::max();
+
+    struct Edge
+    {
+        std::uint32_t source;
+        EdgeWeight weight;
+        EdgeDuration duration;
+        EdgeDistance distance;
+    };
+
+    // Shortest path found so far, ordered by weight and duration like the query heaps
+    struct Label
+    {
+        EdgeWeight weight;
+        EdgeDuration duration;
+        EdgeDistance distance;
+
+        bool operator<(const Label &other) const
         {
-            auto weight = ch::getLoopWeight<false>(facade, packed_leg.front());
-            if (weight != INVALID_EDGE_WEIGHT)
-                packed_leg.push_back(packed_leg.front());
+            return std::tie(weight, duration) < std::tie(other.weight, other.duration);
         }
-        if (!packed_leg.empty())
-        {
-            auto annotation =
-                ch::calculateEBGNodeAnnotations(facade, packed_leg.begin(), packed_leg.end());
+    };
 
-            distances_table[row_index * number_of_targets + column_index] = annotation;
+    static constexpr Label INVALID_LABEL{
+        INVALID_EDGE_WEIGHT, MAXIMAL_EDGE_DURATION, INVALID_EDGE_DISTANCE};
 
-            // check the direction of travel to figure out how to calculate the offset to/from
-            // the source/target
-            if (source_phantom.forward_segment_id.id == packed_leg.front())
+    // A node a target phantom node can be reached on, with the offsets of the phantom node
+    struct Target
+    {
+        std::uint32_t column_index;
+        std::uint32_t position;
+        NodeID node;
+        EdgeWeight weight;
+        EdgeDuration duration;
+        EdgeDistance distance;
+    };
+
+    RestrictedDownwardGraph(const DataFacade<ch::Algorithm> &facade,
+                            const std::vector<PhantomNode> &phantom_nodes,
+                            const std::vector<std::size_t> &target_indices,
+                            Deadline &deadline)
+    {
+        // Nodes and downward edges in the order they are discovered
+        std::vector<NodeID> nodes;
+        struct DiscoveredEdge
+        {
+            std::uint32_t from;
+            std::uint32_t to;
+            EdgeWeight weight;
+            EdgeDuration duration;
+            EdgeDistance distance;
+        };
+        std::vector<DiscoveredEdge> discovered_edges;
+
+        const auto discover = [&](const NodeID node) {
+            const auto inserted = positions.emplace(node, nodes.size());
+            if (inserted.second)
             {
-                //       ............       <-- calculateEGBAnnotation returns distance from 0 to 3
-                //       -->s               <-- subtract offset to start at source
-                //          .........       <-- want this distance as result
-                // entry 0---1---2---3---   <-- 3 is exit node
-                EdgeDistance offset = source_phantom.GetForwardDistance();
-                distances_table[row_index * number_of_targets + column_index] -= offset;
+                nodes.push_back(node);
             }
-            else if (source_phantom.reverse_segment_id.id == packed_leg.front())
+            return inserted.first->second;
+        };
+
+        for (const auto column_index : util::irange<std::size_t>(0, target_indices.size()))
+        {
+            const auto &phantom = phantom_nodes[target_indices[column_index]];
+            if (phantom.IsValidForwardTarget())
             {
-                //       ............    <-- calculateEGBAnnotation returns distance from 0 to 3
-                //          s<-------    <-- subtract offset to start at source
-                //       ...             <-- want this distance
-                // entry 0---1---2---3   <-- 3 is exit node
-                EdgeDistance offset = source_phantom.GetReverseDistance();
-                distances_table[row_index * number_of_targets + column_index] -= offset;
+                const auto node = phantom.forward_segment_id.id;
+                targets.push_back({static_cast<std::uint32_t>(column_index),
+                                   discover(node),
+                                   node,
+                                   phantom.GetForwardWeightPlusOffset(),
+                                   phantom.GetForwardDuration(),
+                                   phantom.GetForwardDistance()});
             }
-            if (target_phantom.forward_segment_id.id == packed_leg.back())
+            if (phantom.IsValidReverseTarget())
             {
-                //       ............       <-- calculateEGBAnnotation returns distance from 0 to 3
-                //                   ++>t   <-- add offset to get to target
-                //       ................   <-- want this distance as result
-                // entry 0---1---2---3---   <-- 3 is exit node
-                EdgeDistance offset = target_phantom.GetForwardDistance();
-                distances_table[row_index * number_of_targets + column_index] += offset;
+                const auto node = phantom.reverse_segment_id.id;
+                targets.push_back({static_cast<std::uint32_t>(column_index),
+                                   discover(node),
+                                   node,
+                                   phantom.GetReverseWeightPlusOffset(),
+                                   phantom.GetReverseDuration(),
+                                   phantom.GetReverseDistance()});
             }
-            else if (target_phantom.reverse_segment_id.id == packed_leg.back())
+        }
+
+        // All nodes the backward searches of the targets can reach, without stalling
+        for (std::size_t index = 0; index < nodes.size(); ++index)
+        {
+            deadline.Check();
+            const auto node = nodes[index];
+            for (const auto edge : facade.GetAdjacentEdgeRange(node))
             {
-                //       ............       <-- calculateEGBAnnotation returns distance from 0 to 3
-                //                   <++t   <-- add offset to get from target
-                //       ................   <-- want this distance as result
-                // entry 0---1---2---3---   <-- 3 is exit node
-                EdgeDistance offset = target_phantom.GetReverseDistance();
-                distances_table[row_index * number_of_targets + column_index] += offset;
+                const auto &data = facade.GetEdgeData(edge);
+                const auto to = facade.GetTarget(edge);
+                if (data.backward && to != node)
+                {
+                    discovered_edges.push_back({discover(to),
+                                                static_cast<std::uint32_t>(index),
+                                                data.weight,
+                                                data.duration,
+                                                data.distance});
+                }
             }
         }
-        else
+
+        // Topological order of the discovered nodes, edges only lead to lower ranked nodes
+        const auto number_of_nodes = nodes.size();
+        std::sort(discovered_edges.begin(),
+                  discovered_edges.end(),
+                  [](const DiscoveredEdge &lhs, const DiscoveredEdge &rhs) {
+                      return lhs.from < rhs.from;
+                  });
+        std::vector<std::uint32_t> first_outgoing(number_of_nodes + 1, 0);
+        std::vector<std::uint32_t> in_degree(number_of_nodes, 0);
+        for (const auto &edge : discovered_edges)
+        {
+            ++first_outgoing[edge.from + 1];
+            ++in_degree[edge.to];
+        }
+        std::partial_sum(first_outgoing.begin(), first_outgoing.end(), first_outgoing.begin());
+
+        std::vector<std::uint32_t> order;
+        order.reserve(number_of_nodes);
+        for (const auto index : util::irange<std::uint32_t>(0, number_of_nodes))
         {
-            // there is no shortcut to unpack. source and target are on the same EBG Node.
-            // if the offset of the target is greater than the offset of the source, subtract it
-            if (target_phantom.GetForwardDistance() > source_phantom.GetForwardDistance())
+            if (in_degree[index] == 0)
+                order.push_back(index);
+        }
+        for (std::size_t next = 0; next < order.size(); ++next)
+        {
+            const auto from = order[next];
+            for (auto edge = first_outgoing[from]; edge < first_outgoing[from + 1]; ++edge)
             {
-                //       --------->t        <-- offsets
-                //       ->s                <-- subtract source offset from target offset
-                //         .........        <-- want this distance as result
-                // entry 0---1---2---3---   <-- 3 is exit node
-                EdgeDistance offset =
-                    target_phantom.GetForwardDistance() - source_phantom.GetForwardDistance();
-                distances_table[row_index * number_of_targets + column_index] = offset;
+                if (--in_degree[discovered_edges[edge].to] == 0)
+                    order.push_back(discovered_edges[edge].to);
             }
-            else
+        }
+        BOOST_ASSERT_MSG(order.size() == number_of_nodes, "hierarchy is not acyclic");
+
+        std::vector<std::uint32_t> discovered_to_position(number_of_nodes);
+        for (const auto position : util::irange<std::uint32_t>(0, number_of_nodes))
+        {
+            discovered_to_position[order[position]] = position;
+        }
+        for (auto &position : positions)
+        {
+            position.second = discovered_to_position[position.second];
+        }
+        for (auto &target : targets)
+        {
+            target.position = discovered_to_position[target.position];
+        }
+
+        // Incoming edges of the nodes, in the order of the sweep
+        first_edge.resize(number_of_nodes + 1, 0);
+        for (const auto &edge : discovered_edges)
+        {
+            ++first_edge[discovered_to_position[edge.to] + 1];
+        }
+        std::partial_sum(first_edge.begin(), first_edge.end(), first_edge.begin());
+        edges.resize(discovered_edges.size());
+        auto next_edge = first_edge;
+        for (const auto &edge : discovered_edges)
+        {
+            edges[next_edge[discovered_to_position[edge.to]]++] = {
+                discovered_to_position[edge.from], edge.weight, edge.duration, edge.distance};
+        }
+    }
+
+    std::uint32_t GetNumberOfNodes() const { return first_edge.size() - 1; }
+
+    std::uint32_t GetPosition(const NodeID node) const
+    {
+        const auto found = positions.find(node);
+        return found == positions.end() ? INVALID_POSITION : found->second;
+    }
+
+    const std::vector<Target> &GetTargets() const { return targets; }
+
+    // Shortest path to the node over its incoming edges, the labels have to be final for all
+    // lower positions
+    template <typename Metrics>
+    Label RelaxIncomingEdges(const std::uint32_t position, const std::vector<Label> &labels) const
+    {
+        Label best = INVALID_LABEL;
+        for (auto edge = first_edge[position]; edge < first_edge[position + 1]; ++edge)
+        {
+            const auto &data = edges[edge];
+            const auto &source = labels[data.source];
+            if (source.weight != INVALID_EDGE_WEIGHT)
             {
-                //               s<---      <-- offsets
-                //         t<---------      <-- subtract source offset from target offset
-                //         ......           <-- want this distance as result
-                // entry 0---1---2---3---   <-- 3 is exit node
-                EdgeDistance offset =
-                    target_phantom.GetReverseDistance() - source_phantom.GetReverseDistance();
-                distances_table[row_index * number_of_targets + column_index] = offset;
+                const Label candidate{
+                    source.weight + data.weight,
+                    Metrics::duration ? source.duration + data.duration : 0,
+                    Metrics::distance ? source.distance + data.distance : 0};
+                if (candidate < best)
+                    best = candidate;
             }
         }
-        packed_leg.clear();
+        return best;
     }
-}
 
-template <>
-std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
-manyToManySearch(SearchEngineData<ch::Algorithm> &engine_working_data,
-                 const DataFacade<ch::Algorithm> &facade,
-                 const std::vector<PhantomNode> &phantom_nodes,
-                 const std::vector<std::size_t> &source_indices,
-                 const std::vector<std::size_t> &target_indices,
-                 const bool calculate_distance,
-                 const bool calculate_duration)
-{
-    (void)calculate_duration; // TODO: stub to use when computing durations become optional
+    // Propagates the labels of the upward search down to all nodes, a single linear pass
+    template <typename Metrics> void Sweep(std::vector<Label> &labels) const
+    {
+        BOOST_ASSERT(labels.size() == GetNumberOfNodes());
+        for (const auto position : util::irange<std::uint32_t>(0, GetNumberOfNodes()))
+        {
+            const auto best = RelaxIncomingEdges<Metrics>(position, labels);
+            if (best < labels[position])
+                labels[position] = best;
+        }
+    }
 
-    const auto number_of_sources = source_indices.size();
-    const auto number_of_targets = target_indices.size();
-    const auto number_of_entries = number_of_sources * number_of_targets;
+  private:
+    std::unordered_map<NodeID, std::uint32_t> positions;
+    std::vector<std::uint32_t> first_edge;
+    std::vector<Edge> edges;
+    std::vector<Target> targets;
+};
 
-    std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
-    std::vector<EdgeDuration> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
-    std::vector<EdgeDistance> distances_table;
-    std::vector<NodeID> middle_nodes_table(number_of_entries, SPECIAL_NODEID);
+constexpr RestrictedDownwardGraph::Label RestrictedDownwardGraph::INVALID_LABEL;
 
-    std::vector<NodeBucket> search_space_with_buckets;
+struct SweepBuffers
+{
+    std::vector<RestrictedDownwardGraph::Label> labels;
+    std::vector<RestrictedDownwardGraph::Label> row;
+};
+
+// Runs the upward searches of the rows and sweeps the restricted graph for each of them.
+// The tables start with the row first_row.
+template <typename Metrics>
+void restrictedSweeps(SearchEngineData<ch::Algorithm> &engine_working_data,
+                      const DataFacade<ch::Algorithm> &facade,
+                      const std::vector<PhantomNode> &phantom_nodes,
+                      const std::vector<std::size_t> &source_indices,
+                      const std::size_t number_of_targets,
+                      const RestrictedDownwardGraph &graph,
+                      const tbb::blocked_range<std::uint32_t> &rows,
+                      Deadline &deadline,
+                      SweepBuffers &buffers,
+                      const std::size_t first_row,
+                      std::vector<EdgeDuration> &durations_table,
+                      std::vector<EdgeDistance> &distances_table)
+{
+    using Label = RestrictedDownwardGraph::Label;
+    auto &labels = buffers.labels;
+    auto &row = buffers.row;
 
-    // Populate buckets with paths from all accessible nodes to destinations via backward searches
-    for (std::uint32_t column_index = 0; column_index < target_indices.size(); ++column_index)
+    for (auto row_index = rows.begin(); row_index < rows.end(); ++row_index)
     {
-        const auto index = target_indices[column_index];
-        const auto &phantom = phantom_nodes[index];
+        const auto &source_phantom = phantom_nodes[source_indices[row_index]];
 
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes());
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes());
         auto &query_heap = *(engine_working_data.many_to_many_heap);
-        insertTargetInHeap(query_heap, phantom);
+        ch::insertSourceInHeap<Metrics>(query_heap, source_phantom);
 
-        // Explore search space
+        labels.assign(graph.GetNumberOfNodes(), RestrictedDownwardGraph::INVALID_LABEL);
+
+        // The upward search enters the restricted graph at the nodes it settles
         while (!query_heap.Empty())
         {
-            backwardRoutingStep(
-                facade, column_index, query_heap, search_space_with_buckets, phantom);
+            deadline.Check();
+            const auto node = query_heap.DeleteMin();
+            const auto weight = query_heap.GetKey(node);
+            const auto duration = query_heap.GetData(node).duration;
+            const auto distance = query_heap.GetData(node).distance;
+
+            const auto position = graph.GetPosition(node);
+            if (position != RestrictedDownwardGraph::INVALID_POSITION)
+            {
+                labels[position] = {weight, duration, distance};
+            }
+
+            ch::relaxOutgoingEdges<FORWARD_DIRECTION, Metrics>(
+                facade, node, weight, duration, distance, query_heap, source_phantom);
+        }
+
+        graph.Sweep<Metrics>(labels);
+
+        row.assign(number_of_targets, RestrictedDownwardGraph::INVALID_LABEL);
+        for (const auto &target : graph.GetTargets())
+        {
+            auto &current = row[target.column_index];
+
+            // Paths that reach the target node from a higher node
+            const auto downward = graph.RelaxIncomingEdges<Metrics>(target.position, labels);
+            if (downward.weight != INVALID_EDGE_WEIGHT)
+            {
+                const Label candidate{
+                    downward.weight + target.weight,
+                    Metrics::duration ? downward.duration + target.duration : 0,
+                    Metrics::distance ? downward.distance + target.distance : 0};
+                if (candidate < current)
+                    current = candidate;
+            }
+
+            // The upward search reached the target node, the same checks as forwardRoutingStep
+            if (query_heap.WasInserted(target.node))
+            {
+                const auto &data = query_heap.GetData(target.node);
+                Label candidate{query_heap.GetKey(target.node) + target.weight,
+                                Metrics::duration ? data.duration + target.duration : 0,
+                                Metrics::distance ? data.distance + target.distance : 0};
+
+                if (candidate.weight < 0)
+                {
+                    if (ch::addLoopWeight<Metrics>(facade,
+                                                   target.node,
+                                                   candidate.weight,
+                                                   candidate.duration,
+                                                   candidate.distance))
+                    {
+                        current.weight = std::min(current.weight, candidate.weight);
+                        current.duration = std::min(current.duration, candidate.duration);
+                        current.distance = std::min(current.distance, candidate.distance);
+                    }
+                }
+                else if (candidate < current)
+                {
+                    current = candidate;
+                }
+            }
+        }
+
+        const auto row_begin = (row_index - first_row) * number_of_targets;
+        for (const auto column_index : util::irange<std::size_t>(0, number_of_targets))
+        {
+            if (Metrics::duration)
+                durations_table[row_begin + column_index] = row[column_index].duration;
+            if (Metrics::distance)
+                distances_table[row_begin + column_index] = row[column_index].distance;
         }
     }
+}
+
+template <typename Metrics>
+void restrictedPHASTSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                           const DataFacade<ch::Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler)
+{
+    const auto number_of_sources = source_indices.size();
+    const auto number_of_targets = target_indices.size();
 
-    // Order lookup buckets
-    std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+    auto &deadline = Deadline::Current();
+    const RestrictedDownwardGraph graph(facade, phantom_nodes, target_indices, deadline);
 
-    // Find shortest paths from sources to all accessible nodes
-    for (std::uint32_t row_index = 0; row_index < source_indices.size(); ++row_index)
+    const auto workers = makeTableWorkers(engine_working_data, max_threads, number_of_sources);
+    if (!workers)
     {
-        const auto source_index = source_indices[row_index];
-        const auto &source_phantom = phantom_nodes[source_index];
+        SweepBuffers buffers;
+        searchRowBlocks<Metrics>(
+            number_of_sources,
+            number_of_targets,
+            rows_per_block,
+            [&](const tbb::blocked_range<std::uint32_t> &rows,
+                std::vector<EdgeDuration> &durations_table,
+                std::vector<EdgeDistance> &distances_table) {
+                restrictedSweeps<Metrics>(engine_working_data,
+                                          facade,
+                                          phantom_nodes,
+                                          source_indices,
+                                          number_of_targets,
+                                          graph,
+                                          rows,
+                                          deadline,
+                                          buffers,
+                                          rows.begin(),
+                                          durations_table,
+                                          distances_table);
+            },
+            handler);
+        return;
+    }
 
-        // Clear heap and insert source nodes
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes());
-        auto &query_heap = *(engine_working_data.many_to_many_heap);
-        insertSourceInHeap(query_heap, source_phantom);
+    // Same as for the bucket search, the restricted graph is shared by all threads
+    tbb::enumerable_thread_specific<SweepBuffers> worker_buffers;
 
-        // Explore search space
-        while (!query_heap.Empty())
+    searchRowBlocks<Metrics>(
+        number_of_sources,
+        number_of_targets,
+        rows_per_block,
+        [&](const tbb::blocked_range<std::uint32_t> &block,
+            std::vector<EdgeDuration> &durations_table,
+            std::vector<EdgeDistance> &distances_table) {
+            workers->arena.execute([&] {
+                tbb::parallel_for(block, [&](const tbb::blocked_range<std::uint32_t> &range) {
+                    workers->contexts.Run([&](SearchEngineData<ch::Algorithm> &heaps) {
+                        restrictedSweeps<Metrics>(heaps,
+                                                  facade,
+                                                  phantom_nodes,
+                                                  source_indices,
+                                                  number_of_targets,
+                                                  graph,
+                                                  range,
+                                                  workers->deadlines.local(),
+                                                  worker_buffers.local(),
+                                                  block.begin(),
+                                                  durations_table,
+                                                  distances_table);
+                    });
+                });
+            });
+        },
+        handler);
+}
+}
+
+namespace ch
+{
+
+ManyToManyStrategy chooseManyToManyStrategy(const std::size_t number_of_sources,
+                                            const std::size_t number_of_targets)
+{
+    // Extracting the restricted graph costs about as much as the backward searches of the
+    // bucket search. It pays off once the buckets get large and enough rows sweep the graph.
+    const constexpr std::size_t RESTRICTED_PHAST_MIN_SOURCES = 64;
+    const constexpr std::size_t RESTRICTED_PHAST_MIN_TARGETS = 1024;
+
+    if (number_of_sources >= RESTRICTED_PHAST_MIN_SOURCES &&
+        number_of_targets >= RESTRICTED_PHAST_MIN_TARGETS)
+    {
+        return ManyToManyStrategy::RestrictedPHAST;
+    }
+    return ManyToManyStrategy::Buckets;
+}
+
+std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const bool calculate_distance,
+                 const bool calculate_duration,
+                 const unsigned max_threads,
+                 const ManyToManyStrategy strategy)
+{
+    // A single block holds the whole table
+    std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>> tables;
+    manyToManyBlockSearch(engine_working_data,
+                          facade,
+                          phantom_nodes,
+                          source_indices,
+                          target_indices,
+                          calculate_distance,
+                          calculate_duration,
+                          max_threads,
+                          std::max<std::size_t>(source_indices.size(), 1),
+                          [&tables](const std::size_t,
+                                    std::vector<EdgeDuration> &durations,
+                                    std::vector<EdgeDistance> &distances) {
+                              tables.first.swap(durations);
+                              tables.second.swap(distances);
+                          },
+                          strategy);
+    return tables;
+}
+
+void manyToManyBlockSearch(SearchEngineData<Algorithm> &engine_working_data,
+                           const DataFacade<Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler,
+                           const ManyToManyStrategy strategy)
+{
+    dispatchTableMetrics(calculate_duration, calculate_distance, [&](auto metrics) {
+        using Metrics = decltype(metrics);
+        if (strategy == ManyToManyStrategy::RestrictedPHAST)
         {
-            forwardRoutingStep(facade,
-                               row_index,
-                               number_of_targets,
-                               query_heap,
-                               search_space_with_buckets,
-                               weights_table,
-                               durations_table,
-                               middle_nodes_table,
-                               source_phantom);
+            restrictedPHASTSearch<Metrics>(engine_working_data,
+                                           facade,
+                                           phantom_nodes,
+                                           source_indices,
+                                           target_indices,
+                                           max_threads,
+                                           rows_per_block,
+                                           handler);
         }
-
-        if (calculate_distance)
+        else
         {
-            distances_table.resize(number_of_entries, INVALID_EDGE_DISTANCE);
-            calculateDistances(query_heap,
-                               facade,
-                               phantom_nodes,
-                               target_indices,
-                               row_index,
-                               source_index,
-                               source_phantom,
-                               number_of_targets,
-                               search_space_with_buckets,
-                               distances_table,
-                               middle_nodes_table);
+            bucketSearch<Metrics>(engine_working_data,
+                                  facade,
+                                  phantom_nodes,
+                                  source_indices,
+                                  target_indices,
+                                  max_threads,
+                                  rows_per_block,
+                                  handler);
         }
-    }
+    });
+}
+} // namespace ch
+
+template <>
+std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                 const DataFacade<ch::Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const bool calculate_distance,
+                 const bool calculate_duration,
+                 const unsigned max_threads)
+{
+    return ch::manyToManySearch(
+        engine_working_data,
+        facade,
+        phantom_nodes,
+        source_indices,
+        target_indices,
+        calculate_distance,
+        calculate_duration,
+        max_threads,
+        ch::chooseManyToManyStrategy(source_indices.size(), target_indices.size()));
+}
+
+template <>
+void manyToManyBlockSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                           const DataFacade<ch::Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler)
+{
+    ch::manyToManyBlockSearch(
+        engine_working_data,
+        facade,
+        phantom_nodes,
+        source_indices,
+        target_indices,
+        calculate_distance,
+        calculate_duration,
+        max_threads,
+        rows_per_block,
+        handler,
+        ch::chooseManyToManyStrategy(source_indices.size(), target_indices.size()));
+}
+
+template <>
+std::shared_ptr<ManyToManyTargets>
+manyToManyTargets(SearchEngineData<ch::Algorithm> &engine_working_data,
+                  const DataFacade<ch::Algorithm> &facade,
+                  const std::vector<PhantomNode> &target_phantom_nodes,
+                  const unsigned max_threads)
+{
+    std::vector<std::size_t> target_indices(target_phantom_nodes.size());
+    std::iota(target_indices.begin(), target_indices.end(), 0);
+
+    const auto workers = makeTableWorkers(engine_working_data, max_threads, target_indices.size());
+    auto bucket_index = backwardBucketIndex<TableMetrics<true, true>>(
+        engine_working_data, facade, target_phantom_nodes, target_indices, workers.get());
+
+    return std::make_shared<BucketTargets>(target_phantom_nodes, std::move(bucket_index));
+}
+
+// Always the bucket search, the backward searches that restricted PHAST saves are already done
+template <>
+void manyToManyBlockSearch(SearchEngineData<ch::Algorithm> &engine_working_data,
+                           const DataFacade<ch::Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const ManyToManyTargets &targets,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler)
+{
+    BOOST_ASSERT(dynamic_cast<const BucketTargets *>(&targets));
+    const auto &bucket_targets = static_cast<const BucketTargets &>(targets);
 
-    return std::make_pair(durations_table, distances_table);
+    const auto workers = makeTableWorkers(engine_working_data, max_threads, source_indices.size());
+    dispatchTableMetrics(calculate_duration, calculate_distance, [&](auto metrics) {
+        using Metrics = decltype(metrics);
+        forwardBucketSearches<Metrics>(engine_working_data,
+                                       facade,
+                                       phantom_nodes,
+                                       source_indices,
+                                       bucket_targets.GetPhantomNodes().size(),
+                                       bucket_targets.bucket_index,
+                                       workers.get(),
+                                       rows_per_block,
+                                       handler);
+    });
 }
 
 } // namespace routing_algorithms
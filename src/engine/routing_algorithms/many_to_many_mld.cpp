@@ -2,10 +2,12 @@
 #include "engine/routing_algorithms/routing_base.hpp"
 
 #include <boost/assert.hpp>
-#include <boost/range/iterator_range_core.hpp>
+#include <boost/optional.hpp>
 
 #include <limits>
 #include <memory>
+#include <numeric>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -82,12 +84,21 @@ inline LevelID getNodeQueryLevel(const MultiLevelPartition &partition,
     return result;
 }
 
-template <bool DIRECTION, typename... Args>
+// Edge filter of the searches on the whole graph
+struct AllEdges
+{
+    bool operator()(const NodeID, const NodeID) const { return true; }
+};
+
+// Durations are only summed up if they are requested. Border edges from node to a node are only
+// relaxed if is_allowed(node, to), shortcuts are not filtered.
+template <bool DIRECTION, typename Metrics, typename EdgeFilterT, typename... Args>
 void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
                         const NodeID node,
                         const EdgeWeight weight,
                         const EdgeDuration duration,
                         typename SearchEngineData<mld::Algorithm>::ManyToManyQueryHeap &query_heap,
+                        const EdgeFilterT &is_allowed,
                         Args... args)
 {
     BOOST_ASSERT(!facade.ExcludeNode(node));
@@ -120,7 +131,8 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
                 if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
                 {
                     const auto to_weight = weight + shortcut_weight;
-                    const auto to_duration = duration + shortcut_durations.front();
+                    const auto to_duration =
+                        Metrics::duration ? duration + shortcut_durations.front() : 0;
                     if (!query_heap.WasInserted(to))
                     {
                         query_heap.Insert(to, to_weight, {node, true, to_duration});
@@ -150,7 +162,8 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
                 if (shortcut_weight != INVALID_EDGE_WEIGHT && node != to)
                 {
                     const auto to_weight = weight + shortcut_weight;
-                    const auto to_duration = duration + shortcut_durations.front();
+                    const auto to_duration =
+                        Metrics::duration ? duration + shortcut_durations.front() : 0;
                     if (!query_heap.WasInserted(to))
                     {
                         query_heap.Insert(to, to_weight, {node, true, to_duration});
@@ -176,7 +189,7 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
                                              : facade.IsBackwardEdge(edge))
         {
             const NodeID to = facade.GetTarget(edge);
-            if (facade.ExcludeNode(to))
+            if (facade.ExcludeNode(to) || !is_allowed(node, to))
             {
                 continue;
             }
@@ -190,7 +203,7 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
 
             BOOST_ASSERT_MSG(node_weight + turn_weight > 0, "edge weight is invalid");
             const auto to_weight = weight + turn_weight;
-            const auto to_duration = duration + turn_duration;
+            const auto to_duration = Metrics::duration ? duration + turn_duration : 0;
 
             // New Node discovered -> Add to Heap + Node Info Storage
             if (!query_heap.WasInserted(to))
@@ -211,7 +224,7 @@ void relaxOutgoingEdges(const DataFacade<mld::Algorithm> &facade,
 //
 // Unidirectional multi-layer Dijkstra search for 1-to-N and N-to-1 matrices
 //
-template <bool DIRECTION>
+template <bool DIRECTION, typename Metrics>
 std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
 oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                 const DataFacade<Algorithm> &facade,
@@ -219,9 +232,10 @@ oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                 std::size_t phantom_index,
                 const std::vector<std::size_t> &phantom_indices)
 {
+    // MLD tables do not compute distances
     std::vector<EdgeWeight> weights(phantom_indices.size(), INVALID_EDGE_WEIGHT);
-    std::vector<EdgeDuration> durations(phantom_indices.size(), MAXIMAL_EDGE_DURATION);
-    std::vector<EdgeDistance> distances(phantom_indices.size(), INVALID_EDGE_DISTANCE);
+    std::vector<EdgeDuration> durations(Metrics::duration ? phantom_indices.size() : 0,
+                                        MAXIMAL_EDGE_DURATION);
 
     // Collect destination (source) nodes into a map
     std::unordered_multimap<NodeID, std::tuple<std::size_t, EdgeWeight, EdgeDuration>>
@@ -265,8 +279,8 @@ oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
     }
 
     // Initialize query heap
-    engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-        facade.GetNumberOfNodes(), facade.GetMaxBorderNodeID() + 1);
+    engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes(),
+                                                        facade.GetMaxBorderNodeID() + 1);
     auto &query_heap = *(engine_working_data.many_to_many_heap);
 
     // Check if node is in the destinations list and update weights/durations
@@ -282,13 +296,19 @@ oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
             const auto path_weight = weight + target_weight;
             if (path_weight >= 0)
             {
-                const auto path_duration = duration + target_duration;
-
-                if (std::tie(path_weight, path_duration) <
-                    std::tie(weights[index], durations[index]))
+                if (!Metrics::duration)
+                {
+                    weights[index] = std::min(weights[index], path_weight);
+                }
+                else
                 {
-                    weights[index] = path_weight;
-                    durations[index] = path_duration;
+                    const auto path_duration = duration + target_duration;
+                    if (std::tie(path_weight, path_duration) <
+                        std::tie(weights[index], durations[index]))
+                    {
+                        weights[index] = path_weight;
+                        durations[index] = path_duration;
+                    }
                 }
 
                 // Remove node from destinations list
@@ -317,8 +337,10 @@ oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                 const auto node_id = DIRECTION == FORWARD_DIRECTION ? node : facade.GetTarget(edge);
                 const auto edge_weight = initial_weight + facade.GetNodeWeight(node_id) +
                                          facade.GetWeightPenaltyForEdgeID(turn_id);
-                const auto edge_duration = initial_duration + facade.GetNodeDuration(node_id) +
-                                           facade.GetDurationPenaltyForEdgeID(turn_id);
+                const auto edge_duration =
+                    Metrics::duration ? initial_duration + facade.GetNodeDuration(node_id) +
+                                            facade.GetDurationPenaltyForEdgeID(turn_id)
+                                      : 0;
 
                 query_heap.Insert(facade.GetTarget(edge), edge_weight, {node, edge_duration});
             }
@@ -355,8 +377,10 @@ oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
         }
     }
 
+    auto &deadline = Deadline::Current();
     while (!query_heap.Empty() && !target_nodes_index.empty())
     {
+        deadline.Check();
         // Extract node from the heap
         const auto node = query_heap.DeleteMin();
         const auto weight = query_heap.GetKey(node);
@@ -366,48 +390,47 @@ oneToManySearch(SearchEngineData<Algorithm> &engine_working_data,
         update_values(node, weight, duration);
 
         // Relax outgoing edges
-        relaxOutgoingEdges<DIRECTION>(facade,
-                                      node,
-                                      weight,
-                                      duration,
-                                      query_heap,
-                                      phantom_nodes,
-                                      phantom_index,
-                                      phantom_indices);
+        relaxOutgoingEdges<DIRECTION, Metrics>(facade,
+                                               node,
+                                               weight,
+                                               duration,
+                                               query_heap,
+                                               AllEdges{},
+                                               phantom_nodes,
+                                               phantom_index,
+                                               phantom_indices);
     }
 
-    return std::make_pair(durations, distances);
+    return std::make_pair(durations, std::vector<EdgeDistance>());
 }
 
 //
 // Bidirectional multi-layer Dijkstra search for M-to-N matrices
 //
-template <bool DIRECTION>
+template <bool DIRECTION, typename Metrics, typename EdgeFilterT = AllEdges>
 void forwardRoutingStep(const DataFacade<Algorithm> &facade,
                         const unsigned row_idx,
                         const unsigned number_of_sources,
                         const unsigned number_of_targets,
                         typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
-                        const std::vector<NodeBucket> &search_space_with_buckets,
+                        const NodeBucketIndex &bucket_index,
                         std::vector<EdgeWeight> &weights_table,
                         std::vector<EdgeDuration> &durations_table,
-                        const PhantomNode &phantom_node)
+                        const PhantomNode &phantom_node,
+                        const EdgeFilterT &is_allowed = {})
 {
     const auto node = query_heap.DeleteMin();
     const auto source_weight = query_heap.GetKey(node);
     const auto source_duration = query_heap.GetData(node).duration;
 
     // Check if each encountered node has an entry
-    const auto &bucket_list = std::equal_range(search_space_with_buckets.begin(),
-                                               search_space_with_buckets.end(),
-                                               node,
-                                               NodeBucket::Compare());
-    for (const auto &current_bucket : boost::make_iterator_range(bucket_list))
+    const auto buckets = bucket_index.GetBuckets(node);
+    for (const auto index : util::irange<std::size_t>(0, buckets.size))
     {
         // Get target id from bucket entry
-        const auto column_idx = current_bucket.column_index;
-        const auto target_weight = current_bucket.weight;
-        const auto target_duration = current_bucket.duration;
+        const auto column_idx = buckets.column_indices[index];
+        const auto target_weight = buckets.weights[index];
+        const auto target_duration = buckets.durations[index];
 
         // Get the value location in the results tables:
         //  * row-major direct (row_idx, column_idx) index for forward direction
@@ -416,25 +439,32 @@ void forwardRoutingStep(const DataFacade<Algorithm> &facade,
                                   ? row_idx * number_of_targets + column_idx
                                   : row_idx + column_idx * number_of_sources;
         auto &current_weight = weights_table[location];
-        auto &current_duration = durations_table[location];
 
         // Check if new weight is better
         auto new_weight = source_weight + target_weight;
-        auto new_duration = source_duration + target_duration;
+        if (new_weight < 0)
+            continue;
 
-        if (new_weight >= 0 &&
-            std::tie(new_weight, new_duration) < std::tie(current_weight, current_duration))
+        if (!Metrics::duration)
+        {
+            current_weight = std::min(current_weight, new_weight);
+            continue;
+        }
+
+        auto &current_duration = durations_table[location];
+        auto new_duration = source_duration + target_duration;
+        if (std::tie(new_weight, new_duration) < std::tie(current_weight, current_duration))
         {
             current_weight = new_weight;
             current_duration = new_duration;
         }
     }
 
-    relaxOutgoingEdges<DIRECTION>(
-        facade, node, source_weight, source_duration, query_heap, phantom_node);
+    relaxOutgoingEdges<DIRECTION, Metrics>(
+        facade, node, source_weight, source_duration, query_heap, is_allowed, phantom_node);
 }
 
-template <bool DIRECTION>
+template <bool DIRECTION, typename Metrics>
 void backwardRoutingStep(const DataFacade<Algorithm> &facade,
                          const unsigned column_idx,
                          typename SearchEngineData<Algorithm>::ManyToManyQueryHeap &query_heap,
@@ -447,42 +477,327 @@ void backwardRoutingStep(const DataFacade<Algorithm> &facade,
     const auto parent = query_heap.GetData(node).parent;
 
     // Store settled nodes in search space bucket
+    // MLD tables do not compute distances
     search_space_with_buckets.emplace_back(
-        node, parent, column_idx, target_weight, target_duration);
+        node, parent, column_idx, target_weight, target_duration, INVALID_EDGE_DISTANCE);
 
     const auto &partition = facade.GetMultiLevelPartition();
     const auto maximal_level = partition.GetNumberOfLevels() - 1;
 
-    relaxOutgoingEdges<!DIRECTION>(
-        facade, node, target_weight, target_duration, query_heap, phantom_node, maximal_level);
+    relaxOutgoingEdges<!DIRECTION, Metrics>(facade,
+                                            node,
+                                            target_weight,
+                                            target_duration,
+                                            query_heap,
+                                            AllEdges{},
+                                            phantom_node,
+                                            maximal_level);
+}
+
+//
+// Source groups: sources in the same cell share the searches from the exits of the cell
+//
+// A path from a source in cell C either stays in C or leaves C the first time over an edge from
+// an exit of C, a node of C with an edge to another cell. The search of a source in the group
+// of C is restricted to C, it finds the paths in C and the weights of the source to the exits.
+// The paths from an exit over its edges out of C to the targets are searched once per group and
+// added to the weights of the sources to the exit like a cell matrix.
+struct SourceGroup
+{
+    CellID cell;
+    std::vector<std::size_t> rows; // rows of the table of the sources in the cell
+};
+
+struct SourceGroups
+{
+    LevelID level = INVALID_LEVEL_ID;
+    std::vector<SourceGroup> groups;
+};
+
+// A settled node relaxes several edges and shortcuts and costs about as much as this number of
+// sums of an exit's weight to a target and a source's weight to the exit
+constexpr double SETTLED_NODE_COST = 8.;
+
+// The cell of level that contains all nodes of the phantom node, if any
+inline bool getPhantomCell(const partitioner::MultiLevelPartitionView &partition,
+                           const LevelID level,
+                           const PhantomNode &phantom_node,
+                           CellID &cell)
+{
+    cell = INVALID_CELL_ID;
+    for (const auto &segment : {phantom_node.forward_segment_id, phantom_node.reverse_segment_id})
+    {
+        if (!segment.enabled)
+            continue;
+        const auto segment_cell = partition.GetCell(level, segment.id);
+        if (cell != INVALID_CELL_ID && cell != segment_cell)
+            return false;
+        cell = segment_cell;
+    }
+    return cell != INVALID_CELL_ID;
+}
+
+// Groups the sources in cells of group_level or, without a level, of the level with the least
+// estimated cost. Each group is estimated to search its exits, a source search restricted to the
+// cell and the sums of the weights to the exits and of the exits to the targets per source.
+// A group is only kept if that costs less than searching from its sources.
+inline SourceGroups planSourceGroups(const DataFacade<Algorithm> &facade,
+                                     const std::vector<PhantomNode> &phantom_nodes,
+                                     const std::vector<std::size_t> &source_indices,
+                                     const std::size_t number_of_targets,
+                                     const double search_cost,
+                                     const boost::optional<LevelID> group_level)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto &cells = facade.GetCellStorage();
+    const auto &metric = facade.GetCellMetric();
+
+    SourceGroups best_groups;
+    auto best_cost = source_indices.size() * search_cost;
+
+    for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+    {
+        if (group_level && *group_level != level)
+            continue;
+
+        std::unordered_map<CellID, std::vector<std::size_t>> cell_rows;
+        double cost = 0;
+        for (const auto row : util::irange<std::size_t>(0, source_indices.size()))
+        {
+            CellID cell;
+            if (getPhantomCell(partition, level, phantom_nodes[source_indices[row]], cell))
+                cell_rows[cell].push_back(row);
+            else
+                cost += search_cost;
+        }
+
+        // the restricted searches settle at most the nodes of the cell
+        const double cell_search_cost =
+            std::min(search_cost,
+                     static_cast<double>(facade.GetNumberOfNodes()) /
+                         partition.GetNumberOfCells(level));
+
+        SourceGroups groups{level, {}};
+        for (auto &rows : cell_rows)
+        {
+            const auto &cell = cells.GetCell(metric, level, rows.first);
+            const double number_of_exits =
+                std::max(cell.GetSourceNodes().size(), cell.GetDestinationNodes().size());
+            const double number_of_sources = rows.second.size();
+
+            const auto sources_cost = number_of_sources * search_cost;
+            const auto group_cost =
+                number_of_exits * search_cost +
+                number_of_sources * (cell_search_cost + number_of_exits * number_of_targets /
+                                                            SETTLED_NODE_COST);
+            if (group_level || group_cost < sources_cost)
+            {
+                groups.groups.push_back({rows.first, std::move(rows.second)});
+                cost += group_cost;
+            }
+            else
+            {
+                cost += sources_cost;
+            }
+        }
+
+        if (group_level || cost < best_cost)
+        {
+            best_cost = cost;
+            best_groups = std::move(groups);
+        }
+    }
+
+    return best_groups;
+}
+
+// Fills the rows of the sources of the group, see SourceGroup
+template <bool DIRECTION, typename Metrics>
+void sourceGroupSearch(SearchEngineData<Algorithm> &engine_working_data,
+                       const DataFacade<Algorithm> &facade,
+                       const std::vector<PhantomNode> &phantom_nodes,
+                       const std::vector<std::size_t> &source_indices,
+                       const std::size_t number_of_targets,
+                       const NodeBucketIndex &bucket_index,
+                       const LevelID level,
+                       const SourceGroup &group,
+                       std::vector<EdgeWeight> &weights_table,
+                       std::vector<EdgeDuration> &durations_table)
+{
+    const auto &partition = facade.GetMultiLevelPartition();
+    const auto number_of_sources = source_indices.size();
+    auto &deadline = Deadline::Current();
+
+    // The weights of the exits of the group to all targets, one row per exit in the order they
+    // are found by the sources
+    std::unordered_map<NodeID, std::size_t> exit_rows;
+    std::vector<EdgeWeight> exit_weights;
+    std::vector<EdgeDuration> exit_durations;
+
+    const auto search_exit = [&](const NodeID exit) {
+        std::vector<EdgeWeight> weights(number_of_targets, INVALID_EDGE_WEIGHT);
+        std::vector<EdgeDuration> durations(Metrics::duration ? number_of_targets : 0,
+                                            MAXIMAL_EDGE_DURATION);
+
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes(),
+                                                            facade.GetMaxBorderNodeID() + 1);
+        auto &query_heap = *(engine_working_data.many_to_many_heap);
+
+        // The search levels are the ones of a source at the exit. The exit is settled without
+        // its buckets and only its edges out of the cell are relaxed, the paths in the cell are
+        // found by the restricted searches of the sources.
+        PhantomNode exit_phantom;
+        exit_phantom.forward_segment_id = {exit, true};
+        const auto leaves_cell = [&](const NodeID, const NodeID to) {
+            return partition.GetCell(level, to) != group.cell;
+        };
+        query_heap.Insert(exit, 0, {exit, 0});
+        query_heap.DeleteMin();
+        relaxOutgoingEdges<DIRECTION, Metrics>(
+            facade, exit, 0, 0, query_heap, leaves_cell, exit_phantom);
+
+        while (!query_heap.Empty())
+        {
+            deadline.Check();
+            forwardRoutingStep<DIRECTION, Metrics>(facade,
+                                                   0,
+                                                   1,
+                                                   number_of_targets,
+                                                   query_heap,
+                                                   bucket_index,
+                                                   weights,
+                                                   durations,
+                                                   exit_phantom);
+        }
+
+        exit_rows.emplace(exit, exit_rows.size());
+        exit_weights.insert(exit_weights.end(), weights.begin(), weights.end());
+        exit_durations.insert(exit_durations.end(), durations.begin(), durations.end());
+    };
+
+    std::vector<NodeID> exits;
+    std::vector<std::tuple<NodeID, EdgeWeight, EdgeDuration>> exit_labels;
+    for (const auto row_idx : group.rows)
+    {
+        const auto &phantom = phantom_nodes[source_indices[row_idx]];
+
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes(),
+                                                            facade.GetMaxBorderNodeID() + 1);
+        auto &query_heap = *(engine_working_data.many_to_many_heap);
+
+        if (DIRECTION == FORWARD_DIRECTION)
+            insertSourceInHeap(query_heap, phantom);
+        else
+            insertTargetInHeap(query_heap, phantom);
+
+        // Edges out of the cell are not relaxed, their nodes are the exits the source reaches
+        exits.clear();
+        const auto stays_in_cell = [&](const NodeID from, const NodeID to) {
+            if (partition.GetCell(level, to) == group.cell)
+                return true;
+            // the edges of a node are relaxed one after the other
+            if (exits.empty() || exits.back() != from)
+                exits.push_back(from);
+            return false;
+        };
+
+        while (!query_heap.Empty())
+        {
+            deadline.Check();
+            forwardRoutingStep<DIRECTION, Metrics>(facade,
+                                                   row_idx,
+                                                   number_of_sources,
+                                                   number_of_targets,
+                                                   query_heap,
+                                                   bucket_index,
+                                                   weights_table,
+                                                   durations_table,
+                                                   phantom,
+                                                   stays_in_cell);
+        }
+
+        exit_labels.clear();
+        for (const auto exit : exits)
+        {
+            exit_labels.emplace_back(
+                exit, query_heap.GetKey(exit), query_heap.GetData(exit).duration);
+        }
+
+        for (const auto &label : exit_labels)
+        {
+            NodeID exit;
+            EdgeWeight exit_weight;
+            EdgeDuration exit_duration;
+            std::tie(exit, exit_weight, exit_duration) = label;
+
+            if (exit_rows.count(exit) == 0)
+                search_exit(exit);
+            const auto first_exit_column = exit_rows[exit] * number_of_targets;
+
+            for (const auto column_idx : util::irange<std::size_t>(0, number_of_targets))
+            {
+                const auto target_weight = exit_weights[first_exit_column + column_idx];
+                if (target_weight == INVALID_EDGE_WEIGHT)
+                    continue;
+
+                // the same layout as in forwardRoutingStep
+                const auto location = DIRECTION == FORWARD_DIRECTION
+                                          ? row_idx * number_of_targets + column_idx
+                                          : row_idx + column_idx * number_of_sources;
+                auto &current_weight = weights_table[location];
+                const auto new_weight = exit_weight + target_weight;
+
+                if (!Metrics::duration)
+                {
+                    current_weight = std::min(current_weight, new_weight);
+                    continue;
+                }
+
+                auto &current_duration = durations_table[location];
+                const auto new_duration =
+                    exit_duration + exit_durations[first_exit_column + column_idx];
+                if (std::tie(new_weight, new_duration) <
+                    std::tie(current_weight, current_duration))
+                {
+                    current_weight = new_weight;
+                    current_duration = new_duration;
+                }
+            }
+        }
+    }
 }
 
-template <bool DIRECTION>
+// Without a group level the source groups are planned by their estimated cost
+template <bool DIRECTION, typename Metrics>
 std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
 manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
                  const DataFacade<Algorithm> &facade,
                  const std::vector<PhantomNode> &phantom_nodes,
                  const std::vector<std::size_t> &source_indices,
-                 const std::vector<std::size_t> &target_indices)
+                 const std::vector<std::size_t> &target_indices,
+                 const boost::optional<LevelID> group_level)
 {
     const auto number_of_sources = source_indices.size();
     const auto number_of_targets = target_indices.size();
     const auto number_of_entries = number_of_sources * number_of_targets;
 
+    // MLD tables do not compute distances
     std::vector<EdgeWeight> weights_table(number_of_entries, INVALID_EDGE_WEIGHT);
-    std::vector<EdgeDuration> durations_table(number_of_entries, MAXIMAL_EDGE_DURATION);
-    std::vector<EdgeDistance> distances_table(number_of_entries, MAXIMAL_EDGE_DURATION);
+    std::vector<EdgeDuration> durations_table(Metrics::duration ? number_of_entries : 0,
+                                              MAXIMAL_EDGE_DURATION);
 
     std::vector<NodeBucket> search_space_with_buckets;
 
+    auto &deadline = Deadline::Current();
+
     // Populate buckets with paths from all accessible nodes to destinations via backward searches
     for (std::uint32_t column_idx = 0; column_idx < target_indices.size(); ++column_idx)
     {
         const auto index = target_indices[column_idx];
         const auto &phantom = phantom_nodes[index];
 
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes(), facade.GetMaxBorderNodeID() + 1);
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes(),
+                                                            facade.GetMaxBorderNodeID() + 1);
         auto &query_heap = *(engine_working_data.many_to_many_heap);
 
         if (DIRECTION == FORWARD_DIRECTION)
@@ -493,23 +808,53 @@ manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
         // explore search space
         while (!query_heap.Empty())
         {
-            backwardRoutingStep<DIRECTION>(
+            deadline.Check();
+            backwardRoutingStep<DIRECTION, Metrics>(
                 facade, column_idx, query_heap, search_space_with_buckets, phantom);
         }
     }
 
-    // Order lookup buckets
-    std::sort(search_space_with_buckets.begin(), search_space_with_buckets.end());
+    // Group lookup buckets by node
+    const NodeBucketIndex bucket_index(search_space_with_buckets);
+    std::vector<NodeBucket>().swap(search_space_with_buckets);
+
+    // The backward searches are restricted to the top level cells of the targets, their average
+    // number of settled nodes is a lower bound of the cost of a source search
+    const auto search_cost =
+        std::max(1., static_cast<double>(bucket_index.GetNumberOfBuckets()) / number_of_targets);
+    const auto source_groups = planSourceGroups(
+        facade, phantom_nodes, source_indices, number_of_targets, search_cost, group_level);
+
+    std::vector<bool> is_grouped(number_of_sources, false);
+    for (const auto &group : source_groups.groups)
+    {
+        for (const auto row_idx : group.rows)
+            is_grouped[row_idx] = true;
+
+        sourceGroupSearch<DIRECTION, Metrics>(engine_working_data,
+                                              facade,
+                                              phantom_nodes,
+                                              source_indices,
+                                              number_of_targets,
+                                              bucket_index,
+                                              source_groups.level,
+                                              group,
+                                              weights_table,
+                                              durations_table);
+    }
 
     // Find shortest paths from sources to all accessible nodes
     for (std::uint32_t row_idx = 0; row_idx < source_indices.size(); ++row_idx)
     {
+        if (is_grouped[row_idx])
+            continue;
+
         const auto index = source_indices[row_idx];
         const auto &phantom = phantom_nodes[index];
 
         // Clear heap and insert source nodes
-        engine_working_data.InitializeOrClearManyToManyThreadLocalStorage(
-            facade.GetNumberOfNodes(), facade.GetMaxBorderNodeID() + 1);
+        engine_working_data.InitializeOrClearManyToManyHeap(facade.GetNumberOfNodes(),
+                                                            facade.GetMaxBorderNodeID() + 1);
         auto &query_heap = *(engine_working_data.many_to_many_heap);
 
         if (DIRECTION == FORWARD_DIRECTION)
@@ -520,23 +865,22 @@ manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
         // Explore search space
         while (!query_heap.Empty())
         {
-            forwardRoutingStep<DIRECTION>(facade,
-                                          row_idx,
-                                          number_of_sources,
-                                          number_of_targets,
-                                          query_heap,
-                                          search_space_with_buckets,
-                                          weights_table,
-                                          durations_table,
-                                          phantom);
+            deadline.Check();
+            forwardRoutingStep<DIRECTION, Metrics>(facade,
+                                                   row_idx,
+                                                   number_of_sources,
+                                                   number_of_targets,
+                                                   query_heap,
+                                                   bucket_index,
+                                                   weights_table,
+                                                   durations_table,
+                                                   phantom);
         }
     }
 
-    return std::make_pair(durations_table, distances_table);
+    return std::make_pair(durations_table, std::vector<EdgeDistance>());
 }
 
-} // namespace mld
-
 // Dispatcher function for one-to-many and many-to-one tasks that can be handled by MLD differently:
 //
 // * one-to-many (many-to-one) tasks use a unidirectional forward (backward) Dijkstra search
@@ -549,6 +893,77 @@ manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
 //   when number of sources is less than targets. If number of targets is less than sources
 //   then search is performed on a reversed graph with phantom nodes with flipped roles and
 //   returning a transposed matrix.
+inline std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
+dispatchManyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                         const DataFacade<Algorithm> &facade,
+                         const std::vector<PhantomNode> &phantom_nodes,
+                         const std::vector<std::size_t> &source_indices,
+                         const std::vector<std::size_t> &target_indices,
+                         const bool calculate_duration,
+                         const boost::optional<LevelID> group_level)
+{
+    return dispatchTableMetrics(calculate_duration, false, [&](auto metrics) {
+        using Metrics = decltype(metrics);
+
+        if (source_indices.size() == 1)
+        { // TODO: check if target_indices.size() == 1 and do a bi-directional search
+            return oneToManySearch<FORWARD_DIRECTION, Metrics>(engine_working_data,
+                                                               facade,
+                                                               phantom_nodes,
+                                                               source_indices.front(),
+                                                               target_indices);
+        }
+
+        if (target_indices.size() == 1)
+        {
+            return oneToManySearch<REVERSE_DIRECTION, Metrics>(engine_working_data,
+                                                               facade,
+                                                               phantom_nodes,
+                                                               target_indices.front(),
+                                                               source_indices);
+        }
+
+        if (target_indices.size() < source_indices.size())
+        {
+            return manyToManySearch<REVERSE_DIRECTION, Metrics>(engine_working_data,
+                                                                facade,
+                                                                phantom_nodes,
+                                                                target_indices,
+                                                                source_indices,
+                                                                group_level);
+        }
+
+        return manyToManySearch<FORWARD_DIRECTION, Metrics>(engine_working_data,
+                                                            facade,
+                                                            phantom_nodes,
+                                                            source_indices,
+                                                            target_indices,
+                                                            group_level);
+    });
+}
+
+std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
+manyToManySearch(SearchEngineData<Algorithm> &engine_working_data,
+                 const DataFacade<Algorithm> &facade,
+                 const std::vector<PhantomNode> &phantom_nodes,
+                 const std::vector<std::size_t> &source_indices,
+                 const std::vector<std::size_t> &target_indices,
+                 const bool calculate_distance,
+                 const bool calculate_duration,
+                 const LevelID group_level)
+{
+    (void)calculate_distance; // MLD tables do not compute distances
+    return dispatchManyToManySearch(engine_working_data,
+                                    facade,
+                                    phantom_nodes,
+                                    source_indices,
+                                    target_indices,
+                                    calculate_duration,
+                                    group_level);
+}
+
+} // namespace mld
+
 template <>
 std::pair<std::vector<EdgeDuration>, std::vector<EdgeDistance>>
 manyToManySearch(SearchEngineData<mld::Algorithm> &engine_working_data,
@@ -557,33 +972,87 @@ manyToManySearch(SearchEngineData<mld::Algorithm> &engine_working_data,
                  const std::vector<std::size_t> &source_indices,
                  const std::vector<std::size_t> &target_indices,
                  const bool calculate_distance,
-                 const bool calculate_duration)
+                 const bool calculate_duration,
+                 const unsigned max_threads)
 {
+    (void)max_threads;        // searches run on the calling thread, see the CH implementation
     (void)calculate_distance; // flag stub to use for calculating distances in matrix in mld in the
                               // future
-    (void)calculate_duration; // flag stub to use for calculating distances in matrix in mld in the
-                              // future
 
-    if (source_indices.size() == 1)
-    { // TODO: check if target_indices.size() == 1 and do a bi-directional search
-        return mld::oneToManySearch<FORWARD_DIRECTION>(
-            engine_working_data, facade, phantom_nodes, source_indices.front(), target_indices);
-    }
+    return mld::dispatchManyToManySearch(engine_working_data,
+                                         facade,
+                                         phantom_nodes,
+                                         source_indices,
+                                         target_indices,
+                                         calculate_duration,
+                                         boost::none);
+}
 
-    if (target_indices.size() == 1)
-    {
-        return mld::oneToManySearch<REVERSE_DIRECTION>(
-            engine_working_data, facade, phantom_nodes, target_indices.front(), source_indices);
-    }
+// The transposed searches finish all rows at once, the table is passed as a single block
+template <>
+void manyToManyBlockSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                           const DataFacade<mld::Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const std::vector<std::size_t> &target_indices,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t,
+                           const ManyToManyRowsHandler &handler)
+{
+    auto tables = manyToManySearch(engine_working_data,
+                                   facade,
+                                   phantom_nodes,
+                                   source_indices,
+                                   target_indices,
+                                   calculate_distance,
+                                   calculate_duration,
+                                   max_threads);
+    handler(0, tables.first, tables.second);
+}
 
-    if (target_indices.size() < source_indices.size())
-    {
-        return mld::manyToManySearch<REVERSE_DIRECTION>(
-            engine_working_data, facade, phantom_nodes, target_indices, source_indices);
-    }
+// MLD has nothing to precompute, the targets are only snapped once
+template <>
+std::shared_ptr<ManyToManyTargets>
+manyToManyTargets(SearchEngineData<mld::Algorithm> &,
+                  const DataFacade<mld::Algorithm> &,
+                  const std::vector<PhantomNode> &target_phantom_nodes,
+                  const unsigned)
+{
+    return std::make_shared<ManyToManyTargets>(target_phantom_nodes);
+}
 
-    return mld::manyToManySearch<FORWARD_DIRECTION>(
-        engine_working_data, facade, phantom_nodes, source_indices, target_indices);
+template <>
+void manyToManyBlockSearch(SearchEngineData<mld::Algorithm> &engine_working_data,
+                           const DataFacade<mld::Algorithm> &facade,
+                           const std::vector<PhantomNode> &phantom_nodes,
+                           const std::vector<std::size_t> &source_indices,
+                           const ManyToManyTargets &targets,
+                           const bool calculate_distance,
+                           const bool calculate_duration,
+                           const unsigned max_threads,
+                           const std::size_t rows_per_block,
+                           const ManyToManyRowsHandler &handler)
+{
+    // the targets follow the phantom nodes of the sources
+    auto all_phantom_nodes = phantom_nodes;
+    all_phantom_nodes.insert(all_phantom_nodes.end(),
+                             targets.GetPhantomNodes().begin(),
+                             targets.GetPhantomNodes().end());
+    std::vector<std::size_t> target_indices(targets.GetPhantomNodes().size());
+    std::iota(target_indices.begin(), target_indices.end(), phantom_nodes.size());
+
+    manyToManyBlockSearch(engine_working_data,
+                          facade,
+                          all_phantom_nodes,
+                          source_indices,
+                          target_indices,
+                          calculate_distance,
+                          calculate_duration,
+                          max_threads,
+                          rows_per_block,
+                          handler);
 }
 
 } // namespace routing_algorithms
@@ -15,6 +15,7 @@
 #include <iomanip>
 #include <memory>
 #include <numeric>
+#include <set>
 #include <utility>
 
 namespace osrm
@@ -53,7 +54,7 @@ inline void initializeHeap(SearchEngineData<Algorithm> &engine_working_data,
 {
 
     const auto nodes_number = facade.GetNumberOfNodes();
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(nodes_number);
+    engine_working_data.InitializeOrClearFirstHeaps(nodes_number);
 }
 
 template <>
@@ -63,48 +64,32 @@ inline void initializeHeap<mld::Algorithm>(SearchEngineData<mld::Algorithm> &eng
 
     const auto nodes_number = facade.GetNumberOfNodes();
     const auto border_nodes_number = facade.GetMaxBorderNodeID() + 1;
-    engine_working_data.InitializeOrClearFirstThreadLocalStorage(nodes_number, border_nodes_number);
-}
+    engine_working_data.InitializeOrClearFirstHeaps(nodes_number, border_nodes_number);
 }
 
-template <typename Algorithm>
-SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
-                            const DataFacade<Algorithm> &facade,
-                            const CandidateLists &candidates_list,
-                            const std::vector<util::Coordinate> &trace_coordinates,
-                            const std::vector<unsigned> &trace_timestamps,
-                            const std::vector<boost::optional<double>> &trace_gps_precision,
-                            const bool allow_splitting)
+void appendEmissionLogProbabilities(MapMatchingState &state)
 {
-    map_matching::MatchingConfidence confidence;
-    map_matching::EmissionLogProbability default_emission_log_probability(DEFAULT_GPS_PRECISION);
-    map_matching::TransitionLogProbability transition_log_probability(MATCHING_BETA);
-
-    SubMatchingList sub_matchings;
+    const map_matching::EmissionLogProbability default_emission_log_probability(
+        DEFAULT_GPS_PRECISION);
 
-    BOOST_ASSERT(candidates_list.size() == trace_coordinates.size());
-    BOOST_ASSERT(candidates_list.size() > 1);
-
-    const bool use_timestamps = trace_timestamps.size() > 1;
-
-    const auto median_sample_time = [&] {
-        if (use_timestamps)
+    const auto &candidates_list = state.candidates_list;
+    const auto &trace_gps_precision = state.trace_gps_precision;
+    auto &emission_log_probabilities = state.emission_log_probabilities;
+    for (auto t = emission_log_probabilities.size(); t < candidates_list.size(); ++t)
+    {
+        emission_log_probabilities.emplace_back(candidates_list[t].size());
+        if (!trace_gps_precision.empty() && trace_gps_precision[t])
         {
-            return std::max(1u, getMedianSampleTime(trace_timestamps));
+            map_matching::EmissionLogProbability emission_log_probability(*trace_gps_precision[t]);
+            std::transform(candidates_list[t].begin(),
+                           candidates_list[t].end(),
+                           emission_log_probabilities[t].begin(),
+                           [&emission_log_probability](const PhantomNodeWithDistance &candidate) {
+                               return emission_log_probability(candidate.distance);
+                           });
         }
         else
         {
-            return 1u;
-        }
-    }();
-    const auto max_broken_time = median_sample_time * MAX_BROKEN_STATES;
-
-    std::vector<std::vector<double>> emission_log_probabilities(trace_coordinates.size());
-    if (trace_gps_precision.empty())
-    {
-        for (auto t = 0UL; t < candidates_list.size(); ++t)
-        {
-            emission_log_probabilities[t].resize(candidates_list[t].size());
             std::transform(candidates_list[t].begin(),
                            candidates_list[t].end(),
                            emission_log_probabilities[t].begin(),
@@ -113,55 +98,70 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                            });
         }
     }
-    else
+}
+
+// Computes the transitions to the points from state.next_timestamp on and records the splits
+template <typename Algorithm>
+void forwardSteps(SearchEngineData<Algorithm> &engine_working_data,
+                  const DataFacade<Algorithm> &facade,
+                  MapMatchingState &state,
+                  const bool allow_splitting)
+{
+    const map_matching::TransitionLogProbability transition_log_probability(MATCHING_BETA);
+
+    const auto &candidates_list = state.candidates_list;
+    const auto &trace_coordinates = state.trace_coordinates;
+    const auto &trace_timestamps = state.trace_timestamps;
+    const auto &emission_log_probabilities = state.emission_log_probabilities;
+    auto &model = state.model;
+    auto &breakage_begin = state.breakage_begin;
+    auto &split_points = state.split_points;
+    auto &prev_unbroken_timestamps = state.prev_unbroken_timestamps;
+
+    if (state.next_timestamp >= candidates_list.size())
+    {
+        return;
+    }
+
+    if (prev_unbroken_timestamps.empty())
     {
-        for (auto t = 0UL; t < candidates_list.size(); ++t)
+        std::size_t initial_timestamp = model.initialize(state.next_timestamp);
+        if (initial_timestamp == map_matching::INVALID_STATE)
         {
-            emission_log_probabilities[t].resize(candidates_list[t].size());
-            if (trace_gps_precision[t])
-            {
-                map_matching::EmissionLogProbability emission_log_probability(
-                    *trace_gps_precision[t]);
-                std::transform(
-                    candidates_list[t].begin(),
-                    candidates_list[t].end(),
-                    emission_log_probabilities[t].begin(),
-                    [&emission_log_probability](const PhantomNodeWithDistance &candidate) {
-                        return emission_log_probability(candidate.distance);
-                    });
-            }
-            else
-            {
-                std::transform(candidates_list[t].begin(),
-                               candidates_list[t].end(),
-                               emission_log_probabilities[t].begin(),
-                               [&](const PhantomNodeWithDistance &candidate) {
-                                   return default_emission_log_probability(candidate.distance);
-                               });
-            }
+            // the last point might still start a sub matching once more points are known
+            state.next_timestamp = candidates_list.size() - 1;
+            return;
         }
+        state.sub_matching_begin = initial_timestamp;
+        prev_unbroken_timestamps.push_back(initial_timestamp);
+        state.next_timestamp = initial_timestamp + 1;
     }
 
-    HMM model(candidates_list, emission_log_probabilities);
+    const bool use_timestamps = trace_timestamps.size() > 1;
 
-    std::size_t initial_timestamp = model.initialize(0);
-    if (initial_timestamp == map_matching::INVALID_STATE)
-    {
-        return sub_matchings;
-    }
+    const auto median_sample_time = [&] {
+        if (use_timestamps)
+        {
+            return std::max(1u, getMedianSampleTime(trace_timestamps));
+        }
+        else
+        {
+            return 1u;
+        }
+    }();
+    const auto max_broken_time = median_sample_time * MAX_BROKEN_STATES;
 
     initializeHeap(engine_working_data, facade);
     auto &forward_heap = *engine_working_data.forward_heap_1;
     auto &reverse_heap = *engine_working_data.reverse_heap_1;
 
-    std::size_t breakage_begin = map_matching::INVALID_STATE;
-    std::vector<std::size_t> split_points;
-    std::vector<std::size_t> prev_unbroken_timestamps;
-    prev_unbroken_timestamps.reserve(candidates_list.size());
-    prev_unbroken_timestamps.push_back(initial_timestamp);
-    for (auto t = initial_timestamp + 1; t < candidates_list.size(); ++t)
-    {
+    std::vector<std::size_t> target_candidates;
+    std::vector<PhantomNode> target_phantoms;
 
+    const auto &deadline = Deadline::Current();
+    for (auto t = state.next_timestamp; t < candidates_list.size(); ++t)
+    {
+        deadline.CheckNow();
         const auto step_time = [&] {
             if (use_timestamps)
             {
@@ -228,23 +228,41 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
                     continue;
                 }
 
+                // only the candidates that s can still improve need network distances, they are
+                // all found by one search from s
+                target_candidates.clear();
+                target_phantoms.clear();
                 for (const auto s_prime : util::irange<std::size_t>(0UL, current_viterbi.size()))
                 {
                     const double emission_pr = emission_log_probabilities[t][s_prime];
-                    double new_value = prev_viterbi[s] + emission_pr;
-                    if (current_viterbi[s_prime] > new_value)
+                    if (current_viterbi[s_prime] > prev_viterbi[s] + emission_pr)
                     {
                         continue;
                     }
+                    target_candidates.push_back(s_prime);
+                    target_phantoms.push_back(current_timestamps_list[s_prime].phantom_node);
+                }
 
-                    double network_distance =
-                        getNetworkDistance(engine_working_data,
-                                           facade,
-                                           forward_heap,
-                                           reverse_heap,
-                                           prev_unbroken_timestamps_list[s].phantom_node,
-                                           current_timestamps_list[s_prime].phantom_node,
-                                           weight_upper_bound);
+                if (target_candidates.empty())
+                {
+                    continue;
+                }
+
+                const auto network_distances =
+                    getNetworkDistances(engine_working_data,
+                                        facade,
+                                        forward_heap,
+                                        reverse_heap,
+                                        prev_unbroken_timestamps_list[s].phantom_node,
+                                        target_phantoms,
+                                        weight_upper_bound);
+
+                for (const auto target : util::irange<std::size_t>(0UL, target_candidates.size()))
+                {
+                    const auto s_prime = target_candidates[target];
+                    const double emission_pr = emission_log_probabilities[t][s_prime];
+                    double new_value = prev_viterbi[s] + emission_pr;
+                    const double network_distance = network_distances[target];
 
                     // get distance diff between loc1/2 and locs/s_prime
                     const auto d_t = std::abs(network_distance - haversine_distance);
@@ -302,14 +320,15 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
 
             // note: this preserves everything before split_index
             model.Clear(split_index);
+            prev_unbroken_timestamps.clear();
             std::size_t new_start = model.initialize(split_index);
             // no new start was found -> stop viterbi calculation
             if (new_start == map_matching::INVALID_STATE)
             {
-                break;
+                state.next_timestamp = candidates_list.size() - 1;
+                return;
             }
 
-            prev_unbroken_timestamps.clear();
             prev_unbroken_timestamps.push_back(new_start);
             // Important: We potentially go back here!
             // However since t > new_start >= breakge_begin
@@ -320,16 +339,105 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
         }
     }
 
-    if (!prev_unbroken_timestamps.empty())
+    state.next_timestamp = candidates_list.size();
+}
+
+// Backtracks the sub matching from the given last state to sub_matching_begin
+void backtrackSubMatching(MapMatchingState &state,
+                          const std::size_t sub_matching_begin,
+                          std::size_t parent_timestamp_index,
+                          std::size_t parent_candidate_index,
+                          SubMatchingList &sub_matchings)
+{
+    const map_matching::MatchingConfidence confidence;
+
+    auto &model = state.model;
+    const auto &candidates_list = state.candidates_list;
+    const auto &trace_coordinates = state.trace_coordinates;
+    const auto sub_matching_last_timestamp = parent_timestamp_index;
+
+    std::deque<std::pair<std::size_t, std::size_t>> reconstructed_indices;
+    while (parent_timestamp_index > sub_matching_begin)
+    {
+        reconstructed_indices.emplace_front(parent_timestamp_index, parent_candidate_index);
+        model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
+        const auto &next = model.parents[parent_timestamp_index][parent_candidate_index];
+        // make sure we can never get stuck in this loop
+        if (parent_timestamp_index == next.first)
+        {
+            break;
+        }
+        parent_timestamp_index = next.first;
+        parent_candidate_index = next.second;
+    }
+    reconstructed_indices.emplace_front(parent_timestamp_index, parent_candidate_index);
+    model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
+    if (reconstructed_indices.size() < 2)
+    {
+        return;
+    }
+
+    // fill viterbi reachability matrix
+    for (const auto s_last :
+         util::irange<std::size_t>(0UL, model.viterbi[sub_matching_last_timestamp].size()))
     {
-        split_points.push_back(prev_unbroken_timestamps.back() + 1);
+        parent_timestamp_index = sub_matching_last_timestamp;
+        parent_candidate_index = s_last;
+        while (parent_timestamp_index > sub_matching_begin)
+        {
+            if (model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] ||
+                model.pruned[parent_timestamp_index][parent_candidate_index])
+            {
+                break;
+            }
+            model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
+            const auto &next = model.parents[parent_timestamp_index][parent_candidate_index];
+            parent_timestamp_index = next.first;
+            parent_candidate_index = next.second;
+        }
+        model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
     }
 
-    std::size_t sub_matching_begin = initial_timestamp;
-    for (const auto sub_matching_end : split_points)
+    map_matching::SubMatching matching;
+    auto matching_distance = 0.0;
+    auto trace_distance = 0.0;
+    matching.nodes.reserve(reconstructed_indices.size());
+    matching.indices.reserve(reconstructed_indices.size());
+    for (const auto &idx : reconstructed_indices)
     {
-        map_matching::SubMatching matching;
+        const auto timestamp_index = idx.first;
+        const auto location_index = idx.second;
+
+        matching.indices.push_back(state.first_index + timestamp_index);
+        matching.nodes.push_back(candidates_list[timestamp_index][location_index].phantom_node);
+        auto const routes_count = std::accumulate(model.viterbi_reachable[timestamp_index].begin(),
+                                                  model.viterbi_reachable[timestamp_index].end(),
+                                                  0);
+        BOOST_ASSERT(routes_count > 0);
+        // we don't count the current route in the "alternatives_count" parameter
+        matching.alternatives_count.push_back(routes_count - 1);
+        matching_distance += model.path_distances[timestamp_index][location_index];
+    }
+    util::for_each_pair(
+        reconstructed_indices,
+        [&trace_distance, &trace_coordinates](const std::pair<std::size_t, std::size_t> &prev,
+                                              const std::pair<std::size_t, std::size_t> &curr) {
+            trace_distance += util::coordinate_calculation::haversineDistance(
+                trace_coordinates[prev.first], trace_coordinates[curr.first]);
+        });
+
+    matching.confidence = confidence(trace_distance, matching_distance);
 
+    sub_matchings.push_back(std::move(matching));
+}
+
+// Backtracks the sub matchings that end at the split points
+void extractSubMatchings(MapMatchingState &state, SubMatchingList &sub_matchings)
+{
+    const auto &model = state.model;
+    auto &sub_matching_begin = state.sub_matching_begin;
+    for (const auto sub_matching_end : state.split_points)
+    {
         std::size_t parent_timestamp_index = sub_matching_end - 1;
         while (parent_timestamp_index >= sub_matching_begin &&
                model.breakage[parent_timestamp_index])
@@ -340,7 +448,6 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
         {
             ++sub_matching_begin;
         }
-        const auto sub_matching_last_timestamp = parent_timestamp_index;
 
         // matchings that only consist of one candidate are invalid
         if (parent_timestamp_index - sub_matching_begin + 1 < 2)
@@ -357,86 +464,243 @@ SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
         std::size_t parent_candidate_index =
             std::distance(model.viterbi[parent_timestamp_index].begin(), max_element_iter);
 
-        std::deque<std::pair<std::size_t, std::size_t>> reconstructed_indices;
-        while (parent_timestamp_index > sub_matching_begin)
+        backtrackSubMatching(state,
+                             sub_matching_begin,
+                             parent_timestamp_index,
+                             parent_candidate_index,
+                             sub_matchings);
+        sub_matching_begin = sub_matching_end;
+    }
+    state.split_points.clear();
+}
+
+// Drops the first points of the state, all indices are shifted to the remaining points
+void dropPoints(MapMatchingState &state, const std::size_t number_of_points)
+{
+    BOOST_ASSERT(state.split_points.empty());
+    BOOST_ASSERT(number_of_points <= state.candidates_list.size());
+    if (number_of_points == 0)
+    {
+        return;
+    }
+
+    const auto drop = [number_of_points](auto &values) {
+        if (!values.empty())
         {
-            reconstructed_indices.emplace_front(parent_timestamp_index, parent_candidate_index);
-            model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
-            const auto &next = model.parents[parent_timestamp_index][parent_candidate_index];
-            // make sure we can never get stuck in this loop
-            if (parent_timestamp_index == next.first)
-            {
-                break;
-            }
-            parent_timestamp_index = next.first;
-            parent_candidate_index = next.second;
+            values.erase(values.begin(), values.begin() + number_of_points);
         }
-        reconstructed_indices.emplace_front(parent_timestamp_index, parent_candidate_index);
-        model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
-        if (reconstructed_indices.size() < 2)
+    };
+    drop(state.candidates_list);
+    drop(state.trace_coordinates);
+    drop(state.trace_timestamps);
+    drop(state.trace_gps_precision);
+    drop(state.emission_log_probabilities);
+    state.model.Drop(number_of_points);
+    state.first_index += number_of_points;
+
+    const auto shift = [number_of_points](const std::size_t index) {
+        return index > number_of_points ? index - number_of_points : 0;
+    };
+    auto &prev_unbroken_timestamps = state.prev_unbroken_timestamps;
+    prev_unbroken_timestamps.erase(std::remove_if(prev_unbroken_timestamps.begin(),
+                                                  prev_unbroken_timestamps.end(),
+                                                  [number_of_points](const std::size_t t) {
+                                                      return t < number_of_points;
+                                                  }),
+                                   prev_unbroken_timestamps.end());
+    std::transform(prev_unbroken_timestamps.begin(),
+                   prev_unbroken_timestamps.end(),
+                   prev_unbroken_timestamps.begin(),
+                   shift);
+    if (state.breakage_begin != map_matching::INVALID_STATE)
+    {
+        state.breakage_begin = state.breakage_begin < number_of_points
+                                   ? map_matching::INVALID_STATE
+                                   : state.breakage_begin - number_of_points;
+    }
+    state.next_timestamp = shift(state.next_timestamp);
+    state.sub_matching_begin = shift(state.sub_matching_begin);
+}
+
+// Finds the latest state that all states which later transitions or splits can continue from
+// descend from. The matching up to it can not change anymore.
+std::pair<std::size_t, std::size_t> findConvergedState(const MapMatchingState &state)
+{
+    const auto &model = state.model;
+    const auto &prev_unbroken_timestamps = state.prev_unbroken_timestamps;
+    BOOST_ASSERT(!prev_unbroken_timestamps.empty());
+    const auto last_timestamp = state.candidates_list.size() - 1;
+
+    std::set<std::pair<std::size_t, std::size_t>> live_states;
+    const auto add_best_state = [&](std::size_t t) {
+        while (t > state.sub_matching_begin && model.breakage[t])
         {
-            sub_matching_begin = sub_matching_end;
-            continue;
+            --t;
         }
+        const auto max_element_iter =
+            std::max_element(model.viterbi[t].begin(), model.viterbi[t].end());
+        live_states.emplace(t, std::distance(model.viterbi[t].begin(), max_element_iter));
+    };
 
-        // fill viterbi reachability matrix
-        for (const auto s_last :
-             util::irange<std::size_t>(0UL, model.viterbi[sub_matching_last_timestamp].size()))
+    // later transitions start at the recent unbroken points
+    for (const auto t : prev_unbroken_timestamps)
+    {
+        if (t + MAX_BROKEN_STATES < last_timestamp && t != prev_unbroken_timestamps.back())
         {
-            parent_timestamp_index = sub_matching_last_timestamp;
-            parent_candidate_index = s_last;
-            while (parent_timestamp_index > sub_matching_begin)
+            continue;
+        }
+        for (const auto s : util::irange<std::size_t>(0UL, model.viterbi[t].size()))
+        {
+            if (!model.pruned[t][s])
             {
-                if (model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] ||
-                    model.pruned[parent_timestamp_index][parent_candidate_index])
-                {
-                    break;
-                }
-                model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
-                const auto &next = model.parents[parent_timestamp_index][parent_candidate_index];
-                parent_timestamp_index = next.first;
-                parent_candidate_index = next.second;
+                live_states.emplace(t, s);
             }
-            model.viterbi_reachable[parent_timestamp_index][parent_candidate_index] = true;
         }
+    }
+    // splits end the sub matching at the best state before the gap or the breakage
+    add_best_state(last_timestamp);
+    if (state.breakage_begin != map_matching::INVALID_STATE && state.breakage_begin > 0)
+    {
+        add_best_state(state.breakage_begin - 1);
+    }
 
-        auto matching_distance = 0.0;
-        auto trace_distance = 0.0;
-        matching.nodes.reserve(reconstructed_indices.size());
-        matching.indices.reserve(reconstructed_indices.size());
-        for (const auto &idx : reconstructed_indices)
+    while (live_states.size() > 1)
+    {
+        const auto latest = std::prev(live_states.end());
+        const auto t = latest->first;
+        const auto s = latest->second;
+        const auto &parent = model.parents[t][s];
+        // reached the start of the sub matching
+        if (parent.first == t)
         {
-            const auto timestamp_index = idx.first;
-            const auto location_index = idx.second;
-
-            matching.indices.push_back(timestamp_index);
-            matching.nodes.push_back(candidates_list[timestamp_index][location_index].phantom_node);
-            auto const routes_count =
-                std::accumulate(model.viterbi_reachable[timestamp_index].begin(),
-                                model.viterbi_reachable[timestamp_index].end(),
-                                0);
-            BOOST_ASSERT(routes_count > 0);
-            // we don't count the current route in the "alternatives_count" parameter
-            matching.alternatives_count.push_back(routes_count - 1);
-            matching_distance += model.path_distances[timestamp_index][location_index];
+            return std::make_pair(map_matching::INVALID_STATE, map_matching::INVALID_STATE);
         }
-        util::for_each_pair(
-            reconstructed_indices,
-            [&trace_distance, &trace_coordinates](const std::pair<std::size_t, std::size_t> &prev,
-                                                  const std::pair<std::size_t, std::size_t> &curr) {
-                trace_distance += util::coordinate_calculation::haversineDistance(
-                    trace_coordinates[prev.first], trace_coordinates[curr.first]);
-            });
+        live_states.erase(latest);
+        live_states.emplace(parent.first, parent.second);
+    }
+    return *live_states.begin();
+}
 
-        matching.confidence = confidence(trace_distance, matching_distance);
+// Returns the sub matching up to the converged state and continues the matching from it
+void finalizeUpTo(MapMatchingState &state,
+                  const std::size_t converged_timestamp,
+                  const std::size_t converged_candidate,
+                  SubMatchingList &sub_matchings)
+{
+    auto &model = state.model;
 
-        sub_matchings.push_back(matching);
-        sub_matching_begin = sub_matching_end;
+    std::size_t sub_matching_begin = state.sub_matching_begin;
+    while (sub_matching_begin < converged_timestamp && model.breakage[sub_matching_begin])
+    {
+        ++sub_matching_begin;
+    }
+    backtrackSubMatching(
+        state, sub_matching_begin, converged_timestamp, converged_candidate, sub_matchings);
+
+    // the converged state is the only start of the rest of the matching, the log probabilities
+    // are kept relative to it so they don't grow without bound
+    const auto root_viterbi = model.viterbi[converged_timestamp][converged_candidate];
+    for (const auto s : util::irange<std::size_t>(0UL, model.viterbi[converged_timestamp].size()))
+    {
+        if (s != converged_candidate)
+        {
+            model.viterbi[converged_timestamp][s] = map_matching::IMPOSSIBLE_LOG_PROB;
+            model.pruned[converged_timestamp][s] = true;
+        }
+    }
+    model.parents[converged_timestamp][converged_candidate] =
+        std::make_pair(converged_timestamp, converged_candidate);
+    model.path_distances[converged_timestamp][converged_candidate] = 0;
+    std::fill(model.viterbi_reachable[converged_timestamp].begin(),
+              model.viterbi_reachable[converged_timestamp].end(),
+              false);
+    for (const auto t : util::irange(converged_timestamp, model.viterbi.size()))
+    {
+        for (auto &value : model.viterbi[t])
+        {
+            value -= root_viterbi;
+        }
+    }
+
+    dropPoints(state, converged_timestamp);
+}
+}
+
+template <typename Algorithm>
+SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            MapMatchingState &state,
+                            const bool allow_splitting,
+                            const bool finish,
+                            const std::size_t max_kept_points)
+{
+    BOOST_ASSERT(state.candidates_list.size() == state.trace_coordinates.size());
+    BOOST_ASSERT(state.trace_timestamps.empty() ||
+                 state.trace_timestamps.size() == state.candidates_list.size());
+    BOOST_ASSERT(state.trace_gps_precision.empty() ||
+                 state.trace_gps_precision.size() == state.candidates_list.size());
+
+    appendEmissionLogProbabilities(state);
+    state.model.Grow();
+    forwardSteps(engine_working_data, facade, state, allow_splitting);
+
+    SubMatchingList sub_matchings;
+    extractSubMatchings(state, sub_matchings);
+
+    if (!finish)
+    {
+        if (state.prev_unbroken_timestamps.empty())
+        {
+            // everything before the next start is matched already
+            dropPoints(state, state.next_timestamp);
+        }
+        else
+        {
+            dropPoints(state, state.sub_matching_begin);
+            const auto converged_state = findConvergedState(state);
+            if (converged_state.first != map_matching::INVALID_STATE &&
+                converged_state.first > 0)
+            {
+                finalizeUpTo(state, converged_state.first, converged_state.second, sub_matchings);
+            }
+        }
+    }
+
+    const auto number_of_points = state.candidates_list.size();
+    if (finish || (max_kept_points > 0 && number_of_points > max_kept_points))
+    {
+        if (!state.prev_unbroken_timestamps.empty())
+        {
+            state.split_points.push_back(state.prev_unbroken_timestamps.back() + 1);
+        }
+        extractSubMatchings(state, sub_matchings);
+        dropPoints(state, number_of_points);
     }
 
     return sub_matchings;
 }
 
+template <typename Algorithm>
+SubMatchingList mapMatching(SearchEngineData<Algorithm> &engine_working_data,
+                            const DataFacade<Algorithm> &facade,
+                            const CandidateLists &candidates_list,
+                            const std::vector<util::Coordinate> &trace_coordinates,
+                            const std::vector<unsigned> &trace_timestamps,
+                            const std::vector<boost::optional<double>> &trace_gps_precision,
+                            const bool allow_splitting)
+{
+    BOOST_ASSERT(candidates_list.size() == trace_coordinates.size());
+    BOOST_ASSERT(candidates_list.size() > 1);
+
+    MapMatchingState state;
+    state.candidates_list = candidates_list;
+    state.trace_coordinates = trace_coordinates;
+    state.trace_timestamps = trace_timestamps;
+    state.trace_gps_precision = trace_gps_precision;
+
+    return mapMatching(engine_working_data, facade, state, allow_splitting, true);
+}
+
 // CH
 template SubMatchingList
 mapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
@@ -447,6 +711,13 @@ mapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
             const std::vector<boost::optional<double>> &trace_gps_precision,
             const bool allow_splitting);
 
+template SubMatchingList mapMatching(SearchEngineData<ch::Algorithm> &engine_working_data,
+                                     const DataFacade<ch::Algorithm> &facade,
+                                     MapMatchingState &state,
+                                     const bool allow_splitting,
+                                     const bool finish,
+                                     const std::size_t max_kept_points);
+
 // MLD
 template SubMatchingList
 mapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
@@ -457,6 +728,13 @@ mapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
             const std::vector<boost::optional<double>> &trace_gps_precision,
             const bool allow_splitting);
 
+template SubMatchingList mapMatching(SearchEngineData<mld::Algorithm> &engine_working_data,
+                                     const DataFacade<mld::Algorithm> &facade,
+                                     MapMatchingState &state,
+                                     const bool allow_splitting,
+                                     const bool finish,
+                                     const std::size_t max_kept_points);
+
 } // namespace routing_algorithms
 } // namespace engine
 } // namespace osrm
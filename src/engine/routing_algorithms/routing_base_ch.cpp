@@ -1,5 +1,7 @@
 #include "engine/routing_algorithms/routing_base_ch.hpp"
 
+#include "util/integer_range.hpp"
+
 namespace osrm
 {
 namespace engine
@@ -115,9 +117,12 @@ void search(SearchEngineData<Algorithm> & /*engine_working_data*/,
     // we only every insert negative offsets for nodes in the forward heap
     BOOST_ASSERT(reverse_heap.MinKey() >= 0);
 
+    auto &deadline = Deadline::Current();
+
     // run two-Target Dijkstra routing step.
     while (0 < (forward_heap.Size() + reverse_heap.Size()))
     {
+        deadline.Check();
         if (!forward_heap.Empty())
         {
             routingStep<FORWARD_DIRECTION>(facade,
@@ -208,6 +213,98 @@ double getNetworkDistance(SearchEngineData<Algorithm> &engine_working_data,
 
     return getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
 }
+
+std::vector<double> getNetworkDistances(SearchEngineData<Algorithm> & /*engine_working_data*/,
+                                        const DataFacade<Algorithm> &facade,
+                                        SearchEngineData<Algorithm>::QueryHeap &forward_heap,
+                                        SearchEngineData<Algorithm>::QueryHeap &reverse_heap,
+                                        const PhantomNode &source_phantom,
+                                        const std::vector<PhantomNode> &target_phantoms,
+                                        const EdgeWeight weight_upper_bound)
+{
+    std::vector<double> distances(target_phantoms.size(), std::numeric_limits<double>::max());
+
+    forward_heap.Clear();
+    reverse_heap.Clear();
+
+    insertSourceNodesInHeap(forward_heap, source_phantom);
+    if (forward_heap.Empty())
+    {
+        return distances;
+    }
+
+    const auto min_edge_offset = std::min(0, forward_heap.MinKey());
+    auto &deadline = Deadline::Current();
+
+    // Reverse weights are not negative, so all paths below the bound meet the forward search at
+    // a node with a smaller weight. With the empty reverse heap the forward steps never meet.
+    NodeID middle = SPECIAL_NODEID;
+    EdgeWeight weight = weight_upper_bound;
+    while (!forward_heap.Empty() && forward_heap.MinKey() < weight_upper_bound)
+    {
+        deadline.Check();
+        routingStep<FORWARD_DIRECTION>(facade,
+                                       forward_heap,
+                                       reverse_heap,
+                                       middle,
+                                       weight,
+                                       min_edge_offset,
+                                       DO_NOT_FORCE_LOOPS,
+                                       DO_NOT_FORCE_LOOPS);
+    }
+
+    for (const auto index : util::irange<std::size_t>(0UL, target_phantoms.size()))
+    {
+        const auto &target_phantom = target_phantoms[index];
+
+        reverse_heap.Clear();
+        insertTargetNodesInHeap(reverse_heap, target_phantom);
+
+        middle = SPECIAL_NODEID;
+        weight = weight_upper_bound;
+        while (!reverse_heap.Empty())
+        {
+            deadline.Check();
+            routingStep<REVERSE_DIRECTION>(facade,
+                                           reverse_heap,
+                                           forward_heap,
+                                           middle,
+                                           weight,
+                                           min_edge_offset,
+                                           DO_NOT_FORCE_LOOPS,
+                                           DO_NOT_FORCE_LOOPS);
+        }
+
+        if (weight_upper_bound <= weight || SPECIAL_NODEID == middle)
+        {
+            continue;
+        }
+
+        std::vector<NodeID> packed_path;
+        if (weight != forward_heap.GetKey(middle) + reverse_heap.GetKey(middle))
+        {
+            // self loop makes up the full path
+            packed_path.push_back(middle);
+            packed_path.push_back(middle);
+        }
+        else
+        {
+            retrievePackedPathFromHeap(forward_heap, reverse_heap, middle, packed_path);
+        }
+
+        std::vector<PathData> unpacked_path;
+        unpackPath(facade,
+                   packed_path.begin(),
+                   packed_path.end(),
+                   {source_phantom, target_phantom},
+                   unpacked_path);
+
+        distances[index] =
+            getPathDistance(facade, unpacked_path, source_phantom, target_phantom);
+    }
+
+    return distances;
+}
 } // namespace ch
 
 } // namespace routing_algorithms
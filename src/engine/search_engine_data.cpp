@@ -7,16 +7,26 @@ namespace engine
 
 // CH heaps
 using CH = routing_algorithms::ch::Algorithm;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_1;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_1;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_2;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_2;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::forward_heap_3;
-SearchEngineData<CH>::SearchEngineHeapPtr SearchEngineData<CH>::reverse_heap_3;
-SearchEngineData<CH>::ManyToManyHeapPtr SearchEngineData<CH>::many_to_many_heap;
-
-void SearchEngineData<CH>::InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+
+void SearchEngineData<CH>::ResetOnSizeChange(unsigned number_of_nodes)
+{
+    if (heaps_number_of_nodes == number_of_nodes)
+        return;
+
+    forward_heap_1.reset();
+    reverse_heap_1.reset();
+    forward_heap_2.reset();
+    reverse_heap_2.reset();
+    forward_heap_3.reset();
+    reverse_heap_3.reset();
+    many_to_many_heap.reset();
+    heaps_number_of_nodes = number_of_nodes;
+}
+
+void SearchEngineData<CH>::InitializeOrClearFirstHeaps(unsigned number_of_nodes)
 {
+    ResetOnSizeChange(number_of_nodes);
+
     if (forward_heap_1.get())
     {
         forward_heap_1->Clear();
@@ -36,8 +46,10 @@ void SearchEngineData<CH>::InitializeOrClearFirstThreadLocalStorage(unsigned num
     }
 }
 
-void SearchEngineData<CH>::InitializeOrClearSecondThreadLocalStorage(unsigned number_of_nodes)
+void SearchEngineData<CH>::InitializeOrClearSecondHeaps(unsigned number_of_nodes)
 {
+    ResetOnSizeChange(number_of_nodes);
+
     if (forward_heap_2.get())
     {
         forward_heap_2->Clear();
@@ -57,8 +69,10 @@ void SearchEngineData<CH>::InitializeOrClearSecondThreadLocalStorage(unsigned nu
     }
 }
 
-void SearchEngineData<CH>::InitializeOrClearThirdThreadLocalStorage(unsigned number_of_nodes)
+void SearchEngineData<CH>::InitializeOrClearThirdHeaps(unsigned number_of_nodes)
 {
+    ResetOnSizeChange(number_of_nodes);
+
     if (forward_heap_3.get())
     {
         forward_heap_3->Clear();
@@ -78,8 +92,10 @@ void SearchEngineData<CH>::InitializeOrClearThirdThreadLocalStorage(unsigned num
     }
 }
 
-void SearchEngineData<CH>::InitializeOrClearManyToManyThreadLocalStorage(unsigned number_of_nodes)
+void SearchEngineData<CH>::InitializeOrClearManyToManyHeap(unsigned number_of_nodes)
 {
+    ResetOnSizeChange(number_of_nodes);
+
     if (many_to_many_heap.get())
     {
         many_to_many_heap->Clear();
@@ -92,13 +108,26 @@ void SearchEngineData<CH>::InitializeOrClearManyToManyThreadLocalStorage(unsigne
 
 // MLD
 using MLD = routing_algorithms::mld::Algorithm;
-SearchEngineData<MLD>::SearchEngineHeapPtr SearchEngineData<MLD>::forward_heap_1;
-SearchEngineData<MLD>::SearchEngineHeapPtr SearchEngineData<MLD>::reverse_heap_1;
-SearchEngineData<MLD>::ManyToManyHeapPtr SearchEngineData<MLD>::many_to_many_heap;
 
-void SearchEngineData<MLD>::InitializeOrClearFirstThreadLocalStorage(
-    unsigned number_of_nodes, unsigned number_of_boundary_nodes)
+void SearchEngineData<MLD>::ResetOnSizeChange(unsigned number_of_nodes,
+                                              unsigned number_of_boundary_nodes)
 {
+    if (heaps_number_of_nodes == number_of_nodes &&
+        heaps_number_of_boundary_nodes == number_of_boundary_nodes)
+        return;
+
+    forward_heap_1.reset();
+    reverse_heap_1.reset();
+    many_to_many_heap.reset();
+    heaps_number_of_nodes = number_of_nodes;
+    heaps_number_of_boundary_nodes = number_of_boundary_nodes;
+}
+
+void SearchEngineData<MLD>::InitializeOrClearFirstHeaps(unsigned number_of_nodes,
+                                                        unsigned number_of_boundary_nodes)
+{
+    ResetOnSizeChange(number_of_nodes, number_of_boundary_nodes);
+
     if (forward_heap_1.get())
     {
         forward_heap_1->Clear();
@@ -118,9 +147,11 @@ void SearchEngineData<MLD>::InitializeOrClearFirstThreadLocalStorage(
     }
 }
 
-void SearchEngineData<MLD>::InitializeOrClearManyToManyThreadLocalStorage(
-    unsigned number_of_nodes, unsigned number_of_boundary_nodes)
+void SearchEngineData<MLD>::InitializeOrClearManyToManyHeap(unsigned number_of_nodes,
+                                                            unsigned number_of_boundary_nodes)
 {
+    ResetOnSizeChange(number_of_nodes, number_of_boundary_nodes);
+
     if (many_to_many_heap.get())
     {
         many_to_many_heap->Clear();
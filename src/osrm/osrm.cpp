@@ -62,17 +62,52 @@ engine::Status OSRM::Route(const engine::api::RouteParameters &params,
     return engine_->Route(params, result);
 }
 
+engine::Status OSRM::Route(const engine::api::RouteParameters &params, std::string &result) const
+{
+    return engine_->Route(params, result);
+}
+
 engine::Status OSRM::Table(const engine::api::TableParameters &params, json::Object &result) const
 {
     return engine_->Table(params, result);
 }
 
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           std::vector<char> &result) const
+{
+    return engine_->Table(params, result);
+}
+
+engine::Status OSRM::Table(const engine::api::TableParameters &params,
+                           std::vector<char> &result,
+                           const std::function<void(std::vector<char> &)> &consume) const
+{
+    return engine_->Table(params, result, consume);
+}
+
+engine::Status OSRM::Table(const engine::api::TableParameters &params, std::string &result) const
+{
+    return engine_->Table(params, result);
+}
+
 engine::Status OSRM::Nearest(const engine::api::NearestParameters &params,
                              json::Object &result) const
 {
     return engine_->Nearest(params, result);
 }
 
+engine::Status OSRM::Nearest(const engine::api::NearestParameters &params,
+                             std::vector<char> &result) const
+{
+    return engine_->Nearest(params, result);
+}
+
+engine::Status OSRM::Nearest(const engine::api::NearestParameters &params,
+                             std::string &result) const
+{
+    return engine_->Nearest(params, result);
+}
+
 engine::Status OSRM::Trip(const engine::api::TripParameters &params, json::Object &result) const
 {
     return engine_->Trip(params, result);
@@ -83,9 +118,19 @@ engine::Status OSRM::Match(const engine::api::MatchParameters &params, json::Obj
     return engine_->Match(params, result);
 }
 
+engine::Status
+OSRM::Match(const std::vector<engine::api::MatchParameters> &params,
+            const std::function<void(std::size_t, engine::Status, json::Object &)> &handler,
+            const unsigned max_threads) const
+{
+    return engine_->Match(params, handler, max_threads);
+}
+
 engine::Status OSRM::Tile(const engine::api::TileParameters &params, std::string &result) const
 {
     return engine_->Tile(params, result);
 }
 
+std::uint64_t OSRM::GetDataTimestamp() const { return engine_->GetDataTimestamp(); }
+
 } // ns osrm
@@ -0,0 +1,108 @@
+#include "server/api/cache_key.hpp"
+
+#include <boost/optional.hpp>
+
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+template <typename T> void append(std::string &key, const T &value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only plain values can be appended");
+    key.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+void append(std::string &key, const std::string &value)
+{
+    append(key, static_cast<std::uint32_t>(value.size()));
+    key.append(value);
+}
+
+void append(std::string &key, const util::Coordinate &coordinate)
+{
+    append(key, static_cast<std::int32_t>(coordinate.lon));
+    append(key, static_cast<std::int32_t>(coordinate.lat));
+}
+
+void append(std::string &key, const engine::Bearing &bearing)
+{
+    append(key, bearing.bearing);
+    append(key, bearing.range);
+}
+
+template <typename T> void append(std::string &key, const boost::optional<T> &value)
+{
+    append(key, static_cast<bool>(value));
+    if (value)
+    {
+        append(key, *value);
+    }
+}
+
+template <typename T> void append(std::string &key, const std::vector<T> &values)
+{
+    append(key, static_cast<std::uint32_t>(values.size()));
+    for (const auto &value : values)
+    {
+        append(key, value);
+    }
+}
+
+void appendBaseParameters(std::string &key, const engine::api::BaseParameters &parameters)
+{
+    append(key, parameters.coordinates);
+    // hints are decoded into all bytes of the struct, so they are compared as a whole
+    append(key, parameters.hints);
+    append(key, parameters.radiuses);
+    append(key, parameters.bearings);
+    append(key, parameters.approaches);
+    append(key, parameters.exclude);
+    append(key, parameters.generate_hints);
+    append(key, parameters.format);
+}
+
+// Keeps keys of different services apart
+enum class Service : std::uint8_t
+{
+    Route,
+    Nearest
+};
+}
+
+std::string makeCacheKey(const engine::api::RouteParameters &parameters)
+{
+    std::string key;
+    append(key, Service::Route);
+    appendBaseParameters(key, parameters);
+    append(key, parameters.steps);
+    append(key, parameters.alternatives);
+    append(key, parameters.number_of_alternatives);
+    append(key, parameters.annotations);
+    append(key, parameters.annotations_type);
+    append(key, parameters.geometries);
+    append(key, parameters.overview);
+    append(key, parameters.continue_straight);
+    return key;
+}
+
+std::string makeCacheKey(const engine::api::NearestParameters &parameters)
+{
+    std::string key;
+    append(key, Service::Nearest);
+    appendBaseParameters(key, parameters);
+    append(key, parameters.number_of_results);
+    return key;
+}
+
+} // ns api
+} // ns server
+} // ns osrm
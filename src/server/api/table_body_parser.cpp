@@ -0,0 +1,118 @@
+#include "server/api/table_body_parser.hpp"
+
+#include "util/coordinate.hpp"
+
+#include <cstdint>
+#include <iterator>
+
+namespace osrm
+{
+namespace server
+{
+namespace api
+{
+
+namespace
+{
+using Iterator = std::vector<char>::const_iterator;
+
+// Reads a little endian value independent of the byte order of the host, the iterator is only
+// moved if the value is complete
+bool readUInt32(Iterator &iter, const Iterator end, std::uint32_t &value)
+{
+    if (std::distance(iter, end) < 4)
+    {
+        return false;
+    }
+
+    value = 0;
+    for (const auto shift : {0, 8, 16, 24})
+    {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(*iter++)) << shift;
+    }
+    return true;
+}
+
+// Reads count indices, fails before allocating them if the remaining bytes are too few
+bool readIndices(Iterator &iter,
+                 const Iterator end,
+                 const std::uint32_t count,
+                 std::vector<std::size_t> &indices)
+{
+    if (static_cast<std::size_t>(std::distance(iter, end)) / 4 < count)
+    {
+        return false;
+    }
+
+    indices.resize(count);
+    for (auto &index : indices)
+    {
+        std::uint32_t value;
+        readUInt32(iter, end, value);
+        index = value;
+    }
+    return true;
+}
+}
+
+boost::optional<engine::api::TableParameters> parseTableBody(Iterator &iter, const Iterator end)
+{
+    engine::api::TableParameters parameters;
+
+    std::uint32_t number_of_coordinates;
+    std::uint32_t number_of_sources;
+    std::uint32_t number_of_destinations;
+    if (!readUInt32(iter, end, number_of_coordinates) ||
+        !readUInt32(iter, end, number_of_sources) ||
+        !readUInt32(iter, end, number_of_destinations))
+    {
+        return boost::none;
+    }
+
+    std::uint32_t flags;
+    const auto flags_position = iter;
+    if (!readUInt32(iter, end, flags) || (flags & ~table_body::ALL_FLAGS) != 0)
+    {
+        iter = flags_position;
+        return boost::none;
+    }
+    // durations if no annotation is set, like the default of the annotations parameter
+    if (flags & (table_body::DURATIONS | table_body::DISTANCES))
+    {
+        parameters.annotations = static_cast<engine::api::TableParameters::AnnotationsType>(
+            flags & (table_body::DURATIONS | table_body::DISTANCES));
+    }
+    parameters.generate_hints = !(flags & table_body::SKIP_HINTS);
+
+    if (static_cast<std::size_t>(std::distance(iter, end)) / 8 < number_of_coordinates)
+    {
+        return boost::none;
+    }
+    parameters.coordinates.reserve(number_of_coordinates);
+    for (std::uint32_t index = 0; index < number_of_coordinates; ++index)
+    {
+        std::uint32_t longitude;
+        std::uint32_t latitude;
+        readUInt32(iter, end, longitude);
+        readUInt32(iter, end, latitude);
+        parameters.coordinates.emplace_back(
+            util::FixedLongitude{static_cast<std::int32_t>(longitude)},
+            util::FixedLatitude{static_cast<std::int32_t>(latitude)});
+    }
+
+    if (!readIndices(iter, end, number_of_sources, parameters.sources) ||
+        !readIndices(iter, end, number_of_destinations, parameters.destinations))
+    {
+        return boost::none;
+    }
+
+    if (iter != end)
+    {
+        return boost::none;
+    }
+    return boost::make_optional(std::move(parameters));
+}
+
+} // ns api
+} // ns server
+} // ns osrm
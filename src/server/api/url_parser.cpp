@@ -22,7 +22,8 @@ namespace qi = boost::spirit::qi;
 template <typename Iterator, typename Into> //
 struct URLParser final : qi::grammar<Iterator, Into>
 {
-    URLParser() : URLParser::base_type(start)
+    // Without a query for requests that send their query in the body
+    explicit URLParser(const bool has_query) : URLParser::base_type(start)
     {
         using boost::spirit::repository::qi::iter_pos;
 
@@ -39,10 +40,22 @@ struct URLParser final : qi::grammar<Iterator, Into>
 
         // Example input: /route/v1/driving/7.416351,43.731205;7.420363,43.736189
 
-        start = qi::lit('/') > service > qi::lit('/') > qi::lit('v') > version > qi::lit('/') >
+        if (has_query)
+        {
+            start =
+                qi::lit('/') > service > qi::lit('/') > qi::lit('v') > version > qi::lit('/') >
                 profile > qi::lit('/') >
                 qi::omit[iter_pos[ph::bind(&osrm::server::api::ParsedURL::prefix_length, qi::_val) =
                                       qi::_1 - qi::_r1]] > query;
+        }
+        else
+        {
+            start =
+                qi::lit('/') > service > qi::lit('/') > qi::lit('v') > version > qi::lit('/') >
+                profile >
+                qi::omit[iter_pos[ph::bind(&osrm::server::api::ParsedURL::prefix_length, qi::_val) =
+                                      qi::_1 - qi::_r1]] > qi::attr(std::string());
+        }
 
         BOOST_SPIRIT_DEBUG_NODES((start)(service)(version)(profile)(query))
     }
@@ -69,11 +82,12 @@ namespace server
 namespace api
 {
 
-boost::optional<ParsedURL> parseURL(std::string::iterator &iter, const std::string::iterator end)
+namespace
+{
+template <typename It>
+boost::optional<ParsedURL>
+parseURL(const URLParser<It, ParsedURL(It)> &parser, It &iter, const It end)
 {
-    using It = std::decay<decltype(iter)>::type;
-
-    static URLParser<It, ParsedURL(It)> const parser;
     ParsedURL out;
 
     try
@@ -92,6 +106,24 @@ boost::optional<ParsedURL> parseURL(std::string::iterator &iter, const std::stri
 
     return boost::none;
 }
+}
+
+boost::optional<ParsedURL> parseURL(std::string::iterator &iter, const std::string::iterator end)
+{
+    using It = std::decay<decltype(iter)>::type;
+
+    static URLParser<It, ParsedURL(It)> const parser(true);
+    return parseURL(parser, iter, end);
+}
+
+boost::optional<ParsedURL> parseServiceURL(std::string::iterator &iter,
+                                           const std::string::iterator end)
+{
+    using It = std::decay<decltype(iter)>::type;
+
+    static URLParser<It, ParsedURL(It)> const parser(false);
+    return parseURL(parser, iter, end);
+}
 
 } // api
 } // server
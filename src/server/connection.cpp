@@ -1,13 +1,18 @@
 #include "server/connection.hpp"
 #include "server/request_handler.hpp"
 #include "server/request_parser.hpp"
+#include "server/request_queue.hpp"
+
+#include "util/exception.hpp"
 
 #include <boost/assert.hpp>
 #include <boost/bind.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 #include <boost/iostreams/filtering_stream.hpp>
 
+#include <chrono>
 #include <iterator>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -16,16 +21,57 @@ namespace osrm
 namespace server
 {
 
-Connection::Connection(boost::asio::io_service &io_service, RequestHandler &handler)
-    : strand(io_service), TCP_socket(io_service), request_handler(handler)
+namespace
+{
+const char chunk_end[] = {'\r', '\n'};
+const char last_chunk[] = {'0', '\r', '\n', '\r', '\n'};
+
+// A query streaming its reply waits while more than this is not sent yet. Queries running on
+// the I/O threads can't wait and are aborted instead.
+const std::size_t MAX_PENDING_CONTENT = 16 * 1024 * 1024;
+// The query is aborted if none of its pending content could be sent for this long
+const auto MAX_CONTENT_STALL = std::chrono::seconds(30);
+
+void append_buffers(const std::vector<boost::asio::const_buffer> &buffers,
+                    std::vector<char> &output)
+{
+    const auto size = output.size();
+    output.resize(size + boost::asio::buffer_size(buffers));
+    boost::asio::buffer_copy(boost::asio::buffer(output.data() + size, output.size() - size),
+                             buffers);
+}
+}
+
+Connection::Connection(boost::asio::io_service &io_service,
+                       RequestHandler &handler,
+                       RequestQueue *request_queue,
+                       const unsigned keepalive_timeout,
+                       const unsigned keepalive_max_requests)
+    : strand(io_service), TCP_socket(io_service), timer(io_service), request_handler(handler),
+      request_queue(request_queue), pending_begin(nullptr), pending_end(nullptr),
+      keepalive_timeout(keepalive_timeout), remaining_requests(keepalive_max_requests),
+      keep_alive(false), current_compression(http::no_compression), streaming(false),
+      pending_content_size(0), written_content_size(0), writing_content(false),
+      content_complete(false), content_failed(false)
 {
 }
 
 boost::asio::ip::tcp::socket &Connection::socket() { return TCP_socket; }
 
 /// Start the first asynchronous operation for the connection.
-void Connection::start()
+void Connection::start() { start_read(); }
+
+void Connection::start_read()
 {
+    if (keepalive_timeout > 0)
+    {
+        // closes connections of clients that stay idle (or send too slowly) for too long
+        timer.expires_from_now(boost::posix_time::seconds(keepalive_timeout));
+        timer.async_wait(strand.wrap(boost::bind(&Connection::handle_timeout,
+                                                 this->shared_from_this(),
+                                                 boost::asio::placeholders::error)));
+    }
+
     TCP_socket.async_read_some(
         boost::asio::buffer(incoming_data_buffer),
         strand.wrap(boost::bind(&Connection::handle_read,
@@ -38,60 +84,87 @@ void Connection::handle_read(const boost::system::error_code &error, std::size_t
 {
     if (error)
     {
+        if (error != boost::asio::error::operation_aborted)
+        {
+            close();
+        }
         return;
     }
 
+    process_data(incoming_data_buffer.data(), incoming_data_buffer.data() + bytes_transferred);
+}
+
+void Connection::process_data(char *begin, char *end)
+{
     // no error detected, let's parse the request
     http::compression_type compression_type(http::no_compression);
     RequestParser::RequestStatus result;
-    std::tie(result, compression_type) =
-        request_parser.parse(current_request,
-                             incoming_data_buffer.data(),
-                             incoming_data_buffer.data() + bytes_transferred);
+    std::tie(result, compression_type, pending_begin) =
+        request_parser.parse(current_request, begin, end);
+    pending_end = end;
 
     // the request has been parsed
     if (result == RequestParser::RequestStatus::valid)
     {
+        timer.cancel();
+
         current_request.endpoint = TCP_socket.remote_endpoint().address();
-        request_handler.HandleRequest(current_request, current_reply);
+        current_compression = compression_type;
 
-        // compress the result w/ gzip/deflate if requested
-        switch (compression_type)
-        {
-        case http::deflate_rfc1951:
-            // use deflate for compression
-            current_reply.headers.insert(current_reply.headers.begin(),
-                                         {"Content-Encoding", "deflate"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
-            break;
-        case http::gzip_rfc1952:
-            // use gzip for compression
-            current_reply.headers.insert(current_reply.headers.begin(),
-                                         {"Content-Encoding", "gzip"});
-            compressed_output = compress_buffers(current_reply.content, compression_type);
-            current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
-            output_buffer = current_reply.headers_to_buffers();
-            output_buffer.push_back(boost::asio::buffer(compressed_output));
-            break;
-        case http::no_compression:
-            // don't use any compression
-            current_reply.set_uncompressed_size();
-            output_buffer = current_reply.to_buffers();
-            break;
-        }
-        // write result to stream
-        boost::asio::async_write(TCP_socket,
-                                 output_buffer,
-                                 strand.wrap(boost::bind(&Connection::handle_write,
-                                                         this->shared_from_this(),
-                                                         boost::asio::placeholders::error)));
+        if (request_queue == nullptr)
+        {
+            handle_request();
+            write_reply();
+        }
+        else
+        {
+            auto self = this->shared_from_this();
+            const auto accepted = request_queue->Push(
+                RequestQueue::GetServiceName(current_request.uri),
+                [self] {
+                    self->handle_request();
+                    // writing the reply is done by the I/O threads again
+                    self->strand.post(boost::bind(&Connection::write_reply, self));
+                },
+                [self](const RequestQueue::Failure failure) {
+                    // like the replies of the queries written by the I/O threads, the server
+                    // stops them only after the queue
+                    self->strand.post([self, failure] {
+                        if (failure == RequestQueue::Failure::Stopped)
+                        {
+                            // the server is shutting down, the connection is not kept alive
+                            self->remaining_requests = 0;
+                            self->current_reply =
+                                http::reply::stock_reply(http::reply::service_unavailable);
+                        }
+                        else
+                        {
+                            self->current_reply =
+                                http::reply::stock_reply(http::reply::internal_server_error);
+                        }
+                        self->write_reply();
+                    });
+                });
+
+            if (!accepted)
+            {
+                // shed load early instead of letting the latency of all requests grow
+                current_reply = http::reply::stock_reply(http::reply::service_unavailable);
+                current_reply.headers.emplace_back("Retry-After", "1");
+                write_reply();
+            }
+        }
     }
-    else if (result == RequestParser::RequestStatus::invalid)
-    { // request is not parseable
-        current_reply = http::reply::stock_reply(http::reply::bad_request);
+    else if (result == RequestParser::RequestStatus::invalid ||
+             result == RequestParser::RequestStatus::too_large)
+    { // request is not parseable or its body is not read
+        timer.cancel();
+
+        keep_alive = false;
+        current_reply = http::reply::stock_reply(result == RequestParser::RequestStatus::too_large
+                                                     ? http::reply::payload_too_large
+                                                     : http::reply::bad_request);
+        current_reply.headers.emplace_back("Connection", "close");
 
         boost::asio::async_write(TCP_socket,
                                  current_reply.to_buffers(),
@@ -111,19 +184,376 @@ void Connection::handle_read(const boost::system::error_code &error, std::size_t
     }
 }
 
+void Connection::handle_request()
+{
+    if (current_request.accepts_chunked())
+    {
+        // the content is written synchronously, no other operation uses the socket meanwhile
+        request_handler.HandleRequest(
+            current_request, current_reply, [this](http::reply &reply, std::vector<char> &content) {
+                write_content(reply, content);
+            });
+    }
+    else
+    {
+        request_handler.HandleRequest(current_request, current_reply);
+    }
+}
+
+void Connection::set_connection_headers(http::reply &reply)
+{
+    if (remaining_requests > 0)
+    {
+        --remaining_requests;
+    }
+    keep_alive = keepalive_timeout > 0 && remaining_requests > 0 && current_request.keep_alive();
+    if (keep_alive)
+    {
+        reply.headers.emplace_back("Connection", "keep-alive");
+        reply.headers.emplace_back("Keep-Alive",
+                                   "timeout=" + std::to_string(keepalive_timeout) + ", max=" +
+                                       std::to_string(remaining_requests));
+    }
+    else
+    {
+        reply.headers.emplace_back("Connection", "close");
+    }
+}
+
+void Connection::append_chunk(const std::vector<char> &data, std::vector<char> &output)
+{
+    if (data.empty())
+    {
+        return;
+    }
+
+    std::ostringstream size_line;
+    size_line << std::hex << data.size() << "\r\n";
+    const auto chunk_size_line = size_line.str();
+    output.insert(output.end(), chunk_size_line.begin(), chunk_size_line.end());
+    output.insert(output.end(), data.begin(), data.end());
+    output.insert(output.end(), std::begin(chunk_end), std::end(chunk_end));
+}
+
+void Connection::write_content(http::reply &reply, std::vector<char> &content)
+{
+    std::vector<char> output;
+    if (!streaming)
+    {
+        streaming = true;
+        set_connection_headers(reply);
+        reply.headers.emplace_back("Transfer-Encoding", "chunked");
+
+        if (current_compression != http::no_compression)
+        {
+            reply.headers.insert(
+                reply.headers.begin(),
+                {"Content-Encoding",
+                 current_compression == http::deflate_rfc1951 ? "deflate" : "gzip"});
+            chunk_compressor = std::make_unique<boost::iostreams::filtering_ostream>();
+            chunk_compressor->push(
+                boost::iostreams::gzip_compressor(get_compression_parameters(current_compression)));
+            chunk_compressor->push(boost::iostreams::back_inserter(compressed_output));
+        }
+        append_buffers(reply.headers_to_buffers(), output);
+    }
+
+    if (chunk_compressor)
+    {
+        // the compressor holds back data until it has enough for a block
+        compressed_output.clear();
+        chunk_compressor->write(content.data(), content.size());
+        append_chunk(compressed_output, output);
+    }
+    else
+    {
+        append_chunk(content, output);
+    }
+
+    if (!output.empty())
+    {
+        queue_content(std::move(output));
+    }
+}
+
+void Connection::queue_content(std::vector<char> output)
+{
+    std::unique_lock<std::mutex> lock(content_mutex);
+
+    if (request_queue == nullptr)
+    {
+        // the query runs on the strand, no write of the I/O threads uses the socket meanwhile
+        pending_content_size += output.size();
+        pending_content.push_back(std::move(output));
+        write_pending_content_now();
+        if (content_failed)
+        {
+            throw util::exception("Client closed the connection");
+        }
+        if (pending_content_size > MAX_PENDING_CONTENT)
+        {
+            throw util::exception("Client does not read the response");
+        }
+        return;
+    }
+
+    // backpressure: wait until the I/O threads sent enough of the previous content
+    const auto has_room = [&] {
+        return content_failed || pending_content.empty() ||
+               pending_content_size + output.size() <= MAX_PENDING_CONTENT;
+    };
+    while (!has_room())
+    {
+        const auto written = written_content_size;
+        if (!content_written.wait_for(lock, MAX_CONTENT_STALL, has_room) &&
+            written == written_content_size)
+        {
+            throw util::exception("Client does not read the response");
+        }
+    }
+    if (content_failed)
+    {
+        throw util::exception("Client closed the connection");
+    }
+
+    pending_content_size += output.size();
+    pending_content.push_back(std::move(output));
+    if (!writing_content)
+    {
+        writing_content = true;
+        strand.post(boost::bind(&Connection::write_pending_content, this->shared_from_this()));
+    }
+}
+
+void Connection::write_pending_content_now()
+{
+    boost::system::error_code error;
+    TCP_socket.non_blocking(true, error);
+    while (!error && !pending_content.empty())
+    {
+        auto &content = pending_content.front();
+        const auto written = TCP_socket.write_some(boost::asio::buffer(content), error);
+        pending_content_size -= written;
+        written_content_size += written;
+        if (written == content.size())
+        {
+            pending_content.pop_front();
+        }
+        else
+        {
+            content.erase(content.begin(), content.begin() + written);
+        }
+    }
+    boost::system::error_code ignore_error;
+    TCP_socket.non_blocking(false, ignore_error);
+
+    if (error && error != boost::asio::error::would_block && error != boost::asio::error::try_again)
+    {
+        content_failed = true;
+    }
+}
+
+void Connection::write_pending_content()
+{
+    bool complete = false;
+    {
+        std::lock_guard<std::mutex> lock(content_mutex);
+        if (!pending_content.empty())
+        {
+            // the deque keeps its elements in place when the query adds content
+            boost::asio::async_write(TCP_socket,
+                                     boost::asio::buffer(pending_content.front()),
+                                     strand.wrap(boost::bind(&Connection::handle_content_write,
+                                                             this->shared_from_this(),
+                                                             boost::asio::placeholders::error)));
+            return;
+        }
+        writing_content = false;
+        complete = content_complete;
+    }
+
+    if (complete)
+    {
+        handle_write(boost::system::error_code());
+    }
+}
+
+void Connection::handle_content_write(const boost::system::error_code &error)
+{
+    {
+        std::lock_guard<std::mutex> lock(content_mutex);
+        if (error)
+        {
+            content_failed = true;
+            writing_content = false;
+            pending_content.clear();
+            pending_content_size = 0;
+        }
+        else
+        {
+            pending_content_size -= pending_content.front().size();
+            written_content_size += pending_content.front().size();
+            pending_content.pop_front();
+        }
+    }
+    content_written.notify_all();
+
+    if (error)
+    {
+        close();
+        return;
+    }
+    write_pending_content();
+}
+
+void Connection::write_reply()
+{
+    if (streaming)
+    {
+        if (current_reply.status != http::reply::ok)
+        {
+            // the query failed after the start of the content was sent, without a last chunk
+            // the client sees an incomplete response
+            close();
+            return;
+        }
+
+        std::vector<char> output;
+        if (chunk_compressor)
+        {
+            compressed_output.clear();
+            chunk_compressor->write(current_reply.content.data(), current_reply.content.size());
+            boost::iostreams::close(*chunk_compressor);
+            append_chunk(compressed_output, output);
+        }
+        else
+        {
+            append_chunk(current_reply.content, output);
+        }
+        output.insert(output.end(), std::begin(last_chunk), std::end(last_chunk));
+
+        {
+            std::unique_lock<std::mutex> lock(content_mutex);
+            if (content_failed)
+            {
+                lock.unlock();
+                close();
+                return;
+            }
+            pending_content_size += output.size();
+            pending_content.push_back(std::move(output));
+            content_complete = true;
+            if (writing_content)
+            {
+                // the running write continues with the last chunk
+                return;
+            }
+            writing_content = true;
+        }
+        write_pending_content();
+        return;
+    }
+
+    set_connection_headers(current_reply);
+
+    // compress the result w/ gzip/deflate if requested
+    switch (current_compression)
+    {
+    case http::deflate_rfc1951:
+        // use deflate for compression
+        current_reply.headers.insert(current_reply.headers.begin(),
+                                     {"Content-Encoding", "deflate"});
+        compressed_output = compress_buffers(current_reply.content, current_compression);
+        current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
+        output_buffer = current_reply.headers_to_buffers();
+        output_buffer.push_back(boost::asio::buffer(compressed_output));
+        break;
+    case http::gzip_rfc1952:
+        // use gzip for compression
+        current_reply.headers.insert(current_reply.headers.begin(),
+                                     {"Content-Encoding", "gzip"});
+        compressed_output = compress_buffers(current_reply.content, current_compression);
+        current_reply.set_size(static_cast<unsigned>(compressed_output.size()));
+        output_buffer = current_reply.headers_to_buffers();
+        output_buffer.push_back(boost::asio::buffer(compressed_output));
+        break;
+    case http::no_compression:
+        // don't use any compression
+        current_reply.set_uncompressed_size();
+        output_buffer = current_reply.to_buffers();
+        break;
+    }
+    // write result to stream
+    boost::asio::async_write(TCP_socket,
+                             output_buffer,
+                             strand.wrap(boost::bind(&Connection::handle_write,
+                                                     this->shared_from_this(),
+                                                     boost::asio::placeholders::error)));
+}
+
 /// Handle completion of a write operation.
 void Connection::handle_write(const boost::system::error_code &error)
 {
-    if (!error)
+    if (error)
+    {
+        return;
+    }
+
+    if (!keep_alive)
     {
         // Initiate graceful connection closure.
         boost::system::error_code ignore_error;
         TCP_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignore_error);
+        return;
+    }
+
+    current_request = http::request();
+    current_reply = http::reply();
+    request_parser.reset();
+    compressed_output.clear();
+    output_buffer.clear();
+    streaming = false;
+    chunk_compressor.reset();
+    {
+        std::lock_guard<std::mutex> lock(content_mutex);
+        pending_content.clear();
+        pending_content_size = 0;
+        written_content_size = 0;
+        content_complete = false;
+        content_failed = false;
+    }
+
+    if (pending_begin != pending_end)
+    {
+        // the client pipelined further requests behind the one we just answered
+        process_data(pending_begin, pending_end);
+    }
+    else
+    {
+        start_read();
     }
 }
 
-std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompressed_data,
-                                               const http::compression_type compression_type)
+void Connection::handle_timeout(const boost::system::error_code &error)
+{
+    // the timer might have been re-armed after this handler was already queued
+    if (error != boost::asio::error::operation_aborted &&
+        timer.expires_at() <= boost::asio::deadline_timer::traits_type::now())
+    {
+        close();
+    }
+}
+
+void Connection::close()
+{
+    boost::system::error_code ignore_error;
+    timer.cancel(ignore_error);
+    TCP_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ignore_error);
+    TCP_socket.close(ignore_error);
+}
+
+boost::iostreams::gzip_params
+Connection::get_compression_parameters(const http::compression_type compression_type)
 {
     boost::iostreams::gzip_params compression_parameters;
 
@@ -134,11 +564,17 @@ std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompre
     {
         compression_parameters.noheader = true;
     }
+    return compression_parameters;
+}
 
+std::vector<char> Connection::compress_buffers(const std::vector<char> &uncompressed_data,
+                                               const http::compression_type compression_type)
+{
     std::vector<char> compressed_data;
     // plug data into boost's compression stream
     boost::iostreams::filtering_ostream gzip_stream;
-    gzip_stream.push(boost::iostreams::gzip_compressor(compression_parameters));
+    gzip_stream.push(
+        boost::iostreams::gzip_compressor(get_compression_parameters(compression_type)));
     gzip_stream.push(boost::iostreams::back_inserter(compressed_data));
     gzip_stream.write(&uncompressed_data[0], uncompressed_data.size());
     boost::iostreams::close(gzip_stream);
@@ -38,7 +38,9 @@ void RequestHandler::RegisterServiceHandler(
     service_handler = std::move(service_handler_);
 }
 
-void RequestHandler::HandleRequest(const http::request &current_request, http::reply &current_reply)
+void RequestHandler::HandleRequest(const http::request &current_request,
+                                   http::reply &current_reply,
+                                   const ContentWriter &write_content)
 {
     if (!service_handler)
     {
@@ -58,16 +60,46 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
 
         util::Log(logDEBUG) << "[req][" << tid << "] " << request_string;
 
+        // the parameters of POST requests are in the body, their URL ends with the profile
+        const bool has_body = current_request.method == "POST";
         auto api_iterator = request_string.begin();
-        auto maybe_parsed_url = api::parseURL(api_iterator, request_string.end());
+        auto maybe_parsed_url = has_body
+                                    ? api::parseServiceURL(api_iterator, request_string.end())
+                                    : api::parseURL(api_iterator, request_string.end());
         ServiceHandler::ResultT result;
 
+        current_reply.headers.emplace_back("Access-Control-Allow-Origin", "*");
+        current_reply.headers.emplace_back("Access-Control-Allow-Methods", "GET, POST");
+        current_reply.headers.emplace_back("Access-Control-Allow-Headers",
+                                           "X-Requested-With, Content-Type");
+
+        // streamed responses are always JSON, their headers are sent with the first part
+        bool streamed = false;
+        util::json::BufferConsumer consume;
+        if (write_content)
+        {
+            consume = [&](util::json::Buffer &content) {
+                if (!streamed)
+                {
+                    current_reply.headers.emplace_back("Content-Type",
+                                                       "application/json; charset=UTF-8");
+                    current_reply.headers.emplace_back("Content-Disposition",
+                                                       "inline; filename=\"response.json\"");
+                    streamed = true;
+                }
+                write_content(current_reply, content);
+                content.clear();
+            };
+        }
+
         // check if the was an error with the request
         if (maybe_parsed_url && api_iterator == request_string.end())
         {
 
             const engine::Status status =
-                service_handler->RunQuery(*std::move(maybe_parsed_url), result);
+                has_body ? service_handler->RunBodyQuery(
+                               *std::move(maybe_parsed_url), current_request.body, result, consume)
+                         : service_handler->RunQuery(*std::move(maybe_parsed_url), result, consume);
             if (status != engine::Status::Ok)
             {
                 // 4xx bad request return code
@@ -98,11 +130,12 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
                                             std::to_string(position) + ": \"" + context + "\"";
         }
 
-        current_reply.headers.emplace_back("Access-Control-Allow-Origin", "*");
-        current_reply.headers.emplace_back("Access-Control-Allow-Methods", "GET");
-        current_reply.headers.emplace_back("Access-Control-Allow-Headers",
-                                           "X-Requested-With, Content-Type");
-        if (result.is<util::json::Object>())
+        if (streamed)
+        {
+            // the rest of the response, the connection sends it as the last part
+            current_reply.content.swap(result.get<util::json::Buffer>());
+        }
+        else if (result.is<util::json::Object>())
         {
             current_reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
             current_reply.headers.emplace_back("Content-Disposition",
@@ -110,6 +143,14 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
 
             util::json::render(current_reply.content, result.get<util::json::Object>());
         }
+        else if (result.is<util::json::Buffer>())
+        {
+            current_reply.headers.emplace_back("Content-Type", "application/json; charset=UTF-8");
+            current_reply.headers.emplace_back("Content-Disposition",
+                                               "inline; filename=\"response.json\"");
+
+            current_reply.content.swap(result.get<util::json::Buffer>());
+        }
         else
         {
             BOOST_ASSERT(result.is<std::string>());
@@ -121,9 +162,12 @@ void RequestHandler::HandleRequest(const http::request &current_request, http::r
             current_reply.headers.emplace_back("Content-Type", "application/x-protobuf");
         }
 
-        // set headers
-        current_reply.headers.emplace_back("Content-Length",
-                                           std::to_string(current_reply.content.size()));
+        // set headers, the length of streamed responses is unknown up front
+        if (!streamed)
+        {
+            current_reply.headers.emplace_back("Content-Length",
+                                               std::to_string(current_reply.content.size()));
+        }
 
         if (!std::getenv("DISABLE_ACCESS_LOGGING"))
         {
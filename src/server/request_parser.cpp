@@ -6,6 +6,8 @@
 
 #include <boost/algorithm/string/predicate.hpp>
 
+#include <algorithm>
+#include <iterator>
 #include <string>
 
 namespace osrm
@@ -13,26 +15,108 @@ namespace osrm
 namespace server
 {
 
+constexpr std::size_t RequestParser::MAX_BODY_SIZE;
+
 RequestParser::RequestParser()
     : state(internal_state::method_start), current_header({"", ""}),
-      selected_compression(http::no_compression)
+      selected_compression(http::no_compression), content_length(0)
 {
 }
 
-std::tuple<RequestParser::RequestStatus, http::compression_type>
+std::tuple<RequestParser::RequestStatus, http::compression_type, char *>
 RequestParser::parse(http::request &current_request, char *begin, char *end)
 {
     while (begin != end)
     {
+        if (state == internal_state::body)
+        {
+            // the body is copied as a whole instead of byte by byte
+            const auto missing = content_length - current_request.body.size();
+            const auto available = std::min<std::size_t>(missing, std::distance(begin, end));
+            current_request.body.insert(current_request.body.end(), begin, begin + available);
+            begin += available;
+            if (current_request.body.size() == content_length)
+            {
+                return std::make_tuple(RequestStatus::valid, selected_compression, begin);
+            }
+            continue;
+        }
+
         RequestStatus result = consume(current_request, *begin++);
         if (result != RequestStatus::indeterminate)
         {
-            return std::make_tuple(result, selected_compression);
+            return std::make_tuple(result, selected_compression, begin);
         }
     }
     RequestStatus result = RequestStatus::indeterminate;
 
-    return std::make_tuple(result, selected_compression);
+    return std::make_tuple(result, selected_compression, begin);
+}
+
+void RequestParser::reset()
+{
+    state = internal_state::method_start;
+    current_header.clear();
+    selected_compression = http::no_compression;
+    content_length = 0;
+}
+
+bool RequestParser::apply_header(http::request &current_request)
+{
+    if (boost::iequals(current_header.name, "Accept-Encoding"))
+    {
+        /* giving gzip precedence over deflate */
+        if (boost::icontains(current_header.value, "deflate"))
+        {
+            selected_compression = http::deflate_rfc1951;
+        }
+        if (boost::icontains(current_header.value, "gzip"))
+        {
+            selected_compression = http::gzip_rfc1952;
+        }
+    }
+
+    if (boost::iequals(current_header.name, "Referer"))
+    {
+        current_request.referrer = current_header.value;
+    }
+
+    if (boost::iequals(current_header.name, "User-Agent"))
+    {
+        current_request.agent = current_header.value;
+    }
+
+    if (boost::iequals(current_header.name, "Connection"))
+    {
+        current_request.connection = current_header.value;
+    }
+
+    if (boost::iequals(current_header.name, "Content-Length"))
+    {
+        if (current_header.value.empty())
+        {
+            return false;
+        }
+        content_length = 0;
+        for (const auto digit : current_header.value)
+        {
+            if (!is_digit(digit))
+            {
+                return false;
+            }
+            // saturates, any length above the maximum is rejected after the headers
+            content_length =
+                std::min<std::size_t>(content_length * 10 + (digit - '0'), MAX_BODY_SIZE + 1);
+        }
+    }
+
+    // only bodies of a known length are supported
+    if (boost::iequals(current_header.name, "Transfer-Encoding"))
+    {
+        return false;
+    }
+
+    return true;
 }
 
 RequestParser::RequestStatus RequestParser::consume(http::request &current_request,
@@ -46,6 +130,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             return RequestStatus::invalid;
         }
         state = internal_state::method;
+        current_request.method.push_back(input);
         return RequestStatus::indeterminate;
     case internal_state::method:
         if (input == ' ')
@@ -57,6 +142,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         {
             return RequestStatus::invalid;
         }
+        current_request.method.push_back(input);
         return RequestStatus::indeterminate;
     case internal_state::uri_start:
         if (is_CTL(input))
@@ -116,6 +202,7 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
     case internal_state::http_version_major_start:
         if (is_digit(input))
         {
+            current_request.http_version_major = input - '0';
             state = internal_state::http_version_major;
             return RequestStatus::indeterminate;
         }
@@ -128,12 +215,15 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         if (is_digit(input))
         {
+            current_request.http_version_major =
+                current_request.http_version_major * 10 + (input - '0');
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
     case internal_state::http_version_minor_start:
         if (is_digit(input))
         {
+            current_request.http_version_minor = input - '0';
             state = internal_state::http_version_minor;
             return RequestStatus::indeterminate;
         }
@@ -146,6 +236,8 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         if (is_digit(input))
         {
+            current_request.http_version_minor =
+                current_request.http_version_minor * 10 + (input - '0');
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
@@ -157,28 +249,12 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
         }
         return RequestStatus::invalid;
     case internal_state::header_line_start:
-        if (boost::iequals(current_header.name, "Accept-Encoding"))
+        if (!apply_header(current_request))
         {
-            /* giving gzip precedence over deflate */
-            if (boost::icontains(current_header.value, "deflate"))
-            {
-                selected_compression = http::deflate_rfc1951;
-            }
-            if (boost::icontains(current_header.value, "gzip"))
-            {
-                selected_compression = http::gzip_rfc1952;
-            }
-        }
-
-        if (boost::iequals(current_header.name, "Referer"))
-        {
-            current_request.referrer = current_header.value;
-        }
-
-        if (boost::iequals(current_header.name, "User-Agent"))
-        {
-            current_request.agent = current_header.value;
+            return RequestStatus::invalid;
         }
+        // the header is only applied once, even if the line ends the headers
+        current_header.clear();
 
         if (input == '\r')
         {
@@ -247,8 +323,29 @@ RequestParser::RequestStatus RequestParser::consume(http::request &current_reque
             return RequestStatus::indeterminate;
         }
         return RequestStatus::invalid;
-    default: // expecting_newline_3
-        return input == '\n' ? RequestStatus::valid : RequestStatus::invalid;
+    case internal_state::expecting_newline_3:
+        if (input != '\n')
+        {
+            return RequestStatus::invalid;
+        }
+        if (content_length > 0)
+        {
+            // rejected before any of the body is read, the body grows as it arrives
+            if (current_request.method != "POST" ||
+                !boost::starts_with(current_request.uri, "/table/"))
+            {
+                return RequestStatus::invalid;
+            }
+            if (content_length > MAX_BODY_SIZE)
+            {
+                return RequestStatus::too_large;
+            }
+            state = internal_state::body;
+            return RequestStatus::indeterminate;
+        }
+        return RequestStatus::valid;
+    default: // body, read by parse
+        return RequestStatus::invalid;
     }
 }
 
@@ -0,0 +1,162 @@
+#include "server/request_queue.hpp"
+
+#include "util/log.hpp"
+
+#include <boost/assert.hpp>
+
+#include <algorithm>
+#include <exception>
+
+namespace osrm
+{
+namespace server
+{
+
+RequestQueue::RequestQueue(const unsigned num_workers,
+                           const std::size_t max_queue_size,
+                           std::unordered_map<std::string, std::size_t> service_limits_)
+    : max_queue_size(max_queue_size), service_limits(std::move(service_limits_)),
+      rejected_count(0), stopped(false)
+{
+    BOOST_ASSERT(num_workers > 0);
+    workers.reserve(num_workers);
+    for (unsigned i = 0; i < num_workers; ++i)
+    {
+        workers.emplace_back([this] { Work(); });
+    }
+}
+
+RequestQueue::~RequestQueue() { Stop(); }
+
+bool RequestQueue::Push(const std::string &service, Job job, FailureHandler on_failure)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped)
+        {
+            return false;
+        }
+
+        if (max_queue_size > 0 && jobs.size() >= max_queue_size)
+        {
+            ++rejected_count;
+            return false;
+        }
+
+        auto &pending = pending_per_service[service];
+        const auto limit = service_limits.find(service);
+        if (limit != service_limits.end() && limit->second > 0 && pending >= limit->second)
+        {
+            ++rejected_count;
+            return false;
+        }
+
+        ++pending;
+        jobs.push_back(QueuedJob{service, std::move(job), std::move(on_failure)});
+    }
+    condition.notify_one();
+    return true;
+}
+
+void RequestQueue::Stop()
+{
+    std::deque<QueuedJob> discarded_jobs;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopped)
+        {
+            return;
+        }
+        stopped = true;
+        discarded_jobs.swap(jobs);
+        for (const auto &job : discarded_jobs)
+        {
+            BOOST_ASSERT(pending_per_service[job.service] > 0);
+            --pending_per_service[job.service];
+        }
+    }
+    condition.notify_all();
+
+    // the waiting requests are answered instead of being dropped silently
+    for (const auto &job : discarded_jobs)
+    {
+        HandleFailure(job, Failure::Stopped);
+    }
+
+    for (auto &worker : workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+void RequestQueue::HandleFailure(const QueuedJob &job, const Failure failure)
+{
+    if (!job.on_failure)
+    {
+        return;
+    }
+
+    try
+    {
+        job.on_failure(failure);
+    }
+    catch (const std::exception &e)
+    {
+        util::Log(logWARNING) << "[server error] answering failed request: " << e.what();
+    }
+}
+
+std::size_t RequestQueue::GetRejectedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return rejected_count;
+}
+
+std::string RequestQueue::GetServiceName(const std::string &uri)
+{
+    const auto begin = std::find_if(uri.begin(), uri.end(), [](const char c) { return c != '/'; });
+    const auto end = std::find(begin, uri.end(), '/');
+    return std::string(begin, end);
+}
+
+void RequestQueue::Work()
+{
+    while (true)
+    {
+        QueuedJob current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this] { return stopped || !jobs.empty(); });
+            if (stopped)
+            {
+                return;
+            }
+            current = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        try
+        {
+            current.job();
+        }
+        catch (const std::exception &e)
+        {
+            util::Log(logWARNING) << "[server error] request worker: " << e.what();
+            HandleFailure(current, Failure::Error);
+        }
+        catch (...)
+        {
+            util::Log(logWARNING) << "[server error] request worker: unknown exception";
+            HandleFailure(current, Failure::Error);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        BOOST_ASSERT(pending_per_service[current.service] > 0);
+        --pending_per_service[current.service];
+    }
+}
+}
+}
@@ -0,0 +1,125 @@
+#include "server/response_cache.hpp"
+
+#include <boost/assert.hpp>
+
+#include <functional>
+#include <utility>
+
+namespace osrm
+{
+namespace server
+{
+
+namespace
+{
+// list node, hash table node and the response variant
+constexpr std::size_t ENTRY_OVERHEAD = 128;
+
+std::size_t getResponseSize(const ResponseCache::Response &response)
+{
+    if (response.is<util::json::Buffer>())
+    {
+        return response.get<util::json::Buffer>().size();
+    }
+    BOOST_ASSERT(response.is<std::string>());
+    return response.get<std::string>().size();
+}
+}
+
+ResponseCache::ResponseCache(const std::size_t max_bytes, const std::size_t number_of_shards)
+    : max_shard_bytes(max_bytes / number_of_shards), shards(number_of_shards)
+{
+    BOOST_ASSERT(number_of_shards > 0);
+}
+
+ResponseCache::Shard &ResponseCache::GetShard(const std::string &key)
+{
+    return shards[std::hash<std::string>()(key) % shards.size()];
+}
+
+std::shared_ptr<const ResponseCache::Response>
+ResponseCache::Lookup(const std::string &key, const std::uint64_t data_timestamp)
+{
+    auto &shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    if (shard.data_timestamp != data_timestamp)
+    {
+        shard.statistics.invalidations += shard.entries.size();
+        shard.entries.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+        shard.data_timestamp = data_timestamp;
+    }
+
+    const auto found = shard.index.find(key);
+    if (found == shard.index.end())
+    {
+        ++shard.statistics.misses;
+        return nullptr;
+    }
+
+    ++shard.statistics.hits;
+    shard.entries.splice(shard.entries.begin(), shard.entries, found->second);
+    return found->second->response;
+}
+
+void ResponseCache::Insert(const std::string &key,
+                           const std::uint64_t data_timestamp,
+                           Response response)
+{
+    BOOST_ASSERT(!response.is<util::json::Object>());
+    const auto bytes = 2 * key.size() + getResponseSize(response) + ENTRY_OVERHEAD;
+    if (bytes > max_shard_bytes)
+    {
+        return;
+    }
+    auto shared_response = std::make_shared<const Response>(std::move(response));
+
+    auto &shard = GetShard(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    // the response was computed on a dataset that is not current anymore
+    if (shard.data_timestamp != data_timestamp)
+    {
+        return;
+    }
+
+    // a concurrent query for the same key got here first
+    if (shard.index.count(key) > 0)
+    {
+        return;
+    }
+
+    while (shard.bytes + bytes > max_shard_bytes)
+    {
+        BOOST_ASSERT(!shard.entries.empty());
+        const auto &oldest = shard.entries.back();
+        shard.bytes -= oldest.bytes;
+        shard.index.erase(oldest.key);
+        shard.entries.pop_back();
+        ++shard.statistics.evictions;
+    }
+
+    shard.entries.push_front(Entry{key, std::move(shared_response), bytes});
+    shard.index.emplace(key, shard.entries.begin());
+    shard.bytes += bytes;
+}
+
+ResponseCache::Statistics ResponseCache::GetStatistics() const
+{
+    Statistics total;
+    for (const auto &shard : shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total.hits += shard.statistics.hits;
+        total.misses += shard.statistics.misses;
+        total.evictions += shard.statistics.evictions;
+        total.invalidations += shard.statistics.invalidations;
+        total.entries += shard.entries.size();
+        total.bytes += shard.bytes;
+    }
+    return total;
+}
+}
+}
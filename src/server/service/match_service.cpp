@@ -32,7 +32,23 @@ std::string getWrongOptionHelp(const engine::api::MatchParameters &parameters)
         constrainParamSize(
             PARAMETER_SIZE_MISMATCH_MSG, "timestamps", parameters.timestamps, coord_size, help);
 
-    if (!param_size_mismatch && parameters.coordinates.size() < 2)
+    if (param_size_mismatch)
+    {
+        return help;
+    }
+
+    if (!parameters.session.empty() || parameters.close_session)
+    {
+        if (parameters.session.empty())
+        {
+            help = "Closing a session needs its name in session.";
+        }
+        else if (parameters.tidy || !parameters.waypoints.empty())
+        {
+            help = "Sessions don't support tidy and waypoints.";
+        }
+    }
+    else if (parameters.coordinates.size() < 2)
     {
         help = "Number of coordinates needs to be at least two.";
     }
@@ -2,6 +2,7 @@
 #include "server/service/utils.hpp"
 
 #include "server/api/parameters_parser.hpp"
+#include "server/response_cache.hpp"
 #include "engine/api/nearest_parameters.hpp"
 
 #include "util/json_container.hpp"
@@ -62,7 +63,18 @@ NearestService::RunQuery(std::size_t prefix_length, std::string &query, ResultT
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Nearest(*parameters, json_result);
+    return runCachedQuery(response_cache, routing_machine, *parameters, result, [&] {
+        if (parameters->format == engine::api::BaseParameters::OutputFormatType::PBF)
+        {
+            result = std::string();
+            return BaseService::routing_machine.Nearest(*parameters, result.get<std::string>());
+        }
+
+        // the response is rendered while it is computed, without an intermediate object tree
+        result = util::json::Buffer();
+        return BaseService::routing_machine.Nearest(*parameters,
+                                                    result.get<util::json::Buffer>());
+    });
 }
 }
 }
@@ -2,6 +2,7 @@
 #include "server/service/utils.hpp"
 
 #include "server/api/parameters_parser.hpp"
+#include "server/response_cache.hpp"
 #include "engine/api/route_parameters.hpp"
 
 #include "util/json_container.hpp"
@@ -66,7 +67,15 @@ RouteService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters->IsValid());
 
-    return BaseService::routing_machine.Route(*parameters, json_result);
+    return runCachedQuery(response_cache, routing_machine, *parameters, result, [&] {
+        if (parameters->format == engine::api::BaseParameters::OutputFormatType::PBF)
+        {
+            result = std::string();
+            return BaseService::routing_machine.Route(*parameters, result.get<std::string>());
+        }
+
+        return BaseService::routing_machine.Route(*parameters, json_result);
+    });
 }
 }
 }
@@ -1,6 +1,7 @@
 #include "server/service/table_service.hpp"
 
 #include "server/api/parameters_parser.hpp"
+#include "server/api/table_body_parser.hpp"
 #include "engine/api/table_parameters.hpp"
 
 #include "util/json_container.hpp"
@@ -17,6 +18,9 @@ namespace service
 namespace
 {
 
+// Smaller tables are sent in one piece, their JSON text is at most a few megabytes
+const constexpr std::size_t MIN_STREAMED_TABLE_CELLS = 1000 * 1000;
+
 const constexpr char PARAMETER_SIZE_MISMATCH_MSG[] =
     "Number of elements in %1% size %2% does not match coordinate size %3%";
 
@@ -51,7 +55,29 @@ std::string getWrongOptionHelp(const engine::api::TableParameters &parameters)
         constrainParamSize(
             PARAMETER_SIZE_MISMATCH_MSG, "approaches", parameters.approaches, coord_size, help);
 
-    if (!param_size_mismatch && parameters.coordinates.size() < 2)
+    if (param_size_mismatch)
+    {
+        return help;
+    }
+
+    if (parameters.register_target_set || !parameters.target_set.empty())
+    {
+        if (parameters.target_set.empty())
+        {
+            help = "Registering a target set needs its name in target_set.";
+        }
+        else if (parameters.register_target_set &&
+                 (!parameters.sources.empty() || !parameters.destinations.empty()))
+        {
+            help = "All coordinates of a target set are targets, sources and destinations "
+                   "are not supported.";
+        }
+        else if (!parameters.destinations.empty())
+        {
+            help = "The destinations of requests to a target set are its targets.";
+        }
+    }
+    else if (parameters.coordinates.size() < 2)
     {
         help = "Number of coordinates needs to be at least two.";
     }
@@ -62,6 +88,14 @@ std::string getWrongOptionHelp(const engine::api::TableParameters &parameters)
 
 engine::Status
 TableService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &result)
+{
+    return RunStreamingQuery(prefix_length, query, result, util::json::BufferConsumer{});
+}
+
+engine::Status TableService::RunStreamingQuery(std::size_t prefix_length,
+                                               std::string &query,
+                                               ResultT &result,
+                                               const util::json::BufferConsumer &consume)
 {
     result = util::json::Object();
     auto &json_result = result.get<util::json::Object>();
@@ -79,15 +113,64 @@ TableService::RunQuery(std::size_t prefix_length, std::string &query, ResultT &r
     }
     BOOST_ASSERT(parameters);
 
-    if (!parameters->IsValid())
+    return RunTable(*parameters, result, consume);
+}
+
+engine::Status TableService::RunBodyQuery(const std::vector<char> &body,
+                                          ResultT &result,
+                                          const util::json::BufferConsumer &consume)
+{
+    result = util::json::Object();
+    auto &json_result = result.get<util::json::Object>();
+
+    auto body_iterator = body.begin();
+    auto parameters = api::parseTableBody(body_iterator, body.end());
+    if (!parameters)
+    {
+        const auto position = std::distance(body.begin(), body_iterator);
+        json_result.values["code"] = "InvalidQuery";
+        json_result.values["message"] =
+            "Request body malformed close to byte " + std::to_string(position);
+        return engine::Status::Error;
+    }
+    BOOST_ASSERT(parameters);
+
+    return RunTable(*parameters, result, consume);
+}
+
+engine::Status TableService::RunTable(engine::api::TableParameters &parameters,
+                                      ResultT &result,
+                                      const util::json::BufferConsumer &consume)
+{
+    auto &json_result = result.get<util::json::Object>();
+    if (!parameters.IsValid())
     {
         json_result.values["code"] = "InvalidOptions";
-        json_result.values["message"] = getWrongOptionHelp(*parameters);
+        json_result.values["message"] = getWrongOptionHelp(parameters);
         return engine::Status::Error;
     }
-    BOOST_ASSERT(parameters->IsValid());
+    BOOST_ASSERT(parameters.IsValid());
+
+    if (parameters.format == engine::api::BaseParameters::OutputFormatType::PBF)
+    {
+        result = std::string();
+        return BaseService::routing_machine.Table(parameters, result.get<std::string>());
+    }
+
+    // the response is rendered while it is computed, without an intermediate object tree
+    result = util::json::Buffer();
 
-    return BaseService::routing_machine.Table(*parameters, json_result);
+    const auto number_of_sources =
+        parameters.sources.empty() ? parameters.coordinates.size() : parameters.sources.size();
+    const auto number_of_destinations = parameters.destinations.empty()
+                                            ? parameters.coordinates.size()
+                                            : parameters.destinations.size();
+    if (consume && number_of_sources * number_of_destinations >= MIN_STREAMED_TABLE_CELLS)
+    {
+        return BaseService::routing_machine.Table(
+            parameters, result.get<util::json::Buffer>(), consume);
+    }
+    return BaseService::routing_machine.Table(parameters, result.get<util::json::Buffer>());
 }
 }
 }
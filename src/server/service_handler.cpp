@@ -9,6 +9,7 @@
 
 #include "server/api/parsed_url.hpp"
 #include "util/json_util.hpp"
+#include "util/log.hpp"
 
 #include <memory>
 
@@ -16,18 +17,38 @@ namespace osrm
 {
 namespace server
 {
-ServiceHandler::ServiceHandler(osrm::EngineConfig &config) : routing_machine(config)
+ServiceHandler::ServiceHandler(osrm::EngineConfig &config, const std::size_t response_cache_size)
+    : routing_machine(config)
 {
-    service_map["route"] = std::make_unique<service::RouteService>(routing_machine);
+    if (response_cache_size > 0)
+    {
+        response_cache = std::make_unique<ResponseCache>(response_cache_size);
+    }
+
+    service_map["route"] =
+        std::make_unique<service::RouteService>(routing_machine, response_cache.get());
     service_map["table"] = std::make_unique<service::TableService>(routing_machine);
-    service_map["nearest"] = std::make_unique<service::NearestService>(routing_machine);
+    service_map["nearest"] =
+        std::make_unique<service::NearestService>(routing_machine, response_cache.get());
     service_map["trip"] = std::make_unique<service::TripService>(routing_machine);
     service_map["match"] = std::make_unique<service::MatchService>(routing_machine);
     service_map["tile"] = std::make_unique<service::TileService>(routing_machine);
 }
 
-engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
-                                        service::BaseService::ResultT &result)
+ServiceHandler::~ServiceHandler()
+{
+    if (response_cache)
+    {
+        const auto statistics = response_cache->GetStatistics();
+        util::Log() << "Response cache: " << statistics.hits << " hits, " << statistics.misses
+                    << " misses, " << statistics.evictions << " evictions, "
+                    << statistics.invalidations << " invalidated, " << statistics.entries
+                    << " entries with " << statistics.bytes << " bytes";
+    }
+}
+
+service::BaseService *ServiceHandler::FindService(const api::ParsedURL &parsed_url,
+                                                  ResultT &result)
 {
     const auto &service_iter = service_map.find(parsed_url.service);
     if (service_iter == service_map.end())
@@ -36,7 +57,7 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
         auto &json_result = result.get<util::json::Object>();
         json_result.values["code"] = "InvalidService";
         json_result.values["message"] = "Service " + parsed_url.service + " not found!";
-        return engine::Status::Error;
+        return nullptr;
     }
     auto &service = service_iter->second;
 
@@ -46,10 +67,38 @@ engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
         auto &json_result = result.get<util::json::Object>();
         json_result.values["code"] = "InvalidVersion";
         json_result.values["message"] = "Service " + parsed_url.service + " not found!";
+        return nullptr;
+    }
+
+    return service.get();
+}
+
+engine::Status ServiceHandler::RunQuery(api::ParsedURL parsed_url,
+                                        service::BaseService::ResultT &result,
+                                        const util::json::BufferConsumer &consume)
+{
+    const auto service = FindService(parsed_url, result);
+    if (!service)
+    {
+        return engine::Status::Error;
+    }
+
+    return service->RunStreamingQuery(
+        parsed_url.prefix_length, parsed_url.query, result, consume);
+}
+
+engine::Status ServiceHandler::RunBodyQuery(api::ParsedURL parsed_url,
+                                            const std::vector<char> &body,
+                                            service::BaseService::ResultT &result,
+                                            const util::json::BufferConsumer &consume)
+{
+    const auto service = FindService(parsed_url, result);
+    if (!service)
+    {
         return engine::Status::Error;
     }
 
-    return service->RunQuery(parsed_url.prefix_length, parsed_url.query, result);
+    return service->RunBodyQuery(body, result, consume);
 }
 }
 }
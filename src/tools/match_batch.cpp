@@ -0,0 +1,398 @@
+#include "util/exception.hpp"
+#include "util/exception_utils.hpp"
+#include "util/log.hpp"
+#include "util/meminfo.hpp"
+#include "util/timing_util.hpp"
+#include "util/version.hpp"
+
+#include "osrm/coordinate.hpp"
+#include "osrm/engine_config.hpp"
+#include "osrm/exception.hpp"
+#include "osrm/json_container.hpp"
+#include "osrm/match_parameters.hpp"
+#include "osrm/osrm.hpp"
+#include "osrm/status.hpp"
+#include "osrm/storage_config.hpp"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/program_options.hpp>
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace osrm;
+
+namespace osrm
+{
+namespace engine
+{
+std::istream &operator>>(std::istream &in, EngineConfig::Algorithm &algorithm)
+{
+    std::string token;
+    in >> token;
+    boost::to_lower(token);
+
+    if (token == "ch" || token == "corech")
+        algorithm = EngineConfig::Algorithm::CH;
+    else if (token == "mld")
+        algorithm = EngineConfig::Algorithm::MLD;
+    else
+        throw boost::program_options::validation_error(
+            boost::program_options::validation_error::invalid_option_value);
+    return in;
+}
+}
+}
+
+namespace
+{
+struct Trace
+{
+    std::string id;
+    std::vector<util::Coordinate> coordinates;
+    std::vector<unsigned> timestamps;
+};
+
+// Reads traces from lines of "id,longitude,latitude[,timestamp]", the points of a trace are
+// consecutive lines with its id
+class TraceReader
+{
+  public:
+    explicit TraceReader(std::istream &input) : input(input) {}
+
+    // Reads up to max_traces traces, returns false at the end of the input
+    bool Read(const std::size_t max_traces, std::vector<Trace> &traces)
+    {
+        traces.clear();
+        while (has_line || NextLine())
+        {
+            std::istringstream fields(line);
+            std::string id, longitude, latitude, timestamp;
+            std::getline(fields, id, ',');
+            std::getline(fields, longitude, ',');
+            std::getline(fields, latitude, ',');
+            const bool has_timestamp = static_cast<bool>(std::getline(fields, timestamp, ','));
+
+            if (traces.empty() || traces.back().id != id)
+            {
+                if (traces.size() == max_traces)
+                {
+                    // the line starts the first trace of the next batch
+                    return true;
+                }
+                traces.push_back(Trace{id, {}, {}});
+            }
+            has_line = false;
+
+            auto &trace = traces.back();
+            try
+            {
+                trace.coordinates.emplace_back(util::FloatLongitude{std::stod(longitude)},
+                                               util::FloatLatitude{std::stod(latitude)});
+                if (has_timestamp)
+                    trace.timestamps.push_back(std::stoul(timestamp));
+            }
+            catch (const std::logic_error &)
+            {
+                throw util::exception("Invalid trace point in line " +
+                                      std::to_string(line_number) + ": " + line);
+            }
+        }
+        return !traces.empty();
+    }
+
+  private:
+    bool NextLine()
+    {
+        while (std::getline(input, line))
+        {
+            ++line_number;
+            if (!line.empty() && line.front() != '#')
+            {
+                has_line = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::istream &input;
+    std::string line;
+    bool has_line = false;
+    std::size_t line_number = 0;
+};
+
+// Writes a line of "id,matching,confidence,distance,duration,indices,geometry" for each
+// matching, indices are the ;-separated indices of the matched trace points
+void writeMatchings(const std::string &trace_id,
+                    const util::json::Object &result,
+                    std::string &output)
+{
+    const auto &matchings = result.values.at("matchings").get<util::json::Array>().values;
+    const auto &tracepoints = result.values.at("tracepoints").get<util::json::Array>().values;
+
+    std::vector<std::string> matched_indices(matchings.size());
+    for (std::size_t index = 0; index < tracepoints.size(); ++index)
+    {
+        if (tracepoints[index].is<util::json::Null>())
+            continue;
+
+        const auto matchings_index = static_cast<std::size_t>(tracepoints[index]
+                                                                  .get<util::json::Object>()
+                                                                  .values.at("matchings_index")
+                                                                  .get<util::json::Number>()
+                                                                  .value);
+        auto &indices = matched_indices[matchings_index];
+        if (!indices.empty())
+            indices += ';';
+        indices += std::to_string(index);
+    }
+
+    std::ostringstream lines;
+    lines << std::fixed;
+    for (std::size_t index = 0; index < matchings.size(); ++index)
+    {
+        const auto &matching = matchings[index].get<util::json::Object>().values;
+        lines << trace_id << ',' << index << ',' << std::setprecision(3)
+              << matching.at("confidence").get<util::json::Number>().value << ','
+              << std::setprecision(1) << matching.at("distance").get<util::json::Number>().value
+              << ',' << matching.at("duration").get<util::json::Number>().value << ','
+              << matched_indices[index] << ','
+              << matching.at("geometry").get<util::json::String>().value << '\n';
+    }
+    output = lines.str();
+}
+}
+
+int main(int argc, const char *argv[]) try
+{
+    util::LogPolicy::GetInstance().Unmute();
+
+    EngineConfig config;
+    boost::filesystem::path base_path;
+    std::string input_path;
+    std::string output_path;
+    std::string gaps;
+    bool tidy = false;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t batch_size = 10000;
+
+    using boost::program_options::value;
+
+    boost::program_options::options_description generic_options("Options");
+    generic_options.add_options()            //
+        ("version,v", "Show version")        //
+        ("help,h", "Show this help message") //
+        ("verbosity,l",
+         value<std::string>(&config.verbosity)->default_value("INFO"),
+         std::string("Log verbosity level: " + util::LogPolicy::GetLevels()).c_str());
+
+    boost::program_options::options_description config_options("Configuration");
+    config_options.add_options() //
+        ("input,i",
+         value<std::string>(&input_path)->default_value("-"),
+         "Traces as lines of id,longitude,latitude[,timestamp], - for stdin") //
+        ("output,o",
+         value<std::string>(&output_path)->default_value("-"),
+         "Matchings as lines of id,matching,confidence,distance,duration,indices,geometry, - "
+         "for stdout") //
+        ("threads,t",
+         value<unsigned>(&threads)->default_value(threads),
+         "Number of threads matching traces") //
+        ("batch-size",
+         value<std::size_t>(&batch_size)->default_value(batch_size),
+         "Number of traces read and matched at once") //
+        ("gaps",
+         value<std::string>(&gaps)->default_value("split"),
+         "Split traces at large timestamp gaps (split) or not (ignore)") //
+        ("tidy",
+         value<bool>(&tidy)->implicit_value(true)->default_value(false),
+         "Remove points of traces that are too close to each other") //
+        ("shared-memory,s",
+         value<bool>(&config.use_shared_memory)->implicit_value(true)->default_value(false),
+         "Load data from shared memory") //
+        ("dataset-name",
+         value<std::string>(&config.dataset_name),
+         "Name of the shared memory dataset to connect to.") //
+        ("algorithm,a",
+         value<EngineConfig::Algorithm>(&config.algorithm)
+             ->default_value(EngineConfig::Algorithm::CH, "CH"),
+         "Algorithm to use for the data. Can be CH, CoreCH, MLD.");
+
+    boost::program_options::options_description hidden_options("Hidden options");
+    hidden_options.add_options()(
+        "base,b", value<boost::filesystem::path>(&base_path), "base path to .osrm file");
+
+    boost::program_options::positional_options_description positional_options;
+    positional_options.add("base", 1);
+
+    boost::program_options::options_description cmdline_options;
+    cmdline_options.add(generic_options).add(config_options).add(hidden_options);
+
+    boost::program_options::options_description visible_options(
+        boost::filesystem::path(argv[0]).filename().string() + " <base.osrm> [<options>]");
+    visible_options.add(generic_options).add(config_options);
+
+    boost::program_options::variables_map option_variables;
+    try
+    {
+        boost::program_options::store(boost::program_options::command_line_parser(argc, argv)
+                                          .options(cmdline_options)
+                                          .positional(positional_options)
+                                          .run(),
+                                      option_variables);
+    }
+    catch (const boost::program_options::error &e)
+    {
+        util::Log(logERROR) << e.what();
+        return EXIT_FAILURE;
+    }
+
+    if (option_variables.count("version"))
+    {
+        std::cout << OSRM_VERSION << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    if (option_variables.count("help"))
+    {
+        std::cout << visible_options;
+        return EXIT_SUCCESS;
+    }
+
+    boost::program_options::notify(option_variables);
+
+    // the data is either loaded from shared memory or from the base path
+    if (config.use_shared_memory == (option_variables.count("base") > 0))
+    {
+        util::Log(logERROR) << (config.use_shared_memory
+                                    ? "Shared memory settings conflict with path settings."
+                                    : "Either a base path or --shared-memory is required.");
+        std::cout << visible_options;
+        return EXIT_FAILURE;
+    }
+
+    if (gaps != "split" && gaps != "ignore")
+    {
+        util::Log(logERROR) << "Invalid gaps " << gaps << ", expected split or ignore";
+        return EXIT_FAILURE;
+    }
+
+    util::LogPolicy::GetInstance().SetLevel(config.verbosity);
+
+    if (!base_path.empty())
+    {
+        config.storage_config = storage::StorageConfig(base_path);
+    }
+    if (!config.use_shared_memory && !config.storage_config.IsValid())
+    {
+        util::Log(logERROR) << "Required files are missing, cannot continue";
+        return EXIT_FAILURE;
+    }
+    // one search context per matching thread
+    config.max_search_contexts = threads;
+
+    const OSRM osrm{config};
+
+    std::ifstream input_file;
+    if (input_path != "-")
+    {
+        input_file.open(input_path);
+        if (!input_file)
+        {
+            util::Log(logERROR) << "Can't open " << input_path;
+            return EXIT_FAILURE;
+        }
+    }
+    std::ofstream output_file;
+    if (output_path != "-")
+    {
+        output_file.open(output_path);
+        if (!output_file)
+        {
+            util::Log(logERROR) << "Can't open " << output_path;
+            return EXIT_FAILURE;
+        }
+    }
+    TraceReader reader(input_path == "-" ? std::cin : input_file);
+    std::ostream &output = output_path == "-" ? std::cout : output_file;
+
+    TIMER_START(matching);
+    std::size_t number_of_traces = 0;
+    std::atomic<std::size_t> number_of_failed_traces{0};
+    std::vector<Trace> traces;
+    std::vector<MatchParameters> parameters;
+    std::vector<std::string> outputs;
+    while (reader.Read(std::max<std::size_t>(1, batch_size), traces))
+    {
+        parameters.resize(traces.size());
+        for (std::size_t index = 0; index < traces.size(); ++index)
+        {
+            auto &trace_parameters = parameters[index];
+            trace_parameters = MatchParameters{};
+            trace_parameters.coordinates = std::move(traces[index].coordinates);
+            // timestamps are given for all points or for none
+            if (traces[index].timestamps.size() == trace_parameters.coordinates.size())
+                trace_parameters.timestamps = std::move(traces[index].timestamps);
+            trace_parameters.geometries = MatchParameters::GeometriesType::Polyline6;
+            trace_parameters.overview = MatchParameters::OverviewType::Full;
+            trace_parameters.gaps = gaps == "split" ? MatchParameters::GapsType::Split
+                                                    : MatchParameters::GapsType::Ignore;
+            trace_parameters.tidy = tidy;
+        }
+
+        outputs.assign(traces.size(), std::string{});
+        osrm.Match(
+            parameters,
+            [&](const std::size_t index, const Status status, json::Object &result) {
+                if (status == Status::Ok)
+                {
+                    writeMatchings(traces[index].id, result, outputs[index]);
+                    return;
+                }
+                ++number_of_failed_traces;
+                util::Log(logWARNING) << "Trace " << traces[index].id << ": "
+                                      << result.values.at("code").get<json::String>().value;
+            },
+            threads);
+
+        for (const auto &trace_output : outputs)
+            output << trace_output;
+        number_of_traces += traces.size();
+    }
+    output.flush();
+    TIMER_STOP(matching);
+
+    util::Log() << "Matched " << number_of_traces << " traces in " << TIMER_SEC(matching)
+                << "s, " << number_of_failed_traces << " could not be matched";
+
+    return EXIT_SUCCESS;
+}
+catch (const osrm::RuntimeError &e)
+{
+    util::Log(logERROR) << e.what();
+    return e.GetCode();
+}
+catch (const std::bad_alloc &e)
+{
+    util::DumpMemoryStats();
+    util::Log(logWARNING) << "[exception] " << e.what();
+    util::Log(logWARNING) << "Please provide more memory or consider using a larger swapfile";
+    return EXIT_FAILURE;
+}
+catch (const std::exception &e)
+{
+    util::Log(logERROR) << "[exception] " << e.what();
+    return EXIT_FAILURE;
+}
@@ -14,10 +14,12 @@
 #include <boost/filesystem.hpp>
 #include <boost/program_options.hpp>
 
+#include <cctype>
 #include <cstdlib>
 
 #include <signal.h>
 
+#include <algorithm>
 #include <chrono>
 #include <exception>
 #include <future>
@@ -26,6 +28,8 @@
 #include <new>
 #include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #ifdef _WIN32
 boost::function0<void> console_ctrl_function;
@@ -81,7 +85,13 @@ inline unsigned generateServerProgramOptions(const int argc,
                                              int &ip_port,
                                              bool &trial,
                                              EngineConfig &config,
-                                             int &requested_thread_num)
+                                             int &requested_thread_num,
+                                             unsigned &keepalive_timeout,
+                                             unsigned &keepalive_max_requests,
+                                             unsigned &worker_threads,
+                                             std::size_t &max_queue_size,
+                                             std::vector<std::string> &service_queue_limits,
+                                             std::size_t &response_cache_size)
 {
     using boost::filesystem::path;
     using boost::program_options::value;
@@ -114,6 +124,26 @@ inline unsigned generateServerProgramOptions(const int argc,
         ("threads,t",
          value<int>(&requested_thread_num)->default_value(hardware_threads),
          "Number of threads to use") //
+        ("keepalive-timeout,k",
+         value<unsigned>(&keepalive_timeout)->default_value(5),
+         "Seconds an idle connection is kept open, 0 disables keep-alive") //
+        ("keepalive-max-requests",
+         value<unsigned>(&keepalive_max_requests)->default_value(512),
+         "Max. number of requests served over a single connection, 0 disables keep-alive") //
+        ("worker-threads",
+         value<unsigned>(&worker_threads)->default_value(0),
+         "Number of threads running queries behind a bounded queue. "
+         "Default: run queries on the connection threads") //
+        ("max-queue-size",
+         value<std::size_t>(&max_queue_size)->default_value(0),
+         "Max. number of queued requests before rejecting with 503. Default: unlimited") //
+        ("service-queue-limit",
+         value<std::vector<std::string>>(&service_queue_limits)->composing(),
+         "Max. number of pending requests of a service, e.g. trip=10. Can be repeated.") //
+        ("response-cache-size",
+         value<std::size_t>(&response_cache_size)->default_value(0),
+         "Max. size in bytes of the cache for identical route and nearest queries. "
+         "Default: no cache") //
         ("shared-memory,s",
          value<bool>(&config.use_shared_memory)->implicit_value(true)->default_value(false),
          "Load data from shared memory") //
@@ -147,7 +177,35 @@ inline unsigned generateServerProgramOptions(const int argc,
          "Max. number of alternatives supported in the MLD route query") //
         ("max-matching-radius",
          value<double>(&config.max_radius_map_matching)->default_value(-1.0),
-         "Max. radius size supported in map matching query. Default: unlimited.");
+         "Max. radius size supported in map matching query. Default: unlimited.") //
+        ("default-timeout",
+         value<int>(&config.default_timeout)->default_value(-1),
+         "Time budget of a query in milliseconds, requests can only lower it. "
+         "Default: unlimited.") //
+        ("max-search-contexts",
+         value<unsigned>(&config.max_search_contexts)->default_value(0),
+         "Max. number of search contexts kept for running queries, each holds the heaps of "
+         "one query or of a thread of a parallel query. Default: number of threads running "
+         "queries.") //
+        ("max-table-threads",
+         value<unsigned>(&config.max_table_threads)->default_value(1),
+         "Max. number of threads running the searches of a single table query") //
+        ("max-route-threads",
+         value<unsigned>(&config.max_route_threads)->default_value(1),
+         "Max. number of threads searching the legs of a single route query with u-turns "
+         "at the waypoints") //
+        ("max-snapping-threads",
+         value<unsigned>(&config.max_snapping_threads)->default_value(1),
+         "Max. number of threads snapping the coordinates of a single query") //
+        ("max-table-target-sets",
+         value<unsigned>(&config.max_table_target_sets)->default_value(16),
+         "Max. number of named table target sets, 0 disables them") //
+        ("max-match-sessions",
+         value<unsigned>(&config.max_match_sessions)->default_value(1024),
+         "Max. number of map matching sessions, 0 disables them") //
+        ("match-session-timeout",
+         value<unsigned>(&config.match_session_timeout)->default_value(300),
+         "Seconds after which idle map matching sessions are removed, 0 keeps them");
 
     // hidden options, will be allowed on command line, but will not be shown to the user
     boost::program_options::options_description hidden_options("Hidden options");
@@ -229,8 +287,26 @@ int main(int argc, const char *argv[]) try
     boost::filesystem::path base_path;
 
     int requested_thread_num = 1;
-    const unsigned init_result = generateServerProgramOptions(
-        argc, argv, base_path, ip_address, ip_port, trial_run, config, requested_thread_num);
+    unsigned keepalive_timeout = 5;
+    unsigned keepalive_max_requests = 512;
+    unsigned worker_threads = 0;
+    std::size_t max_queue_size = 0;
+    std::vector<std::string> service_queue_limit_options;
+    std::size_t response_cache_size = 0;
+    const unsigned init_result = generateServerProgramOptions(argc,
+                                                              argv,
+                                                              base_path,
+                                                              ip_address,
+                                                              ip_port,
+                                                              trial_run,
+                                                              config,
+                                                              requested_thread_num,
+                                                              keepalive_timeout,
+                                                              keepalive_max_requests,
+                                                              worker_threads,
+                                                              max_queue_size,
+                                                              service_queue_limit_options,
+                                                              response_cache_size);
     if (init_result == INIT_OK_DO_NOT_START_ENGINE)
     {
         return EXIT_SUCCESS;
@@ -267,9 +343,32 @@ int main(int argc, const char *argv[]) try
         util::Log() << "Loading from shared memory";
     }
 
+    std::unordered_map<std::string, std::size_t> service_queue_limits;
+    for (const auto &option : service_queue_limit_options)
+    {
+        const auto separator = option.find('=');
+        const auto limit =
+            separator == std::string::npos ? std::string{} : option.substr(separator + 1);
+        if (limit.empty() || !std::all_of(limit.begin(), limit.end(), ::isdigit))
+        {
+            util::Log(logERROR) << "Invalid service queue limit " << option
+                                << ", expected <service>=<limit>";
+            return EXIT_FAILURE;
+        }
+        service_queue_limits[option.substr(0, separator)] = std::stoul(limit);
+    }
+
+    // queries only run on the worker threads if there are any
+    if (config.max_search_contexts == 0)
+    {
+        config.max_search_contexts =
+            worker_threads > 0 ? worker_threads : static_cast<unsigned>(requested_thread_num);
+    }
+
     util::Log() << "Threads: " << requested_thread_num;
     util::Log() << "IP address: " << ip_address;
     util::Log() << "IP port: " << ip_port;
+    util::Log() << "Keep-alive timeout: " << keepalive_timeout << "s";
 
 #ifndef _WIN32
     int sig = 0;
@@ -279,8 +378,20 @@ int main(int argc, const char *argv[]) try
     pthread_sigmask(SIG_BLOCK, &new_mask, &old_mask);
 #endif
 
-    auto service_handler = std::make_unique<server::ServiceHandler>(config);
-    auto routing_server = server::Server::CreateServer(ip_address, ip_port, requested_thread_num);
+    if (response_cache_size > 0)
+    {
+        util::Log() << "Response cache size: " << response_cache_size << " bytes";
+    }
+
+    auto service_handler = std::make_unique<server::ServiceHandler>(config, response_cache_size);
+    auto routing_server = server::Server::CreateServer(ip_address,
+                                                       ip_port,
+                                                       requested_thread_num,
+                                                       keepalive_timeout,
+                                                       keepalive_max_requests,
+                                                       worker_threads,
+                                                       max_queue_size,
+                                                       std::move(service_queue_limits));
 
     routing_server->RegisterServiceHandler(std::move(service_handler));
 
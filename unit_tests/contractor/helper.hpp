@@ -21,14 +21,17 @@ inline contractor::ContractorGraph makeGraph(const std::vector<TestEdge> &edges)
         int weight;
         std::tie(start, target, weight) = edge;
         max_id = std::max(std::max(start, target), max_id);
+        const auto distance = static_cast<EdgeDistance>(weight);
         input_edges.push_back(contractor::ContractorEdge{
             start,
             target,
-            contractor::ContractorEdgeData{weight, weight * 2, id++, 0, false, true, false}});
+            contractor::ContractorEdgeData{
+                weight, weight * 2, distance, id++, 0, false, true, false}});
         input_edges.push_back(contractor::ContractorEdge{
             target,
             start,
-            contractor::ContractorEdgeData{weight, weight * 2, id++, 0, false, false, true}});
+            contractor::ContractorEdgeData{
+                weight, weight * 2, distance, id++, 0, false, false, true}});
     }
     std::sort(input_edges.begin(), input_edges.end());
 
@@ -0,0 +1,143 @@
+#include "engine/routing_algorithms/bucket_relaxation.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include <boost/mpl/list.hpp>
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(bucket_relaxation)
+
+using namespace osrm;
+using namespace osrm::engine::routing_algorithms;
+
+namespace
+{
+struct Tables
+{
+    explicit Tables(const std::size_t number_of_columns, std::mt19937 &generator)
+    {
+        // some entries are still unreached, others have the same weight as new paths
+        std::uniform_int_distribution<EdgeWeight> values(0, 200);
+        for (std::size_t column = 0; column < number_of_columns; ++column)
+        {
+            const auto weight = values(generator);
+            weights.push_back(weight > 150 ? INVALID_EDGE_WEIGHT : weight);
+            durations.push_back(weight > 150 ? MAXIMAL_EDGE_DURATION : values(generator));
+            distances.push_back(weight > 150 ? INVALID_EDGE_DISTANCE : values(generator));
+        }
+    }
+
+    TableRow Row() { return {weights.data(), durations.data(), distances.data()}; }
+
+    std::vector<EdgeWeight> weights;
+    std::vector<EdgeDuration> durations;
+    std::vector<EdgeDistance> distances;
+};
+}
+
+using Metrics = boost::mpl::list<TableMetrics<true, true>,
+                                 TableMetrics<true, false>,
+                                 TableMetrics<false, true>,
+                                 TableMetrics<false, false>>;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(same_tables_as_scalar_kernel, MetricsT, Metrics)
+{
+    const std::size_t number_of_columns = 100;
+    std::mt19937 generator(1337);
+    std::uniform_int_distribution<EdgeWeight> values(0, 100);
+
+    // all lengths around the vector widths, the buckets of a node are in different columns
+    for (std::size_t number_of_buckets = 0; number_of_buckets < 40; ++number_of_buckets)
+    {
+        std::vector<std::uint32_t> column_indices(number_of_columns);
+        std::iota(column_indices.begin(), column_indices.end(), 0);
+        std::shuffle(column_indices.begin(), column_indices.end(), generator);
+        column_indices.resize(number_of_buckets);
+
+        std::vector<EdgeWeight> weights;
+        std::vector<EdgeDuration> durations;
+        std::vector<EdgeDistance> distances;
+        for (std::size_t bucket = 0; bucket < number_of_buckets; ++bucket)
+        {
+            weights.push_back(values(generator));
+            durations.push_back(values(generator));
+            distances.push_back(values(generator));
+        }
+        const NodeBuckets buckets{column_indices.data(),
+                                  weights.data(),
+                                  durations.data(),
+                                  distances.data(),
+                                  number_of_buckets};
+
+        const auto seed = generator();
+        std::mt19937 table_generator(seed);
+        Tables expected(number_of_columns, table_generator);
+        relaxBuckets<MetricsT>(buckets, 50, 50, 50, expected.Row(), BucketKernel::Scalar);
+
+        for (const auto kernel : {BucketKernel::SSE41, BucketKernel::AVX2})
+        {
+            if (!isSupported(kernel))
+                continue;
+
+            table_generator.seed(seed);
+            Tables result(number_of_columns, table_generator);
+            relaxBuckets<MetricsT>(buckets, 50, 50, 50, result.Row(), kernel);
+
+            BOOST_CHECK_EQUAL_COLLECTIONS(expected.weights.begin(),
+                                          expected.weights.end(),
+                                          result.weights.begin(),
+                                          result.weights.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(expected.durations.begin(),
+                                          expected.durations.end(),
+                                          result.durations.begin(),
+                                          result.durations.end());
+            BOOST_CHECK_EQUAL_COLLECTIONS(expected.distances.begin(),
+                                          expected.distances.end(),
+                                          result.distances.begin(),
+                                          result.distances.end());
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(scalar_kernel_keeps_better_paths)
+{
+    const std::vector<std::uint32_t> column_indices = {2, 0, 1};
+    const std::vector<EdgeWeight> weights = {10, 10, 20};
+    const std::vector<EdgeDuration> durations = {3, 1, 1};
+    const std::vector<EdgeDistance> distances = {1, 2, 3};
+    const NodeBuckets buckets{
+        column_indices.data(), weights.data(), durations.data(), distances.data(), 3};
+
+    std::vector<EdgeWeight> row_weights = {INVALID_EDGE_WEIGHT, 15, 15};
+    std::vector<EdgeDuration> row_durations = {MAXIMAL_EDGE_DURATION, 0, 10};
+    std::vector<EdgeDistance> row_distances = {INVALID_EDGE_DISTANCE, 0, 0};
+    relaxBuckets<TableMetrics<true, true>>(
+        buckets,
+        5,
+        5,
+        5,
+        {row_weights.data(), row_durations.data(), row_distances.data()},
+        BucketKernel::Scalar);
+
+    // a new path, a worse path and a path of the same weight with a shorter duration
+    const std::vector<EdgeWeight> expected_weights = {15, 15, 15};
+    const std::vector<EdgeDuration> expected_durations = {6, 0, 8};
+    const std::vector<EdgeDistance> expected_distances = {7, 0, 6};
+    BOOST_CHECK_EQUAL_COLLECTIONS(
+        row_weights.begin(), row_weights.end(), expected_weights.begin(), expected_weights.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(row_durations.begin(),
+                                  row_durations.end(),
+                                  expected_durations.begin(),
+                                  expected_durations.end());
+    BOOST_CHECK_EQUAL_COLLECTIONS(row_distances.begin(),
+                                  row_distances.end(),
+                                  expected_distances.begin(),
+                                  expected_distances.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
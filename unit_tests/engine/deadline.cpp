@@ -0,0 +1,70 @@
+#include "engine/deadline.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE(deadline)
+
+using namespace osrm::engine;
+
+BOOST_AUTO_TEST_CASE(unlimited_never_expires)
+{
+    Deadline deadline;
+    BOOST_CHECK(deadline.IsUnlimited());
+    BOOST_CHECK(!deadline.Expired());
+    for (auto i = 0u; i < 2 * Deadline::CHECK_INTERVAL; ++i)
+    {
+        BOOST_CHECK_NO_THROW(deadline.Check());
+    }
+    BOOST_CHECK_NO_THROW(deadline.CheckNow());
+}
+
+BOOST_AUTO_TEST_CASE(expired_deadline_throws)
+{
+    Deadline deadline{std::chrono::milliseconds(1)};
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    BOOST_CHECK(deadline.Expired());
+    BOOST_CHECK_THROW(deadline.CheckNow(), DeadlineExceeded);
+
+    // the clock is only consulted every CHECK_INTERVAL calls
+    BOOST_CHECK_THROW(
+        {
+            for (auto i = 0u; i < Deadline::CHECK_INTERVAL; ++i)
+                deadline.Check();
+        },
+        DeadlineExceeded);
+}
+
+BOOST_AUTO_TEST_CASE(scoped_deadline)
+{
+    BOOST_CHECK(Deadline::Current().IsUnlimited());
+    {
+        ScopedDeadline scoped(Deadline{std::chrono::milliseconds(100)});
+        BOOST_CHECK(!Deadline::Current().IsUnlimited());
+    }
+    BOOST_CHECK(Deadline::Current().IsUnlimited());
+}
+
+BOOST_AUTO_TEST_CASE(query_deadline)
+{
+    BOOST_CHECK(Deadline::ForQuery(-1, boost::none).IsUnlimited());
+    BOOST_CHECK(!Deadline::ForQuery(-1, 100u).IsUnlimited());
+    BOOST_CHECK(!Deadline::ForQuery(100, boost::none).IsUnlimited());
+
+    // the request can only lower the default budget
+    const auto lowered = Deadline::ForQuery(100000, 0u);
+    const auto kept = Deadline::ForQuery(0, 100000u);
+    // budgets beyond the range of int neither wrap around nor lift the default
+    const auto huge = Deadline::ForQuery(0, 3000000000u);
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    BOOST_CHECK(lowered.Expired());
+    BOOST_CHECK(kept.Expired());
+    BOOST_CHECK(!huge.IsUnlimited());
+    BOOST_CHECK(huge.Expired());
+    BOOST_CHECK(!Deadline::ForQuery(-1, 3000000000u).IsUnlimited());
+    BOOST_CHECK(!Deadline::ForQuery(-1, 3000000000u).Expired());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
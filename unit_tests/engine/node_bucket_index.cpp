@@ -0,0 +1,68 @@
+#include "engine/routing_algorithms/many_to_many.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(node_bucket_index)
+
+using namespace osrm;
+using namespace osrm::engine::routing_algorithms;
+
+BOOST_AUTO_TEST_CASE(empty_index)
+{
+    const NodeBucketIndex index;
+    BOOST_CHECK_EQUAL(index.GetNumberOfBuckets(), 0);
+    BOOST_CHECK(index.GetBuckets(0).empty());
+    BOOST_CHECK(index.GetBuckets(42).empty());
+}
+
+BOOST_AUTO_TEST_CASE(same_buckets_as_sorted_vector)
+{
+    std::mt19937 generator(1337);
+    // clustered node ids like the search spaces of neighbouring targets
+    std::uniform_int_distribution<NodeID> nodes(1000, 1500);
+
+    std::vector<NodeBucket> buckets;
+    for (unsigned column = 0; column < 100; ++column)
+    {
+        std::vector<NodeID> search_space;
+        for (int count = 0; count < 50; ++count)
+            search_space.push_back(nodes(generator));
+        std::sort(search_space.begin(), search_space.end());
+        search_space.erase(std::unique(search_space.begin(), search_space.end()),
+                           search_space.end());
+
+        for (const auto node : search_space)
+            buckets.emplace_back(node, SPECIAL_NODEID, column, node + column, column, node);
+    }
+
+    const NodeBucketIndex index(buckets);
+    BOOST_CHECK_EQUAL(index.GetNumberOfBuckets(), buckets.size());
+
+    std::sort(buckets.begin(), buckets.end());
+    for (NodeID node = 900; node < 1600; ++node)
+    {
+        const auto expected =
+            std::equal_range(buckets.begin(), buckets.end(), node, NodeBucket::Compare());
+        const auto found = index.GetBuckets(node);
+        BOOST_REQUIRE_EQUAL(found.size, std::distance(expected.first, expected.second));
+
+        // the buckets of a node keep the order they were added in, by column here
+        auto expected_bucket = expected.first;
+        for (std::size_t bucket = 0; bucket < found.size; ++bucket)
+        {
+            BOOST_CHECK_EQUAL(expected_bucket->middle_node, node);
+            BOOST_CHECK_EQUAL(found.column_indices[bucket], expected_bucket->column_index);
+            BOOST_CHECK_EQUAL(found.weights[bucket], expected_bucket->weight);
+            BOOST_CHECK_EQUAL(found.durations[bucket], expected_bucket->duration);
+            BOOST_CHECK_EQUAL(found.distances[bucket], expected_bucket->distance);
+            ++expected_bucket;
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
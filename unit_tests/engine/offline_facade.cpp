@@ -32,7 +32,7 @@ template <> struct SearchEngineData<routing_algorithms::offline::Algorithm>
     SearchEngineHeapPtr forward_heap_1;
     SearchEngineHeapPtr reverse_heap_1;
 
-    void InitializeOrClearFirstThreadLocalStorage(unsigned number_of_nodes)
+    void InitializeOrClearFirstHeaps(unsigned number_of_nodes)
     {
         if (forward_heap_1.get())
         {
@@ -438,8 +438,8 @@ BOOST_AUTO_TEST_CASE(shortest_path)
     std::vector<osrm::engine::PhantomNodes> phantom_nodes;
     phantom_nodes.push_back({osrm::engine::PhantomNode{}, osrm::engine::PhantomNode{}});
 
-    auto route =
-        osrm::engine::routing_algorithms::shortestPathSearch(heaps, facade, phantom_nodes, false);
+    auto route = osrm::engine::routing_algorithms::shortestPathSearch(
+        heaps, facade, phantom_nodes, false, 1);
 
     BOOST_CHECK_EQUAL(route.shortest_path_weight, INVALID_EDGE_WEIGHT);
 }
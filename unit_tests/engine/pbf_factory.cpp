@@ -0,0 +1,87 @@
+#include "engine/api/pbf_factory.hpp"
+#include "guidance/turn_instruction.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <protozero/pbf_reader.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(pbf_factory)
+
+using namespace osrm;
+using namespace osrm::engine::api;
+
+BOOST_AUTO_TEST_CASE(geometry_is_delta_encoded)
+{
+    const std::vector<util::Coordinate> coordinates = {
+        {util::FloatLongitude{13.388860}, util::FloatLatitude{52.517037}},
+        {util::FloatLongitude{13.397634}, util::FloatLatitude{52.529407}},
+        {util::FloatLongitude{13.388860}, util::FloatLatitude{52.517037}}};
+
+    std::string buffer;
+    {
+        protozero::pbf_writer writer(buffer);
+        pbf::writeGeometry(writer, pbf::route::geometry, coordinates.begin(), coordinates.end());
+    }
+
+    protozero::pbf_reader reader(buffer);
+    BOOST_REQUIRE(reader.next(pbf::route::geometry));
+    const auto range = reader.get_packed_sint32();
+    const std::vector<std::int32_t> values(range.begin(), range.end());
+    const std::vector<std::int32_t> expected = {13388860, 52517037, 8774, 12370, -8774, -12370};
+    BOOST_CHECK_EQUAL_COLLECTIONS(values.begin(), values.end(), expected.begin(), expected.end());
+    BOOST_CHECK(!reader.next());
+}
+
+BOOST_AUTO_TEST_CASE(error_response)
+{
+    std::string buffer = "leftover";
+    pbf::writeError(buffer, "NoSegment", "Could not find a matching segment for any coordinate");
+
+    protozero::pbf_reader reader(buffer);
+    BOOST_REQUIRE(reader.next(pbf::response::code));
+    BOOST_CHECK_EQUAL(reader.get_string(), "NoSegment");
+    BOOST_REQUIRE(reader.next(pbf::response::message));
+    BOOST_CHECK_EQUAL(reader.get_string(), "Could not find a matching segment for any coordinate");
+    BOOST_CHECK(!reader.next());
+}
+
+BOOST_AUTO_TEST_CASE(step_maneuver)
+{
+    engine::guidance::StepManeuver maneuver = engine::guidance::getInvalidStepManeuver();
+    maneuver.location = util::Coordinate{util::FloatLongitude{-1.5}, util::FloatLatitude{2.25}};
+    maneuver.bearing_before = 359;
+    maneuver.bearing_after = 90;
+    maneuver.instruction = {osrm::guidance::TurnType::Turn,
+                            osrm::guidance::DirectionModifier::Left};
+
+    std::string buffer;
+    {
+        protozero::pbf_writer writer(buffer);
+        pbf::writeStepManeuver(writer, maneuver);
+    }
+
+    protozero::pbf_reader reader(buffer);
+    BOOST_REQUIRE(reader.next(pbf::maneuver::type));
+    BOOST_CHECK_EQUAL(reader.get_string(), "turn");
+    BOOST_REQUIRE(reader.next(pbf::maneuver::modifier));
+    BOOST_CHECK_EQUAL(reader.get_string(), "left");
+    BOOST_REQUIRE(reader.next(pbf::maneuver::location));
+    const auto location = reader.get_packed_sint32();
+    const std::vector<std::int32_t> lon_lat(location.begin(), location.end());
+    BOOST_REQUIRE_EQUAL(lon_lat.size(), 2);
+    BOOST_CHECK_EQUAL(lon_lat[0], -1500000);
+    BOOST_CHECK_EQUAL(lon_lat[1], 2250000);
+    BOOST_REQUIRE(reader.next(pbf::maneuver::bearing_before));
+    BOOST_CHECK_EQUAL(reader.get_uint32(), 359);
+    BOOST_REQUIRE(reader.next(pbf::maneuver::bearing_after));
+    BOOST_CHECK_EQUAL(reader.get_uint32(), 90);
+    // no exit for plain turns
+    BOOST_CHECK(!reader.next());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
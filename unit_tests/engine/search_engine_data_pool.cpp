@@ -0,0 +1,181 @@
+#include "engine/search_engine_data_pool.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(search_engine_data_pool)
+
+using namespace osrm;
+using namespace osrm::engine;
+
+using CH = routing_algorithms::ch::Algorithm;
+using MLD = routing_algorithms::mld::Algorithm;
+
+BOOST_AUTO_TEST_CASE(reuses_returned_contexts)
+{
+    SearchEngineDataPool<CH> pool;
+
+    const SearchEngineData<CH> *first_context = nullptr;
+    {
+        auto context = pool.Acquire();
+        first_context = &*context;
+    }
+    {
+        auto context = pool.Acquire();
+        BOOST_CHECK_EQUAL(&*context, first_context);
+    }
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.contexts, 1);
+    BOOST_CHECK_EQUAL(statistics.acquisitions, 2);
+    BOOST_CHECK_EQUAL(statistics.contended_acquisitions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(grows_with_concurrent_queries)
+{
+    SearchEngineDataPool<CH> pool;
+    {
+        auto first = pool.Acquire();
+        auto second = pool.Acquire();
+        BOOST_CHECK(&*first != &*second);
+    }
+    auto third = pool.Acquire();
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.contexts, 2);
+    BOOST_CHECK_EQUAL(statistics.acquisitions, 3);
+}
+
+BOOST_AUTO_TEST_CASE(waits_for_context_at_limit)
+{
+    SearchEngineDataPool<CH> pool(1);
+
+    auto context = std::make_unique<SearchEngineDataPool<CH>::Handle>(pool.Acquire());
+    std::atomic<bool> acquired{false};
+    std::thread waiting([&] {
+        auto other = pool.Acquire();
+        acquired = true;
+    });
+
+    // the second query can only run once the first one returned its context
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    BOOST_CHECK(!acquired);
+    context.reset();
+    waiting.join();
+    BOOST_CHECK(acquired);
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.contexts, 1);
+    BOOST_CHECK_EQUAL(statistics.acquisitions, 2);
+    BOOST_CHECK_EQUAL(statistics.contended_acquisitions, 1);
+    BOOST_CHECK(statistics.wait_time.count() > 0);
+}
+
+BOOST_AUTO_TEST_CASE(try_acquire_does_not_wait)
+{
+    SearchEngineDataPool<CH> pool(2);
+
+    auto first = pool.TryAcquire();
+    auto second = pool.TryAcquire();
+    BOOST_CHECK(first && second);
+    BOOST_CHECK(!pool.TryAcquire());
+    second = boost::none;
+    BOOST_CHECK(pool.TryAcquire());
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.contexts, 2);
+    BOOST_CHECK_EQUAL(statistics.acquisitions, 3);
+    BOOST_CHECK_EQUAL(statistics.contended_acquisitions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(workers_share_the_pool_of_the_query)
+{
+    SearchEngineDataPool<CH> pool(3);
+    ScopedSearchEngineDataPool<CH> scoped_pool(pool);
+    BOOST_CHECK_EQUAL(SearchEngineDataPool<CH>::Current(), &pool);
+
+    auto query_context = pool.Acquire();
+    auto other_query_context = pool.Acquire();
+    {
+        // the query context and the context left in the pool
+        WorkerSearchContexts<CH> workers(*query_context, 8);
+        BOOST_CHECK_EQUAL(workers.Size(), 2);
+
+        // the workers never wait for the pool, they get fewer contexts instead
+        WorkerSearchContexts<CH> other_workers(*other_query_context, 8);
+        BOOST_CHECK_EQUAL(other_workers.Size(), 1);
+        other_workers.Run([&](SearchEngineData<CH> &context) {
+            BOOST_CHECK_EQUAL(&context, &*other_query_context);
+        });
+    }
+
+    const auto statistics = pool.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.contexts, 3);
+    BOOST_CHECK_EQUAL(statistics.contended_acquisitions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(workers_without_pool)
+{
+    BOOST_CHECK(!SearchEngineDataPool<MLD>::Current());
+
+    SearchEngineData<MLD> query_context;
+    WorkerSearchContexts<MLD> workers(query_context, 4);
+    BOOST_CHECK_EQUAL(workers.Size(), 4);
+
+    std::vector<SearchEngineData<MLD> *> contexts;
+    std::mutex mutex;
+    std::vector<std::thread> threads;
+    for (int index = 0; index < 4; ++index)
+    {
+        threads.emplace_back([&] {
+            workers.Run([&](SearchEngineData<MLD> &context) {
+                std::lock_guard<std::mutex> lock(mutex);
+                contexts.push_back(&context);
+            });
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    BOOST_CHECK_EQUAL(contexts.size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(heaps_are_allocated_lazily)
+{
+    SearchEngineData<CH> ch_heaps;
+    BOOST_CHECK(!ch_heaps.forward_heap_1);
+    BOOST_CHECK(!ch_heaps.many_to_many_heap);
+
+    ch_heaps.InitializeOrClearManyToManyHeap(10);
+    BOOST_CHECK(ch_heaps.many_to_many_heap);
+    BOOST_CHECK(!ch_heaps.forward_heap_1);
+
+    ch_heaps.InitializeOrClearFirstHeaps(10);
+    ch_heaps.forward_heap_1->Insert(1, 0, 1);
+    const auto *forward_heap = ch_heaps.forward_heap_1.get();
+    ch_heaps.InitializeOrClearFirstHeaps(10);
+    BOOST_CHECK_EQUAL(ch_heaps.forward_heap_1.get(), forward_heap);
+    BOOST_CHECK(ch_heaps.forward_heap_1->Empty());
+
+    SearchEngineData<MLD> mld_heaps;
+    mld_heaps.InitializeOrClearFirstHeaps(10, 5);
+    mld_heaps.InitializeOrClearManyToManyHeap(10, 5);
+    BOOST_CHECK(mld_heaps.forward_heap_1);
+    BOOST_CHECK(mld_heaps.many_to_many_heap);
+
+    // a dataset with more nodes drops all heaps sized for the previous one
+    mld_heaps.InitializeOrClearFirstHeaps(20, 8);
+    BOOST_CHECK(mld_heaps.forward_heap_1);
+    BOOST_CHECK(!mld_heaps.many_to_many_heap);
+    mld_heaps.forward_heap_1->Insert(7, 0, 7);
+    mld_heaps.forward_heap_1->Insert(19, 0, 19);
+    BOOST_CHECK_EQUAL(mld_heaps.forward_heap_1->Size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -13,8 +13,102 @@
 #include "osrm/osrm.hpp"
 #include "osrm/status.hpp"
 
+#include "engine/approach.hpp"
+#include "engine/datafacade_provider.hpp"
+#include "engine/routing_algorithms/routing_base_ch.hpp"
+#include "engine/routing_algorithms/routing_base_mld.hpp"
+#include "engine/search_engine_data.hpp"
+#include "storage/storage_config.hpp"
+
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(match)
 
+namespace
+{
+// The transition search of the matching finds the distances of all candidates of the next
+// timestamp at once, they have to be the distances of the searches between the pairs
+template <typename Algorithm>
+void checkNetworkDistances(osrm::engine::SearchEngineData<Algorithm> &heaps,
+                           const osrm::engine::DataFacade<Algorithm> &facade)
+{
+    using namespace osrm;
+
+    std::vector<engine::PhantomNode> phantom_nodes;
+    for (int lon = 0; lon < 4; ++lon)
+    {
+        for (int lat = 0; lat < 4; ++lat)
+        {
+            const util::Coordinate coordinate{util::FloatLongitude{7.415 + lon * 0.001},
+                                              util::FloatLatitude{43.73 + lat * 0.001}};
+            phantom_nodes.push_back(facade
+                                        .NearestPhantomNodeWithAlternativeFromBigComponent(
+                                            coordinate, engine::Approach::UNRESTRICTED)
+                                        .first);
+        }
+    }
+
+    auto &forward_heap = *heaps.forward_heap_1;
+    auto &reverse_heap = *heaps.reverse_heap_1;
+
+    // the bounded searches also miss the farther targets
+    for (const EdgeWeight weight_upper_bound : {INVALID_EDGE_WEIGHT, 1500})
+    {
+        for (const auto &source_phantom : phantom_nodes)
+        {
+            const auto distances = getNetworkDistances(heaps,
+                                                       facade,
+                                                       forward_heap,
+                                                       reverse_heap,
+                                                       source_phantom,
+                                                       phantom_nodes,
+                                                       weight_upper_bound);
+            BOOST_REQUIRE_EQUAL(distances.size(), phantom_nodes.size());
+
+            for (std::size_t target = 0; target < phantom_nodes.size(); ++target)
+            {
+                const auto distance = getNetworkDistance(heaps,
+                                                         facade,
+                                                         forward_heap,
+                                                         reverse_heap,
+                                                         source_phantom,
+                                                         phantom_nodes[target],
+                                                         weight_upper_bound);
+                BOOST_CHECK_EQUAL(distances[target], distance);
+            }
+        }
+    }
+}
+}
+
+BOOST_AUTO_TEST_CASE(test_match_network_distances_ch)
+{
+    using namespace osrm;
+    using CH = engine::routing_algorithms::ch::Algorithm;
+
+    const storage::StorageConfig config{OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    engine::ImmutableProvider<CH> provider(config);
+    const auto facade = provider.Get(engine::api::BaseParameters{});
+
+    engine::SearchEngineData<CH> heaps;
+    heaps.InitializeOrClearFirstHeaps(facade->GetNumberOfNodes());
+    checkNetworkDistances(heaps, *facade);
+}
+
+BOOST_AUTO_TEST_CASE(test_match_network_distances_mld)
+{
+    using namespace osrm;
+    using MLD = engine::routing_algorithms::mld::Algorithm;
+
+    const storage::StorageConfig config{OSRM_TEST_DATA_DIR "/mld/monaco.osrm"};
+    engine::ImmutableProvider<MLD> provider(config);
+    const auto facade = provider.Get(engine::api::BaseParameters{});
+
+    engine::SearchEngineData<MLD> heaps;
+    heaps.InitializeOrClearFirstHeaps(facade->GetNumberOfNodes(), facade->GetMaxBorderNodeID() + 1);
+    checkNetworkDistances(heaps, *facade);
+}
+
 BOOST_AUTO_TEST_CASE(test_match)
 {
     using namespace osrm;
@@ -116,4 +210,126 @@ BOOST_AUTO_TEST_CASE(test_match_split)
     }
 }
 
+BOOST_AUTO_TEST_CASE(test_match_session)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    const auto locations = get_split_trace_locations();
+    const std::vector<unsigned> timestamps = {1, 2, 1700, 1800};
+
+    // the points arrive one by one, the last request closes the session
+    std::size_t number_of_matchings = 0;
+    for (std::size_t index = 0; index < locations.size(); ++index)
+    {
+        MatchParameters params;
+        params.session = "vehicle";
+        params.coordinates.push_back(locations[index]);
+        params.timestamps.push_back(timestamps[index]);
+        params.close_session = index + 1 == locations.size();
+
+        json::Object result;
+        const auto rc = osrm.Match(params, result);
+        BOOST_CHECK(rc == Status::Ok);
+        BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "Ok");
+
+        // the tracepoints reach from the first matched point up to the appended one
+        const auto offset = result.values.at("tracepoints_offset").get<json::Number>().value;
+        const auto &tracepoints = result.values.at("tracepoints").get<json::Array>().values;
+        BOOST_CHECK_LE(offset, index);
+        BOOST_CHECK_EQUAL(offset + tracepoints.size(), index + 1);
+
+        const auto &matchings = result.values.at("matchings").get<json::Array>().values;
+        for (const auto &waypoint : tracepoints)
+        {
+            if (waypoint.is<mapbox::util::recursive_wrapper<util::json::Object>>())
+            {
+                BOOST_CHECK(waypoint_check(waypoint));
+                const auto matchings_index = waypoint.get<json::Object>()
+                                                 .values.at("matchings_index")
+                                                 .get<json::Number>()
+                                                 .value;
+                BOOST_CHECK_LT(matchings_index, matchings.size());
+            }
+        }
+        number_of_matchings += matchings.size();
+    }
+    // the trace is split by the time gap
+    BOOST_CHECK_GE(number_of_matchings, 2);
+
+    MatchParameters params;
+    params.session = "vehicle";
+    params.close_session = true;
+
+    json::Object result;
+    const auto rc = osrm.Match(params, result);
+    BOOST_CHECK(rc == Status::Error);
+    BOOST_CHECK_EQUAL(result.values.at("code").get<json::String>().value, "InvalidValue");
+}
+
+BOOST_AUTO_TEST_CASE(test_match_batch)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    std::vector<MatchParameters> params(5);
+    for (auto &trace_params : params)
+    {
+        trace_params.coordinates = get_split_trace_locations();
+        trace_params.timestamps = {1, 2, 1700, 1800};
+    }
+    params[1].timestamps.clear();
+    params[3].coordinates.assign(3, get_dummy_location());
+    params[3].timestamps.clear();
+    // the timestamps don't match the coordinates
+    params[4].timestamps.pop_back();
+
+    std::vector<std::size_t> number_of_calls(params.size(), 0);
+    std::vector<Status> statuses(params.size());
+    std::vector<json::Object> results(params.size());
+    const auto rc = osrm.Match(
+        params,
+        [&](const std::size_t index, const Status status, json::Object &result) {
+            ++number_of_calls[index];
+            statuses[index] = status;
+            results[index] = std::move(result);
+        },
+        2);
+    BOOST_CHECK(rc == Status::Ok);
+
+    // every trace is handled once with the result of matching it alone
+    for (std::size_t index = 0; index < params.size(); ++index)
+    {
+        BOOST_CHECK_EQUAL(number_of_calls[index], 1);
+
+        json::Object result;
+        const auto status = params[index].IsValid() ? osrm.Match(params[index], result)
+                                                    : Status::Error;
+        BOOST_CHECK(statuses[index] == status);
+        if (status == Status::Error)
+        {
+            BOOST_CHECK_EQUAL(results[index].values.at("code").get<json::String>().value,
+                              "InvalidOptions");
+            continue;
+        }
+
+        const auto &batch_matchings =
+            results[index].values.at("matchings").get<json::Array>().values;
+        const auto &matchings = result.values.at("matchings").get<json::Array>().values;
+        BOOST_REQUIRE_EQUAL(batch_matchings.size(), matchings.size());
+        for (std::size_t matching = 0; matching < matchings.size(); ++matching)
+        {
+            const auto &batch_values = batch_matchings[matching].get<json::Object>().values;
+            const auto &values = matchings[matching].get<json::Object>().values;
+            BOOST_CHECK_EQUAL(batch_values.at("confidence").get<json::Number>().value,
+                              values.at("confidence").get<json::Number>().value);
+            BOOST_CHECK_EQUAL(batch_values.at("distance").get<json::Number>().value,
+                              values.at("distance").get<json::Number>().value);
+        }
+    }
+    BOOST_CHECK(statuses[4] == Status::Error);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
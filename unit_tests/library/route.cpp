@@ -456,4 +456,43 @@ BOOST_AUTO_TEST_CASE(test_manual_setting_of_annotations_property)
     BOOST_CHECK_EQUAL(annotations.size(), 6);
 }
 
+BOOST_AUTO_TEST_CASE(test_route_parallel_legs)
+{
+    using namespace osrm;
+
+    for (const auto &algorithm : {std::make_pair(EngineConfig::Algorithm::CH, "/ch/monaco.osrm"),
+                                  std::make_pair(EngineConfig::Algorithm::MLD, "/mld/monaco.osrm")})
+    {
+        EngineConfig config;
+        config.storage_config = {OSRM_TEST_DATA_DIR + std::string(algorithm.second)};
+        config.use_shared_memory = false;
+        config.algorithm = algorithm.first;
+        config.max_route_threads = 4;
+        const OSRM parallel_osrm{config};
+        auto osrm = getOSRM(OSRM_TEST_DATA_DIR + std::string(algorithm.second), algorithm.first);
+
+        RouteParameters params;
+        for (int waypoint = 0; waypoint < 12; ++waypoint)
+        {
+            params.coordinates.push_back(
+                util::Coordinate{util::FloatLongitude{7.41 + (waypoint % 4) * 0.003},
+                                 util::FloatLatitude{43.72 + (waypoint / 4) * 0.004}});
+        }
+        params.coordinates.push_back(params.coordinates.back());
+        params.steps = true;
+
+        // the legs are only independent if u-turns are allowed at the waypoints
+        for (const bool continue_straight : {false, true})
+        {
+            params.continue_straight = continue_straight;
+
+            json::Object expected;
+            BOOST_CHECK(osrm.Route(params, expected) == Status::Ok);
+            json::Object result;
+            BOOST_CHECK(parallel_osrm.Route(params, result) == Status::Ok);
+            CHECK_EQUAL_JSON(expected, result);
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -2,6 +2,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include "coordinates.hpp"
+#include "equal_json.hpp"
 #include "fixture.hpp"
 #include "waypoint_check.hpp"
 
@@ -13,6 +14,20 @@
 #include "osrm/osrm.hpp"
 #include "osrm/status.hpp"
 
+#include "engine/api/pbf_schema.hpp"
+#include "engine/approach.hpp"
+#include "engine/datafacade_provider.hpp"
+#include "engine/routing_algorithms/many_to_many.hpp"
+#include "engine/search_engine_data.hpp"
+#include "storage/storage_config.hpp"
+#include "util/json_renderer.hpp"
+
+#include <protozero/pbf_reader.hpp>
+
+#include <numeric>
+#include <string>
+#include <vector>
+
 BOOST_AUTO_TEST_SUITE(table)
 
 BOOST_AUTO_TEST_CASE(test_table_three_coords_one_source_one_dest_matrix)
@@ -187,4 +202,422 @@ BOOST_AUTO_TEST_CASE(test_table_no_segment_for_some_coordinates)
     BOOST_CHECK_EQUAL(code, "NoSegment");
 }
 
+BOOST_AUTO_TEST_CASE(test_table_rendered_response)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.sources.push_back(0);
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    json::Object object_result;
+    BOOST_CHECK(osrm.Table(params, object_result) == Status::Ok);
+    std::vector<char> expected;
+    json::render(expected, object_result);
+
+    std::vector<char> rendered_result;
+    BOOST_CHECK(osrm.Table(params, rendered_result) == Status::Ok);
+
+    // the object keys are unordered, so only the size has to match exactly
+    const std::string rendered(rendered_result.begin(), rendered_result.end());
+    BOOST_CHECK_EQUAL(rendered_result.size(), expected.size());
+    BOOST_CHECK(rendered.find("\"code\":\"Ok\"") != std::string::npos);
+    BOOST_CHECK(rendered.find("\"durations\":[[") != std::string::npos);
+    BOOST_CHECK(rendered.find("\"distances\":[[") != std::string::npos);
+
+    // resembles query option: `&radiuses=0;;`
+    params.radiuses.push_back(boost::make_optional(0.));
+    params.radiuses.push_back(boost::none);
+    params.radiuses.push_back(boost::none);
+    BOOST_CHECK(osrm.Table(params, rendered_result) == Status::Error);
+    BOOST_CHECK_EQUAL(std::string(rendered_result.begin(), rendered_result.end()).find(
+                          "\"code\":\"NoSegment\""),
+                      1);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_streamed_response)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    // enough cells for more than one block of rows
+    TableParameters params;
+    for (int index = 0; index < 600; ++index)
+        params.coordinates.push_back(get_dummy_location());
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    std::vector<char> expected;
+    BOOST_CHECK(osrm.Table(params, expected) == Status::Ok);
+
+    std::vector<char> streamed;
+    std::size_t number_of_parts = 0;
+    std::vector<char> rendered_result;
+    BOOST_CHECK(osrm.Table(params, rendered_result, [&](std::vector<char> &part) {
+        streamed.insert(streamed.end(), part.begin(), part.end());
+        part.clear();
+        ++number_of_parts;
+    }) == Status::Ok);
+    streamed.insert(streamed.end(), rendered_result.begin(), rendered_result.end());
+
+    // the waypoints, two blocks of durations and the distances of both blocks
+    BOOST_CHECK_EQUAL(number_of_parts, 5);
+    BOOST_CHECK(streamed == expected);
+
+    // errors are reported before anything is streamed
+    params.radiuses.push_back(boost::make_optional(0.));
+    params.radiuses.resize(params.coordinates.size());
+    number_of_parts = 0;
+    BOOST_CHECK(osrm.Table(params, rendered_result, [&](std::vector<char> &) {
+        ++number_of_parts;
+    }) == Status::Error);
+    BOOST_CHECK_EQUAL(number_of_parts, 0);
+    BOOST_CHECK_EQUAL(std::string(rendered_result.begin(), rendered_result.end()).find(
+                          "\"code\":\"NoSegment\""),
+                      1);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_pbf_response)
+{
+    using namespace osrm;
+    namespace pbf = engine::api::pbf;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.coordinates.push_back(get_dummy_location());
+    params.sources.push_back(0);
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    json::Object object_result;
+    BOOST_CHECK(osrm.Table(params, object_result) == Status::Ok);
+    const auto &json_durations =
+        object_result.values.at("durations").get<json::Array>().values.at(0).get<json::Array>();
+
+    std::string pbf_result;
+    BOOST_CHECK(osrm.Table(params, pbf_result) == Status::Ok);
+
+    std::string code;
+    std::size_t number_of_sources = 0;
+    std::size_t number_of_destinations = 0;
+    std::vector<double> durations;
+    std::vector<double> distances;
+    protozero::pbf_reader response(pbf_result);
+    while (response.next())
+    {
+        switch (response.tag())
+        {
+        case pbf::response::code:
+            code = response.get_string();
+            break;
+        case pbf::response::sources:
+            response.skip();
+            ++number_of_sources;
+            break;
+        case pbf::response::destinations:
+            response.skip();
+            ++number_of_destinations;
+            break;
+        case pbf::response::durations:
+        {
+            const auto range = response.get_packed_double();
+            durations.assign(range.begin(), range.end());
+            break;
+        }
+        case pbf::response::distances:
+        {
+            const auto range = response.get_packed_double();
+            distances.assign(range.begin(), range.end());
+            break;
+        }
+        default:
+            BOOST_ERROR("unexpected field " << response.tag());
+            response.skip();
+        }
+    }
+
+    BOOST_CHECK_EQUAL(code, "Ok");
+    BOOST_CHECK_EQUAL(number_of_sources, 1);
+    BOOST_CHECK_EQUAL(number_of_destinations, 3);
+    BOOST_REQUIRE_EQUAL(durations.size(), json_durations.values.size());
+    BOOST_CHECK_EQUAL(distances.size(), 3);
+    for (std::size_t column = 0; column < durations.size(); ++column)
+    {
+        BOOST_CHECK_EQUAL(durations[column],
+                          json_durations.values[column].get<json::Number>().value);
+    }
+
+    // resembles query option: `&radiuses=0;;`
+    params.radiuses.push_back(boost::make_optional(0.));
+    params.radiuses.push_back(boost::none);
+    params.radiuses.push_back(boost::none);
+    BOOST_CHECK(osrm.Table(params, pbf_result) == Status::Error);
+    protozero::pbf_reader error(pbf_result);
+    BOOST_REQUIRE(error.next(pbf::response::code));
+    BOOST_CHECK_EQUAL(error.get_string(), "NoSegment");
+}
+
+BOOST_AUTO_TEST_CASE(test_table_parallel_searches)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_table_threads = 4;
+    const OSRM parallel_osrm{config};
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    for (const auto &locations : {get_split_trace_locations(),
+                                  get_locations_in_small_component(),
+                                  get_locations_in_big_component()})
+    {
+        params.coordinates.insert(params.coordinates.end(), locations.begin(), locations.end());
+    }
+    params.annotations = TableParameters::AnnotationsType::All;
+
+    json::Object expected;
+    BOOST_CHECK(osrm.Table(params, expected) == Status::Ok);
+    json::Object result;
+    BOOST_CHECK(parallel_osrm.Table(params, result) == Status::Ok);
+
+    // the same searches, only on several threads
+    CHECK_EQUAL_JSON(expected.values.at("durations"), result.values.at("durations"));
+    CHECK_EQUAL_JSON(expected.values.at("distances"), result.values.at("distances"));
+}
+
+BOOST_AUTO_TEST_CASE(test_table_parallel_snapping)
+{
+    using namespace osrm;
+
+    EngineConfig config;
+    config.storage_config = {OSRM_TEST_DATA_DIR "/ch/monaco.osrm"};
+    config.use_shared_memory = false;
+    config.max_snapping_threads = 4;
+    const OSRM parallel_osrm{config};
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    // enough coordinates to be snapped in several chunks
+    TableParameters params;
+    for (int lon = 0; lon < 16; ++lon)
+    {
+        for (int lat = 0; lat < 16; ++lat)
+        {
+            params.coordinates.push_back(
+                util::Coordinate{util::FloatLongitude{7.41 + lon * 0.001},
+                                 util::FloatLatitude{43.72 + lat * 0.001}});
+        }
+    }
+    params.sources = {0, 17, 200};
+
+    json::Object expected;
+    BOOST_CHECK(osrm.Table(params, expected) == Status::Ok);
+    json::Object result;
+    BOOST_CHECK(parallel_osrm.Table(params, result) == Status::Ok);
+
+    // the same phantom nodes, only found in a different order
+    CHECK_EQUAL_JSON(expected.values.at("sources"), result.values.at("sources"));
+    CHECK_EQUAL_JSON(expected.values.at("destinations"), result.values.at("destinations"));
+    CHECK_EQUAL_JSON(expected.values.at("durations"), result.values.at("durations"));
+
+    // and the same coordinate is reported as the one without a segment
+    params.radiuses.resize(params.coordinates.size());
+    params.radiuses[100] = 0.;
+    params.radiuses[150] = 0.;
+    json::Object expected_error;
+    BOOST_CHECK(osrm.Table(params, expected_error) == Status::Error);
+    json::Object error;
+    BOOST_CHECK(parallel_osrm.Table(params, error) == Status::Error);
+    CHECK_EQUAL_JSON(expected_error, error);
+}
+
+BOOST_AUTO_TEST_CASE(test_table_restricted_phast)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    // large enough for the restricted PHAST search
+    TableParameters params;
+    for (int lon = 0; lon < 32; ++lon)
+    {
+        for (int lat = 0; lat < 32; ++lat)
+        {
+            params.coordinates.push_back({util::FloatLongitude{7.41 + lon * 0.001},
+                                          util::FloatLatitude{43.72 + lat * 0.001}});
+        }
+    }
+    for (std::size_t source = 0; source < 64; ++source)
+    {
+        params.sources.push_back(source * 16);
+    }
+
+    params.annotations = TableParameters::AnnotationsType::All;
+    json::Object result;
+    BOOST_CHECK(osrm.Table(params, result) == Status::Ok);
+    const auto &durations = result.values.at("durations").get<json::Array>().values;
+    const auto &distances = result.values.at("distances").get<json::Array>().values;
+    BOOST_CHECK_EQUAL(durations.size(), params.sources.size());
+
+    // every row on its own uses the bucket search
+    const auto sources = params.sources;
+    for (std::size_t row = 0; row < sources.size(); ++row)
+    {
+        params.sources = {sources[row]};
+        json::Object expected;
+        BOOST_CHECK(osrm.Table(params, expected) == Status::Ok);
+
+        CHECK_EQUAL_JSON(expected.values.at("durations").get<json::Array>().values.front(),
+                         durations[row]);
+        CHECK_EQUAL_JSON(expected.values.at("distances").get<json::Array>().values.front(),
+                         distances[row]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_table_single_annotation)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    TableParameters params;
+    params.coordinates = get_locations_in_big_component();
+    params.annotations = TableParameters::AnnotationsType::All;
+    json::Object expected;
+    BOOST_CHECK(osrm.Table(params, expected) == Status::Ok);
+
+    // the searches only compute the requested metric
+    params.annotations = TableParameters::AnnotationsType::Distance;
+    json::Object distances;
+    BOOST_CHECK(osrm.Table(params, distances) == Status::Ok);
+    BOOST_CHECK(distances.values.count("durations") == 0);
+    CHECK_EQUAL_JSON(expected.values.at("distances"), distances.values.at("distances"));
+
+    params.annotations = TableParameters::AnnotationsType::Duration;
+    json::Object durations;
+    BOOST_CHECK(osrm.Table(params, durations) == Status::Ok);
+    BOOST_CHECK(durations.values.count("distances") == 0);
+    CHECK_EQUAL_JSON(expected.values.at("durations"), durations.values.at("durations"));
+}
+
+BOOST_AUTO_TEST_CASE(test_table_target_set)
+{
+    using namespace osrm;
+
+    auto osrm = getOSRM(OSRM_TEST_DATA_DIR "/ch/monaco.osrm");
+
+    const auto targets = get_locations_in_big_component();
+    const auto sources = get_split_trace_locations();
+
+    TableParameters register_params;
+    register_params.coordinates = targets;
+    register_params.target_set = "depots";
+    register_params.register_target_set = true;
+    json::Object registered;
+    BOOST_CHECK(osrm.Table(register_params, registered) == Status::Ok);
+    BOOST_CHECK_EQUAL(registered.values.at("code").get<json::String>().value, "Ok");
+    BOOST_CHECK_EQUAL(registered.values.at("destinations").get<json::Array>().values.size(),
+                      targets.size());
+    BOOST_CHECK(registered.values.count("durations") == 0);
+
+    TableParameters params;
+    params.coordinates = sources;
+    params.coordinates.insert(params.coordinates.end(), targets.begin(), targets.end());
+    for (std::size_t index = 0; index < params.coordinates.size(); ++index)
+    {
+        (index < sources.size() ? params.sources : params.destinations).push_back(index);
+    }
+    params.annotations = TableParameters::AnnotationsType::All;
+    json::Object expected;
+    BOOST_CHECK(osrm.Table(params, expected) == Status::Ok);
+
+    // the coordinates of the request are the sources, the targets of the set its destinations
+    TableParameters set_params;
+    set_params.coordinates = sources;
+    set_params.target_set = "depots";
+    set_params.annotations = TableParameters::AnnotationsType::All;
+    json::Object result;
+    BOOST_CHECK(osrm.Table(set_params, result) == Status::Ok);
+    CHECK_EQUAL_JSON(expected.values.at("durations"), result.values.at("durations"));
+    CHECK_EQUAL_JSON(expected.values.at("distances"), result.values.at("distances"));
+    BOOST_CHECK_EQUAL(result.values.at("destinations").get<json::Array>().values.size(),
+                      targets.size());
+
+    set_params.target_set = "warehouses";
+    json::Object unknown;
+    BOOST_CHECK(osrm.Table(set_params, unknown) == Status::Error);
+    BOOST_CHECK_EQUAL(unknown.values.at("code").get<json::String>().value, "InvalidOptions");
+}
+
+BOOST_AUTO_TEST_CASE(test_table_mld_source_groups)
+{
+    using namespace osrm;
+    using MLD = engine::routing_algorithms::mld::Algorithm;
+
+    const storage::StorageConfig config{OSRM_TEST_DATA_DIR "/mld/monaco.osrm"};
+    engine::ImmutableProvider<MLD> provider(config);
+    const auto facade = provider.Get(engine::api::BaseParameters{});
+    engine::SearchEngineData<MLD> heaps;
+
+    std::vector<engine::PhantomNode> phantom_nodes;
+    for (int lon = 0; lon < 8; ++lon)
+    {
+        for (int lat = 0; lat < 8; ++lat)
+        {
+            const util::Coordinate coordinate{util::FloatLongitude{7.41 + lon * 0.002},
+                                              util::FloatLatitude{43.72 + lat * 0.002}};
+            phantom_nodes.push_back(facade
+                                        ->NearestPhantomNodeWithAlternativeFromBigComponent(
+                                            coordinate, engine::Approach::UNRESTRICTED)
+                                        .first);
+        }
+    }
+
+    // more sources than targets are searched transposed
+    for (const std::size_t number_of_sources : {16, 48})
+    {
+        std::vector<std::size_t> source_indices(number_of_sources);
+        std::iota(source_indices.begin(), source_indices.end(), 0);
+        std::vector<std::size_t> target_indices(phantom_nodes.size() - number_of_sources);
+        std::iota(target_indices.begin(), target_indices.end(), number_of_sources);
+
+        const auto expected = engine::routing_algorithms::mld::manyToManySearch(heaps,
+                                                                                *facade,
+                                                                                phantom_nodes,
+                                                                                source_indices,
+                                                                                target_indices,
+                                                                                false,
+                                                                                true,
+                                                                                INVALID_LEVEL_ID)
+                                  .first;
+        BOOST_CHECK_EQUAL(expected.size(), source_indices.size() * target_indices.size());
+
+        // the sources in a cell of any level find the same paths over the exits of the cell
+        const auto &partition = facade->GetMultiLevelPartition();
+        for (LevelID level = 1; level < partition.GetNumberOfLevels(); ++level)
+        {
+            const auto durations =
+                engine::routing_algorithms::mld::manyToManySearch(heaps,
+                                                                  *facade,
+                                                                  phantom_nodes,
+                                                                  source_indices,
+                                                                  target_indices,
+                                                                  false,
+                                                                  true,
+                                                                  level)
+                    .first;
+            BOOST_CHECK_EQUAL_COLLECTIONS(
+                expected.begin(), expected.end(), durations.begin(), durations.end());
+        }
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
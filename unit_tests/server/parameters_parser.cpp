@@ -55,6 +55,7 @@ BOOST_AUTO_TEST_CASE(invalid_route_urls)
                       32UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?generate_hints=notboolean"),
                       23UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?timeout=-1"), 16UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&geometries=foo"),
                       34UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4?overview=false&overview=foo"),
@@ -68,6 +69,8 @@ BOOST_AUTO_TEST_CASE(invalid_route_urls)
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4.json?nooptions"), 13);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4..json?nooptions"), 14);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4.0.json?nooptions"), 15);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4.xml"), 8);
+    BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>("1,2;3,4.pbf.json"), 11);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>(std::string{"1,2;3,4"} + '\0' + ".json"),
                       7);
     BOOST_CHECK_EQUAL(testInvalidOptions<RouteParameters>(std::string{"1,2;3,"} + '\0'), 6);
@@ -85,6 +88,7 @@ BOOST_AUTO_TEST_CASE(invalid_table_urls)
     BOOST_CHECK_EQUAL(
         testInvalidOptions<TableParameters>("1,2;3,4?sources=1&destinations=1&bla=foo"), 32UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?sources=foo"), 16UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?target_set=d%20pots"), 20UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<TableParameters>("1,2;3,4?destinations=foo"), 21UL);
     BOOST_CHECK_EQUAL(
         testInvalidOptions<TableParameters>("1,2;3,4?sources=all&destinations=all&annotations=bla"),
@@ -332,6 +336,15 @@ BOOST_AUTO_TEST_CASE(valid_route_urls)
     auto result_13 = parseParameters<RouteParameters>("1,2;3,4");
     BOOST_CHECK(result_13);
     BOOST_CHECK_EQUAL(result_13->generate_hints, true);
+    BOOST_CHECK(!result_13->timeout);
+
+    auto result_timeout = parseParameters<RouteParameters>("1,2;3,4?timeout=250");
+    BOOST_CHECK(result_timeout);
+    BOOST_CHECK(result_timeout->timeout);
+    BOOST_CHECK_EQUAL(*result_timeout->timeout, 250u);
+    auto result_huge_timeout = parseParameters<RouteParameters>("1,2;3,4?timeout=3000000000");
+    BOOST_CHECK(result_huge_timeout);
+    BOOST_CHECK_EQUAL(*result_huge_timeout->timeout, 3000000000u);
 
     // parse none annotations value correctly
     RouteParameters reference_14{};
@@ -563,6 +576,28 @@ BOOST_AUTO_TEST_CASE(valid_table_urls)
     BOOST_CHECK_EQUAL(result_7->annotations & TableParameters::AnnotationsType::Distance, true);
     CHECK_EQUAL_RANGE(reference_7.sources, result_7->sources);
     CHECK_EQUAL_RANGE(reference_7.destinations, result_7->destinations);
+
+    auto result_8 =
+        parseParameters<TableParameters>("1,2;3,4?target_set=depots_2-b&register_target_set=true");
+    BOOST_CHECK(result_8);
+    BOOST_CHECK_EQUAL(result_8->target_set, "depots_2-b");
+    BOOST_CHECK(result_8->register_target_set);
+    BOOST_CHECK(result_8->IsValid());
+
+    // the coordinates of requests to a target set are their sources
+    auto result_9 = parseParameters<TableParameters>("1,2?target_set=depots");
+    BOOST_CHECK(result_9);
+    BOOST_CHECK_EQUAL(result_9->target_set, "depots");
+    BOOST_CHECK(!result_9->register_target_set);
+    BOOST_CHECK(result_9->IsValid());
+
+    auto result_10 = parseParameters<TableParameters>("1,2;3,4?target_set=depots&destinations=1");
+    BOOST_CHECK(result_10);
+    BOOST_CHECK(!result_10->IsValid());
+
+    auto result_11 = parseParameters<TableParameters>("1,2;3,4?register_target_set=true");
+    BOOST_CHECK(result_11);
+    BOOST_CHECK(!result_11->IsValid());
 }
 
 BOOST_AUTO_TEST_CASE(valid_match_urls)
@@ -606,6 +641,15 @@ BOOST_AUTO_TEST_CASE(valid_match_urls)
     CHECK_EQUAL_RANGE(reference_3.radiuses, result_3->radiuses);
     CHECK_EQUAL_RANGE(reference_3.approaches, result_3->approaches);
     CHECK_EQUAL_RANGE(reference_3.coordinates, result_3->coordinates);
+
+    // sessions take single points
+    auto result_4 = parseParameters<MatchParameters>("1,2?session=truck_7-a&close_session=true");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK_EQUAL(result_4->session, "truck_7-a");
+    BOOST_CHECK(result_4->close_session);
+    BOOST_CHECK(result_4->IsValid());
+    const std::vector<util::Coordinate> coords_3 = {coords_1.front()};
+    CHECK_EQUAL_RANGE(coords_3, result_4->coordinates);
 }
 
 BOOST_AUTO_TEST_CASE(invalid_match_urls)
@@ -631,6 +675,7 @@ BOOST_AUTO_TEST_CASE(invalid_match_urls)
     BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?waypoints=0,4"), 19UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?waypoints=x;4"), 18UL);
     BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?waypoints=0;3.5"), 21UL);
+    BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4?session=a.b"), 17UL);
 }
 
 BOOST_AUTO_TEST_CASE(valid_nearest_urls)
@@ -659,6 +704,43 @@ BOOST_AUTO_TEST_CASE(valid_nearest_urls)
     CHECK_EQUAL_RANGE(reference_2.coordinates, result_2->coordinates);
 }
 
+BOOST_AUTO_TEST_CASE(valid_format_urls)
+{
+    using OutputFormatType = BaseParameters::OutputFormatType;
+    std::vector<util::Coordinate> coords_1 = {{util::FloatLongitude{1}, util::FloatLatitude{2}},
+                                              {util::FloatLongitude{3}, util::FloatLatitude{4}}};
+
+    auto result_1 = parseParameters<RouteParameters>("1,2;3,4");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK(result_1->format == OutputFormatType::JSON);
+
+    auto result_2 = parseParameters<RouteParameters>("1,2;3,4.json?steps=true");
+    BOOST_CHECK(result_2);
+    BOOST_CHECK(result_2->format == OutputFormatType::JSON);
+    BOOST_CHECK_EQUAL(result_2->steps, true);
+
+    auto result_3 = parseParameters<RouteParameters>("1,2;3,4.pbf?steps=true");
+    BOOST_CHECK(result_3);
+    BOOST_CHECK(result_3->format == OutputFormatType::PBF);
+    BOOST_CHECK_EQUAL(result_3->steps, true);
+    CHECK_EQUAL_RANGE(coords_1, result_3->coordinates);
+
+    auto result_4 = parseParameters<TableParameters>("1,2;3.0,4.0.pbf?sources=0");
+    BOOST_CHECK(result_4);
+    BOOST_CHECK(result_4->format == OutputFormatType::PBF);
+    BOOST_CHECK_EQUAL(result_4->sources.size(), 1);
+    CHECK_EQUAL_RANGE(coords_1, result_4->coordinates);
+
+    auto result_5 = parseParameters<NearestParameters>("1,2.pbf?number=3");
+    BOOST_CHECK(result_5);
+    BOOST_CHECK(result_5->format == OutputFormatType::PBF);
+    BOOST_CHECK_EQUAL(result_5->number_of_results, 3);
+
+    // only route, table and nearest have a binary response
+    BOOST_CHECK_EQUAL(testInvalidOptions<TripParameters>("1,2;3,4.pbf"), 7);
+    BOOST_CHECK_EQUAL(testInvalidOptions<MatchParameters>("1,2;3,4.pbf"), 7);
+}
+
 BOOST_AUTO_TEST_CASE(invalid_tile_urls)
 {
     TileParameters reference_1{1, 2, 3};
@@ -0,0 +1,130 @@
+#include "server/request_parser.hpp"
+#include "server/http/request.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(request_parser)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(keep_alive_defaults)
+{
+    const auto parse = [](std::string input) {
+        RequestParser parser;
+        http::request request;
+        RequestParser::RequestStatus status;
+        http::compression_type compression;
+        char *position;
+        std::tie(status, compression, position) =
+            parser.parse(request, &input[0], &input[0] + input.size());
+        BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+        return request;
+    };
+
+    BOOST_CHECK(parse("GET /route HTTP/1.1\r\nHost: localhost\r\n\r\n").keep_alive());
+    BOOST_CHECK(!parse("GET /route HTTP/1.1\r\nConnection: close\r\n\r\n").keep_alive());
+    BOOST_CHECK(!parse("GET /route HTTP/1.0\r\nHost: localhost\r\n\r\n").keep_alive());
+    BOOST_CHECK(parse("GET /route HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n").keep_alive());
+}
+
+BOOST_AUTO_TEST_CASE(pipelined_requests)
+{
+    std::string input = "GET /nearest/v1/car/1,1 HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"
+                        "GET /nearest/v1/car/2,2 HTTP/1.1\r\n\r\n"
+                        "GET /nearest/v1/car/3,3 HTTP/1.1\r\n";
+    char *begin = &input[0];
+    char *end = begin + input.size();
+
+    RequestParser parser;
+    http::request request;
+    RequestParser::RequestStatus status;
+    http::compression_type compression;
+
+    std::tie(status, compression, begin) = parser.parse(request, begin, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(compression, http::gzip_rfc1952);
+    BOOST_CHECK_EQUAL(request.uri, "/nearest/v1/car/1,1");
+
+    parser.reset();
+    request = http::request();
+    std::tie(status, compression, begin) = parser.parse(request, begin, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(compression, http::no_compression);
+    BOOST_CHECK_EQUAL(request.uri, "/nearest/v1/car/2,2");
+
+    parser.reset();
+    request = http::request();
+    std::tie(status, compression, begin) = parser.parse(request, begin, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::indeterminate);
+    BOOST_CHECK(begin == end);
+    BOOST_CHECK_EQUAL(request.uri, "/nearest/v1/car/3,3");
+}
+
+BOOST_AUTO_TEST_CASE(request_body)
+{
+    std::string input = "POST /table/v1/car HTTP/1.1\r\nContent-Length: 10\r\n\r\n01234"
+                        "56789GET /nearest/v1/car/1,1 HTTP/1.1\r\n\r\n";
+    char *begin = &input[0];
+    char *end = begin + input.size();
+    // the body is split across two reads
+    char *split = begin + input.find("56789");
+
+    RequestParser parser;
+    http::request request;
+    RequestParser::RequestStatus status;
+    http::compression_type compression;
+
+    std::tie(status, compression, begin) = parser.parse(request, begin, split);
+    BOOST_CHECK(status == RequestParser::RequestStatus::indeterminate);
+    std::tie(status, compression, begin) = parser.parse(request, begin, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(request.method, "POST");
+    BOOST_CHECK_EQUAL(request.uri, "/table/v1/car");
+    BOOST_CHECK_EQUAL(std::string(request.body.begin(), request.body.end()), "0123456789");
+
+    parser.reset();
+    request = http::request();
+    std::tie(status, compression, begin) = parser.parse(request, begin, end);
+    BOOST_CHECK(status == RequestParser::RequestStatus::valid);
+    BOOST_CHECK_EQUAL(request.method, "GET");
+    BOOST_CHECK(request.body.empty());
+    BOOST_CHECK(begin == end);
+}
+
+BOOST_AUTO_TEST_CASE(invalid_request_bodies)
+{
+    const auto parse = [](std::string input) {
+        RequestParser parser;
+        http::request request;
+        RequestParser::RequestStatus status;
+        http::compression_type compression;
+        char *position;
+        std::tie(status, compression, position) =
+            parser.parse(request, &input[0], &input[0] + input.size());
+        return status;
+    };
+
+    BOOST_CHECK(parse("POST /table/v1/car HTTP/1.1\r\nContent-Length: 1a\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+    BOOST_CHECK(parse("POST /table/v1/car HTTP/1.1\r\nContent-Length: " +
+                      std::to_string(RequestParser::MAX_BODY_SIZE + 1) + "\r\n\r\n") ==
+                RequestParser::RequestStatus::too_large);
+    BOOST_CHECK(parse("POST /table/v1/car HTTP/1.1\r\n"
+                      "Content-Length: 99999999999999999999999\r\n\r\n") ==
+                RequestParser::RequestStatus::too_large);
+    BOOST_CHECK(parse("POST /table/v1/car HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+    // only table requests have a body, it is rejected before it arrives
+    BOOST_CHECK(parse("GET /table/v1/car/1,1;2,2 HTTP/1.1\r\nContent-Length: 10\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+    BOOST_CHECK(parse("POST /route/v1/car HTTP/1.1\r\nContent-Length: 10\r\n\r\n") ==
+                RequestParser::RequestStatus::invalid);
+    BOOST_CHECK(parse("POST /table/v1/car HTTP/1.1\r\nContent-Length: 10\r\n\r\n") ==
+                RequestParser::RequestStatus::indeterminate);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
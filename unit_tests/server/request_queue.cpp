@@ -0,0 +1,101 @@
+#include "server/request_queue.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <future>
+#include <stdexcept>
+
+BOOST_AUTO_TEST_SUITE(request_queue)
+
+using namespace osrm;
+using namespace osrm::server;
+
+BOOST_AUTO_TEST_CASE(service_name)
+{
+    BOOST_CHECK_EQUAL(RequestQueue::GetServiceName("/route/v1/driving/1,1;2,2"), "route");
+    BOOST_CHECK_EQUAL(RequestQueue::GetServiceName("//nearest/v1/driving/1,1"), "nearest");
+    BOOST_CHECK_EQUAL(RequestQueue::GetServiceName("/"), "");
+}
+
+BOOST_AUTO_TEST_CASE(rejects_when_full)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> started;
+
+    RequestQueue queue(1, 1, {{"trip", 1}});
+
+    // occupies the single worker
+    BOOST_CHECK(queue.Push("route", [&] {
+        started.set_value();
+        released.wait();
+    }));
+    started.get_future().wait();
+
+    // fills the queue, no more pending trip requests allowed
+    BOOST_CHECK(queue.Push("trip", [&] { released.wait(); }));
+    BOOST_CHECK(!queue.Push("nearest", [] {}));
+    BOOST_CHECK_EQUAL(queue.GetRejectedCount(), 1);
+
+    release.set_value();
+    queue.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(service_limit)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    RequestQueue queue(2, 0, {{"trip", 1}});
+
+    BOOST_CHECK(queue.Push("trip", [&] { released.wait(); }));
+    BOOST_CHECK(!queue.Push("trip", [] {}));
+    BOOST_CHECK(queue.Push("nearest", [] {}));
+    BOOST_CHECK_EQUAL(queue.GetRejectedCount(), 1);
+
+    release.set_value();
+    queue.Stop();
+}
+
+BOOST_AUTO_TEST_CASE(reports_failed_jobs)
+{
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    std::promise<void> started;
+    std::promise<RequestQueue::Failure> error;
+    std::promise<RequestQueue::Failure> discarded;
+    bool running_job_failed = false;
+
+    RequestQueue queue(1, 0, {});
+
+    // the exception of a job is reported instead of leaving its request unanswered
+    BOOST_CHECK(queue.Push("route",
+                           [] { throw std::runtime_error("failed"); },
+                           [&](const RequestQueue::Failure failure) { error.set_value(failure); }));
+    BOOST_CHECK(error.get_future().get() == RequestQueue::Failure::Error);
+
+    BOOST_CHECK(queue.Push("route",
+                           [&] {
+                               started.set_value();
+                               released.wait();
+                           },
+                           [&](const RequestQueue::Failure) { running_job_failed = true; }));
+    started.get_future().wait();
+    // waits behind the running job and is discarded by Stop
+    BOOST_CHECK(queue.Push("route",
+                           [] {},
+                           [&](const RequestQueue::Failure failure) {
+                               discarded.set_value(failure);
+                           }));
+
+    // Stop answers the waiting job before it waits for the running one
+    auto stopped = std::async(std::launch::async, [&] { queue.Stop(); });
+    BOOST_CHECK(discarded.get_future().get() == RequestQueue::Failure::Stopped);
+    release.set_value();
+    stopped.get();
+
+    BOOST_CHECK(!running_job_failed);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
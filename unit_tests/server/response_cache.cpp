@@ -0,0 +1,107 @@
+#include "server/api/cache_key.hpp"
+#include "server/api/parameters_parser.hpp"
+#include "server/response_cache.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(response_cache)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+std::string getContent(const std::shared_ptr<const ResponseCache::Response> &response)
+{
+    BOOST_REQUIRE(response);
+    return response->get<std::string>();
+}
+}
+
+BOOST_AUTO_TEST_CASE(hit_and_miss)
+{
+    ResponseCache cache(1 << 20);
+
+    BOOST_CHECK(!cache.Lookup("a", 0));
+    cache.Insert("a", 0, std::string("response a"));
+    BOOST_CHECK_EQUAL(getContent(cache.Lookup("a", 0)), "response a");
+    BOOST_CHECK(!cache.Lookup("b", 0));
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.hits, 1);
+    BOOST_CHECK_EQUAL(statistics.misses, 2);
+    BOOST_CHECK_EQUAL(statistics.entries, 1);
+    BOOST_CHECK(statistics.bytes > 10);
+}
+
+BOOST_AUTO_TEST_CASE(evicts_least_recently_used)
+{
+    // a single shard with room for two responses
+    const std::string response(400, 'x');
+    ResponseCache cache(1200, 1);
+
+    cache.Insert("a", 0, response);
+    cache.Insert("b", 0, response);
+    BOOST_CHECK(cache.Lookup("a", 0));
+    cache.Insert("c", 0, response);
+
+    BOOST_CHECK(cache.Lookup("a", 0));
+    BOOST_CHECK(!cache.Lookup("b", 0));
+    BOOST_CHECK(cache.Lookup("c", 0));
+    BOOST_CHECK_EQUAL(cache.GetStatistics().evictions, 1);
+
+    // larger than the shard
+    cache.Insert("d", 0, std::string(2000, 'x'));
+    BOOST_CHECK(!cache.Lookup("d", 0));
+    BOOST_CHECK_EQUAL(cache.GetStatistics().entries, 2);
+}
+
+BOOST_AUTO_TEST_CASE(invalidated_by_new_dataset)
+{
+    ResponseCache cache(1 << 20, 1);
+
+    cache.Insert("a", 0, std::string("old dataset"));
+    BOOST_CHECK(cache.Lookup("a", 0));
+    BOOST_CHECK(!cache.Lookup("a", 1));
+
+    // computed on the old dataset while the new one was already looked up
+    cache.Insert("a", 0, std::string("old dataset"));
+    BOOST_CHECK(!cache.Lookup("a", 1));
+
+    cache.Insert("a", 1, std::string("new dataset"));
+    BOOST_CHECK_EQUAL(getContent(cache.Lookup("a", 1)), "new dataset");
+
+    const auto statistics = cache.GetStatistics();
+    BOOST_CHECK_EQUAL(statistics.invalidations, 1);
+    BOOST_CHECK_EQUAL(statistics.entries, 1);
+}
+
+BOOST_AUTO_TEST_CASE(cache_key_normalizes_parameters)
+{
+    using engine::api::NearestParameters;
+    using engine::api::RouteParameters;
+
+    const auto key = [](const std::string &query) {
+        const auto parameters = api::parseParameters<RouteParameters>(query);
+        BOOST_REQUIRE(parameters);
+        return api::makeCacheKey(*parameters);
+    };
+
+    BOOST_CHECK(key("1,2;3,4?steps=true") == key("1.0,2;3,4.000?steps=true"));
+    BOOST_CHECK(key("1,2;3,4?steps=true&overview=false") ==
+                key("1,2;3,4?overview=false&steps=true"));
+    BOOST_CHECK(key("1,2;3,4") == key("1,2;3,4?alternatives=false"));
+    BOOST_CHECK(key("1,2;3,4") != key("1,2;3,4.000001"));
+    BOOST_CHECK(key("1,2;3,4") != key("1,2;3,4?steps=true"));
+    BOOST_CHECK(key("1,2;3,4") != key("1,2;3,4.pbf"));
+    BOOST_CHECK(key("1,2;3,4?radiuses=10;") != key("1,2;3,4?radiuses=;10"));
+
+    const auto nearest = api::parseParameters<NearestParameters>(std::string("1,2"));
+    BOOST_REQUIRE(nearest);
+    BOOST_CHECK(api::makeCacheKey(*nearest) != key("1,2;1,2"));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
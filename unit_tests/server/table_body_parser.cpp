@@ -0,0 +1,94 @@
+#include "server/api/table_body_parser.hpp"
+
+#include "util/debug.hpp"
+
+#include <boost/test/test_tools.hpp>
+#include <boost/test/unit_test.hpp>
+
+#define CHECK_EQUAL_RANGE(R1, R2)                                                                  \
+    BOOST_CHECK_EQUAL_COLLECTIONS(R1.begin(), R1.end(), R2.begin(), R2.end());
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(table_body_parser)
+
+using namespace osrm;
+using namespace osrm::server;
+
+namespace
+{
+// Packs the values little endian like a client on any host does
+std::vector<char> packBody(std::initializer_list<std::int64_t> values)
+{
+    std::vector<char> body;
+    for (const auto value : values)
+    {
+        const auto bits = static_cast<std::uint32_t>(value);
+        for (const auto shift : {0, 8, 16, 24})
+            body.push_back(static_cast<char>((bits >> shift) & 0xff));
+    }
+    return body;
+}
+
+std::size_t testInvalidBody(const std::vector<char> &body)
+{
+    auto iter = body.begin();
+    const auto result = api::parseTableBody(iter, body.end());
+    BOOST_CHECK(!result);
+    return std::distance(body.begin(), iter);
+}
+}
+
+BOOST_AUTO_TEST_CASE(valid_bodies)
+{
+    const auto all = api::parseTableBody(
+        packBody({2, 0, 0, 0, 7416351, 43731205, -7420363, -43736189}));
+    BOOST_REQUIRE(all);
+    BOOST_CHECK_EQUAL(all->coordinates.size(), 2);
+    BOOST_CHECK_EQUAL(all->coordinates[0],
+                      util::Coordinate(util::FloatLongitude{7.416351},
+                                       util::FloatLatitude{43.731205}));
+    BOOST_CHECK_EQUAL(all->coordinates[1],
+                      util::Coordinate(util::FloatLongitude{-7.420363},
+                                       util::FloatLatitude{-43.736189}));
+    BOOST_CHECK(all->sources.empty());
+    BOOST_CHECK(all->destinations.empty());
+    BOOST_CHECK(all->annotations == engine::api::TableParameters::AnnotationsType::Duration);
+    BOOST_CHECK(all->generate_hints);
+    BOOST_CHECK(all->IsValid());
+
+    const auto some = api::parseTableBody(packBody(
+        {3, 1, 2, 0x02 | 0x04, 1000000, 2000000, 3000000, 4000000, 5000000, 6000000, 2, 0, 1}));
+    BOOST_REQUIRE(some);
+    BOOST_CHECK_EQUAL(some->coordinates.size(), 3);
+    const std::vector<std::size_t> sources = {2};
+    const std::vector<std::size_t> destinations = {0, 1};
+    CHECK_EQUAL_RANGE(some->sources, sources);
+    CHECK_EQUAL_RANGE(some->destinations, destinations);
+    BOOST_CHECK(some->annotations == engine::api::TableParameters::AnnotationsType::Distance);
+    BOOST_CHECK(!some->generate_hints);
+    BOOST_CHECK(some->IsValid());
+
+    // indices are checked like the ones of GET requests
+    const auto out_of_range = api::parseTableBody(packBody({2, 1, 0, 0, 0, 0, 0, 0, 2}));
+    BOOST_REQUIRE(out_of_range);
+    BOOST_CHECK(!out_of_range->IsValid());
+}
+
+BOOST_AUTO_TEST_CASE(invalid_bodies)
+{
+    // too short for the header
+    BOOST_CHECK_EQUAL(testInvalidBody(std::vector<char>(10)), 8UL);
+    // unknown flag
+    BOOST_CHECK_EQUAL(testInvalidBody(packBody({1, 0, 0, 0x08, 0, 0})), 12UL);
+    // more coordinates than the body holds
+    BOOST_CHECK_EQUAL(testInvalidBody(packBody({0xffffffff, 0, 0, 0, 0, 0})), 16UL);
+    // missing destination index
+    BOOST_CHECK_EQUAL(testInvalidBody(packBody({2, 1, 1, 0, 0, 0, 0, 0, 1})), 36UL);
+    // trailing bytes
+    BOOST_CHECK_EQUAL(testInvalidBody(packBody({2, 0, 0, 0, 0, 0, 0, 0, 1})), 32UL);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
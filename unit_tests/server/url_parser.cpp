@@ -39,6 +39,14 @@ std::size_t testInvalidURL(std::string url)
     return std::distance(url.begin(), iter);
 }
 
+std::size_t testInvalidServiceURL(std::string url)
+{
+    auto iter = url.begin();
+    auto result = api::parseServiceURL(iter, url.end());
+    BOOST_CHECK(!result);
+    return std::distance(url.begin(), iter);
+}
+
 BOOST_AUTO_TEST_CASE(invalid_urls)
 {
     BOOST_CHECK_EQUAL(testInvalidURL("/route/"), 7UL);
@@ -126,4 +134,21 @@ BOOST_AUTO_TEST_CASE(valid_urls)
     BOOST_CHECK_EQUAL(reference_8.prefix_length, result_8->prefix_length);
 }
 
+BOOST_AUTO_TEST_CASE(valid_service_urls)
+{
+    api::ParsedURL reference_1{"table", 1, "car", "", 13UL};
+    auto result_1 = api::parseServiceURL("/table/v1/car");
+    BOOST_CHECK(result_1);
+    BOOST_CHECK_EQUAL(reference_1.service, result_1->service);
+    BOOST_CHECK_EQUAL(reference_1.version, result_1->version);
+    BOOST_CHECK_EQUAL(reference_1.profile, result_1->profile);
+    CHECK_EQUAL_RANGE(reference_1.query, result_1->query);
+    BOOST_CHECK_EQUAL(reference_1.prefix_length, result_1->prefix_length);
+
+    // the parameters of these requests are in the body
+    BOOST_CHECK_EQUAL(testInvalidServiceURL("/table/v1/car/"), 13UL);
+    BOOST_CHECK_EQUAL(testInvalidServiceURL("/table/v1/car/1,2;3,4"), 13UL);
+    BOOST_CHECK_EQUAL(testInvalidServiceURL("/table/v1"), 9UL);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,33 @@
+#include "storage/view_factory.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE(view_factory)
+
+using namespace osrm;
+using namespace osrm::storage;
+
+BOOST_AUTO_TEST_CASE(contracted_edge_layout_test)
+{
+    using EdgeArrayEntry = contractor::QueryGraphView::EdgeArrayEntry;
+    using NodeArrayEntry = contractor::QueryGraphView::NodeArrayEntry;
+
+    DataLayout layout;
+    layout.SetBlock("/ch/metrics/duration/contracted_graph/node_array",
+                    make_block<NodeArrayEntry>(3));
+    layout.SetBlock("/ch/metrics/duration/contracted_graph/edge_array",
+                    make_block<EdgeArrayEntry>(2));
+    // edges without the distance field of older datasets
+    layout.SetBlock("/ch/metrics/old/contracted_graph/node_array", make_block<NodeArrayEntry>(3));
+    layout.SetBlock("/ch/metrics/old/contracted_graph/edge_array",
+                    Block{2, 2 * (sizeof(EdgeArrayEntry) - sizeof(EdgeDistance))});
+
+    std::vector<char> buffer(layout.GetSizeOfLayout());
+    SharedDataIndex index{{{buffer.data(), layout}}};
+
+    const auto metric = make_contracted_metric_view(index, "/ch/metrics/duration");
+    BOOST_CHECK_EQUAL(metric.graph.GetNumberOfNodes(), 2u);
+    BOOST_CHECK_THROW(make_contracted_metric_view(index, "/ch/metrics/old"), util::RuntimeError);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,128 @@
+#include "util/cast.hpp"
+#include "util/json_container.hpp"
+#include "util/json_renderer.hpp"
+#include "util/json_writer.hpp"
+
+#include <boost/test/test_case_template.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(json_writer)
+
+using namespace osrm;
+using namespace osrm::util;
+
+namespace
+{
+std::string formatNumber(const double value)
+{
+    char buffer[json::detail::NUMBER_BUFFER_SIZE];
+    const auto length = json::detail::formatNumber(value, buffer);
+    return std::string(buffer, length);
+}
+}
+
+BOOST_AUTO_TEST_CASE(number_formatting)
+{
+    const std::vector<double> values = {0.,
+                                        -0.,
+                                        1.,
+                                        -1.,
+                                        0.5,
+                                        0.1,
+                                        123.4,
+                                        13.388798,
+                                        -52.517037,
+                                        0.0000005,
+                                        0.0000015,
+                                        -0.0000001,
+                                        1e-7,
+                                        999999.9999995,
+                                        8796092.999999,
+                                        8796093.,
+                                        1e15,
+                                        -1e300,
+                                        std::numeric_limits<double>::max()};
+    for (const auto value : values)
+    {
+        BOOST_CHECK_EQUAL(formatNumber(value), cast::to_string_with_precision(value));
+    }
+
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> coordinates(-180., 180.);
+    std::uniform_int_distribution<int> deciseconds(0, 1000000);
+    for (int i = 0; i < 100000; ++i)
+    {
+        const auto coordinate = coordinates(generator);
+        BOOST_CHECK_EQUAL(formatNumber(coordinate), cast::to_string_with_precision(coordinate));
+        const auto duration = deciseconds(generator) / 10.;
+        BOOST_CHECK_EQUAL(formatNumber(duration), cast::to_string_with_precision(duration));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(same_output_as_renderer)
+{
+    json::Array rows;
+    rows.values.push_back(json::Array{{json::Number{0.}, json::Null{}, json::Number{12.3}}});
+    rows.values.push_back(json::Array{});
+    json::Object object;
+    object.values["durations"] = std::move(rows);
+    json::Array values{{json::String{"Aleja \"Solidarnosci\"/\n"},
+                        json::True{},
+                        json::False{},
+                        std::move(object)}};
+    json::Object reference;
+    reference.values["values"] = std::move(values);
+
+    json::Buffer expected;
+    json::render(expected, reference);
+
+    json::Buffer buffer;
+    json::Writer writer(buffer);
+    writer.StartObject();
+    writer.Key("values");
+    writer.StartArray();
+    writer.String("Aleja \"Solidarnosci\"/\n");
+    writer.Bool(true);
+    writer.Bool(false);
+    writer.StartObject();
+    writer.Key("durations");
+    writer.StartArray();
+    writer.StartArray();
+    writer.Number(0.);
+    writer.Null();
+    writer.Number(12.3);
+    writer.EndArray();
+    writer.StartArray();
+    writer.EndArray();
+    writer.EndArray();
+    writer.EndObject();
+    writer.EndArray();
+    writer.EndObject();
+
+    BOOST_CHECK(writer.IsComplete());
+    BOOST_CHECK_EQUAL(std::string(buffer.begin(), buffer.end()),
+                      std::string(expected.begin(), expected.end()));
+}
+
+BOOST_AUTO_TEST_CASE(embedded_values)
+{
+    json::Object waypoint;
+    waypoint.values["name"] = "Unter den Linden";
+
+    json::Buffer buffer;
+    json::Writer writer(buffer);
+    writer.StartArray();
+    writer.Value(waypoint);
+    writer.Number(1);
+    writer.EndArray();
+
+    BOOST_CHECK_EQUAL(std::string(buffer.begin(), buffer.end()),
+                      "[{\"name\":\"Unter den Linden\"},1]");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,3 +1,4 @@
+#include "util/integer_range.hpp"
 #include "util/query_heap.hpp"
 #include "util/typedefs.hpp"
 
@@ -8,6 +9,8 @@
 #include <algorithm>
 #include <limits>
 #include <random>
+#include <set>
+#include <tuple>
 #include <vector>
 
 BOOST_AUTO_TEST_SUITE(binary_heap)
@@ -25,7 +28,9 @@ typedef int TestKey;
 typedef int TestWeight;
 typedef boost::mpl::list<ArrayStorage<TestNodeID, TestKey>,
                          MapStorage<TestNodeID, TestKey>,
-                         UnorderedMapStorage<TestNodeID, TestKey>>
+                         UnorderedMapStorage<TestNodeID, TestKey>,
+                         GenerationArrayStorage<TestNodeID, TestKey>,
+                         HybridStorage<TestNodeID, TestKey>>
     storage_types;
 
 template <unsigned NUM_ELEM> struct RandomDataFixture
@@ -157,4 +162,122 @@ BOOST_FIXTURE_TEST_CASE_TEMPLATE(decrease_key_test, T, storage_types, RandomData
     }
 }
 
+BOOST_FIXTURE_TEST_CASE_TEMPLATE(clear_test, T, storage_types, RandomDataFixture<NUM_NODES>)
+{
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, T> heap(NUM_NODES);
+
+    for (unsigned idx : order)
+    {
+        heap.Insert(ids[idx], weights[idx], data[idx]);
+    }
+
+    heap.Clear();
+    BOOST_CHECK(heap.Empty());
+    for (auto id : ids)
+    {
+        BOOST_CHECK(!heap.WasInserted(id));
+    }
+
+    // reuse the heap with a smaller search space
+    for (unsigned idx : order)
+    {
+        if (idx % 3 == 0)
+        {
+            heap.Insert(ids[idx], weights[idx], data[idx]);
+        }
+    }
+    for (auto id : ids)
+    {
+        BOOST_CHECK_EQUAL(heap.WasInserted(id), id % 3 == 0);
+    }
+    BOOST_CHECK_EQUAL(heap.Min(), 0);
+    BOOST_CHECK_EQUAL(heap.GetKey(3), weights[3]);
+}
+
+BOOST_AUTO_TEST_CASE(random_operations_test)
+{
+    constexpr unsigned number_of_nodes = 1000;
+    QueryHeap<TestNodeID, TestKey, TestWeight, TestData, ArrayStorage<TestNodeID, TestKey>> heap(
+        number_of_nodes);
+
+    // reference heap ordered by weight and insertion order like the QueryHeap
+    std::set<std::tuple<TestWeight, unsigned, TestNodeID>> reference;
+    std::vector<unsigned> insertion_order(number_of_nodes, 0);
+    unsigned inserted = 0;
+
+    std::mt19937 g(7);
+    std::uniform_int_distribution<TestNodeID> nodes(0, number_of_nodes - 1);
+    std::uniform_int_distribution<TestWeight> weights(0, 50);
+    std::uniform_int_distribution<int> operations(0, 2);
+    for (int step = 0; step < 20000; ++step)
+    {
+        const auto node = nodes(g);
+        const auto operation = operations(g);
+        if (operation == 0 && !heap.WasInserted(node))
+        {
+            const auto weight = weights(g);
+            heap.Insert(node, weight, {node});
+            insertion_order[node] = inserted++;
+            reference.emplace(weight, insertion_order[node], node);
+        }
+        else if (operation == 1 && heap.WasInserted(node) && !heap.WasRemoved(node) &&
+                 heap.GetKey(node) > 0)
+        {
+            const auto weight = heap.GetKey(node);
+            reference.erase(std::make_tuple(weight, insertion_order[node], node));
+            heap.DecreaseKey(node, weight - 1);
+            reference.emplace(weight - 1, insertion_order[node], node);
+        }
+        else if (operation == 2 && !heap.Empty())
+        {
+            BOOST_REQUIRE(!reference.empty());
+            BOOST_CHECK_EQUAL(heap.MinKey(), std::get<0>(*reference.begin()));
+            BOOST_CHECK_EQUAL(heap.DeleteMin(), std::get<2>(*reference.begin()));
+            reference.erase(reference.begin());
+        }
+        BOOST_CHECK_EQUAL(heap.Size(), reference.size());
+    }
+
+    while (!heap.Empty())
+    {
+        BOOST_CHECK_EQUAL(heap.DeleteMin(), std::get<2>(*reference.begin()));
+        reference.erase(reference.begin());
+    }
+    BOOST_CHECK(reference.empty());
+}
+
+BOOST_AUTO_TEST_CASE(hybrid_storage_promotion)
+{
+    // large enough that the hash table has to grow before it is promoted
+    constexpr std::size_t number_of_nodes = 1 << 16;
+    HybridStorage<TestNodeID, TestKey> storage(number_of_nodes);
+
+    std::mt19937 g(42);
+    std::uniform_int_distribution<TestNodeID> nodes(0, number_of_nodes - 1);
+    std::vector<TestNodeID> inserted;
+    while (!storage.IsPromoted())
+    {
+        const auto node = nodes(g);
+        if (storage.peek_index(node) == std::numeric_limits<TestKey>::max())
+        {
+            storage[node] = static_cast<TestKey>(inserted.size());
+            inserted.push_back(node);
+        }
+    }
+    BOOST_CHECK_GT(inserted.size(), 64);
+    BOOST_CHECK_LE(inserted.size(), number_of_nodes / 64);
+
+    for (const auto index : util::irange<std::size_t>(0, inserted.size()))
+    {
+        BOOST_CHECK_EQUAL(storage.peek_index(inserted[index]), index);
+    }
+
+    storage.Clear();
+    BOOST_CHECK(storage.IsPromoted());
+    for (const auto node : inserted)
+    {
+        BOOST_CHECK_EQUAL(storage.peek_index(node), std::numeric_limits<TestKey>::max());
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()